@@ -0,0 +1,342 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/bench/CMakeLists.txt"
+  "/root/repo/cmake/compile-options.cmake"
+  "/root/repo/cmake/external-libs.cmake"
+  "/root/repo/cmake/static-analysis-0.cmake"
+  "/root/repo/cmake/static-analysis-1.cmake"
+  "/root/repo/cmake/warn-everything-clang.cmake"
+  "/root/repo/cmake/warn-everything-default.cmake"
+  "/root/repo/cmake/warn-everything-gcc.cmake"
+  "/root/repo/cmake/warn-everything.cmake"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/src/cfg/CMakeLists.txt"
+  "/root/repo/src/main/CMakeLists.txt"
+  "/root/repo/src/perf/CMakeLists.txt"
+  "/root/repo/src/sym/CMakeLists.txt"
+  "/root/repo/src/system/CMakeLists.txt"
+  "/root/repo/src/util/CMakeLists.txt"
+  "/root/repo/tests/CMakeLists.txt"
+  "/root/repo/tests/src/CMakeLists.txt"
+  "/root/repo/tests/src/cfg/CMakeLists.txt"
+  "/root/repo/tests/src/perf/CMakeLists.txt"
+  "/root/repo/tests/src/sym/CMakeLists.txt"
+  "/root/repo/tests/src/system/CMakeLists.txt"
+  "/root/repo/tests/src/util/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCheckCompilerFlagCommonPatterns.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckCompilerFlag.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckFlagCommonConfig.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/main/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/perf/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/util/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/system/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/sym/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/cfg/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "bench/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/perf/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/system/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/util/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/sym/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/src/cfg/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/static-analysis-impls-parallel.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-tests-parallel.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-impls-source-list.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-tests-source-list.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-tests.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-impls.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis.dir/DependInfo.cmake"
+  "CMakeFiles/static-analysis-parallel.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-util.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-util-lsan.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-lsan.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-util-asan.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-asan.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/DependInfo.cmake"
+  "src/CMakeFiles/thin-layout-optimizer-usan.dir/DependInfo.cmake"
+  "src/CMakeFiles/san.dir/DependInfo.cmake"
+  "src/CMakeFiles/san-lsan.dir/DependInfo.cmake"
+  "src/CMakeFiles/san-asan.dir/DependInfo.cmake"
+  "src/CMakeFiles/san-usan.dir/DependInfo.cmake"
+  "src/CMakeFiles/everything.dir/DependInfo.cmake"
+  "src/main/CMakeFiles/hidden-lint--root-repo-src-main-main-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-parse-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-file-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-saver-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-state-bin-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-data-reader-cc.dir/DependInfo.cmake"
+  "src/perf/CMakeFiles/hidden-lint--root-repo-src-perf-perf-sample-cache-cc.dir/DependInfo.cmake"
+  "src/util/CMakeFiles/hidden-lint--root-repo-src-util-verbosity-cc.dir/DependInfo.cmake"
+  "src/util/CMakeFiles/hidden-lint--root-repo-src-util-global-stats-cc.dir/DependInfo.cmake"
+  "src/util/CMakeFiles/hidden-lint--root-repo-src-util-uring-cc.dir/DependInfo.cmake"
+  "src/util/CMakeFiles/hidden-lint--root-repo-src-util-compressed-reader-cc.dir/DependInfo.cmake"
+  "src/util/CMakeFiles/hidden-lint--root-repo-src-util-compressed-writer-cc.dir/DependInfo.cmake"
+  "src/system/CMakeFiles/hidden-lint--root-repo-src-system-br-insn-cc.dir/DependInfo.cmake"
+  "src/sym/CMakeFiles/hidden-lint--root-repo-src-sym-func-cc.dir/DependInfo.cmake"
+  "src/sym/CMakeFiles/hidden-lint--root-repo-src-sym-dso-cc.dir/DependInfo.cmake"
+  "src/sym/CMakeFiles/hidden-lint--root-repo-src-sym-sym-cache-cc.dir/DependInfo.cmake"
+  "src/cfg/CMakeFiles/hidden-lint--root-repo-src-cfg-cfg-cc.dir/DependInfo.cmake"
+  "src/cfg/CMakeFiles/hidden-lint--root-repo-src-cfg-cfg-order-cc.dir/DependInfo.cmake"
+  "src/cfg/CMakeFiles/hidden-lint--root-repo-src-cfg-ext-tsp-cc.dir/DependInfo.cmake"
+  "bench/CMakeFiles/tlo-bench.dir/DependInfo.cmake"
+  "bench/CMakeFiles/bench.dir/DependInfo.cmake"
+  "tests/CMakeFiles/tlo_test_generated_files_.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all-san.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all-all.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all-lsan.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all-asan.dir/DependInfo.cmake"
+  "tests/CMakeFiles/check-all-usan.dir/DependInfo.cmake"
+  "tests/src/CMakeFiles/check-src.dir/DependInfo.cmake"
+  "tests/src/CMakeFiles/check-src-lsan.dir/DependInfo.cmake"
+  "tests/src/CMakeFiles/check-src-asan.dir/DependInfo.cmake"
+  "tests/src/CMakeFiles/check-src-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-parse.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-parse.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-parse-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-parse-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-parse-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-parse-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-parse-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-parse-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-parse-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-file.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-file.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-file-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-file-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-file-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-file-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-file-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-file-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-file-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-state-saver.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-state-saver.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-state-saver-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-state-saver-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-state-saver-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-state-saver-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-state-saver-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-state-saver-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-state-saver-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-data-reader.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-data-reader.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-data-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-data-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-data-reader-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-data-reader-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-data-reader-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-data-reader-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-data-reader-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-mappings.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-mappings.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-mappings-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-mappings-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-mappings-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-mappings-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-mappings-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-mappings-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-mappings-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-clumper.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-clumper.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-clumper-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-clumper-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-clumper-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-clumper-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-clumper-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-clumper-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-stats-clumper-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-stats-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-stats-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-stats-cc.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-sample-cache.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-sample-cache.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-sample-cache-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-sample-cache-lsan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-sample-cache-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-sample-cache-asan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/test-perf-sample-cache-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/check-perf-sample-cache-usan.dir/DependInfo.cmake"
+  "tests/src/perf/CMakeFiles/hidden-lint--root-repo-tests-src-perf-test-perf-sample-cache-cc.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-system.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-system-lsan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-system-asan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-system-usan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/test-br-insn.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-br-insn.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/test-br-insn-lsan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-br-insn-lsan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/test-br-insn-asan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-br-insn-asan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/test-br-insn-usan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/check-br-insn-usan.dir/DependInfo.cmake"
+  "tests/src/system/CMakeFiles/hidden-lint--root-repo-tests-src-system-test-br-insn-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-util.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-util-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-util-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-util-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-bits.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-bits.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-bits-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-bits-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-bits-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-bits-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-bits-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-bits-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-bits-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-reader.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-reader.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-reader-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-reader-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-reader-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-reader-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-reader-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-file-reader.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-file-reader.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-file-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-file-reader-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-file-reader-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-file-reader-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-file-reader-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-file-reader-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-file-reader-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-strtab.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-strtab.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-strtab-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-strtab-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-strtab-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-strtab-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-strtab-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-strtab-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-strtab-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-ops.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-ops.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-ops-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-ops-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-ops-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-ops-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-ops-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-ops-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-str-ops-cc.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-scan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-scan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-scan-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-scan-lsan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-scan-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-scan-asan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/test-str-scan-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/check-str-scan-usan.dir/DependInfo.cmake"
+  "tests/src/util/CMakeFiles/hidden-lint--root-repo-tests-src-util-test-str-scan-cc.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-sym.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-sym-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-sym-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-sym-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-elffile.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-elffile.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-elffile-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-elffile-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-elffile-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-elffile-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-elffile-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-elffile-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/hidden-lint--root-repo-tests-src-sym-test-elffile-cc.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-addr-range.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-addr-range.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-addr-range-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-addr-range-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-addr-range-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-addr-range-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-addr-range-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-addr-range-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/hidden-lint--root-repo-tests-src-sym-test-addr-range-cc.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-dso.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-dso.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-dso-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-dso-lsan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-dso-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-dso-asan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/test-dso-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/check-dso-usan.dir/DependInfo.cmake"
+  "tests/src/sym/CMakeFiles/hidden-lint--root-repo-tests-src-sym-test-dso-cc.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-cfg.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-cfg-lsan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-cfg-asan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-cfg-usan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/test-ext-tsp.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-ext-tsp.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/test-ext-tsp-lsan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-ext-tsp-lsan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/test-ext-tsp-asan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-ext-tsp-asan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/test-ext-tsp-usan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/check-ext-tsp-usan.dir/DependInfo.cmake"
+  "tests/src/cfg/CMakeFiles/hidden-lint--root-repo-tests-src-cfg-test-ext-tsp-cc.dir/DependInfo.cmake"
+  )
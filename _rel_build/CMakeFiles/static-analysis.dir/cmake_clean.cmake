@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/static-analysis"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/static-analysis.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
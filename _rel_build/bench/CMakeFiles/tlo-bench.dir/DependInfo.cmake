@@ -0,0 +1,25 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/bench/bench-main.cc" "bench/CMakeFiles/tlo-bench.dir/bench-main.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-main.cc.o.d"
+  "/root/repo/bench/bench-perf-parse.cc" "bench/CMakeFiles/tlo-bench.dir/bench-perf-parse.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-perf-parse.cc.o.d"
+  "/root/repo/bench/bench-perf-stats.cc" "bench/CMakeFiles/tlo-bench.dir/bench-perf-stats.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-perf-stats.cc.o.d"
+  "/root/repo/bench/bench-sym.cc" "bench/CMakeFiles/tlo-bench.dir/bench-sym.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-sym.cc.o.d"
+  "/root/repo/bench/bench-system.cc" "bench/CMakeFiles/tlo-bench.dir/bench-system.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-system.cc.o.d"
+  "/root/repo/bench/bench-util.cc" "bench/CMakeFiles/tlo-bench.dir/bench-util.cc.o" "gcc" "bench/CMakeFiles/tlo-bench.dir/bench-util.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rel_build/src/CMakeFiles/thin-layout-optimizer-util.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
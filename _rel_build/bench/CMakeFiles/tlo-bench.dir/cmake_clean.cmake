@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "../tlo-bench"
+  "../tlo-bench.pdb"
+  "CMakeFiles/tlo-bench.dir/bench-main.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-main.cc.o.d"
+  "CMakeFiles/tlo-bench.dir/bench-perf-parse.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-perf-parse.cc.o.d"
+  "CMakeFiles/tlo-bench.dir/bench-perf-stats.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-perf-stats.cc.o.d"
+  "CMakeFiles/tlo-bench.dir/bench-sym.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-sym.cc.o.d"
+  "CMakeFiles/tlo-bench.dir/bench-system.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-system.cc.o.d"
+  "CMakeFiles/tlo-bench.dir/bench-util.cc.o"
+  "CMakeFiles/tlo-bench.dir/bench-util.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tlo-bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/san-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/san-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
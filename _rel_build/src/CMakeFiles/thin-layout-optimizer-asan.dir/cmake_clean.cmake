@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../thin-layout-optimizer-asan"
+  "../thin-layout-optimizer-asan.pdb"
+  "CMakeFiles/thin-layout-optimizer-asan.dir/main/main.cc.o"
+  "CMakeFiles/thin-layout-optimizer-asan.dir/main/main.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thin-layout-optimizer-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../thin-layout-optimizer-usan"
+  "../thin-layout-optimizer-usan.pdb"
+  "CMakeFiles/thin-layout-optimizer-usan.dir/main/main.cc.o"
+  "CMakeFiles/thin-layout-optimizer-usan.dir/main/main.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thin-layout-optimizer-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
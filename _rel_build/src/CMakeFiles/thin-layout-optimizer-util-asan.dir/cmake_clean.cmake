@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/cfg-order.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/cfg-order.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/cfg.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/cfg.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/ext-tsp.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/cfg/ext-tsp.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-data-reader.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-data-reader.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-file.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-file.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-parse.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-parse.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-sample-cache.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-sample-cache.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-saver.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-saver.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-state-bin.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/perf/perf-state-bin.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/dso.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/dso.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/func.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/func.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/sym-cache.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/sym/sym-cache.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/system/br-insn.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/system/br-insn.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/compressed-reader.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/compressed-reader.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/compressed-writer.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/compressed-writer.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/global-stats.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/global-stats.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/uring.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/uring.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/verbosity.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-asan.dir/util/verbosity.cc.o.d"
+  "libthin-layout-optimizer-util-asan.pdb"
+  "libthin-layout-optimizer-util-asan.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thin-layout-optimizer-util-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,36 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/cfg/cfg-order.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg-order.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg-order.cc.o.d"
+  "/root/repo/src/cfg/cfg.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg.cc.o.d"
+  "/root/repo/src/cfg/ext-tsp.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/ext-tsp.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/ext-tsp.cc.o.d"
+  "/root/repo/src/perf/perf-data-reader.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-data-reader.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-data-reader.cc.o.d"
+  "/root/repo/src/perf/perf-file.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-file.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-file.cc.o.d"
+  "/root/repo/src/perf/perf-parse.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-parse.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-parse.cc.o.d"
+  "/root/repo/src/perf/perf-sample-cache.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-sample-cache.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-sample-cache.cc.o.d"
+  "/root/repo/src/perf/perf-saver.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-saver.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-saver.cc.o.d"
+  "/root/repo/src/perf/perf-state-bin.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-state-bin.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-state-bin.cc.o.d"
+  "/root/repo/src/sym/dso.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/dso.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/dso.cc.o.d"
+  "/root/repo/src/sym/func.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/func.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/func.cc.o.d"
+  "/root/repo/src/sym/sym-cache.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/sym-cache.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/sym-cache.cc.o.d"
+  "/root/repo/src/system/br-insn.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/system/br-insn.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/system/br-insn.cc.o.d"
+  "/root/repo/src/util/compressed-reader.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-reader.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-reader.cc.o.d"
+  "/root/repo/src/util/compressed-writer.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-writer.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-writer.cc.o.d"
+  "/root/repo/src/util/global-stats.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/global-stats.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/global-stats.cc.o.d"
+  "/root/repo/src/util/uring.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/uring.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/uring.cc.o.d"
+  "/root/repo/src/util/verbosity.cc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/verbosity.cc.o" "gcc" "src/CMakeFiles/thin-layout-optimizer-util-usan.dir/util/verbosity.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg-order.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg-order.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/cfg.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/ext-tsp.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/cfg/ext-tsp.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-data-reader.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-data-reader.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-file.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-file.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-parse.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-parse.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-sample-cache.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-sample-cache.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-saver.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-saver.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-state-bin.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/perf/perf-state-bin.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/dso.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/dso.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/func.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/func.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/sym-cache.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/sym/sym-cache.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/system/br-insn.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/system/br-insn.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-reader.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-reader.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-writer.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/compressed-writer.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/global-stats.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/global-stats.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/uring.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/uring.cc.o.d"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/verbosity.cc.o"
+  "CMakeFiles/thin-layout-optimizer-util-usan.dir/util/verbosity.cc.o.d"
+  "libthin-layout-optimizer-util-usan.pdb"
+  "libthin-layout-optimizer-util-usan.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thin-layout-optimizer-util-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libthin-layout-optimizer-util.a"
+)
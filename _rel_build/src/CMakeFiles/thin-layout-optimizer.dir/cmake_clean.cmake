@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../thin-layout-optimizer"
+  "../thin-layout-optimizer.pdb"
+  "CMakeFiles/thin-layout-optimizer.dir/main/main.cc.o"
+  "CMakeFiles/thin-layout-optimizer.dir/main/main.cc.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/thin-layout-optimizer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,2 @@
+# CMAKE generated file: DO NOT EDIT!
+# Timestamp file for custom commands dependencies management for hidden-lint--root-repo-src-cfg-cfg-order-cc.
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hidden-lint--root-repo-src-perf-perf-parse-cc"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/hidden-lint--root-repo-src-perf-perf-parse-cc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hidden-lint--root-repo-src-util-compressed-reader-cc"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/hidden-lint--root-repo-src-util-compressed-reader-cc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-all-all"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-all-all.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+file(REMOVE_RECURSE
+  "/root/repo/tests/src/perf/make-test-inputs.py.done"
+  "/root/repo/tests/src/util/gen-compression-tests.py.done"
+  "CMakeFiles/tlo_test_generated_files_"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/tlo_test_generated_files_.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
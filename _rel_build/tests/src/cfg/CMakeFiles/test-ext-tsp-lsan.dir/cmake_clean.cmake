@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-ext-tsp-lsan.dir/test-ext-tsp.cc.o"
+  "CMakeFiles/test-ext-tsp-lsan.dir/test-ext-tsp.cc.o.d"
+  "test-ext-tsp-lsan"
+  "test-ext-tsp-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-ext-tsp-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
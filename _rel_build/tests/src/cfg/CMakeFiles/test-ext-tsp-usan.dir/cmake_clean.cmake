@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-ext-tsp-usan.dir/test-ext-tsp.cc.o"
+  "CMakeFiles/test-ext-tsp-usan.dir/test-ext-tsp.cc.o.d"
+  "test-ext-tsp-usan"
+  "test-ext-tsp-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-ext-tsp-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-ext-tsp.dir/test-ext-tsp.cc.o"
+  "CMakeFiles/test-ext-tsp.dir/test-ext-tsp.cc.o.d"
+  "test-ext-tsp"
+  "test-ext-tsp.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-ext-tsp.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-perf-data-reader-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-perf-data-reader-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
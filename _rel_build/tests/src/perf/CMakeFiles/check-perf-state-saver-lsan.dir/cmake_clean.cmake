@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-perf-state-saver-lsan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-perf-state-saver-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
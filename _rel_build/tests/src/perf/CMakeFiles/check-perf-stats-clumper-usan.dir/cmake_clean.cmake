@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-perf-stats-clumper-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-perf-stats-clumper-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-data-reader-asan.dir/test-perf-data-reader.cc.o"
+  "CMakeFiles/test-perf-data-reader-asan.dir/test-perf-data-reader.cc.o.d"
+  "test-perf-data-reader-asan"
+  "test-perf-data-reader-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-data-reader-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-data-reader-lsan.dir/test-perf-data-reader.cc.o"
+  "CMakeFiles/test-perf-data-reader-lsan.dir/test-perf-data-reader.cc.o.d"
+  "test-perf-data-reader-lsan"
+  "test-perf-data-reader-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-data-reader-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-data-reader.dir/test-perf-data-reader.cc.o"
+  "CMakeFiles/test-perf-data-reader.dir/test-perf-data-reader.cc.o.d"
+  "test-perf-data-reader"
+  "test-perf-data-reader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-data-reader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
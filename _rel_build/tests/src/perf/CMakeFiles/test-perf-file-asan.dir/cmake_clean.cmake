@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-file-asan.dir/test-perf-file.cc.o"
+  "CMakeFiles/test-perf-file-asan.dir/test-perf-file.cc.o.d"
+  "test-perf-file-asan"
+  "test-perf-file-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-file-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-file-lsan.dir/test-perf-file.cc.o"
+  "CMakeFiles/test-perf-file-lsan.dir/test-perf-file.cc.o.d"
+  "test-perf-file-lsan"
+  "test-perf-file-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-file-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-file-usan.dir/test-perf-file.cc.o"
+  "CMakeFiles/test-perf-file-usan.dir/test-perf-file.cc.o.d"
+  "test-perf-file-usan"
+  "test-perf-file-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-file-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
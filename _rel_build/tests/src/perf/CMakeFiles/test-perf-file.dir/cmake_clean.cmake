@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-file.dir/test-perf-file.cc.o"
+  "CMakeFiles/test-perf-file.dir/test-perf-file.cc.o.d"
+  "test-perf-file"
+  "test-perf-file.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-file.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-mappings-usan.dir/test-perf-mappings.cc.o"
+  "CMakeFiles/test-perf-mappings-usan.dir/test-perf-mappings.cc.o.d"
+  "test-perf-mappings-usan"
+  "test-perf-mappings-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-mappings-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-mappings.dir/test-perf-mappings.cc.o"
+  "CMakeFiles/test-perf-mappings.dir/test-perf-mappings.cc.o.d"
+  "test-perf-mappings"
+  "test-perf-mappings.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-mappings.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-parse-asan.dir/test-perf-parse.cc.o"
+  "CMakeFiles/test-perf-parse-asan.dir/test-perf-parse.cc.o.d"
+  "test-perf-parse-asan"
+  "test-perf-parse-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-parse-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-parse-lsan.dir/test-perf-parse.cc.o"
+  "CMakeFiles/test-perf-parse-lsan.dir/test-perf-parse.cc.o.d"
+  "test-perf-parse-lsan"
+  "test-perf-parse-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-parse-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
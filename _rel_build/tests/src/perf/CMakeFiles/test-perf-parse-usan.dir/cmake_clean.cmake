@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-parse-usan.dir/test-perf-parse.cc.o"
+  "CMakeFiles/test-perf-parse-usan.dir/test-perf-parse.cc.o.d"
+  "test-perf-parse-usan"
+  "test-perf-parse-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-parse-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-parse.dir/test-perf-parse.cc.o"
+  "CMakeFiles/test-perf-parse.dir/test-perf-parse.cc.o.d"
+  "test-perf-parse"
+  "test-perf-parse.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-parse.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
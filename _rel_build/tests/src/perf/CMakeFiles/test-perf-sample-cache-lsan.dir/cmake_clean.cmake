@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-sample-cache-lsan.dir/test-perf-sample-cache.cc.o"
+  "CMakeFiles/test-perf-sample-cache-lsan.dir/test-perf-sample-cache.cc.o.d"
+  "test-perf-sample-cache-lsan"
+  "test-perf-sample-cache-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-sample-cache-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-sample-cache-usan.dir/test-perf-sample-cache.cc.o"
+  "CMakeFiles/test-perf-sample-cache-usan.dir/test-perf-sample-cache.cc.o.d"
+  "test-perf-sample-cache-usan"
+  "test-perf-sample-cache-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-sample-cache-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
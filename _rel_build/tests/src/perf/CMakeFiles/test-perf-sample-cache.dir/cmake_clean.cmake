@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-sample-cache.dir/test-perf-sample-cache.cc.o"
+  "CMakeFiles/test-perf-sample-cache.dir/test-perf-sample-cache.cc.o.d"
+  "test-perf-sample-cache"
+  "test-perf-sample-cache.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-sample-cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-state-saver-asan.dir/test-perf-state-saver.cc.o"
+  "CMakeFiles/test-perf-state-saver-asan.dir/test-perf-state-saver.cc.o.d"
+  "test-perf-state-saver-asan"
+  "test-perf-state-saver-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-state-saver-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
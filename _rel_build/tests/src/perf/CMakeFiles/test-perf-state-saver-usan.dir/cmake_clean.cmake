@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-state-saver-usan.dir/test-perf-state-saver.cc.o"
+  "CMakeFiles/test-perf-state-saver-usan.dir/test-perf-state-saver.cc.o.d"
+  "test-perf-state-saver-usan"
+  "test-perf-state-saver-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-state-saver-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
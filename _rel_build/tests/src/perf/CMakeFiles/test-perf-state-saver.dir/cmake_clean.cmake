@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-state-saver.dir/test-perf-state-saver.cc.o"
+  "CMakeFiles/test-perf-state-saver.dir/test-perf-state-saver.cc.o.d"
+  "test-perf-state-saver"
+  "test-perf-state-saver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-state-saver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
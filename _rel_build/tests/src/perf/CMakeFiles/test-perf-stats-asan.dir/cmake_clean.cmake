@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-stats-asan.dir/test-perf-stats.cc.o"
+  "CMakeFiles/test-perf-stats-asan.dir/test-perf-stats.cc.o.d"
+  "test-perf-stats-asan"
+  "test-perf-stats-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-stats-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-stats-clumper-lsan.dir/test-perf-stats-clumper.cc.o"
+  "CMakeFiles/test-perf-stats-clumper-lsan.dir/test-perf-stats-clumper.cc.o.d"
+  "test-perf-stats-clumper-lsan"
+  "test-perf-stats-clumper-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-stats-clumper-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-stats-lsan.dir/test-perf-stats.cc.o"
+  "CMakeFiles/test-perf-stats-lsan.dir/test-perf-stats.cc.o.d"
+  "test-perf-stats-lsan"
+  "test-perf-stats-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-stats-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
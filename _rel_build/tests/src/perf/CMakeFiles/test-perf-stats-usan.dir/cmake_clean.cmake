@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-perf-stats-usan.dir/test-perf-stats.cc.o"
+  "CMakeFiles/test-perf-stats-usan.dir/test-perf-stats.cc.o.d"
+  "test-perf-stats-usan"
+  "test-perf-stats-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-perf-stats-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
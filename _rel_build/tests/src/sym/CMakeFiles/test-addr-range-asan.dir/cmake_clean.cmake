@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-addr-range-asan.dir/test-addr-range.cc.o"
+  "CMakeFiles/test-addr-range-asan.dir/test-addr-range.cc.o.d"
+  "test-addr-range-asan"
+  "test-addr-range-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-addr-range-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
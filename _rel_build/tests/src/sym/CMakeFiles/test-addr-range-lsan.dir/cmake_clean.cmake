@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-addr-range-lsan.dir/test-addr-range.cc.o"
+  "CMakeFiles/test-addr-range-lsan.dir/test-addr-range.cc.o.d"
+  "test-addr-range-lsan"
+  "test-addr-range-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-addr-range-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-addr-range.dir/test-addr-range.cc.o"
+  "CMakeFiles/test-addr-range.dir/test-addr-range.cc.o.d"
+  "test-addr-range"
+  "test-addr-range.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-addr-range.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-dso-lsan.dir/test-dso.cc.o"
+  "CMakeFiles/test-dso-lsan.dir/test-dso.cc.o.d"
+  "test-dso-lsan"
+  "test-dso-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-dso-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
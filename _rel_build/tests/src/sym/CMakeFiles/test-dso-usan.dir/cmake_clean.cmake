@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-dso-usan.dir/test-dso.cc.o"
+  "CMakeFiles/test-dso-usan.dir/test-dso.cc.o.d"
+  "test-dso-usan"
+  "test-dso-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-dso-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
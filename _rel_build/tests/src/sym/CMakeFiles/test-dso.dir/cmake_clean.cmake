@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-dso.dir/test-dso.cc.o"
+  "CMakeFiles/test-dso.dir/test-dso.cc.o.d"
+  "test-dso"
+  "test-dso.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-dso.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
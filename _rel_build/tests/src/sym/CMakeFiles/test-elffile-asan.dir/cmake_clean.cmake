@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-elffile-asan.dir/test-elffile.cc.o"
+  "CMakeFiles/test-elffile-asan.dir/test-elffile.cc.o.d"
+  "test-elffile-asan"
+  "test-elffile-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-elffile-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-elffile-lsan.dir/test-elffile.cc.o"
+  "CMakeFiles/test-elffile-lsan.dir/test-elffile.cc.o.d"
+  "test-elffile-lsan"
+  "test-elffile-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-elffile-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
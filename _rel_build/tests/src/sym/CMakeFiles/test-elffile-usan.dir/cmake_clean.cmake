@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-elffile-usan.dir/test-elffile.cc.o"
+  "CMakeFiles/test-elffile-usan.dir/test-elffile.cc.o.d"
+  "test-elffile-usan"
+  "test-elffile-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-elffile-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-elffile.dir/test-elffile.cc.o"
+  "CMakeFiles/test-elffile.dir/test-elffile.cc.o.d"
+  "test-elffile"
+  "test-elffile.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-elffile.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-br-insn-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-br-insn-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-br-insn-lsan.dir/test-br-insn.cc.o"
+  "CMakeFiles/test-br-insn-lsan.dir/test-br-insn.cc.o.d"
+  "test-br-insn-lsan"
+  "test-br-insn-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-br-insn-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
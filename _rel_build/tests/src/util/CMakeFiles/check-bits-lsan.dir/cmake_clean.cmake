@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-bits-lsan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-bits-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
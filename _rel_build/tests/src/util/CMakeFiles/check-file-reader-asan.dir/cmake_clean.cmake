@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-file-reader-asan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-file-reader-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-file-reader-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-file-reader-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
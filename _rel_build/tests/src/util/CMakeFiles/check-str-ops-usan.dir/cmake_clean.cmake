@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-str-ops-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-str-ops-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-str-scan-asan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-str-scan-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
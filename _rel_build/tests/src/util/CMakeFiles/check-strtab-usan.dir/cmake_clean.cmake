@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/check-strtab-usan"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/check-strtab-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-bits-asan.dir/test-bits.cc.o"
+  "CMakeFiles/test-bits-asan.dir/test-bits.cc.o.d"
+  "test-bits-asan"
+  "test-bits-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-bits-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-bits-lsan.dir/test-bits.cc.o"
+  "CMakeFiles/test-bits-lsan.dir/test-bits.cc.o.d"
+  "test-bits-lsan"
+  "test-bits-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-bits-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
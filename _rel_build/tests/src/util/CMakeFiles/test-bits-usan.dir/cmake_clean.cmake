@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-bits-usan.dir/test-bits.cc.o"
+  "CMakeFiles/test-bits-usan.dir/test-bits.cc.o.d"
+  "test-bits-usan"
+  "test-bits-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-bits-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
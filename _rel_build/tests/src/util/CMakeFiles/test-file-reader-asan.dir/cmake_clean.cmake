@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-file-reader-asan.dir/test-file-reader.cc.o"
+  "CMakeFiles/test-file-reader-asan.dir/test-file-reader.cc.o.d"
+  "test-file-reader-asan"
+  "test-file-reader-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-file-reader-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
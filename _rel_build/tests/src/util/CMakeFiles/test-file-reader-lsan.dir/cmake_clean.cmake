@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-file-reader-lsan.dir/test-file-reader.cc.o"
+  "CMakeFiles/test-file-reader-lsan.dir/test-file-reader.cc.o.d"
+  "test-file-reader-lsan"
+  "test-file-reader-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-file-reader-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
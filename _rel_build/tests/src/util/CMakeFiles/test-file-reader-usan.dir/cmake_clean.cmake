@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-file-reader-usan.dir/test-file-reader.cc.o"
+  "CMakeFiles/test-file-reader-usan.dir/test-file-reader.cc.o.d"
+  "test-file-reader-usan"
+  "test-file-reader-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-file-reader-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
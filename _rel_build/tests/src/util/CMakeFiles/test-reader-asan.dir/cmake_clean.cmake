@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-reader-asan.dir/test-reader.cc.o"
+  "CMakeFiles/test-reader-asan.dir/test-reader.cc.o.d"
+  "test-reader-asan"
+  "test-reader-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-reader-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-reader-lsan.dir/test-reader.cc.o"
+  "CMakeFiles/test-reader-lsan.dir/test-reader.cc.o.d"
+  "test-reader-lsan"
+  "test-reader-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-reader-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-reader-usan.dir/test-reader.cc.o"
+  "CMakeFiles/test-reader-usan.dir/test-reader.cc.o.d"
+  "test-reader-usan"
+  "test-reader-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-reader-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
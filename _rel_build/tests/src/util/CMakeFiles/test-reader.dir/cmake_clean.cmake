@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-reader.dir/test-reader.cc.o"
+  "CMakeFiles/test-reader.dir/test-reader.cc.o.d"
+  "test-reader"
+  "test-reader.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-reader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-str-ops-asan.dir/test-str-ops.cc.o"
+  "CMakeFiles/test-str-ops-asan.dir/test-str-ops.cc.o.d"
+  "test-str-ops-asan"
+  "test-str-ops-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-str-ops-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-str-scan-asan.dir/test-str-scan.cc.o"
+  "CMakeFiles/test-str-scan-asan.dir/test-str-scan.cc.o.d"
+  "test-str-scan-asan"
+  "test-str-scan-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-str-scan-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-str-scan-usan.dir/test-str-scan.cc.o"
+  "CMakeFiles/test-str-scan-usan.dir/test-str-scan.cc.o.d"
+  "test-str-scan-usan"
+  "test-str-scan-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-str-scan-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
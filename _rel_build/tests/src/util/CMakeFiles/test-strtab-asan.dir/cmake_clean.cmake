@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-strtab-asan.dir/test-strtab.cc.o"
+  "CMakeFiles/test-strtab-asan.dir/test-strtab.cc.o.d"
+  "test-strtab-asan"
+  "test-strtab-asan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-strtab-asan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-strtab-lsan.dir/test-strtab.cc.o"
+  "CMakeFiles/test-strtab-lsan.dir/test-strtab.cc.o.d"
+  "test-strtab-lsan"
+  "test-strtab-lsan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-strtab-lsan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
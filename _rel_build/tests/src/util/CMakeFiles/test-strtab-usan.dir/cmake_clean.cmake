@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-strtab-usan.dir/test-strtab.cc.o"
+  "CMakeFiles/test-strtab-usan.dir/test-strtab.cc.o.d"
+  "test-strtab-usan"
+  "test-strtab-usan.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-strtab-usan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test-strtab.dir/test-strtab.cc.o"
+  "CMakeFiles/test-strtab.dir/test-strtab.cc.o.d"
+  "test-strtab"
+  "test-strtab.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test-strtab.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,104 @@
+#include "bench/bench.h"
+
+#include "src/util/verbosity.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TLO_PRINT_USR_ERR(...) TLO_fprint_ifv(-1, stderr, __VA_ARGS__)
+
+static void
+usage(const char * progname) {
+    TLO_PRINT_USR_ERR(
+        "Usage: %s\n"
+        "\t[-h][--help]\t\tDiplay this message\n"
+        "\t[--filter]\t\tOnly run benchmarks whose name contains this string\n"
+        "\t[--min-time]\t\tMinimum time (in milliseconds) of a timed run\n"
+        "\t[--repeats]\t\tNumber of timed runs (the fastest is reported)\n"
+        "Results are printed as one JSON object per line.\n",
+        progname);
+}
+
+static bool
+parse_uint(const char * arg, const char * opt, unsigned long * val_out) {
+    char * end = const_cast<char *>(arg);
+    *val_out   = std::strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0') {
+        TLO_PRINT_USR_ERR(
+            "Unable to convert argument to --%s to integer: \"%s\"\n", opt,
+            arg);
+        return false;
+    }
+    return true;
+}
+
+int
+main(int argc, char ** argv) {
+    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    TLO_DISABLE_WREDUNDANT_TAGS
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+    struct option cmdline_options[] = {
+        { "h", no_argument, nullptr, 0 },
+        { "help", no_argument, nullptr, 0 },
+        { "filter", required_argument, nullptr, 1 },
+        { "min-time", required_argument, nullptr, 2 },
+        { "repeats", required_argument, nullptr, 3 },
+        { nullptr, 0, nullptr, 0 },
+    };
+    TLO_REENABLE_WREDUNDANT_TAGS
+
+    tlo::bench::bench_runner_t runner{
+        {},
+        tlo::bench::bench_runner_t::k_default_min_time_ns,
+        tlo::bench::bench_runner_t::k_default_nrepeats,
+        stdout
+    };
+    for (;;) {
+        int           opt_index, res;
+        unsigned long val;
+        // NOLINTNEXTLINE(concurrency-mt-unsafe,cppcoreguidelines-pro-bounds-array-to-pointer-decay,hicpp-no-array-decay)
+        res = getopt_long_only(argc, argv, "", cmdline_options, &opt_index);
+
+        if (res == -1) {
+            break;
+        }
+        switch (res) {
+            default:
+                // Help
+            case 0:
+                usage(argv[0]);
+                return 0;
+                // Filter
+            case 1:
+                runner.filter_ = { optarg, strlen(optarg) };
+                break;
+                // Min time
+            case 2:
+                if (!parse_uint(optarg, "min-time", &val)) {
+                    return 1;
+                }
+                runner.min_time_ns_ = val * 1000UL * 1000UL;
+                break;
+                // Repeats
+            case 3:
+                if (!parse_uint(optarg, "repeats", &val)) {
+                    return 1;
+                }
+                runner.nrepeats_ = static_cast<uint32_t>(std::max(val, 1UL));
+                break;
+        }
+    }
+    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+
+    tlo::bench::run_perf_parse_benches(runner);
+    tlo::bench::run_system_benches(runner);
+    tlo::bench::run_sym_benches(runner);
+    tlo::bench::run_perf_stats_benches(runner);
+    tlo::bench::run_util_benches(runner);
+    return 0;
+}
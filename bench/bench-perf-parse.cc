@@ -0,0 +1,282 @@
+#include "bench/bench.h"
+
+#include "src/perf/perf-parse.h"
+#include "src/perf/perf-sample.h"
+#include "src/util/vec.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// `perf script` text parsing. The lines look like what `perf script -F
+// comm,tid,time,ip,dso,brstack` / `perf script --show-mmap-events` print.
+
+namespace tlo {
+namespace bench {
+
+static constexpr size_t k_nlines = 4096;
+
+static constexpr std::array<std::string_view, 6> k_dsos = { {
+    "/usr/bin/some-server",
+    "/usr/lib/x86_64-linux-gnu/libc.so.6",
+    "/usr/lib/x86_64-linux-gnu/libstdc++.so.6.0.30",
+    "/usr/lib/x86_64-linux-gnu/libm.so.6",
+    "/opt/app/lib/libapp-core.so",
+    "[unknown]",
+} };
+
+static constexpr std::array<std::string_view, 4> k_comms = { {
+    "some-server",
+    "worker/3",
+    "app thread 12",
+    "gc",
+} };
+
+static uint64_t
+dso_addr(rng_t * rng, size_t dso_idx) {
+    return 0x7f0000000000UL + dso_idx * 0x10000000UL + rng->below(0x400000UL);
+}
+
+// The DSO / comm names are appended separately so the formatted pieces have
+// a known bound.
+__attribute__((format(printf, 2, 3))) static void
+append_fmt(std::string * line, const char * fmt, ...) {
+    std::array<char, 128> buf{};
+    va_list               args;
+    va_start(args, fmt);
+    const int len = vsnprintf(buf.data(), buf.size(), fmt, args);
+    va_end(args);
+    assert(len > 0 && static_cast<size_t>(len) < buf.size());
+    line->append(buf.data(), static_cast<size_t>(len));
+}
+
+static void
+append_sample_hdr(rng_t * rng, std::string * line) {
+    const size_t   dso_idx = rng->below(k_dsos.size());
+    const uint32_t pid     = 1000U + static_cast<uint32_t>(rng->below(8));
+    const uint32_t tid     = pid + static_cast<uint32_t>(rng->below(4));
+    line->append(k_comms[rng->below(k_comms.size())]);
+    append_fmt(line, " %u/%u %lu.%06lu:      %lx (", pid, tid,
+               100000UL + rng->below(1000), rng->below(1000000),
+               dso_addr(rng, dso_idx));
+    line->append(k_dsos[dso_idx]);
+    line->append(") ");
+}
+
+// Branches mostly stay within a DSO.
+static void
+append_lbr_entry(rng_t * rng, std::string * line) {
+    const size_t from_dso = rng->below(k_dsos.size());
+    const size_t to_dso   = rng->below(4) == 0 ? rng->below(k_dsos.size())
+                                               : from_dso;
+    append_fmt(line, "0x%lx(", dso_addr(rng, from_dso));
+    line->append(k_dsos[from_dso]);
+    append_fmt(line, ")/0x%lx(", dso_addr(rng, to_dso));
+    line->append(k_dsos[to_dso]);
+    append_fmt(line, ")/%c/-/-/%lu/ ", rng->below(8) == 0 ? 'M' : 'P',
+               1 + rng->below(40));
+}
+
+static vec_t<std::string>
+make_lbr_lines(uint64_t seed) {
+    rng_t              rng{ seed };
+    vec_t<std::string> lines;
+    for (size_t i = 0; i < k_nlines; ++i) {
+        std::string line;
+        append_sample_hdr(&rng, &line);
+        for (uint32_t j = 0; j < perf::lbr_sample_t::k_max_lbr_samples; ++j) {
+            append_lbr_entry(&rng, &line);
+        }
+        line.back() = '\n';
+        lines.emplace_back(std::move(line));
+    }
+    return lines;
+}
+
+static vec_t<std::string>
+make_mmap_lines(uint64_t seed) {
+    rng_t              rng{ seed };
+    vec_t<std::string> lines;
+    for (size_t i = 0; i < k_nlines; ++i) {
+        const size_t   dso_idx = rng.below(k_dsos.size() - 1);
+        const uint32_t pid     = 1000U + static_cast<uint32_t>(rng.below(64));
+        std::string    line    = "some-server";
+        append_fmt(&line, " %u/%u %lu.%06lu: PERF_RECORD_MMAP2 %u/%u: ", pid,
+                   pid, 100000UL + rng.below(1000), rng.below(1000000), pid,
+                   pid);
+        append_fmt(&line, "[0x%lx(0x%lx) @ 0x%lx fd:01 %lu 0]: r-xp ",
+                   dso_addr(&rng, dso_idx) & -4096UL,
+                   0x1000UL * (1 + rng.below(512)), 0x1000UL * rng.below(64),
+                   1000 + dso_idx);
+        line.append(k_dsos[dso_idx]);
+        line.append("\n");
+        lines.emplace_back(std::move(line));
+    }
+    return lines;
+}
+
+// Two real `perf script` brstack lines (the ones `test-perf-parse.cc` checks).
+// They have what the generated lines above do not: right aligned comms, two
+// spaces between branches, " (" before some DSOs and trailing `/-` fields.
+static constexpr std::string_view k_captured_perf_line =
+    "            perf 2920544/2920544 472467.383545:      55877acea540 (/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf) "
+    "0x55877ae9b1ce(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877acea540(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/31/  "
+    "0x55877ae9b1ab(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b1b4(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/47/  "
+    "0x55877ae9a0d6(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b198(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/2/  "
+    "0x55877ae9a083(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9a0d5(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/102/  "
+    "0x55877ae9a0d0(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9a03c(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/28/  "
+    "0x55877ae9a0b2(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9a0bb(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/16/  "
+    "0x55877ae9b193(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9a084(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/245/  "
+    "0x55877ae9b20f(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b158(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/27/  "
+    "0x55877ae9b23c(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b1f8(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/1/  "
+    "0x55877ae9a0e8(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b239(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/282/  "
+    "0x55877ae9b234(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9a0d7(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/15/  "
+    "0x55877ae9b1f6(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b226(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/89/  "
+    "0x55877ae9b3a7(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b1d5(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/112/  "
+    "0x55877ad8a78b(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9b37e(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/12/  "
+    "0x55877ad82885(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad8a760(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/326/  "
+    "0x55877ad81a34(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad82848(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/32/  "
+    "0x55877ad819d4(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad81a20(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/1/  "
+    "0x55877ae995cd(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad819ce(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/1/  "
+    "0x55877ae995a2(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995cc(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/48/  "
+    "0x55877ae995c5(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae99570(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/32/  "
+    "0x55877ae995ac(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995b6(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/28/  "
+    "0x55877ae9959d(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995a4(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/48/  "
+    "0x55877ae995c5(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae99570(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/14/  "
+    "0x55877ae995b4(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995bf(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/27/  "
+    "0x55877ae9959d(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995a4(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/109/  "
+    "0x55877ae995c5(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae99570(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/8/  "
+    "0x55877ae9956e(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae995bf(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/179/  "
+    "0x55877ae99554(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae9955d(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/9/  "
+    "0x55877ad819c9(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ae99540(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/302/  "
+    "0x55877ad81a1b(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad819c2(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/190/  "
+    "0x55877adfe446(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877ad81a14(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/M/-/-/3/  "
+    "0x55877adfe485(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/0x55877adfe42d(/usr/lib/linux-hwe-6.2-tools-6.2.0-33/perf)/P/-/-/660/";
+
+static constexpr std::string_view k_captured_xwayland_line =
+    "Xwayland  3346/3346  472467.383778:      7f6db265163d (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so) "
+    "0x7f6db26516df(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db265159f(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db26543c8(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db26516dd(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/5/ "
+    "0x7f6db2654341(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db26543b3(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db2654556(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2654320(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db26516d8(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2654550(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6dc81aeffa (/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/0x7f6db26516d4 (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2//- "
+    "0x7f6dc81aefc3 (/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/0x7f6dc81aefe6(/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/P/-/-/1/ "
+    "0x7f6dc81aef8b(/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/0x7f6dc81aefc0(/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/P/-/-/1/ "
+    "0x7f6db2092674(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6dc81aef80(/usr/lib/x86_64-linux-gnu/libc.so.6 (deleted))/P/-/-/1/ "
+    "0x7f6db2654919(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2092670(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/5/ "
+    "0x7f6db2654656(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db26548f2(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2/ "
+    "0x7f6db265460a(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2654618(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/16/ "
+    "0x7f6db26548ed(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2654580(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db26516cf(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db26548c0 (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3//- "
+    "0x7f6db265157f(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2651690(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db23c2b38(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2651540(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db239129a(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2ae7(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2/ "
+    "0x7f6db23911fe(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2391290(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/10/ "
+    "0x7f6db23c2ae2(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23911d0 (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2//- "
+    "0x7f6db23c2a6f (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2ad0(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db2185e86(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2a64(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db21853b8(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2185e5b(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db2185e56(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2185390(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db23c2a5f(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2185e20(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db2185c84(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2a59(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db2185308(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2185c59(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3//- "
+    "0x7f6db2185c54(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db21852e0(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/3/ "
+    "0x7f6db23c2a54(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db2185c20(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db23c2b92(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2a4e(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/1/ "
+    "0x7f6db23c2a48(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2b88(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/4/ "
+    "0x7f6db23c2e33 (/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2a00(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2//- "
+    "0x7f6db21684b1(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/0x7f6db23c2e20(/usr/lib/x86_64-linux-gnu/dri/iris_dri.so)/P/-/-/2/";
+
+// Repeated to `k_nlines` so the per line numbers are comparable.
+static vec_t<std::string>
+make_captured_lines() {
+    vec_t<std::string> lines;
+    for (size_t i = 0; i < k_nlines; ++i) {
+        std::string line{ (i & 1U) != 0 ? k_captured_xwayland_line
+                                        : k_captured_perf_line };
+        line.append("\n");
+        lines.emplace_back(std::move(line));
+    }
+    return lines;
+}
+
+void
+run_perf_parse_benches(const bench_runner_t & runner) {
+    const vec_t<std::string> lbr_lines  = make_lbr_lines(1);
+    const vec_t<std::string> mmap_lines = make_mmap_lines(2);
+    const vec_t<std::string> captured_lines = make_captured_lines();
+
+    // Items are lines.
+    runner.run("perf/parse_sample_line", [&lbr_lines](uint64_t iters) {
+        perf::lbr_sample_t sample;  // NOLINT
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const std::string & line : lbr_lines) {
+                keep(perf::parse_sample_line(line, &sample));
+            }
+        }
+        return iters * lbr_lines.size();
+    });
+
+    // Items are lines (each with 32 branches).
+    runner.run("perf/parse_lbr_line", [&lbr_lines](uint64_t iters) {
+        perf::lbr_sample_t sample;  // NOLINT
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const std::string & line : lbr_lines) {
+                const size_t off = perf::parse_sample_line(line, &sample);
+                keep(perf::parse_lbr_line(line, off, &sample));
+                keep(sample.num_samples_);
+            }
+        }
+        return iters * lbr_lines.size();
+    });
+
+    // Same but with the format detected once (as when collecting a file).
+    runner.run("perf/parse_lbr_line_detected", [&lbr_lines](uint64_t iters) {
+        perf::lbr_sample_t      sample;  // NOLINT
+        perf::lbr_line_parser_t parser{};
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const std::string & line : lbr_lines) {
+                const size_t off = perf::parse_sample_line(line, &sample);
+                keep(parser.parse_lbr_line(line, off, &sample));
+                keep(sample.num_samples_);
+            }
+        }
+        return iters * lbr_lines.size();
+    });
+
+    // Same on the captured lines.
+    runner.run("perf/parse_captured_lbr_line",
+               [&captured_lines](uint64_t iters) {
+                   perf::lbr_sample_t      sample;  // NOLINT
+                   perf::lbr_line_parser_t parser{};
+                   for (uint64_t i = 0; i < iters; ++i) {
+                       for (const std::string & line : captured_lines) {
+                           const size_t off =
+                               perf::parse_sample_line(line, &sample);
+                           keep(parser.parse_lbr_line(line, off, &sample));
+                           keep(sample.num_samples_);
+                       }
+                   }
+                   return iters * captured_lines.size();
+               });
+
+    // There is no separate mmap parser, they go through `parse_info_line`.
+    runner.run("perf/parse_mmap_line", [&mmap_lines](uint64_t iters) {
+        perf::info_sample_t sample;  // NOLINT
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const std::string & line : mmap_lines) {
+                keep(perf::parse_info_line(line, &sample));
+            }
+        }
+        return iters * mmap_lines.size();
+    });
+}
+
+}  // namespace bench
+}  // namespace tlo
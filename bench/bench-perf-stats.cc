@@ -0,0 +1,210 @@
+#include "bench/bench.h"
+
+#include "src/perf/perf-mappings.h"
+#include "src/perf/perf-sample.h"
+#include "src/perf/perf-stats.h"
+#include "src/sym/syms.h"
+#include "src/util/file-ops.h"
+#include "src/util/strbuf.h"
+#include "src/util/vec.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+// Address unmapping and accumulating LBR samples.
+
+namespace tlo {
+namespace bench {
+
+static constexpr uint32_t k_npids = 8;
+
+static small_str_t<char const *>
+to_sstr(std::string_view sv) {
+    return { sv.data(), static_cast<uint16_t>(sv.length()) };
+}
+
+static perf::info_sample_t
+make_mmap(uint32_t         pid,
+          uint64_t         ts,
+          uint64_t         base,
+          uint64_t         size,
+          uint64_t         off,
+          std::string_view dso) {
+    perf::info_sample_t sample{};
+    sample.hdr_.pid_       = pid;
+    sample.hdr_.tid_       = pid;
+    sample.hdr_.timestamp_ = ts;
+    sample.use_mmap();
+    perf::sample_mmap_t * mmap = sample.get_mmap();
+    mmap->map_base_            = base;
+    mmap->map_size_            = size;
+    mmap->map_off_             = off;
+    mmap->pid_                 = pid;
+    mmap->tid_                 = pid;
+    mmap->read_                = 1;
+    mmap->exec_                = 1;
+    mmap->dso_                 = to_sstr(dso);
+    return sample;
+}
+
+static void
+run_fillin_sample_loc_bench(const bench_runner_t & runner) {
+    static constexpr size_t k_ndsos    = 24;
+    static constexpr size_t k_nlookups = 16384;
+    static constexpr uint64_t k_map_size = 0x400000;
+
+    struct lookup_t {
+        const sym::dso_t *  dso_;
+        perf::sample_hdr_t  hdr_;
+        perf::sample_loc_t  loc_;
+    };
+
+    rng_t                  rng{ 6 };
+    sym::sym_state_t       ss{};
+    perf::perf_mappings_t  mappings{};
+    vec_t<std::string>     dso_names;
+    vec_t<const sym::dso_t *> dsos;
+    for (size_t i = 0; i < k_ndsos; ++i) {
+        dso_names.emplace_back("/nonexistent/lib" + std::to_string(i) + ".so");
+    }
+    for (const std::string & name : dso_names) {
+        dsos.emplace_back(ss.get_dso(strbuf_t<>{ name }));
+    }
+    // Every process maps every DSO (at a different base). Some are remapped
+    // part way through.
+    for (uint32_t pid = 0; pid < k_npids; ++pid) {
+        for (size_t i = 0; i < k_ndsos; ++i) {
+            const uint64_t base =
+                0x7f0000000000UL + (pid * k_ndsos + i) * 0x1000000UL;
+            (void)mappings.add_sample(ss.get_strtab(),
+                                      make_mmap(pid, 1, base, k_map_size,
+                                                0x1000, dso_names[i]));
+            if (rng.below(4) == 0) {
+                (void)mappings.add_sample(
+                    ss.get_strtab(), make_mmap(pid, 500, base, k_map_size / 2,
+                                               0x2000, dso_names[i]));
+            }
+        }
+    }
+    (void)mappings.finalize();
+
+    // Consecutive lookups are usually from the same process and DSO (the
+    // branches of an LBR sample).
+    vec_t<lookup_t> lookups;
+    uint32_t        pid     = 0;
+    size_t          dso_idx = 0;
+    for (size_t i = 0; i < k_nlookups; ++i) {
+        if ((i % 32) == 0) {
+            pid = static_cast<uint32_t>(rng.below(k_npids));
+        }
+        if (rng.below(4) == 0) {
+            dso_idx = rng.below(k_ndsos);
+        }
+        lookup_t lookup{};
+        lookup.dso_            = dsos[dso_idx];
+        lookup.hdr_.pid_       = pid;
+        lookup.hdr_.tid_       = pid;
+        lookup.hdr_.timestamp_ = 2 + rng.below(1000);
+        lookup.loc_.mapped_addr_ =
+            0x7f0000000000UL + (pid * k_ndsos + dso_idx) * 0x1000000UL +
+            rng.below(k_map_size / 2);
+        lookups.emplace_back(lookup);
+    }
+
+    runner.run("perf/fillin_sample_loc", [&mappings,
+                                          &lookups](uint64_t iters) {
+        perf::perf_map_hint_t hint{};
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (lookup_t & lookup : lookups) {
+                keep(mappings.fillin_sample_loc(lookup.dso_, lookup.hdr_,
+                                                &(lookup.loc_), nullptr,
+                                                &hint));
+            }
+        }
+        return iters * lookups.size();
+    });
+}
+
+// Samples are against ourselves so there are real symbols and branch
+// instructions to decode.
+static void
+run_add_lbr_sample_bench(const bench_runner_t & runner) {
+    static constexpr std::string_view k_self     = "/proc/self/exe";
+    static constexpr std::string_view k_comm     = "bench";
+    static constexpr size_t           k_nsamples = 1024;
+    static constexpr uint64_t         k_base     = 0x555500000000UL;
+
+    rng_t                 rng{ 7 };
+    sym::sym_state_t      ss{};
+    perf::perf_stats_t    stats{ &ss };
+    file_ops::filebuf_t   self = file_ops::readfile(k_self.data());
+    const size_t          self_size = self.active() ? self.size() : 0;
+    self.cleanup();
+    if (self_size == 0) {
+        (void)fprintf(stderr, "Unable to read %s\n", k_self.data());
+        return;
+    }
+    for (uint32_t pid = 0; pid < k_npids; ++pid) {
+        (void)stats.collect_mmap_sample(
+            make_mmap(pid, 1, k_base, self_size, 0, k_self));
+    }
+    (void)stats.finalize_mappings();
+
+    vec_t<sym::addr_range_t> ranges;
+    for (const sym::func_clump_t & fc :
+         ss.get_dso(strbuf_t<>{ k_self })->func_clumps()) {
+        ranges.emplace_back(fc.get_addr_range());
+    }
+    if (ranges.empty()) {
+        (void)fprintf(stderr, "No symbols in %s\n", k_self.data());
+        return;
+    }
+
+    auto rand_addr = [&rng, &ranges]() {
+        const sym::addr_range_t range = ranges[rng.below(ranges.size())];
+        return k_base + range.lo_addr_inclusive_ + rng.below(range.size());
+    };
+    vec_t<perf::lbr_sample_t> samples;
+    samples.reserve(k_nsamples);
+    for (size_t i = 0; i < k_nsamples; ++i) {
+        perf::lbr_sample_t sample{};
+        sample.hdr_.pid_         = static_cast<uint32_t>(rng.below(k_npids));
+        sample.hdr_.tid_         = sample.hdr_.pid_;
+        sample.hdr_.timestamp_   = 2 + i;
+        sample.hdr_.comm_        = to_sstr(k_comm);
+        sample.loc_.mapped_addr_ = rand_addr();
+        sample.loc_.dso_         = to_sstr(k_self);
+        sample.num_samples_      = perf::lbr_sample_t::k_max_lbr_samples;
+        for (perf::lbr_br_sample_t & br : sample.samples_) {
+            br.from_.mapped_addr_ = rand_addr();
+            br.from_.dso_         = to_sstr(k_self);
+            br.to_.mapped_addr_   = rand_addr();
+            br.to_.dso_           = to_sstr(k_self);
+            br.cycles_            = static_cast<uint32_t>(1 + rng.below(40));
+            br.predicted_         = perf::lbr_br_sample_t::k_pred;
+            br.br_insn_           = system::br_insn_t::make_bad();
+        }
+        samples.emplace_back(sample);
+    }
+
+    // Items are LBR samples (each with 32 branches).
+    runner.run("perf/add_lbr_sample", [&stats, &samples](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (perf::lbr_sample_t & sample : samples) {
+                keep(stats.collect_lbr_sample_stats(&sample));
+            }
+        }
+        return iters * samples.size();
+    });
+}
+
+void
+run_perf_stats_benches(const bench_runner_t & runner) {
+    run_fillin_sample_loc_bench(runner);
+    run_add_lbr_sample_bench(runner);
+}
+
+}  // namespace bench
+}  // namespace tlo
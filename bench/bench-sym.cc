@@ -0,0 +1,74 @@
+#include "bench/bench.h"
+
+#include "src/sym/addr-range.h"
+#include "src/sym/dso.h"
+#include "src/sym/func.h"
+#include "src/util/memory.h"
+#include "src/util/strbuf.h"
+#include "src/util/vec.h"
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+// Symbol lookup in a (synthetic) DSO.
+
+namespace tlo {
+namespace bench {
+
+void
+run_sym_benches(const bench_runner_t & runner) {
+    static constexpr size_t k_nfuncs   = 200 * 1000;
+    static constexpr size_t k_nlookups = 16384;
+
+    rng_t      rng{ 4 };
+    sym::dso_t dso{ strbuf_t<>{ "/bench/libsynthetic.so" }, false };
+
+    // Function sizes are roughly log-uniform between 16 bytes and 16kb, with
+    // some padding between functions and the occasional alias.
+    vec_t<std::string> names;
+    names.reserve(k_nfuncs);
+    vec_t<sym::func_t> funcs;
+    funcs.reserve(k_nfuncs);
+    uint64_t addr = 0x10000;
+    for (size_t i = 0; i < k_nfuncs; ++i) {
+        names.emplace_back("_Z12synthetic_" + std::to_string(i) + "v");
+        const uint64_t size = (16UL << rng.below(11)) + rng.below(16);
+        if (i == 0 || rng.below(50) != 0) {
+            addr += (funcs.empty() ? 0 : funcs.back().get_addr_range().size()) +
+                    rng.below(4) * 16;
+        }
+        funcs.emplace_back(&dso, true, strbuf_t<>{ names.back() },
+                           sym::ident_t{ "" },
+                           sym::addr_range_t{ addr, addr + size });
+    }
+    const uint64_t end_addr = addr + funcs.back().get_addr_range().size();
+    dso.func_clumps_ = sym::dso_t::create_func_clumps({ funcs.data(), funcs.size() });
+
+    // Mostly hits, with a hot set, and some misses past the end of the text.
+    vec_t<sym::addr_range_t> lookups;
+    for (size_t i = 0; i < k_nlookups; ++i) {
+        if (rng.below(10) == 0) {
+            lookups.emplace_back(end_addr + rng.below(1UL << 20U) + 1);
+            continue;
+        }
+        const sym::func_t & func =
+            funcs[rng.below(2) == 0 ? rng.below(k_nfuncs / 100)
+                                    : rng.below(k_nfuncs)];
+        lookups.emplace_back(func.get_addr_range().lo_addr_inclusive_ +
+                             rng.below(func.get_addr_range().size()));
+    }
+
+    runner.run("sym/dso_lookup_func_clump", [&dso, &lookups](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const sym::addr_range_t loc : lookups) {
+                keep(dso.lookup_func_clump(loc));
+            }
+        }
+        return iters * lookups.size();
+    });
+
+    arr_free(dso.func_clumps_.data(), dso.func_clumps_.size());
+}
+
+}  // namespace bench
+}  // namespace tlo
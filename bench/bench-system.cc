@@ -0,0 +1,69 @@
+#include "bench/bench.h"
+
+#include "src/system/br-insn.h"
+#include "src/system/insn.h"
+#include "src/util/vec.h"
+
+#include <array>
+
+////////////////////////////////////////////////////////////////////////////////
+// Branch instruction decoding.
+
+namespace tlo {
+namespace bench {
+
+using insn_bytes_t = std::array<uint8_t, system::k_max_insn_sz>;
+
+// Rough mix of what LBR `from` addresses point at: mostly direct/indirect
+// calls and jumps, some returns, prefixed forms, and the odd non-branch (when
+// the profile and binary don't quite match).
+static constexpr std::array<std::array<uint8_t, 4>, 16> k_encodings = { {
+    { { 0xe8, 0x10, 0x20, 0x00 } },  // call rel32
+    { { 0xe8, 0xf0, 0xff, 0xff } },  // call rel32
+    { { 0xff, 0xd0, 0x00, 0x00 } },  // call *%rax
+    { { 0xff, 0x15, 0x10, 0x20 } },  // call *rel(%rip)
+    { { 0x41, 0xff, 0xd4, 0x00 } },  // call *%r12
+    { { 0xe9, 0x10, 0x20, 0x00 } },  // jmp rel32
+    { { 0xeb, 0x10, 0x00, 0x00 } },  // jmp rel8
+    { { 0x0f, 0x84, 0x10, 0x20 } },  // je rel32
+    { { 0x75, 0x10, 0x00, 0x00 } },  // jne rel8
+    { { 0xc3, 0x00, 0x00, 0x00 } },  // ret
+    { { 0xf3, 0xc3, 0x00, 0x00 } },  // repz ret
+    { { 0xf2, 0xe8, 0x10, 0x20 } },  // bnd call rel32
+    { { 0x3e, 0xff, 0xe0, 0x00 } },  // notrack jmp *%rax
+    { { 0xff, 0xe0, 0x00, 0x00 } },  // jmp *%rax
+    { { 0x48, 0x89, 0xc7, 0x00 } },  // mov %rax, %rdi
+    { { 0x90, 0x00, 0x00, 0x00 } },  // nop
+} };
+
+void
+run_system_benches(const bench_runner_t & runner) {
+    static constexpr size_t k_ninsns = 4096;
+
+    rng_t               rng{ 3 };
+    vec_t<insn_bytes_t> insns;
+    for (size_t i = 0; i < k_ninsns; ++i) {
+        // Calls are the common case.
+        const size_t idx = rng.below(3) == 0 ? rng.below(k_encodings.size())
+                                             : rng.below(5);
+        insn_bytes_t insn{};
+        for (size_t j = 0; j < insn.size(); ++j) {
+            insn[j] = static_cast<uint8_t>(rng.next());
+        }
+        std::copy(k_encodings[idx].begin(), k_encodings[idx].end(),
+                  insn.begin());
+        insns.emplace_back(insn);
+    }
+
+    runner.run("system/br_insn_find", [&insns](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const insn_bytes_t & insn : insns) {
+                keep(system::br_insn_t::find(insn));
+            }
+        }
+        return iters * insns.size();
+    });
+}
+
+}  // namespace bench
+}  // namespace tlo
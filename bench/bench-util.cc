@@ -0,0 +1,73 @@
+#include "bench/bench.h"
+
+#include "src/util/strtab.h"
+#include "src/util/vec.h"
+
+#include <array>
+#include <string>
+
+#include <stdio.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// String interning.
+
+namespace tlo {
+namespace bench {
+
+// Names that look like mangled C++ symbols (lots of shared prefixes).
+static vec_t<std::string>
+make_symbol_names(uint64_t seed, size_t n) {
+    static constexpr std::array<const char *, 6> k_namespaces = { {
+        "3app", "4core", "3net", "2io", "6detail", "5cache",
+    } };
+    static constexpr std::array<const char *, 4> k_suffixes = { {
+        "Ev", "ERKS_", "EPKcm", "ISt6vectorIiSaIiEEEvT_",
+    } };
+    rng_t              rng{ seed };
+    vec_t<std::string> names;
+    for (size_t i = 0; i < n; ++i) {
+        std::array<char, 256> buf{};
+        const int             len = snprintf(
+            buf.data(), buf.size(), "_ZN%s%s12handler_%lu%lu%s",
+            k_namespaces[rng.below(k_namespaces.size())],
+            k_namespaces[rng.below(k_namespaces.size())], i, rng.below(1000),
+            k_suffixes[rng.below(k_suffixes.size())]);
+        names.emplace_back(buf.data(), static_cast<size_t>(len));
+    }
+    return names;
+}
+
+void
+run_util_benches(const bench_runner_t & runner) {
+    static constexpr size_t k_nnames = 16384;
+
+    const vec_t<std::string> names = make_symbol_names(5, k_nnames);
+
+    // Every string is new.
+    runner.run("util/strtab_intern_new", [&names](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            strtab_t<> stab{};
+            for (const std::string & name : names) {
+                keep(stab.get(std::string_view{ name }).str());
+            }
+        }
+        return iters * names.size();
+    });
+
+    // Every string is already in the table (i.e comm/dso names of samples).
+    strtab_t<> stab{};
+    for (const std::string & name : names) {
+        stab.get(std::string_view{ name });
+    }
+    runner.run("util/strtab_intern_hit", [&names, &stab](uint64_t iters) {
+        for (uint64_t i = 0; i < iters; ++i) {
+            for (const std::string & name : names) {
+                keep(stab.get(std::string_view{ name }).str());
+            }
+        }
+        return iters * names.size();
+    });
+}
+
+}  // namespace bench
+}  // namespace tlo
@@ -0,0 +1,127 @@
+#ifndef BENCH_D_BENCH_H_
+#define BENCH_D_BENCH_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Minimal self-contained microbenchmark harness.
+//
+// A benchmark is a callable taking the number of iterations to run and
+// returning the number of items (lines, lookups, ...) it processed. The runner
+// first doubles the iteration count until a run takes at least `min_time_ns_`,
+// then times `nrepeats_` runs of that many iterations and reports the fastest.
+//
+// Results are printed one JSON object per line:
+//  {"name": "...", "iters": N, "items": N, "ns_per_item": X,
+//   "items_per_sec": X}
+//
+// All inputs are generated from a fixed seed so runs are comparable.
+
+#include "src/util/compiler.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+namespace tlo {
+namespace bench {
+
+// Keep the compiler from optimizing away `val` (or the work producing it).
+template<typename T_t>
+static void
+keep(const T_t & val) {
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+// splitmix64. Deterministic and good enough for generating inputs.
+struct rng_t {
+    uint64_t state_;
+
+    uint64_t
+    next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15UL);
+        z          = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9UL;
+        z          = (z ^ (z >> 27U)) * 0x94d049bb133111ebUL;
+        return z ^ (z >> 31U);
+    }
+
+    // In [0, bound).
+    uint64_t
+    below(uint64_t bound) {
+        return next() % bound;
+    }
+};
+
+struct bench_runner_t {
+    static constexpr uint64_t k_default_min_time_ns = 200UL * 1000UL * 1000UL;
+    static constexpr uint32_t k_default_nrepeats    = 5;
+
+    std::string_view filter_;
+    uint64_t         min_time_ns_;
+    uint32_t         nrepeats_;
+    FILE *           fp_;
+
+    static uint64_t
+    now_ns() {
+        TLO_DISABLE_WREDUNDANT_TAGS
+        struct timespec ts;
+        TLO_REENABLE_WREDUNDANT_TAGS
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000UL * 1000UL * 1000UL +
+               static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    bool
+    enabled(std::string_view name) const {
+        return filter_.empty() || name.find(filter_) != std::string_view::npos;
+    }
+
+    template<typename T_body_t>
+    void
+    run(std::string_view name, T_body_t && body) const {
+        if (!enabled(name)) {
+            return;
+        }
+        uint64_t iters = 1;
+        uint64_t items = 0;
+        for (;;) {
+            const uint64_t start = now_ns();
+            items                = body(iters);
+            const uint64_t took  = now_ns() - start;
+            if (took >= min_time_ns_ || iters >= (1UL << 40U)) {
+                break;
+            }
+            iters *= 2;
+        }
+
+        uint64_t best = ~0UL;
+        for (uint32_t i = 0; i < nrepeats_; ++i) {
+            const uint64_t start = now_ns();
+            items                = body(iters);
+            best                 = std::min(best, now_ns() - start);
+        }
+        items = std::max(items, uint64_t{ 1 });
+
+        const double ns_per_item =
+            static_cast<double>(best) / static_cast<double>(items);
+        (void)fprintf(fp_,
+                      "{\"name\": \"%.*s\", \"iters\": %lu, \"items\": %lu, "
+                      "\"ns_per_item\": %.3f, \"items_per_sec\": %.1f}\n",
+                      static_cast<int>(name.size()), name.data(), iters, items,
+                      ns_per_item, 1e9 / ns_per_item);
+        (void)fflush(fp_);
+    }
+};
+
+// Benchmark groups (see bench-*.cc).
+void run_perf_parse_benches(const bench_runner_t & runner);
+void run_perf_stats_benches(const bench_runner_t & runner);
+void run_sym_benches(const bench_runner_t & runner);
+void run_system_benches(const bench_runner_t & runner);
+void run_util_benches(const bench_runner_t & runner);
+
+}  // namespace bench
+}  // namespace tlo
+
+#endif
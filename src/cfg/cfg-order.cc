@@ -1,4 +1,5 @@
 #include "src/cfg/cfg.h"
+#include "src/cfg/ext-tsp.h"
 #include "src/util/compiler.h"
 #include "src/util/umap.h"
 #include "src/util/vec.h"
@@ -468,6 +469,57 @@ hfsort_hotsort(const cfg_t * cg, vec_t<cluster_t> * clusters) {
 }
 
 
+// Ext-TSP (see ext-tsp.h). Each chain becomes a cluster and, like C3, the
+// clusters are ordered by density.
+static void
+ext_tsp(const cfg_t * cg, vec_t<cluster_t> * clusters) {
+    // Huge page size (same as C3).
+    static constexpr size_t k_max_chain_code_size =
+        static_cast<size_t>(2) * 1024 * 1024;
+
+    ext_tsp_t et{};
+    for (const node_id_t id : cg->node_ids()) {
+        const node_id_t et_id = et.add_node(cg->get_node(id)->size());
+        assert(et_id == id);
+        (void)et_id;
+    }
+    for (const node_id_t id : cg->node_ids()) {
+        for (const edge_t & succ : cg->get_node(id)->succs_) {
+            et.add_jump(id, succ.id_, static_cast<double>(succ.weight_));
+        }
+    }
+
+    vec_t<vec_t<size_t>> chains{};
+    et.run(k_max_chain_code_size, &chains);
+
+    clusters->clear();
+    clusters->reserve(chains.size());
+    vec_t<cluster_t *> id_to_cluster(cg->num_nodes(), nullptr);
+    for (const vec_t<size_t> & chain : chains) {
+        assert(!chain.empty());
+        cluster_t * cluster =
+            &clusters->emplace_back(cg->get_node(chain[0]), chain[0]);
+        id_to_cluster[chain[0]] = cluster;
+        for (size_t i = 1; i < chain.size(); ++i) {
+            cluster_t next{ cg->get_node(chain[i]), chain[i] };
+            // No limits, the chains already respect them.
+            const merge_result_t res =
+                cluster->try_merge(&next, &id_to_cluster, 0, 0, 0.0, 0.0);
+            assert(res == merge_result_t::k_success);
+            (void)res;
+        }
+#if (defined TLO_DEBUG_ENABLED) || (defined TLO_DEBUG_ENABLED_GLBL)
+        assert(cluster->valid(cg));
+#endif
+    }
+
+    std::sort(clusters->begin(), clusters->end(),
+              [](const cluster_t & lhs, const cluster_t & rhs) {
+                  return lhs.density() > rhs.density();
+              });
+}
+
+
 void
 cfg_t::order_nodes(order_algorithm                algo,
                    vec_t<cfg_func_order_info_t> * order_out) const {
@@ -492,6 +544,9 @@ cfg_t::order_nodes(order_algorithm                algo,
         case k_hfsort_hotsort:
             hfsort_hotsort(this, &clusters);
             break;
+        case k_ext_tsp:
+            ext_tsp(this, &clusters);
+            break;
     }
 
 
@@ -340,7 +340,11 @@ struct cfg_t {
     }
 
     // Algorithms we support
-    enum order_algorithm { k_hfsort_c3 = 0, k_hfsort_hotsort = 1 };
+    enum order_algorithm {
+        k_hfsort_c3      = 0,
+        k_hfsort_hotsort = 1,
+        k_ext_tsp        = 2
+    };
 
     // Perform some ordering algorithm (the entire reason we construct the CFG).
     // Implemented in cfg-order.cc
@@ -0,0 +1,365 @@
+#include "src/cfg/ext-tsp.h"
+#include "src/util/compiler.h"
+
+#include <algorithm>
+
+namespace tlo {
+
+// Where each part of the merged chain starts.
+struct ext_tsp_layout_t {
+    size_t   x_;
+    size_t   y_;
+    size_t   split_;
+    uint64_t x2_off_;
+    uint64_t x1_base_;
+    uint64_t x2_base_;
+    uint64_t y_base_;
+
+    ext_tsp_layout_t(const ext_tsp_t * et, const ext_tsp_t::merge_t & merge)
+        : x_(merge.x_), y_(merge.y_), split_(merge.split_) {
+        const ext_tsp_t::chain_t & x = et->chains_[merge.x_];
+        const ext_tsp_t::chain_t & y = et->chains_[merge.y_];
+        assert(split_ <= x.nodes_.size());
+        x2_off_ = split_ == x.nodes_.size() ? x.size_
+                                            : et->nodes_[x.nodes_[split_]].off_;
+
+        const uint64_t x1_size = x2_off_;
+        const uint64_t x2_size = x.size_ - x2_off_;
+        switch (merge.type_) {
+            case ext_tsp_t::k_x_y:
+                x1_base_ = 0;
+                x2_base_ = x1_size;
+                y_base_  = x.size_;
+                break;
+            case ext_tsp_t::k_x1_y_x2:
+                x1_base_ = 0;
+                y_base_  = x1_size;
+                x2_base_ = x1_size + y.size_;
+                break;
+            case ext_tsp_t::k_y_x2_x1:
+                y_base_  = 0;
+                x2_base_ = y.size_;
+                x1_base_ = y.size_ + x2_size;
+                break;
+            case ext_tsp_t::k_x2_x1_y:
+                x2_base_ = 0;
+                x1_base_ = x2_size;
+                y_base_  = x2_size + x1_size;
+                break;
+#if TLO_USING_CLANG
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wcovered-switch-default"
+#endif
+            default:
+                assert(0 && "Unrecognized merge type!");
+#if TLO_USING_CLANG
+# pragma clang diagnostic pop
+#endif
+        }
+    }
+
+    uint64_t
+    addr(const ext_tsp_t::node_t & node) const {
+        if (node.chain_ == y_) {
+            return y_base_ + node.off_;
+        }
+        assert(node.chain_ == x_);
+        return node.idx_ < split_ ? (x1_base_ + node.off_)
+                                  : (x2_base_ + node.off_ - x2_off_);
+    }
+};
+
+double
+ext_tsp_t::score(const vec_t<size_t> & order) const {
+    static constexpr uint64_t k_unplaced = ~uint64_t{ 0 };
+    vec_t<uint64_t>           addrs(nodes_.size(), k_unplaced);
+    uint64_t                  addr = 0;
+    for (const size_t id : order) {
+        addrs[id] = addr;
+        addr += nodes_[id].size_;
+    }
+
+    double res = 0.0;
+    for (const jump_t & jump : jumps_) {
+        if (addrs[jump.src_] == k_unplaced || addrs[jump.dst_] == k_unplaced) {
+            continue;
+        }
+        res += jump_score(addrs[jump.src_], nodes_[jump.src_].size_,
+                          addrs[jump.dst_], jump.weight_);
+    }
+    return res;
+}
+
+double
+ext_tsp_t::merge_score(const merge_t & merge,
+                       const vec_t<size_t> & jumps) const {
+    const ext_tsp_layout_t layout{ this, merge };
+    double                 res = 0.0;
+    for (const size_t jump_idx : jumps) {
+        const jump_t & jump = jumps_[jump_idx];
+        const node_t & src  = nodes_[jump.src_];
+        res += jump_score(layout.addr(src), src.size_,
+                          layout.addr(nodes_[jump.dst_]), jump.weight_);
+    }
+    return res;
+}
+
+void
+ext_tsp_t::best_merge(size_t x, size_t y, merge_t * best) const {
+    auto edge_res = chains_[x].edges_.find(y);
+    assert(edge_res != chains_[x].edges_.end());
+    const vec_t<size_t> & cross_jumps = edge_res->second.jumps_;
+
+    auto try_merge = [&](merge_t merge) {
+        // Only the jumps between the chains (and within the chain we split)
+        // can change score.
+        merge.gain_ = merge_score(merge, cross_jumps);
+        if (merge.type_ != k_x_y) {
+            const chain_t & split_chain = chains_[merge.x_];
+            merge.gain_ +=
+                merge_score(merge, split_chain.jumps_) - split_chain.score_;
+        }
+        if (merge.gain_ > best->gain_) {
+            *best = merge;
+        }
+    };
+
+    vec_t<size_t> splits{};
+    for (const auto & [a, b] : { std::pair{ x, y }, std::pair{ y, x } }) {
+        const size_t nnodes = chains_[a].nodes_.size();
+        try_merge(merge_t{ 0.0, a, b, nnodes, k_x_y });
+        if (nnodes > k_split_threshold) {
+            continue;
+        }
+        // Splitting anywhere other than right around a node that jumps
+        // to/from the other chain can't bring the two any closer.
+        splits.clear();
+        for (const size_t jump_idx : cross_jumps) {
+            const jump_t & jump = jumps_[jump_idx];
+            for (const size_t id : { jump.src_, jump.dst_ }) {
+                if (nodes_[id].chain_ == a) {
+                    splits.emplace_back(nodes_[id].idx_);
+                    splits.emplace_back(nodes_[id].idx_ + 1);
+                }
+            }
+        }
+        std::sort(splits.begin(), splits.end());
+        splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+        for (const size_t split : splits) {
+            if (split == 0 || split >= nnodes) {
+                continue;
+            }
+            try_merge(merge_t{ 0.0, a, b, split, k_x1_y_x2 });
+            try_merge(merge_t{ 0.0, a, b, split, k_y_x2_x1 });
+            try_merge(merge_t{ 0.0, a, b, split, k_x2_x1_y });
+        }
+    }
+}
+
+void
+ext_tsp_t::apply_merge(const merge_t & merge) {
+    chain_t & x = chains_[merge.x_];
+    chain_t & y = chains_[merge.y_];
+    assert(x.active() && y.active());
+
+    const auto x_begin = x.nodes_.begin();
+    const auto x_split = x.nodes_.begin() + static_cast<ssize_t>(merge.split_);
+    const auto x_end   = x.nodes_.end();
+
+    vec_t<size_t> order{};
+    order.reserve(x.nodes_.size() + y.nodes_.size());
+    auto append = [&order](auto begin, auto end) {
+        order.insert(order.end(), begin, end);
+    };
+    switch (merge.type_) {
+        case k_x_y:
+            append(x_begin, x_end);
+            append(y.nodes_.begin(), y.nodes_.end());
+            break;
+        case k_x1_y_x2:
+            append(x_begin, x_split);
+            append(y.nodes_.begin(), y.nodes_.end());
+            append(x_split, x_end);
+            break;
+        case k_y_x2_x1:
+            append(y.nodes_.begin(), y.nodes_.end());
+            append(x_split, x_end);
+            append(x_begin, x_split);
+            break;
+        case k_x2_x1_y:
+            append(x_split, x_end);
+            append(x_begin, x_split);
+            append(y.nodes_.begin(), y.nodes_.end());
+            break;
+#if TLO_USING_CLANG
+# pragma clang diagnostic push
+# pragma clang diagnostic ignored "-Wcovered-switch-default"
+#endif
+        default:
+            assert(0 && "Unrecognized merge type!");
+#if TLO_USING_CLANG
+# pragma clang diagnostic pop
+#endif
+    }
+
+    // The gain is exactly the change in score.
+    x.score_ += y.score_ + merge.gain_;
+    x.size_ += y.size_;
+
+    // Jumps between the chains are now internal.
+    auto edge_res = x.edges_.find(merge.y_);
+    assert(edge_res != x.edges_.end());
+    x.jumps_.insert(x.jumps_.end(), edge_res->second.jumps_.begin(),
+                    edge_res->second.jumps_.end());
+    x.jumps_.insert(x.jumps_.end(), y.jumps_.begin(), y.jumps_.end());
+    x.edges_.erase(edge_res);
+
+    // Everything that was connected to `y` is now connected to `x`.
+    for (auto & other_and_edge : y.edges_) {
+        const size_t other = other_and_edge.first;
+        if (other == merge.x_) {
+            continue;
+        }
+        const chain_edge_t & y_edge = other_and_edge.second;
+        chain_edge_t &       x_edge = x.edges_[other];
+        x_edge.jumps_.insert(x_edge.jumps_.end(), y_edge.jumps_.begin(),
+                             y_edge.jumps_.end());
+        x_edge.weight_ += y_edge.weight_;
+
+        umap<size_t, chain_edge_t> & other_edges = chains_[other].edges_;
+        auto other_res = other_edges.find(merge.y_);
+        assert(other_res != other_edges.end());
+        chain_edge_t moved = std::move(other_res->second);
+        other_edges.erase(other_res);
+        chain_edge_t & to_x = other_edges[merge.x_];
+        to_x.jumps_.insert(to_x.jumps_.end(), moved.jumps_.begin(),
+                           moved.jumps_.end());
+        to_x.weight_ += moved.weight_;
+    }
+
+    uint64_t off = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        node_t & node = nodes_[order[i]];
+        node.chain_   = merge.x_;
+        node.idx_     = i;
+        node.off_     = off;
+        off += node.size_;
+    }
+    assert(off == x.size_);
+    x.nodes_ = std::move(order);
+    ++x.version_;
+
+    y.nodes_.clear();
+    y.jumps_.clear();
+    y.edges_.clear();
+    y.size_  = 0;
+    y.score_ = 0.0;
+    ++y.version_;
+}
+
+void
+ext_tsp_t::run(uint64_t max_chain_size, vec_t<vec_t<size_t>> * chains_out) {
+    chains_.clear();
+    chains_.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        nodes_[i].chain_ = i;
+        nodes_[i].idx_   = 0;
+        nodes_[i].off_   = 0;
+        chains_[i].nodes_.emplace_back(i);
+        chains_[i].size_    = nodes_[i].size_;
+        chains_[i].score_   = 0.0;
+        chains_[i].version_ = 0;
+    }
+    for (size_t i = 0; i < jumps_.size(); ++i) {
+        const jump_t & jump = jumps_[i];
+        for (const auto & [a, b] :
+             { std::pair{ jump.src_, jump.dst_ },
+               std::pair{ jump.dst_, jump.src_ } }) {
+            chain_edge_t & edge = chains_[a].edges_[b];
+            edge.jumps_.emplace_back(i);
+            edge.weight_ += jump.weight_;
+        }
+    }
+
+    struct candidate_t {
+        merge_t  merge_;
+        uint64_t x_version_;
+        uint64_t y_version_;
+    };
+    auto cmp = [](const candidate_t & lhs, const candidate_t & rhs) {
+        if (lhs.merge_.gain_ != rhs.merge_.gain_) {
+            return lhs.merge_.gain_ < rhs.merge_.gain_;
+        }
+        // Deterministic tie-break.
+        if (lhs.merge_.x_ != rhs.merge_.x_) {
+            return lhs.merge_.x_ > rhs.merge_.x_;
+        }
+        return lhs.merge_.y_ > rhs.merge_.y_;
+    };
+    vec_t<candidate_t> candidates{};
+
+    auto push_candidate = [&](size_t x, size_t y) {
+        if (max_chain_size != 0 &&
+            (chains_[x].size_ + chains_[y].size_) > max_chain_size) {
+            return;
+        }
+        merge_t best{ 0.0, x, y, 0, k_x_y };
+        best_merge(x, y, &best);
+        if (best.gain_ <= 0.0) {
+            return;
+        }
+        candidates.emplace_back(candidate_t{
+            best, chains_[best.x_].version_, chains_[best.y_].version_ });
+        std::push_heap(candidates.begin(), candidates.end(), cmp);
+    };
+
+    for (size_t x = 0; x < chains_.size(); ++x) {
+        for (const auto & other_and_edge : chains_[x].edges_) {
+            if (x < other_and_edge.first) {
+                push_candidate(x, other_and_edge.first);
+            }
+        }
+    }
+
+    vec_t<std::pair<double, size_t>> neighbours{};
+    while (!candidates.empty()) {
+        std::pop_heap(candidates.begin(), candidates.end(), cmp);
+        const candidate_t cand = candidates.back();
+        candidates.pop_back();
+        const chain_t & x = chains_[cand.merge_.x_];
+        const chain_t & y = chains_[cand.merge_.y_];
+        if (!x.active() || !y.active() || x.version_ != cand.x_version_ ||
+            y.version_ != cand.y_version_) {
+            continue;
+        }
+
+        apply_merge(cand.merge_);
+
+        // Recompute merges with (the most connected of) the new chain's
+        // neighbours.
+        neighbours.clear();
+        for (const auto & other_and_edge : chains_[cand.merge_.x_].edges_) {
+            neighbours.emplace_back(other_and_edge.second.weight_,
+                                    other_and_edge.first);
+        }
+        if (neighbours.size() > k_max_merge_updates) {
+            std::partial_sort(
+                neighbours.begin(),
+                neighbours.begin() + static_cast<ssize_t>(k_max_merge_updates),
+                neighbours.end(), std::greater<>{});
+            neighbours.resize(k_max_merge_updates);
+        }
+        for (const auto & weight_and_other : neighbours) {
+            push_candidate(cand.merge_.x_, weight_and_other.second);
+        }
+    }
+
+    chains_out->clear();
+    for (const chain_t & chain : chains_) {
+        if (chain.active()) {
+            chains_out->emplace_back(chain.nodes_);
+        }
+    }
+}
+
+}  // namespace tlo
@@ -0,0 +1,163 @@
+#ifndef SRC_D_CFG_D_EXT_TSP_H_
+#define SRC_D_CFG_D_EXT_TSP_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Ext-TSP ordering ("Improved Basic Block Reordering", Newell & Pupyrev). This
+// is the objective BOLT/LLVM use for block and function layout.
+//
+// Every node starts in its own chain. We then repeatedly do the merge of two
+// chains (possibly splitting one of them and inserting the other) that
+// increases the Ext-TSP score the most. A jump (call) is scored by how close
+// its target ends up to its source: a fall-through (callee immediately after
+// caller) gets full weight, and short forward/backward jumps get a fraction of
+// it that decays with distance.
+//
+// We don't know where in the caller a call happens, so calls are assumed to
+// come from the middle of the caller. The original distance windows are sized
+// for basic blocks, functions are much larger so they are scaled to pages.
+//
+// To keep this tractable on very large graphs:
+//  - Chains are never grown past `max_chain_size` bytes.
+//  - A chain is only split if it has at most `k_split_threshold` nodes, and
+//    only next to nodes that jump to/from the chain being merged in.
+//  - After a merge, only the `k_max_merge_updates` most heavily connected
+//    neighbouring chains have their merge gains recomputed.
+
+#include "src/util/memory.h"
+#include "src/util/umap.h"
+#include "src/util/vec.h"
+
+#include <stdint.h>
+
+namespace tlo {
+
+struct ext_tsp_t {
+    static constexpr double   k_fallthrough_weight = 1.0;
+    static constexpr double   k_forward_weight     = 0.1;
+    static constexpr double   k_backward_weight    = 0.1;
+    static constexpr uint64_t k_forward_distance   = 4 * k_page_size;
+    static constexpr uint64_t k_backward_distance  = 2 * k_page_size;
+
+    static constexpr size_t k_split_threshold   = 128;
+    static constexpr size_t k_max_merge_updates = 64;
+
+    struct node_t {
+        uint64_t size_;
+        // Chain the node is in, its index in that chain, and its offset (in
+        // bytes) from the start of the chain.
+        size_t   chain_;
+        size_t   idx_;
+        uint64_t off_;
+    };
+
+    struct jump_t {
+        size_t src_;
+        size_t dst_;
+        double weight_;
+    };
+
+    // Jumps between two chains.
+    struct chain_edge_t {
+        vec_t<size_t> jumps_;
+        double        weight_;
+    };
+
+    struct chain_t {
+        vec_t<size_t> nodes_;
+        uint64_t      size_;
+        double        score_;
+        // Bumped on every merge so stale merge candidates can be dropped.
+        uint64_t version_;
+        // Jumps with both ends in this chain.
+        vec_t<size_t>              jumps_;
+        umap<size_t, chain_edge_t> edges_;
+
+        bool
+        active() const {
+            return !nodes_.empty();
+        }
+    };
+
+    enum merge_type_t : uint8_t {
+        k_x_y,
+        k_x1_y_x2,
+        k_y_x2_x1,
+        k_x2_x1_y,
+    };
+
+    // How to merge chain `y` into chain `x`. `x` is split before its node at
+    // index `split_` (`split_` is the number of nodes in `x` for `k_x_y`).
+    struct merge_t {
+        double       gain_;
+        size_t       x_;
+        size_t       y_;
+        size_t       split_;
+        merge_type_t type_;
+    };
+
+    vec_t<node_t>  nodes_;
+    vec_t<jump_t>  jumps_;
+    vec_t<chain_t> chains_;
+
+    size_t
+    add_node(uint64_t size) {
+        nodes_.emplace_back(node_t{ std::max(size, uint64_t{ 1 }), 0, 0, 0 });
+        return nodes_.size() - 1;
+    }
+
+    void
+    add_jump(size_t src, size_t dst, double weight) {
+        assert(src < nodes_.size() && dst < nodes_.size());
+        if (src != dst && weight > 0.0) {
+            jumps_.emplace_back(jump_t{ src, dst, weight });
+        }
+    }
+
+    static double
+    jump_score(uint64_t src_addr,
+               uint64_t src_size,
+               uint64_t dst_addr,
+               double   weight) {
+        if (dst_addr == (src_addr + src_size)) {
+            return weight * k_fallthrough_weight;
+        }
+        const uint64_t src_mid = src_addr + src_size / 2;
+        if (dst_addr > src_mid) {
+            const uint64_t dist = dst_addr - src_mid;
+            if (dist <= k_forward_distance) {
+                return weight * k_forward_weight *
+                       (1.0 - static_cast<double>(dist) /
+                                  static_cast<double>(k_forward_distance));
+            }
+        }
+        else {
+            const uint64_t dist = src_mid - dst_addr;
+            if (dist <= k_backward_distance) {
+                return weight * k_backward_weight *
+                       (1.0 - static_cast<double>(dist) /
+                                  static_cast<double>(k_backward_distance));
+            }
+        }
+        return 0.0;
+    }
+
+    // Ext-TSP score of all jumps if the nodes are laid out in `order`.
+    double score(const vec_t<size_t> & order) const;
+
+    // Group the nodes into chains. Each chain in `chains_out` is in final
+    // layout order, the order of the chains themselves is left to the caller.
+    // A `max_chain_size` of 0 means unlimited.
+    void run(uint64_t max_chain_size, vec_t<vec_t<size_t>> * chains_out);
+
+    // Score of `jumps` if `merge` is done.
+    double merge_score(const merge_t & merge, const vec_t<size_t> & jumps) const;
+
+    // Best way to merge chains `x` and `y` (either way around).
+    void best_merge(size_t x, size_t y, merge_t * best) const;
+
+    void apply_merge(const merge_t & merge);
+};
+
+}  // namespace tlo
+
+#endif
@@ -1,16 +1,23 @@
 #include "src/cfg/cfg.h"
 #include "src/perf/perf-file.h"
+#include "src/perf/perf-sample-cache.h"
 #include "src/perf/perf-saver.h"
+#include "src/sym/sym-cache.h"
 #include "src/util/algo.h"
+#include "src/util/compressed-writer.h"
 #include "src/util/file-reader.h"
 #include "src/util/global-stats.h"
+#include "src/util/uring.h"
 #include "src/util/vec.h"
 #include "src/util/verbosity.h"
 
+#include <array>
+#include <span>
 #include <vector>
 
 #include <errno.h>
 #include <getopt.h>
+#include <glob.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -234,6 +241,100 @@ process_input_files(std::string_view   infile,
     return { "", 0 };
 }
 
+// Path of the first of `names` that exists in `dir` (empty if none). The path
+// is kept in `path_bufs`.
+static std::string_view
+find_profile_file(std::string_view                     dir,
+                  std::span<const std::string_view>    names,
+                  tlo::vec_t<tlo::vec_t<char>> * const path_bufs) {
+    for (const std::string_view name : names) {
+        tlo::vec_t<char> path_buf{};
+        std::copy(dir.begin(), dir.end(), std::back_inserter(path_buf));
+        if (tlo::file_ops::exists(tlo::path_join(&path_buf, name).data())) {
+            path_bufs->emplace_back(std::move(path_buf));
+            return { path_bufs->back().data(), path_bufs->back().size() - 1U };
+        }
+    }
+    return {};
+}
+
+// Expand the --profiles list (CSV, each may be a glob) to the events/info files
+// of each profile. A directory is laid out like --root, a perf.data file has
+// both, and with --dso-offsets any other file is just the events.
+static bool
+find_profiles(char *                                   inputs,
+              bool                                     dso_offsets,
+              tlo::vec_t<tlo::vec_t<char>> *           path_bufs,
+              tlo::vec_t<tlo::perf::perf_profile_t> *  profiles_out) {
+    static constexpr std::array<std::string_view, 3> k_events_files = {
+        { "profile.zst", "profile.txt", "perf.data" }
+    };
+    static constexpr std::array<std::string_view, 3> k_info_files = {
+        { "info-events.zst", "info-events.txt", "perf.data" }
+    };
+
+    glob_t       globbed{};
+    int          flags = 0;
+    char * const end   = inputs + std::strlen(inputs);
+    for (char * input = inputs; input < end;) {
+        char * next = reinterpret_cast<char *>(
+            std::memchr(input, ',', static_cast<uintptr_t>(end - input)));
+        if (next == nullptr) {
+            next = end;
+        }
+        *next         = '\0';
+        const int res = glob(input, flags, nullptr, &globbed);
+        if (res == GLOB_NOMATCH) {
+            TLO_PRINT_USR_ERR("Warning: No profiles match: \"%s\"\n", input);
+        }
+        else if (res != 0) {
+            TLO_PRINT_USR_ERR("Unable to expand profiles: \"%s\"\n", input);
+            globfree(&globbed);
+            return false;
+        }
+        flags = GLOB_APPEND;
+        input = next + 1;
+    }
+
+    // Keep our own copies so the profiles outlive `globbed`.
+    tlo::vec_t<std::string_view> paths{};
+    for (size_t i = 0; i < globbed.gl_pathc; ++i) {
+        const std::string_view path{ globbed.gl_pathv[i] };
+        path_bufs->emplace_back(path.begin(), path.end());
+        path_bufs->back().emplace_back('\0');
+        paths.emplace_back(path_bufs->back().data(), path.size());
+    }
+    globfree(&globbed);
+
+    for (const std::string_view path : paths) {
+        tlo::perf::perf_profile_t profile{};
+        if (tlo::file_ops::is_dir(path)) {
+            profile.events_ =
+                find_profile_file(path, k_events_files, path_bufs);
+            if (!dso_offsets) {
+                profile.info_ =
+                    profile.events_.ends_with(".data")
+                        ? profile.events_
+                        : find_profile_file(path, k_info_files, path_bufs);
+            }
+        }
+        else {
+            profile.events_ = path;
+            if (path.ends_with(".data")) {
+                profile.info_ = path;
+            }
+        }
+        if (profile.events_.empty() ||
+            (!dso_offsets && profile.info_.empty())) {
+            TLO_PRINT_USR_ERR("Warning: Missing events/info files for: %s\n",
+                              path.data());
+            continue;
+        }
+        profiles_out->emplace_back(profile);
+    }
+    return !profiles_out->empty();
+}
+
 static void
 usage(const char * progname) {
     TLO_PRINT_USR_ERR(
@@ -256,6 +357,22 @@ usage(const char * progname) {
         "\t[--add-scale]\t\tAdd a custom scaling factor to the output.\n"
         "\t[--use-custom-scale]\t\tUse custom scaling factors from save states.\n"
         "\t[--dump]\t\tDump stats.\n"
+        "\t[--perf-script]\t\tUse `perf script` to read perf.data files instead of decoding them directly (with --jobs one `perf script` per time slice).\n"
+        "\t[-j][--jobs]\t\tNumber of threads used to load symbols and collect perf events (0 for one per core, 2 pipelines reading/parsing/collecting).\n"
+        "\t[--sym-cache]\t\tDirectory to cache loaded DSO symbols in (created if needed).\n"
+        "\t[--order]\t\tFunction ordering algorithm: c3 (default), ext-tsp, or hotsort.\n"
+        "\t[--save-format]\t\tFormat for --save: json (default) or binary.\n"
+        "\t[--convert]\t\tConvert a save state to --save-format and write it to --save.\n"
+        "\t[--compress]\t\tCompress a profile (text) to <file>.zst so it can be decompressed in parallel.\n"
+        "\t[--compress-level]\t\tZstd compression level for --compress (default 9).\n"
+        "\t[--sample-cache]\t\tFile to cache the collected samples in. Reused while the profile is unchanged.\n"
+        "\t[--checkpoint]\t\tFile to periodically save the samples collected so far in. A later run with the same checkpoint resumes from it (removed once collecting is done).\n"
+        "\t[--checkpoint-interval]\t\tSeconds between checkpoints (default 600).\n"
+        "\t[--aggregate]\t\tAggregate samples per: tpid (default), pid, comm, or global.\n"
+        "\t[--preaggregate]\t\tCount repeated samples by raw address and resolve each distinct one once.\n"
+        "\t[--profiles]\t\tCollect many profiles (CSV, each may be a glob) at once into one ordering. Each is a directory laid out like --root, a perf.data file, or (with --dso-offsets) an events file. Each is normalized like --reload unless --no-normalize.\n"
+        "\t[--dso-offsets]\t\tPerf events are `perf script -F comm,pid,tid,time,brstackoff` output (DSO-relative addresses). No info events are needed.\n"
+        "\t[--io-uring]\t\tRead profiles with a deep queue of io_uring reads and prefetch the DSOs found in the info events in the background (falls back to regular reads if io_uring is unavailable).\n"
         "Can also specify 'stdin' and pass the states to reload from through stdin.\n",
         progname);
 }
@@ -304,21 +421,54 @@ main(int argc, char ** argv) {
         { "add-scale", required_argument, nullptr, 16 },
         { "use-custom-scale", no_argument, nullptr, 17 },
         { "dump", no_argument, nullptr, 18 },
+        { "perf-script", no_argument, nullptr, 19 },
+        { "j", required_argument, nullptr, 20 },
+        { "jobs", required_argument, nullptr, 20 },
+        { "sym-cache", required_argument, nullptr, 21 },
+        { "order", required_argument, nullptr, 22 },
+        { "save-format", required_argument, nullptr, 23 },
+        { "convert", required_argument, nullptr, 24 },
+        { "compress", required_argument, nullptr, 25 },
+        { "compress-level", required_argument, nullptr, 26 },
+        { "sample-cache", required_argument, nullptr, 27 },
+        { "aggregate", required_argument, nullptr, 28 },
+        { "preaggregate", no_argument, nullptr, 29 },
+        { "dso-offsets", no_argument, nullptr, 30 },
+        { "profiles", required_argument, nullptr, 31 },
+        { "io-uring", no_argument, nullptr, 32 },
+        { "checkpoint", required_argument, nullptr, 33 },
+        { "checkpoint-interval", required_argument, nullptr, 34 },
         { nullptr, 0, nullptr, 0 },
     };
     TLO_REENABLE_WREDUNDANT_TAGS
 
     // NOLINTBEGIN(bugprone-string-constructor)
-    bool                            dump_stats = false;
+    bool                            dump_stats      = false;
+    bool                            use_perf_script = false;
+    bool                            preaggregate    = false;
+    bool                            dso_offsets     = false;
+    size_t                          njobs           = 1;
     std::string_view                perf_file{ "", 0 };
     std::string_view                root_path{ "", 0 };
     std::string_view                info_file{ "", 0 };
     std::string_view                savefile{ "", 0 };
     char *                          reload_infiles = nullptr;
+    char *                          profile_inputs = nullptr;
     std::string_view                output_dir{ "", 0 };
     std::string_view                dot_file{ "", 0 };
     std::string_view                dot_dso{ "", 0 };
+    std::string_view                sym_cache_dir{ "", 0 };
+    std::string_view                sample_cache{ "", 0 };
+    std::string_view                checkpoint_file{ "", 0 };
+    uint64_t                        checkpoint_interval = 600;
+    const char *                    convert_infile  = nullptr;
+    const char *                    compress_infile = nullptr;
+    // Only used with ZSTD.
+    [[maybe_unused]] int compress_level = tlo::k_seekable_default_level;
+    tlo::perf::perf_state_fmt_t     save_fmt = tlo::perf::k_perf_state_json;
     tlo::perf::perf_state_scaling_t scaling_todo{};
+    tlo::cfg_t::order_algorithm     order_algo = tlo::cfg_t::k_hfsort_c3;
+    tlo::perf::perf_agr_key_t       agr_key    = tlo::perf::k_agr_tpid;
     // NOLINTEND(bugprone-string-constructor)
     bool overwrite = false;
     for (;;) {
@@ -409,6 +559,128 @@ main(int argc, char ** argv) {
             case 18:
                 dump_stats = true;
                 break;
+                // Use `perf script` for perf.data files
+            case 19:
+                use_perf_script = true;
+                break;
+                // Number of threads for collecting perf events
+            case 20: {
+                char *              end = optarg;
+                const unsigned long val = std::strtoul(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    TLO_PRINT_USR_ERR(
+                        "Unable to convert argument to --jobs to integer: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                njobs = val;
+            } break;
+                // Directory for the on-disk symbol cache
+            case 21:
+                sym_cache_dir = { optarg, strlen(optarg) };
+                break;
+                // Function ordering algorithm
+            case 22:
+                if (strcmp(optarg, "c3") == 0) {
+                    order_algo = tlo::cfg_t::k_hfsort_c3;
+                }
+                else if (strcmp(optarg, "ext-tsp") == 0) {
+                    order_algo = tlo::cfg_t::k_ext_tsp;
+                }
+                else if (strcmp(optarg, "hotsort") == 0) {
+                    order_algo = tlo::cfg_t::k_hfsort_hotsort;
+                }
+                else {
+                    TLO_PRINT_USR_ERR(
+                        "Unknown ordering algorithm for --order: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                break;
+                // Save state format
+            case 23:
+                if (strcmp(optarg, "binary") == 0) {
+                    save_fmt = tlo::perf::k_perf_state_binary;
+                }
+                else if (strcmp(optarg, "json") == 0) {
+                    save_fmt = tlo::perf::k_perf_state_json;
+                }
+                else {
+                    TLO_PRINT_USR_ERR(
+                        "Unknown save state format for --save-format: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                break;
+                // Convert a save state
+            case 24:
+                convert_infile = optarg;
+                break;
+                // Compress a profile
+            case 25:
+                compress_infile = optarg;
+                break;
+                // Compression level for --compress
+            case 26: {
+                char *     end = optarg;
+                const long val = std::strtol(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    TLO_PRINT_USR_ERR(
+                        "Unable to convert argument to --compress-level to integer: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                compress_level = static_cast<int>(val);
+            } break;
+                // File to cache the collected samples in
+            case 27:
+                sample_cache = { optarg, strlen(optarg) };
+                break;
+                // What samples are aggregated by
+            case 28:
+                if (!tlo::perf::perf_agr_key_from_str(optarg, &agr_key)) {
+                    TLO_PRINT_USR_ERR(
+                        "Unknown aggregation key for --aggregate: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                break;
+                // Resolve repeated samples once
+            case 29:
+                preaggregate = true;
+                break;
+                // Perf events have DSO-relative addresses
+            case 30:
+                dso_offsets = true;
+                break;
+                // Collect many profiles at once
+            case 31:
+                profile_inputs = optarg;
+                break;
+                // Read with io_uring
+            case 32:
+                if (!tlo::uring_t::set_enabled(true)) {
+                    TLO_PRINT_USR_ERR(
+                        "Warning: io_uring is unavailable, using regular "
+                        "reads\n");
+                }
+                break;
+                // Checkpoint the events pass
+            case 33:
+                checkpoint_file = { optarg, strlen(optarg) };
+                break;
+                // Seconds between checkpoints
+            case 34: {
+                char *              end = optarg;
+                const unsigned long val = std::strtoul(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    TLO_PRINT_USR_ERR(
+                        "Unable to convert argument to --checkpoint-interval to integer: \"%s\"\n",
+                        optarg);
+                    return 1;
+                }
+                checkpoint_interval = val;
+            } break;
         }
     }
     // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
@@ -417,6 +689,49 @@ main(int argc, char ** argv) {
     tlo::vec_t<tlo::perf::perf_func_t> funcs;
     tlo::vec_t<tlo::perf::perf_edge_t> edges;
 
+    if (convert_infile != nullptr) {
+        if (savefile.empty()) {
+            TLO_PRINT_USR_ERR("Must provide a savefile to convert to\n");
+            return 1;
+        }
+        if (!check_can_overwrite(overwrite, savefile.data(), "Save")) {
+            return 1;
+        }
+        if (!tlo::perf::convert_perf_state(convert_infile, savefile.data(),
+                                           save_fmt)) {
+            TLO_PRINT_USR_ERR("Unable to convert \"%s\" to \"%s\"\n",
+                              convert_infile, savefile.data());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (compress_infile != nullptr) {
+#ifdef TLO_ZSTD
+        tlo::vec_t<char> compress_outfile{};
+        std::copy(compress_infile, compress_infile + strlen(compress_infile),
+                  std::back_inserter(compress_outfile));
+        // Copy with the null-terminator.
+        std::copy(".zst", ".zst" + sizeof(".zst"),
+                  std::back_inserter(compress_outfile));
+        if (!check_can_overwrite(overwrite, compress_outfile.data(),
+                                 "Compressed")) {
+            return 1;
+        }
+        if (!tlo::compress_file_seekable(compress_infile,
+                                         compress_outfile.data(),
+                                         compress_level, njobs)) {
+            TLO_PRINT_USR_ERR("Unable to compress \"%s\" to \"%s\"\n",
+                              compress_infile, compress_outfile.data());
+            return 1;
+        }
+        return 0;
+#else
+        TLO_PRINT_USR_ERR("Not built with ZSTD support\n");
+        return 1;
+#endif
+    }
+
     // Ensure output
     if (output_dir.empty() && savefile.empty() && dot_file.empty()) {
         TLO_PRINT_USR_ERR(
@@ -434,93 +749,275 @@ main(int argc, char ** argv) {
 
         tlo::vec_t<char> perf_path_buf{};
         tlo::vec_t<char> info_path_buf{};
-        // If no perf file then try:
-        //  - root_path/profile.zst
-        //  - root_path/perf.data
-        perf_file =
-            process_input_files(perf_file, root_path, &perf_path_buf,
-                                "profile.zst", "profile.txt", "Perf Events");
-        if (perf_file.empty()) {
-            return 1;
+        tlo::vec_t<tlo::vec_t<char>>          profile_path_bufs{};
+        tlo::vec_t<tlo::perf::perf_profile_t> profiles{};
+        if (profile_inputs != nullptr) {
+            if (!perf_file.empty() || !info_file.empty()) {
+                TLO_PRINT_USR_ERR(
+                    "Warning: Ignoring perf/info arguments with --profiles\n");
+                perf_file = {};
+                info_file = {};
+            }
+            if (!sample_cache.empty()) {
+                TLO_PRINT_USR_ERR(
+                    "Warning: Ignoring --sample-cache with --profiles\n");
+                sample_cache = {};
+            }
+            if (!checkpoint_file.empty()) {
+                TLO_PRINT_USR_ERR(
+                    "Warning: Ignoring --checkpoint with --profiles\n");
+                checkpoint_file = {};
+            }
+            if (!find_profiles(profile_inputs, dso_offsets, &profile_path_bufs,
+                               &profiles)) {
+                TLO_PRINT_USR_ERR("No profiles found\n");
+                return 1;
+            }
+            TLO_printv("Processing %zu profiles\n", profiles.size());
+        }
+        else {
+            // If no perf file then try:
+            //  - root_path/profile.zst
+            //  - root_path/perf.data
+            perf_file = process_input_files(perf_file, root_path,
+                                            &perf_path_buf, "profile.zst",
+                                            "profile.txt", "Perf Events");
+            if (perf_file.empty()) {
+                return 1;
+            }
         }
 
-        if (info_file.empty() && perf_file.ends_with(".data")) {
-            info_file = perf_file;
-            TLO_PRINT_USR_ERR(
-                "Warning: defaulting to \"%s\" as Info Events file\n",
-                info_file.data());
+        // The offsets need no mappings so there are no info events. Each of
+        // the --profiles has its own.
+        if (!dso_offsets && profiles.empty()) {
+            if (info_file.empty() && perf_file.ends_with(".data")) {
+                info_file = perf_file;
+                TLO_PRINT_USR_ERR(
+                    "Warning: defaulting to \"%s\" as Info Events file\n",
+                    info_file.data());
+            }
+            info_file = process_input_files(
+                info_file, root_path, &info_path_buf, "info-events.zst",
+                "info-events.txt", "Info Events");
+            if (info_file.empty()) {
+                return 1;
+            }
         }
-        info_file = process_input_files(info_file, root_path, &info_path_buf,
-                                        "info-events.zst", "info-events.txt",
-                                        "Info Events");
-        if (info_file.empty()) {
-            return 1;
+        else if (!info_file.empty()) {
+            TLO_PRINT_USR_ERR(
+                "Warning: Ignoring info events file with --dso-offsets\n");
+            info_file = {};
         }
 
-        // Open user file(s).
-        tlo::file_reader_t fr_events, fr_map;
-        if (info_file.ends_with(".data")) {
-            tlo::preader_t::cmdline_t cmdline;
-            if (!tlo::perf::create_perf_info_cmdline(info_file, &cmdline)) {
-                TLO_PRINT_USR_ERR("Perf filename too long!\n");
+        // Set root path for DSOs.
+        tlo::sym::dso_t::set_dso_root_path(root_path);
+        if (!sym_cache_dir.empty()) {
+            if (!tlo::file_ops::make_dir_p(sym_cache_dir)) {
+                TLO_PRINT_USR_ERR("Unable to create symbol cache dir: %s\n",
+                                  sym_cache_dir.data());
                 return 1;  // NOLINT(*magic*)
             }
-            fr_map.init(cmdline.data());
-        }
-        else {
-            fr_map.init(info_file.data());
+            tlo::sym::sym_cache_t::set_cache_dir(sym_cache_dir);
         }
 
-        if (perf_file.ends_with(".data")) {
-            tlo::preader_t::cmdline_t cmdline;
-            if (!tlo::perf::create_perf_events_cmdline(perf_file, &cmdline)) {
-                TLO_PRINT_USR_ERR("Perf filename too long!\n");
+        // Reuse the samples collected by the last run if the profile hasn't
+        // changed since. A checkpoint is keyed the same way.
+        tlo::perf::perf_stats_t stats{ &ss, agr_key, preaggregate };
+        if (dso_offsets) {
+            stats.use_dso_offsets();
+        }
+        tlo::vec_t<char>        sample_cache_key{};
+        bool                    from_sample_cache = false;
+        if (!sample_cache.empty() || !checkpoint_file.empty()) {
+            const std::array<std::string_view, 2> inputs = {
+                { perf_file, info_file }
+            };
+            // No info events with --dso-offsets.
+            const std::span<const std::string_view> key_inputs{
+                inputs.data(), dso_offsets ? 1U : inputs.size()
+            };
+            if (!tlo::perf::perf_sample_cache_t::make_key(key_inputs,
+                                                          &sample_cache_key)) {
+                TLO_PRINT_USR_ERR("Unable to stat profile for sample cache\n");
                 return 1;  // NOLINT(*magic*)
             }
-            fr_events.init(cmdline.begin());
         }
-        else {
-            fr_events.init(perf_file.data());
+        if (!sample_cache.empty()) {
+            from_sample_cache = tlo::perf::perf_sample_cache_t::load(
+                sample_cache.data(),
+                { sample_cache_key.data(), sample_cache_key.size() }, &stats,
+                njobs);
+            if (from_sample_cache) {
+                TLO_printv("Reusing samples from: %s\n", sample_cache.data());
+            }
         }
 
-        if (!fr_events.active()) {
-            TLO_PRINT_USR_ERR("Unable to read file: \"%s\"\n",
-                              perf_file.data());
-            return 1;  // NOLINT(*magic*)
+        // Each profile is validated as it is collected. Once normalized the
+        // combined stats no longer balance, so `valid` doesn't apply.
+        if (!profiles.empty()) {
+            if (!tlo::perf::collect_perf_profiles(profiles, &stats,
+                                                  &scaling_todo, njobs)) {
+                TLO_PRINT_USR_ERR("Error collecting stats from profiles\n");
+                return 1;  // NOLINT(*magic*)
+            }
         }
+        else if (!from_sample_cache) {
+            // Open user file(s).
+            // If we are just given a perf.data file, decode it directly.
+            const bool native_perf_data = !dso_offsets && !use_perf_script &&
+                                          perf_file.ends_with(".data") &&
+                                          info_file == perf_file;
+            if (native_perf_data && !checkpoint_file.empty()) {
+                TLO_PRINT_USR_ERR(
+                    "--checkpoint is not supported when decoding perf.data "
+                    "directly (use --perf-script)\n");
+                return 1;  // NOLINT(*magic*)
+            }
+            // `perf script` is single threaded so with multiple jobs run one
+            // per time slice of the recording.
+            const bool sliced_perf_script = !dso_offsets && !native_perf_data &&
+                                            perf_file.ends_with(".data") &&
+                                            njobs != 1;
+            // A checkpoint needs a single stream of events to resume.
+            if (sliced_perf_script && !checkpoint_file.empty()) {
+                TLO_PRINT_USR_ERR(
+                    "--checkpoint is not supported when running perf script "
+                    "per time slice (use --jobs 1)\n");
+                return 1;  // NOLINT(*magic*)
+            }
+            tlo::perf::perf_data_reader_t pdr;
+            tlo::perf::perf_time_range_t  time_range;
+            tlo::file_reader_t            fr_events, fr_map;
+            if (native_perf_data) {
+                if (!pdr.init(perf_file.data())) {
+                    TLO_PRINT_USR_ERR(
+                        "Unable to decode perf.data file: \"%s\"\n",
+                        perf_file.data());
+                    return 1;  // NOLINT(*magic*)
+                }
+            }
+            else {
+                // With --dso-offsets there are no info events to read.
+                if (!dso_offsets && info_file.ends_with(".data")) {
+                    tlo::preader_t::cmdline_t cmdline;
+                    if (!tlo::perf::create_perf_info_cmdline(info_file,
+                                                             &cmdline)) {
+                        TLO_PRINT_USR_ERR("Perf filename too long!\n");
+                        return 1;  // NOLINT(*magic*)
+                    }
+                    fr_map.init(cmdline.data());
+                }
+                else if (!dso_offsets) {
+                    fr_map.init(info_file.data(), njobs);
+                }
 
-        if (!fr_map.active()) {
-            TLO_PRINT_USR_ERR("Unable to read file: \"%s\"\n",
-                              info_file.data());
-            return 1;  // NOLINT(*magic*)
-        }
+                // Sliced `perf script`s are started once the info events give
+                // us the time range.
+                if (!perf_file.ends_with(".data")) {
+                    fr_events.init(perf_file.data(), njobs);
+                }
+                else if (!sliced_perf_script) {
+                    tlo::preader_t::cmdline_t cmdline;
+                    if (!(dso_offsets
+                              ? tlo::perf::create_perf_events_offsets_cmdline(
+                                    perf_file, &cmdline)
+                              : tlo::perf::create_perf_events_cmdline(
+                                    perf_file, &cmdline))) {
+                        TLO_PRINT_USR_ERR("Perf filename too long!\n");
+                        return 1;  // NOLINT(*magic*)
+                    }
+                    fr_events.init(cmdline.begin());
+                }
 
-        // Collect all samples from the file.
-        // Set root path for DSOs.
-        tlo::sym::dso_t::set_dso_root_path(root_path);
+                if (!sliced_perf_script && !fr_events.active()) {
+                    TLO_PRINT_USR_ERR("Unable to read file: \"%s\"\n",
+                                      perf_file.data());
+                    return 1;  // NOLINT(*magic*)
+                }
+
+                if (!dso_offsets && !fr_map.active()) {
+                    TLO_PRINT_USR_ERR("Unable to read file: \"%s\"\n",
+                                      info_file.data());
+                    return 1;  // NOLINT(*magic*)
+                }
+            }
 
-        tlo::perf::perf_stats_t stats{ &ss };
-        bool res = tlo::perf::collect_perf_file_info(&fr_map, &stats);
-        if (!res || !stats.valid()) {
-            if (dump_stats) {
-                stats.dump();
+            // Collect all samples from the file.
+            bool res = dso_offsets ||
+                       (native_perf_data
+                            ? tlo::perf::collect_perf_file_info(&pdr, &stats)
+                            : tlo::perf::collect_perf_file_info(
+                                  &fr_map, &stats, &time_range));
+            if (!res || !stats.valid()) {
+                if (dump_stats) {
+                    stats.dump();
+                }
+                TLO_PRINT_USR_ERR(
+                    "Error collecting stats from perf file: \"%s\"\n",
+                    info_file.data());
+                return 1;  // NOLINT(*magic*)
             }
-            TLO_PRINT_USR_ERR("Error collecting stats from perf file: \"%s\"\n",
-                              info_file.data());
-            return 1;  // NOLINT(*magic*)
-        }
-        fr_map.cleanup();
+            fr_map.cleanup();
 
-        res = tlo::perf::collect_perf_file_events(&fr_events, &stats);
-        if (!res || !stats.valid()) {
-            if (dump_stats) {
-                stats.dump();
+            // Loading symbols is mostly I/O bound so do it all up front (in
+            // parallel) if we can use multiple threads.
+            stats.prefetch_dsos();
+            if (njobs != 1) {
+                stats.preload_dsos(njobs);
+            }
+
+            // The mappings were just rebuilt by the info pass, so all a
+            // checkpoint has to restore is the samples.
+            tlo::perf::perf_checkpoint_t checkpoint{
+                checkpoint_file.data(),
+                { sample_cache_key.data(), sample_cache_key.size() },
+                checkpoint_interval,
+                0
+            };
+            if (!checkpoint_file.empty() &&
+                tlo::perf::perf_sample_cache_t::load_checkpoint(
+                    checkpoint.path_, checkpoint.key_, &stats, njobs,
+                    &checkpoint.nbytes_done_)) {
+                TLO_printv("Resuming from checkpoint: %s (%lu bytes)\n",
+                           checkpoint.path_, checkpoint.nbytes_done_);
+            }
+
+            if (native_perf_data) {
+                res = tlo::perf::collect_perf_file_events(&pdr, &stats);
+            }
+            else if (sliced_perf_script) {
+                res = tlo::perf::collect_perf_data_events_sliced(
+                    perf_file, time_range, &stats, njobs);
+            }
+            else {
+                res = tlo::perf::collect_perf_file_events(
+                    &fr_events, &stats, njobs,
+                    checkpoint_file.empty() ? nullptr : &checkpoint);
+            }
+            if (!res || !stats.valid()) {
+                if (dump_stats) {
+                    stats.dump();
+                }
+                TLO_PRINT_USR_ERR(
+                    "Error collecting stats from perf file: \"%s\"\n",
+                    perf_file.data());
+                return 1;  // NOLINT(*magic*)
+            }
+            fr_events.cleanup();
+            pdr.cleanup();
+            if (!checkpoint_file.empty()) {
+                (void)unlink(checkpoint_file.data());
+            }
+
+            if (!sample_cache.empty() &&
+                !tlo::perf::perf_sample_cache_t::save(
+                    sample_cache.data(),
+                    { sample_cache_key.data(), sample_cache_key.size() },
+                    stats)) {
+                TLO_PRINT_USR_ERR("Warning: Unable to write sample cache: %s\n",
+                                  sample_cache.data());
             }
-            TLO_PRINT_USR_ERR("Error collecting stats from perf file: \"%s\"\n",
-                              perf_file.data());
-            return 1;  // NOLINT(*magic*)
         }
-        fr_events.cleanup();
 
         // Collect function / call stats.
         stats.filter_and_clump(tlo::perf::perf_stats_func_filter_t{},
@@ -529,9 +1026,10 @@ main(int argc, char ** argv) {
                                &funcs, &edges);
     }
     else {
-        if (!root_path.empty() || !info_file.empty() || !perf_file.empty()) {
+        if (!root_path.empty() || !info_file.empty() || !perf_file.empty() ||
+            profile_inputs != nullptr) {
             TLO_PRINT_USR_ERR(
-                "Warning: Ignoring root/perf/info arguments are only using saved-stats\n");
+                "Warning: Ignoring root/perf/info/profiles arguments are only using saved-stats\n");
         }
         std::span<char> stdin_buf{};
         if (std::strncmp(reload_infiles, "stdin", strlen("stdin")) == 0) {
@@ -604,7 +1102,7 @@ main(int argc, char ** argv) {
         const tlo::perf::perf_state_saver_t saver{ &ss };
         if (check_can_overwrite(overwrite, savefile.data(), "Save")) {
             if (!saver.save_state(savefile.data(), &funcs, &edges,
-                                  &scaling_todo)) {
+                                  &scaling_todo, save_fmt)) {
                 TLO_PRINT_USR_ERR("Error saving state to: \"%s\"\n",
                                   savefile.data());
                 no_outdir_ret = 1;
@@ -666,8 +1164,7 @@ main(int argc, char ** argv) {
         if (!output_dir.empty()) {
             // Order functions in the CFG.
             tlo::vec_t<tlo::cfg_func_order_info_t> ordered_funcs;
-            cg.order_nodes(tlo::cfg_t::order_algorithm::k_hfsort_c3,
-                           &ordered_funcs);
+            cg.order_nodes(order_algo, &ordered_funcs);
             // Write result out.
             if (!write_all(output_dir, ss.dsos(), ordered_funcs, overwrite)) {
                 TLO_PRINT_USR_ERR("No DSOs wrote out succesfully\n");
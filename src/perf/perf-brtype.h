@@ -0,0 +1,104 @@
+#ifndef SRC_D_PERF_D_PERF_BRTYPE_H_
+#define SRC_D_PERF_D_PERF_BRTYPE_H_
+
+#include "src/system/br-insn.h"
+
+#include <stdint.h>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+// Branch type as reported by perf (`perf record -j any,save_type`, shown by
+// perf script >= 5.15 after the cycles field and stored in bits 20-23 of
+// `perf_branch_entry::flags`).
+//
+// When present we use it to classify the edge instead of reading + decoding
+// the branch instruction from the dso. Types that don't map to a branch
+// instruction we track (or are missing) fall back to decoding.
+
+namespace tlo {
+namespace perf {
+
+// Values match the kernel's `PERF_BR_*`.
+enum perf_brtype_t : uint8_t {
+    k_perf_br_unknown   = 0,
+    k_perf_br_cond      = 1,
+    k_perf_br_uncond    = 2,
+    k_perf_br_ind       = 3,
+    k_perf_br_call      = 4,
+    k_perf_br_ind_call  = 5,
+    k_perf_br_ret       = 6,
+    k_perf_br_syscall   = 7,
+    k_perf_br_sysret    = 8,
+    k_perf_br_cond_call = 9,
+    k_perf_br_cond_ret  = 10,
+    k_perf_br_eret      = 11,
+    k_perf_br_irq       = 12,
+    k_perf_br_serror    = 13,
+    k_perf_br_no_tx     = 14,
+    k_perf_br_extend    = 15,
+    k_perf_br_max       = 16,
+};
+
+// Names as printed by perf script (see perf's `branch_type_name`). Anything
+// else (including the empty string perf prints for unknown) is unknown.
+static perf_brtype_t
+perf_brtype_from_str(std::string_view str) {
+    if (str.empty()) {
+        return k_perf_br_unknown;
+    }
+    // NOLINTBEGIN(hicpp-avoid-c-arrays,modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
+    static constexpr std::string_view k_names[k_perf_br_max] = {
+        "N/A",      "COND", "UNCOND",  "IND",    "CALL",
+        "IND_CALL", "RET",  "SYSCALL", "SYSRET", "COND_CALL",
+        "COND_RET", "ERET", "IRQ",     "SERROR", "NO_TX",
+        "EXTEND_ABI",
+    };
+    // NOLINTEND(hicpp-avoid-c-arrays,modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
+    for (uint8_t i = 0; i < k_perf_br_max; ++i) {
+        if (k_names[i] == str) {
+            return static_cast<perf_brtype_t>(i);
+        }
+    }
+    return k_perf_br_unknown;
+}
+
+// Representative branch instruction for `brtype`. Bad if we need to decode to
+// classify it.
+static system::br_insn_t
+perf_brtype_to_br_insn(uint8_t brtype) {
+    struct br_insn_tbl_t {
+        // NOLINTNEXTLINE(hicpp-avoid-c-arrays,modernize-avoid-c-arrays,cppcoreguidelines-avoid-c-arrays)
+        system::br_insn_t insns_[k_perf_br_max];
+
+        br_insn_tbl_t() {
+            for (system::br_insn_t & br_insn : insns_) {
+                br_insn = system::br_insn_t::make_bad();
+            }
+            // NOLINTBEGIN(*magic*)
+            insns_[k_perf_br_cond]      = system::br_insn_t::find_enc(0x0f84);
+            insns_[k_perf_br_uncond]    = system::br_insn_t::find_enc(0xe9);
+            insns_[k_perf_br_ind]       = system::br_insn_t::find_enc(0xffe0);
+            insns_[k_perf_br_call]      = system::br_insn_t::find_enc(0xe8);
+            insns_[k_perf_br_ind_call]  = system::br_insn_t::find_enc(0xffd0);
+            insns_[k_perf_br_ret]       = system::br_insn_t::find_enc(0xc3);
+            insns_[k_perf_br_syscall]   = system::br_insn_t::find_enc(0x0f05);
+            insns_[k_perf_br_sysret]    = system::br_insn_t::find_enc(0x0f07);
+            insns_[k_perf_br_cond_call] = system::br_insn_t::find_enc(0xe8);
+            insns_[k_perf_br_cond_ret]  = system::br_insn_t::find_enc(0xc3);
+            insns_[k_perf_br_eret]      = system::br_insn_t::find_enc(0xcf);
+            // `k_perf_br_irq` is an asynchronous interrupt, not an `int`, so
+            // the instruction at the source has nothing to do with it.
+            // NOLINTEND(*magic*)
+        }
+    };
+    static const br_insn_tbl_t k_tbl{};
+    if (brtype >= k_perf_br_max) {
+        return system::br_insn_t::make_bad();
+    }
+    return k_tbl.insns_[brtype];
+}
+
+}  // namespace perf
+}  // namespace tlo
+
+#endif
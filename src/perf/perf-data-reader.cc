@@ -0,0 +1,611 @@
+#include "src/perf/perf-data-reader.h"
+
+#include "src/util/compiler.h"
+#include "src/util/verbosity.h"
+
+#include <array>
+#include <string_view>
+
+#include <stdio.h>
+#include <string.h>
+
+
+namespace tlo {
+namespace perf {
+
+#define DECODE_ASSERT(cond)                                                    \
+ if (TLO_UNLIKELY(!(cond))) {                                                  \
+  TLO_perrv("Decode Error: %s:%d: %s\n", __FILE__, __LINE__,                   \
+            TLO_STRINGIFY(cond));                                              \
+  return k_parse_error;                                                        \
+ }
+
+
+bool
+perf_data_reader_t::is_perf_data(const char * path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    uint64_t     magic = 0;
+    const size_t res   = file_ops::ensure_read(
+        fd, reinterpret_cast<uint8_t *>(&magic), sizeof(magic));
+    close(fd);
+    return res == sizeof(magic) &&
+           (magic == perf_abi::k_magic || magic == perf_abi::k_magic_swapped);
+}
+
+void
+perf_data_reader_t::cleanup() {
+    if (file_.active()) {
+        file_ops::unmap_file(file_);
+        file_.deactivate();
+    }
+    attrs_.clear();
+    id_to_attr_.clear();
+    pid_maps_.clear();
+    kernel_maps_ = perf_pid_mappings_t{};
+    tid_comms_.clear();
+    names_.clear();
+    uniform_attrs_ = true;
+}
+
+bool
+perf_data_reader_t::init(const char * path) {
+    cleanup();
+    file_ = file_ops::map_file(path, file_ops::k_map_read, false);
+    if (!file_.active()) {
+        TLO_perr("Error: Unable to map perf.data file: %s\n", path);
+        return false;
+    }
+    if (!file_.inbounds(0, sizeof(hdr_))) {
+        TLO_perr("Error: %s is too small to be a perf.data file\n", path);
+        cleanup();
+        return false;
+    }
+    std::memcpy(&hdr_, file_.region(0, sizeof(hdr_)), sizeof(hdr_));
+    if (hdr_.magic_ == perf_abi::k_magic_swapped) {
+        TLO_perr(
+            "Error: %s was recorded on a machine with different endianness. Use --perf-script\n",
+            path);
+        cleanup();
+        return false;
+    }
+    if (hdr_.magic_ != perf_abi::k_magic) {
+        TLO_perr(
+            "Error: %s is not a perf.data file (or is in pipe mode). Use --perf-script\n",
+            path);
+        cleanup();
+        return false;
+    }
+    if (hdr_.size_ != sizeof(hdr_) ||
+        !file_.inbounds(hdr_.data_.offset_, hdr_.data_.size_) ||
+        !file_.inbounds(hdr_.attrs_.offset_, hdr_.attrs_.size_)) {
+        TLO_perr("Error: %s has a corrupt perf.data header\n", path);
+        cleanup();
+        return false;
+    }
+    if (!init_attrs()) {
+        TLO_perr("Error: %s has unsupported perf event attributes\n", path);
+        cleanup();
+        return false;
+    }
+
+    const std::span<const uint8_t> version =
+        feature_section(perf_abi::k_feat_version);
+    // perf_header_string: u32 len; char str[len];
+    if (version.size() > sizeof(uint32_t)) {
+        const char * vstr =
+            reinterpret_cast<const char *>(version.data() + sizeof(uint32_t));
+        TLO_printv("Decoding perf.data from perf version: %.*s\n",
+                   static_cast<int>(strnlen(vstr, version.size() -
+                                                      sizeof(uint32_t))),
+                   vstr);
+    }
+    return true;
+}
+
+bool
+perf_data_reader_t::init_attrs() {
+    // Each on-file attr is `perf_event_attr` followed by a `perf_file_section`
+    // pointing to the ids for the attr.
+    const size_t attr_size = hdr_.attr_size_;
+    if (attr_size < (perf_abi::k_attr_branch_sample_type_off +
+                     sizeof(uint64_t) + sizeof(perf_abi::file_section_t)) ||
+        hdr_.attrs_.size_ == 0 || (hdr_.attrs_.size_ % attr_size) != 0) {
+        return false;
+    }
+
+    const uint8_t * p = file_.region(hdr_.attrs_.offset_, hdr_.attrs_.size_);
+    const size_t    nattrs = hdr_.attrs_.size_ / attr_size;
+    for (size_t i = 0; i < nattrs; ++i, p += attr_size) {
+        perf_data_attr_t attr;
+        uint64_t         flags;
+        std::memcpy(&attr.sample_type_, p + perf_abi::k_attr_sample_type_off,
+                    sizeof(uint64_t));
+        std::memcpy(&attr.read_format_, p + perf_abi::k_attr_read_format_off,
+                    sizeof(uint64_t));
+        std::memcpy(&flags, p + perf_abi::k_attr_flags_off, sizeof(uint64_t));
+        std::memcpy(&attr.branch_sample_type_,
+                    p + perf_abi::k_attr_branch_sample_type_off,
+                    sizeof(uint64_t));
+        attr.sample_id_all_ = (flags & perf_abi::k_attr_sample_id_all) != 0;
+
+        perf_abi::file_section_t ids;
+        std::memcpy(&ids, p + attr_size - sizeof(ids), sizeof(ids));
+        if (!file_.inbounds(ids.offset_, ids.size_)) {
+            return false;
+        }
+        const uint8_t * id_p = file_.region(ids.offset_, ids.size_);
+        for (uint64_t j = 0; j < ids.size_ / sizeof(uint64_t); ++j) {
+            uint64_t id;
+            std::memcpy(&id, id_p + j * sizeof(uint64_t), sizeof(id));
+            id_to_attr_.emplace(id, static_cast<uint32_t>(attrs_.size()));
+        }
+
+        if (!attrs_.empty() && !attrs_.front().layout_eq(attr)) {
+            uniform_attrs_ = false;
+        }
+        attrs_.emplace_back(attr);
+    }
+
+    if (!uniform_attrs_) {
+        // If we have multiple layouts we need the IDENTIFIER field to tell
+        // which attr each record belongs to.
+        for (const perf_data_attr_t & attr : attrs_) {
+            if ((attr.sample_type_ & perf_abi::k_sample_identifier) == 0) {
+                TLO_perr(
+                    "Error: multiple events without PERF_SAMPLE_IDENTIFIER\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::span<const uint8_t>
+perf_data_reader_t::feature_section(uint32_t feat_id) const {
+    // The feature sections are stored after the data section, one per set
+    // bit in `adds_features` (in bit order).
+    constexpr uint32_t k_bits_per_word = 64;
+    if (feat_id >= perf_abi::k_feat_bits) {
+        return {};
+    }
+    const uint64_t word = hdr_.adds_features_[feat_id / k_bits_per_word];
+    if ((word & (1UL << (feat_id % k_bits_per_word))) == 0) {
+        return {};
+    }
+    size_t idx = 0;
+    for (uint32_t i = 0; i < feat_id / k_bits_per_word; ++i) {
+        idx += static_cast<size_t>(std::popcount(hdr_.adds_features_[i]));
+    }
+    idx += static_cast<size_t>(std::popcount(
+        word & ((1UL << (feat_id % k_bits_per_word)) - 1UL)));
+
+    perf_abi::file_section_t sec;
+    const uint64_t           sec_off = hdr_.data_.offset_ + hdr_.data_.size_ +
+                             idx * sizeof(perf_abi::file_section_t);
+    if (!file_.inbounds(sec_off, sizeof(sec))) {
+        return {};
+    }
+    std::memcpy(&sec, file_.region(sec_off, sizeof(sec)), sizeof(sec));
+    if (!file_.inbounds(sec.offset_, sec.size_)) {
+        return {};
+    }
+    return { file_.region(sec.offset_, sec.size_), sec.size_ };
+}
+
+bool
+perf_data_reader_t::sample_time(uint64_t * first_ns_out,
+                                uint64_t * last_ns_out) const {
+    // HEADER_SAMPLE_TIME: u64 first_sample_time; u64 last_sample_time;
+    const std::span<const uint8_t> times =
+        feature_section(perf_abi::k_feat_sample_time);
+    if (times.size() < 2 * sizeof(uint64_t)) {
+        return false;
+    }
+    std::memcpy(first_ns_out, times.data(), sizeof(uint64_t));
+    std::memcpy(last_ns_out, times.data() + sizeof(uint64_t), sizeof(uint64_t));
+    return *first_ns_out != 0 && *first_ns_out <= *last_ns_out;
+}
+
+const perf_data_attr_t *
+perf_data_reader_t::sample_attr(perf_data_record_t rec) const {
+    if (uniform_attrs_) {
+        return &(attrs_.front());
+    }
+    perf_data_cursor_t cursor = rec.body();
+    uint64_t           id;
+    if (!cursor.get(&id)) {
+        return nullptr;
+    }
+    auto res = id_to_attr_.find(id);
+    return res == id_to_attr_.end() ? nullptr : &(attrs_[res->second]);
+}
+
+const perf_data_attr_t *
+perf_data_reader_t::info_attr(perf_data_record_t rec) const {
+    if (uniform_attrs_) {
+        return &(attrs_.front());
+    }
+    // IDENTIFIER is always the last field in the sample_id trailer.
+    uint64_t id;
+    if (rec.size_ < sizeof(perf_abi::event_header_t) + sizeof(id)) {
+        return nullptr;
+    }
+    std::memcpy(&id, rec.base_ + rec.size_ - sizeof(id), sizeof(id));
+    auto res = id_to_attr_.find(id);
+    return res == id_to_attr_.end() ? nullptr : &(attrs_[res->second]);
+}
+
+bool
+perf_data_reader_t::decode_sample_id(perf_data_record_t rec,
+                                     sample_hdr_t *     hdr_out) const {
+    // sample_id trailer: { pid, tid }, time, id, stream_id, { cpu, res },
+    // identifier.
+    const perf_data_attr_t * attr = info_attr(rec);
+    *hdr_out                      = {};
+    if (attr == nullptr) {
+        return false;
+    }
+    const size_t id_size = attr->sample_id_size();
+    if (id_size == 0) {
+        return true;
+    }
+    if (rec.size_ < sizeof(perf_abi::event_header_t) + id_size) {
+        return false;
+    }
+    perf_data_cursor_t cursor = { rec.base_ + rec.size_ - id_size,
+                                  rec.base_ + rec.size_ };
+    if (attr->sample_type_ & perf_abi::k_sample_tid) {
+        if (!cursor.get(&(hdr_out->pid_)) || !cursor.get(&(hdr_out->tid_))) {
+            return false;
+        }
+    }
+    if (attr->sample_type_ & perf_abi::k_sample_time) {
+        uint64_t time;
+        if (!cursor.get(&time)) {
+            return false;
+        }
+        hdr_out->timestamp_ = time_to_ts(time);
+    }
+    return true;
+}
+
+bool
+perf_data_reader_t::decode_time(perf_data_record_t rec,
+                                sample_hdr_t *     hdr_out) const {
+    if (!decode_sample_id(rec, hdr_out)) {
+        return false;
+    }
+    // Without sample_id_all fork/exit still have there own time field:
+    // { pid, ppid, tid, ptid, time }
+    if (hdr_out->timestamp_ == 0 && (rec.type_ == perf_abi::k_record_fork ||
+                                     rec.type_ == perf_abi::k_record_exit)) {
+        perf_data_cursor_t cursor = rec.body();
+        uint64_t           time;
+        if (cursor.skip(4 * sizeof(uint32_t)) && cursor.get(&time)) {
+            hdr_out->timestamp_ = time_to_ts(time);
+        }
+    }
+    return true;
+}
+
+bool
+perf_data_reader_t::record_time(perf_data_record_t rec,
+                                uint64_t *         ts_out) const {
+    sample_hdr_t hdr;
+    if (!decode_time(rec, &hdr)) {
+        TLO_perr("Error: unable to find attr for record type %u\n", rec.type_);
+        return false;
+    }
+    *ts_out = hdr.timestamp_;
+    return true;
+}
+
+size_t
+perf_data_reader_t::decode_info(perf_data_record_t rec,
+                                info_sample_t *    sample_out) {
+    sample_out->reset();
+    DECODE_ASSERT(decode_time(rec, &(sample_out->hdr_)));
+
+    const perf_data_attr_t * attr = info_attr(rec);
+    DECODE_ASSERT(attr != nullptr);
+    perf_data_cursor_t cursor = rec.body();
+    // Don't let strings run into the sample_id trailer.
+    cursor.end_ -= attr->sample_id_size();
+    DECODE_ASSERT(cursor.cur_ <= cursor.end_);
+
+    // Strings are NUL padded to 8 bytes.
+    auto get_str = [](perf_data_cursor_t *        str_cursor,
+                      small_str_t<char const *> * str_out) -> bool {
+        const char * s = reinterpret_cast<const char *>(str_cursor->cur_);
+        size_t       slen = strnlen(s, str_cursor->remaining());
+        if (!small_str_t<char const *>::fits(slen)) {
+            return false;
+        }
+        // Match the text parser which doesn't include " (deleted)".
+        if (std::string_view{ s, slen }.ends_with(" (deleted)")) {
+            slen -= std::string_view{ " (deleted)" }.length();
+        }
+        *str_out = { s, static_cast<uint16_t>(slen) };
+        return slen != 0;
+    };
+
+    switch (rec.type_) {
+        case perf_abi::k_record_mmap:
+        case perf_abi::k_record_mmap2: {
+            // { pid, tid, addr, len, pgoff,
+            //   [mmap2: maj, min, ino, ino_generation (or build id), prot,
+            //    flags], filename }
+            sample_out->use_mmap();
+            sample_mmap_t * mmap = sample_out->get_mmap();
+            uint32_t        pid, tid, prot, flags;
+            DECODE_ASSERT(cursor.get(&pid));
+            DECODE_ASSERT(cursor.get(&tid));
+            DECODE_ASSERT(cursor.get(&(mmap->map_base_)));
+            DECODE_ASSERT(cursor.get(&(mmap->map_size_)));
+            DECODE_ASSERT(cursor.get(&(mmap->map_off_)));
+            if (rec.type_ == perf_abi::k_record_mmap2) {
+                // NOLINTNEXTLINE(*magic*)
+                DECODE_ASSERT(cursor.skip(24));
+                DECODE_ASSERT(cursor.get(&prot));
+                DECODE_ASSERT(cursor.get(&flags));
+            }
+            else {
+                // Old style mmap are executable unless marked data.
+                prot = perf_abi::k_prot_read;
+                if ((rec.misc_ & perf_abi::k_misc_mmap_data) == 0) {
+                    prot |= perf_abi::k_prot_exec;
+                }
+                flags = 0;
+            }
+            DECODE_ASSERT(get_str(&cursor, &(mmap->dso_)));
+            mmap->pid_    = pid;
+            mmap->tid_    = tid;
+            mmap->read_   = (prot & perf_abi::k_prot_read) != 0;
+            mmap->write_  = (prot & perf_abi::k_prot_write) != 0;
+            mmap->exec_   = (prot & perf_abi::k_prot_exec) != 0;
+            mmap->shared_ = (flags & perf_abi::k_map_shared) != 0;
+            mmap->priv_   = (flags & perf_abi::k_map_shared) == 0;
+            // perf names the kernel map "[kernel.kallsyms]_text" but uses
+            // "[kernel.kallsyms]" for the dso of samples.
+            if (is_kernel_mmap(*sample_out) &&
+                mmap->dso_.sview().starts_with(k_kernel_dso)) {
+                mmap->dso_ = { k_kernel_dso.data(),
+                               static_cast<uint16_t>(k_kernel_dso.length()) };
+            }
+            return k_parse_done;
+        }
+        case perf_abi::k_record_comm: {
+            // { pid, tid, comm }
+            sample_out->use_comm();
+            sample_comm_t * comm = sample_out->get_comm();
+            DECODE_ASSERT(cursor.get(&(comm->pid_)));
+            DECODE_ASSERT(cursor.get(&(comm->tid_)));
+            DECODE_ASSERT(get_str(&cursor, &(comm->comm_)));
+            comm->exec_ = (rec.misc_ & perf_abi::k_misc_comm_exec) != 0;
+            return k_parse_done;
+        }
+        case perf_abi::k_record_fork: {
+            // { pid, ppid, tid, ptid, time }
+            sample_out->use_fork();
+            sample_fork_t * fork = sample_out->get_fork();
+            DECODE_ASSERT(cursor.get(&(fork->cpid_)));
+            DECODE_ASSERT(cursor.get(&(fork->ppid_)));
+            DECODE_ASSERT(cursor.get(&(fork->ctid_)));
+            DECODE_ASSERT(cursor.get(&(fork->ptid_)));
+            return k_parse_done;
+        }
+        case perf_abi::k_record_exit:
+            // Mappings of dead processes stay valid for samples before the
+            // exit (and the text path ignores exit events as well).
+            return k_parse_incomplete;
+        default:
+            return k_parse_incomplete;
+    }
+}
+
+void
+perf_data_reader_t::track_info(const info_sample_t & sample) {
+    if (const sample_mmap_t * mmap = sample.get_mmap(); mmap != nullptr) {
+        if (is_kernel_mmap(sample)) {
+            kernel_maps_.add_sample(&names_, sample);
+            return;
+        }
+        if (!mmap->is_executable()) {
+            return;
+        }
+        pid_maps_[mmap->pid_].add_sample(&names_, sample);
+    }
+    else if (const sample_comm_t * comm = sample.get_comm(); comm != nullptr) {
+        tid_comms_[comm->tid_].push_back(
+            { sample.hdr_.timestamp_, comm->comm_ });
+    }
+    else if (const sample_fork_t * fork = sample.get_fork(); fork != nullptr) {
+        // Child thread inherits the parents comm.
+        const small_str_t<char const *> parent_comm =
+            lookup_comm(fork->ptid_, sample.hdr_.timestamp_);
+        tid_comms_[fork->ctid_].push_back(
+            { sample.hdr_.timestamp_, parent_comm });
+        if (fork->cpid_ != fork->ppid_) {
+            auto pres = pid_maps_.find(fork->ppid_);
+            if (pres != pid_maps_.end()) {
+                const perf_pid_mappings_t parent_maps = pres->second;
+                pid_maps_[fork->cpid_].merge(parent_maps);
+            }
+        }
+    }
+}
+
+void
+perf_data_reader_t::finalize_info() {
+    for (auto & kvp : pid_maps_) {
+        kvp.second.finalize();
+    }
+    for (auto & kvp : tid_comms_) {
+        std::stable_sort(kvp.second.begin(), kvp.second.end(), ts_cmp_t{});
+    }
+    kernel_maps_.finalize();
+}
+
+small_str_t<char const *>
+perf_data_reader_t::lookup_dso(uint32_t pid, uint64_t ts, uint64_t addr) const {
+    // Same mappings (and lookup) as `perf_mappings_t`, just not tied to a
+    // dso.
+    const perf_map_info_t * mapinfo = nullptr;
+    auto                    res     = pid_maps_.find(pid);
+    if (res != pid_maps_.end()) {
+        mapinfo = res->second.find(ts, addr);
+    }
+    if (mapinfo == nullptr) {
+        mapinfo = kernel_maps_.find(ts, addr);
+    }
+    if (mapinfo != nullptr) {
+        return mapinfo->dso_.buf_;
+    }
+    // NOLINTNEXTLINE(*magic*)
+    if (addr >> 63U) {
+        return { k_kernel_dso.data(),
+                 static_cast<uint16_t>(k_kernel_dso.length()) };
+    }
+    return { k_unknown_dso.data(),
+             static_cast<uint16_t>(k_unknown_dso.length()) };
+}
+
+small_str_t<char const *>
+perf_data_reader_t::lookup_comm(uint32_t tid, uint64_t ts) {
+    auto res = tid_comms_.find(tid);
+    if (res != tid_comms_.end() && !res->second.empty()) {
+        const vec_t<comm_t> & comms = res->second;
+        for (auto it = comms.end(); it != comms.begin();) {
+            --it;
+            if (it->ts_ <= ts) {
+                return it->comm_;
+            }
+        }
+        return comms.front().comm_;
+    }
+    // Same default perf uses for threads it has no comm for.
+    std::array<char, 32> buf;  // NOLINT(*magic*)
+    const int len = snprintf(buf.data(), buf.size(), ":%u", tid);
+    assert(len > 0 && static_cast<size_t>(len) < buf.size());
+    return names_.get(std::string_view{ buf.data(), static_cast<size_t>(len) })
+        .sbuf()
+        .buf_;
+}
+
+size_t
+perf_data_reader_t::decode_sample(perf_data_record_t rec,
+                                  lbr_sample_t *     sample_out) {
+    const perf_data_attr_t * attr = sample_attr(rec);
+    DECODE_ASSERT(attr != nullptr);
+    const uint64_t stype = attr->sample_type_;
+    DECODE_ASSERT(stype & perf_abi::k_sample_ip);
+    DECODE_ASSERT(stype & perf_abi::k_sample_tid);
+
+    perf_data_cursor_t cursor = rec.body();
+    uint64_t           ip = 0, time = 0, tmp;
+    uint32_t           pid = 0, tid = 0;
+
+    // Fields are in the order of the sample_type bits (with identifier
+    // first).
+    if (stype & perf_abi::k_sample_identifier) {
+        DECODE_ASSERT(cursor.get(&tmp));
+    }
+    DECODE_ASSERT(cursor.get(&ip));
+    DECODE_ASSERT(cursor.get(&pid));
+    DECODE_ASSERT(cursor.get(&tid));
+    if (stype & perf_abi::k_sample_time) {
+        DECODE_ASSERT(cursor.get(&time));
+    }
+    constexpr uint64_t k_u64_fields_before_read =
+        perf_abi::k_sample_addr | perf_abi::k_sample_id |
+        perf_abi::k_sample_stream_id | perf_abi::k_sample_cpu |
+        perf_abi::k_sample_period;
+    DECODE_ASSERT(cursor.skip(
+        sizeof(uint64_t) *
+        static_cast<size_t>(std::popcount(stype & k_u64_fields_before_read))));
+
+    if (stype & perf_abi::k_sample_read) {
+        const uint64_t rfmt       = attr->read_format_;
+        const size_t   nextra_hdr = static_cast<size_t>(std::popcount(
+            rfmt & (perf_abi::k_read_total_time_enabled |
+                    perf_abi::k_read_total_time_running)));
+        const size_t   nper_val   = 1U + static_cast<size_t>(std::popcount(
+                                      rfmt & (perf_abi::k_read_id |
+                                              perf_abi::k_read_lost)));
+        if (rfmt & perf_abi::k_read_group) {
+            uint64_t nr;
+            DECODE_ASSERT(cursor.get(&nr));
+            DECODE_ASSERT(nr < (cursor.remaining() / sizeof(uint64_t)));
+            DECODE_ASSERT(
+                cursor.skip(sizeof(uint64_t) * (nextra_hdr + nr * nper_val)));
+        }
+        else {
+            DECODE_ASSERT(
+                cursor.skip(sizeof(uint64_t) * (nextra_hdr + nper_val)));
+        }
+    }
+    if (stype & perf_abi::k_sample_callchain) {
+        uint64_t nr;
+        DECODE_ASSERT(cursor.get(&nr));
+        DECODE_ASSERT(nr <= (cursor.remaining() / sizeof(uint64_t)));
+        DECODE_ASSERT(cursor.skip(sizeof(uint64_t) * nr));
+    }
+    if (stype & perf_abi::k_sample_raw) {
+        uint32_t raw_size;
+        DECODE_ASSERT(cursor.get(&raw_size));
+        DECODE_ASSERT(cursor.skip(raw_size));
+    }
+
+    const uint64_t ts = time_to_ts(time);
+    sample_out->hdr_  = { pid, tid, ts, lookup_comm(tid, ts) };
+    sample_out->loc_  = { ip, {}, lookup_dso(pid, ts, ip) };
+    sample_out->num_samples_ = 0;
+
+    if ((stype & perf_abi::k_sample_branch_stack) == 0) {
+        return k_parse_incomplete;
+    }
+
+    uint64_t nr;
+    DECODE_ASSERT(cursor.get(&nr));
+    if (attr->branch_sample_type_ & perf_abi::k_branch_hw_index) {
+        DECODE_ASSERT(cursor.get(&tmp));
+    }
+    DECODE_ASSERT(nr <= (cursor.remaining() / sizeof(perf_abi::branch_entry_t)));
+    if (nr == 0) {
+        return k_parse_incomplete;
+    }
+    // Like the text parser we only keep the most recent `k_max_lbr_samples`
+    // and store them oldest first.
+    const uint32_t num_samples = static_cast<uint32_t>(
+        std::min(nr, static_cast<uint64_t>(lbr_sample_t::k_max_lbr_samples)));
+    for (uint32_t i = 0; i < num_samples; ++i) {
+        perf_abi::branch_entry_t entry;
+        DECODE_ASSERT(cursor.get(&entry));
+        lbr_br_sample_t * br = &(sample_out->samples_[num_samples - i - 1]);
+
+        br->from_ = { entry.from_, {}, lookup_dso(pid, ts, entry.from_) };
+        br->to_   = { entry.to_, {}, lookup_dso(pid, ts, entry.to_) };
+        br->cycles_ =
+            static_cast<uint32_t>((entry.flags_ >> perf_abi::k_branch_cycles_off) &
+                                  perf_abi::k_branch_cycles_msk);
+        br->predicted_ = (entry.flags_ & perf_abi::k_branch_mispred)
+                             ? lbr_br_sample_t::k_mispred
+                             : ((entry.flags_ & perf_abi::k_branch_predicted)
+                                    ? lbr_br_sample_t::k_pred
+                                    : lbr_br_sample_t::k_unknown);
+        br->in_tx_   = (entry.flags_ & perf_abi::k_branch_in_tx) != 0;
+        br->aborted_ = (entry.flags_ & perf_abi::k_branch_abort) != 0;
+        // Zero (unknown) unless recorded with `-j save_type`.
+        br->brtype_ = (entry.flags_ >> perf_abi::k_branch_type_off) &
+                      perf_abi::k_branch_type_msk;
+        br->br_insn_ = system::br_insn_t::make_bad();
+    }
+    sample_out->num_samples_ = num_samples;
+    return k_parse_done;
+}
+
+}  // namespace perf
+}  // namespace tlo
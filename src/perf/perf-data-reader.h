@@ -0,0 +1,475 @@
+#ifndef SRC_D_PERF_D_PERF_DATA_READER_H_
+#define SRC_D_PERF_D_PERF_DATA_READER_H_
+
+#include "src/perf/perf-mappings.h"
+#include "src/perf/perf-parse.h"
+#include "src/perf/perf-sample.h"
+
+#include "src/util/algo.h"
+#include "src/util/bits.h"
+#include "src/util/compiler.h"
+#include "src/util/file-ops.h"
+#include "src/util/strtab.h"
+#include "src/util/umap.h"
+#include "src/util/vec.h"
+#include "src/util/verbosity.h"
+
+#include <span>
+#include <string_view>
+
+#include <stdint.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Native reader for `perf.data` files. Decodes the binary records directly
+// instead of going through `perf script` + perf-parse.
+//
+// We produce the exact same `info_sample_t` / `lbr_sample_t` objects that
+// perf-parse produces (including the timestamp encoding and dso names) so
+// everything downstream (perf-stats, perf-mappings) is unchanged.
+//
+// Only the "file" format (magic PERFILE2, native endian) is supported. The
+// reader works in two passes (like the `perf script` path):
+//  1) `collect_info`: MMAP/MMAP2/FORK/COMM/EXIT records in time order. This
+//     also builds a small address space per pid so we can name the dso of
+//     each sample/branch address (which `perf script` does for us in the
+//     text path).
+//  2) `collect_samples`: PERF_RECORD_SAMPLE records (IP + BRANCH_STACK).
+
+
+namespace tlo {
+namespace perf {
+
+// Subset of the perf ABI (see linux/perf_event.h and tools/perf/util/header.h)
+// that we need.
+namespace perf_abi {
+static constexpr uint64_t k_magic = 0x32454c4946524550UL;  // "PERFILE2"
+static constexpr uint64_t k_magic_swapped = 0x50455246494c4532UL;
+
+// Record types.
+static constexpr uint32_t k_record_mmap        = 1;
+static constexpr uint32_t k_record_comm        = 3;
+static constexpr uint32_t k_record_exit        = 4;
+static constexpr uint32_t k_record_fork        = 7;
+static constexpr uint32_t k_record_sample      = 9;
+static constexpr uint32_t k_record_mmap2       = 10;
+static constexpr uint32_t k_record_auxtrace    = 71;
+static constexpr uint32_t k_record_compressed  = 81;
+static constexpr uint32_t k_record_compressed2 = 83;
+
+// Record misc bits.
+static constexpr uint16_t k_misc_comm_exec = 1U << 13U;
+static constexpr uint16_t k_misc_mmap_data = 1U << 13U;
+
+// perf_event_attr::sample_type bits.
+static constexpr uint64_t k_sample_ip           = 1UL << 0U;
+static constexpr uint64_t k_sample_tid          = 1UL << 1U;
+static constexpr uint64_t k_sample_time         = 1UL << 2U;
+static constexpr uint64_t k_sample_addr         = 1UL << 3U;
+static constexpr uint64_t k_sample_read         = 1UL << 4U;
+static constexpr uint64_t k_sample_callchain    = 1UL << 5U;
+static constexpr uint64_t k_sample_id           = 1UL << 6U;
+static constexpr uint64_t k_sample_cpu          = 1UL << 7U;
+static constexpr uint64_t k_sample_period       = 1UL << 8U;
+static constexpr uint64_t k_sample_stream_id    = 1UL << 9U;
+static constexpr uint64_t k_sample_raw          = 1UL << 10U;
+static constexpr uint64_t k_sample_branch_stack = 1UL << 11U;
+static constexpr uint64_t k_sample_identifier   = 1UL << 16U;
+
+// perf_event_attr::read_format bits.
+static constexpr uint64_t k_read_total_time_enabled = 1UL << 0U;
+static constexpr uint64_t k_read_total_time_running = 1UL << 1U;
+static constexpr uint64_t k_read_id                 = 1UL << 2U;
+static constexpr uint64_t k_read_group              = 1UL << 3U;
+static constexpr uint64_t k_read_lost               = 1UL << 4U;
+
+// perf_event_attr::branch_sample_type bits.
+static constexpr uint64_t k_branch_hw_index = 1UL << 17U;
+
+// perf_event_attr flag bits.
+static constexpr uint64_t k_attr_sample_id_all = 1UL << 18U;
+
+// perf_branch_entry::flags bits.
+static constexpr uint64_t k_branch_mispred    = 1UL << 0U;
+static constexpr uint64_t k_branch_predicted  = 1UL << 1U;
+static constexpr uint64_t k_branch_in_tx      = 1UL << 2U;
+static constexpr uint64_t k_branch_abort      = 1UL << 3U;
+static constexpr uint32_t k_branch_cycles_off = 4;
+static constexpr uint64_t k_branch_cycles_msk = 0xffff;
+static constexpr uint32_t k_branch_type_off   = 20;
+static constexpr uint64_t k_branch_type_msk   = 0xf;
+
+// Feature ids (bits in `perf_file_header::adds_features`).
+static constexpr uint32_t k_feat_version     = 5;
+static constexpr uint32_t k_feat_sample_time = 21;
+static constexpr uint32_t k_feat_bits        = 256;
+
+// Offsets of the fields we use in perf_event_attr.
+static constexpr size_t k_attr_sample_type_off    = 24;
+static constexpr size_t k_attr_read_format_off    = 32;
+static constexpr size_t k_attr_flags_off          = 40;
+static constexpr size_t k_attr_branch_sample_type_off = 72;
+
+// Prot bits in mmap2.
+static constexpr uint32_t k_prot_read  = 1;
+static constexpr uint32_t k_prot_write = 2;
+static constexpr uint32_t k_prot_exec  = 4;
+static constexpr uint32_t k_map_shared = 1;
+
+struct file_section_t {
+    uint64_t offset_;
+    uint64_t size_;
+};
+
+struct file_header_t {
+    uint64_t       magic_;
+    uint64_t       size_;
+    uint64_t       attr_size_;
+    file_section_t attrs_;
+    file_section_t data_;
+    file_section_t event_types_;
+    uint64_t       adds_features_[k_feat_bits / 64];  // NOLINT(*c-arrays)
+};
+static_assert(sizeof(file_header_t) == 104);
+
+struct event_header_t {
+    uint32_t type_;
+    uint16_t misc_;
+    uint16_t size_;
+};
+static_assert(sizeof(event_header_t) == 8);
+
+struct branch_entry_t {
+    uint64_t from_;
+    uint64_t to_;
+    uint64_t flags_;
+};
+static_assert(sizeof(branch_entry_t) == 24);
+
+}  // namespace perf_abi
+
+
+// Cursor over binary record. Analogous to `parse_state_t` for the text
+// parser. All loads are memcpy as the mapped file has no alignment
+// guarantees.
+struct perf_data_cursor_t {
+    const uint8_t * cur_;
+    const uint8_t * end_;
+
+    constexpr size_t
+    remaining() const {
+        return static_cast<size_t>(end_ - cur_);
+    }
+
+    template<typename T_t>
+    bool
+    get(T_t * out) {
+        if (remaining() < sizeof(T_t)) {
+            return false;
+        }
+        std::memcpy(out, cur_, sizeof(T_t));
+        cur_ += sizeof(T_t);
+        return true;
+    }
+
+    bool
+    skip(size_t nbytes) {
+        if (remaining() < nbytes) {
+            return false;
+        }
+        cur_ += nbytes;
+        return true;
+    }
+};
+
+// Single record in the data section.
+struct perf_data_record_t {
+    const uint8_t * base_;
+    uint32_t        type_;
+    uint16_t        misc_;
+    uint16_t        size_;
+
+    constexpr perf_data_cursor_t
+    body() const {
+        return { base_ + sizeof(perf_abi::event_header_t), base_ + size_ };
+    }
+};
+
+// The bits of `perf_event_attr` that determine the record layout.
+struct perf_data_attr_t {
+    uint64_t sample_type_;
+    uint64_t read_format_;
+    uint64_t branch_sample_type_;
+    bool     sample_id_all_;
+
+    // Size of the `sample_id` trailer on non-sample records.
+    constexpr size_t
+    sample_id_size() const {
+        if (!sample_id_all_) {
+            return 0;
+        }
+        return sizeof(uint64_t) *
+               static_cast<size_t>(std::popcount(
+                   sample_type_ &
+                   (perf_abi::k_sample_tid | perf_abi::k_sample_time |
+                    perf_abi::k_sample_id | perf_abi::k_sample_stream_id |
+                    perf_abi::k_sample_cpu | perf_abi::k_sample_identifier)));
+    }
+
+    constexpr bool
+    layout_eq(const perf_data_attr_t & other) const {
+        return sample_type_ == other.sample_type_ &&
+               read_format_ == other.read_format_ &&
+               branch_sample_type_ == other.branch_sample_type_ &&
+               sample_id_all_ == other.sample_id_all_;
+    }
+};
+
+
+struct perf_data_reader_t {
+    struct comm_t {
+        uint64_t                  ts_;
+        small_str_t<char const *> comm_;
+    };
+
+    struct ts_cmp_t {
+        template<typename T_t>
+        constexpr bool
+        operator()(const T_t & lhs, const T_t & rhs) const {
+            return lhs.ts_ < rhs.ts_;
+        }
+    };
+
+    file_ops::mapped_file_t   file_;
+    perf_abi::file_header_t   hdr_;
+    vec_t<perf_data_attr_t>   attrs_;
+    umap<uint64_t, uint32_t>  id_to_attr_;
+    bool                      uniform_attrs_;
+    // Executable mappings of each pid (only used to name dsos).
+    umap<uint32_t, perf_pid_mappings_t> pid_maps_;
+    perf_pid_mappings_t                 kernel_maps_;
+    umap<uint32_t, vec_t<comm_t>>       tid_comms_;
+    // Backing storage for the mapped dso names and names we need to make up
+    // (i.e ":<tid>" comms).
+    strtab_t<> names_;
+
+    static constexpr std::string_view k_unknown_dso = "[unknown]";
+    static constexpr std::string_view k_kernel_dso  = "[kernel.kallsyms]";
+
+    perf_data_reader_t()
+        : file_(file_ops::mapped_file_t::inactive()),
+          hdr_({}),
+          uniform_attrs_(true) {}
+    perf_data_reader_t(const perf_data_reader_t &) = delete;
+    perf_data_reader_t(perf_data_reader_t &&)      = delete;
+    ~perf_data_reader_t() {
+        cleanup();
+    }
+
+    // Check if `path` looks like a perf.data file we can decode.
+    static bool is_perf_data(const char * path);
+
+    // Map and validate the file. Returns false (with an error printed) if we
+    // don't support the file.
+    bool init(const char * path);
+    void cleanup();
+
+    bool
+    active() const {
+        return file_.active();
+    }
+
+    size_t
+    nbytes_total() const {
+        return hdr_.data_.size_;
+    }
+
+    // Get raw feature section (empty if not present).
+    std::span<const uint8_t> feature_section(uint32_t feat_id) const;
+
+    // Time (in ns) of the first/last sample if the file records it. Returns
+    // false otherwise.
+    bool sample_time(uint64_t * first_ns_out, uint64_t * last_ns_out) const;
+
+    // Decode an info record. Returns k_parse_done if the record was an
+    // mmap/fork/comm, k_parse_incomplete if it was something we don't care
+    // about, and k_parse_error if it was malformed.
+    size_t decode_info(perf_data_record_t rec, info_sample_t * sample_out);
+
+    // Decode a sample record. Must be called after all info records have been
+    // tracked (`track_info` + `finalize_info`). Returns k_parse_done for an
+    // LBR sample, k_parse_incomplete for a simple sample (no branch stack),
+    // and k_parse_error if we can't decode it. `k_parse_incomplete` is only
+    // returned for samples we can use as simple samples.
+    size_t decode_sample(perf_data_record_t rec, lbr_sample_t * sample_out);
+
+    // Update the address-space/comm tables we use to name samples.
+    void track_info(const info_sample_t & sample);
+    void finalize_info();
+
+    // Iterate the raw records in the data section. `fn` is called with each
+    // record and the number of bytes into the data section that have been
+    // processed. Stops if `fn` returns false.
+    template<typename T_func_t>
+    bool
+    for_each_record(T_func_t && fn) const {
+        const uint64_t data_off = hdr_.data_.offset_;
+        const uint64_t data_end = data_off + hdr_.data_.size_;
+        for (uint64_t off = data_off; off < data_end;) {
+            perf_abi::event_header_t ehdr;
+            if ((data_end - off) < sizeof(ehdr)) {
+                TLO_perr("Error: truncated record header at %lu\n", off);
+                return false;
+            }
+            std::memcpy(&ehdr, file_.region(off, sizeof(ehdr)), sizeof(ehdr));
+            if (ehdr.size_ < sizeof(ehdr) || ehdr.size_ > (data_end - off)) {
+                TLO_perr("Error: bad record size (%u) at %lu\n", ehdr.size_,
+                         off);
+                return false;
+            }
+            if (ehdr.type_ == perf_abi::k_record_compressed ||
+                ehdr.type_ == perf_abi::k_record_compressed2) {
+                TLO_perr(
+                    "Error: perf.data has compressed records (perf record -z) which are not supported natively. Use --perf-script\n");
+                return false;
+            }
+            const perf_data_record_t rec = { file_.region(off, ehdr.size_),
+                                             ehdr.type_, ehdr.misc_,
+                                             ehdr.size_ };
+            off += ehdr.size_;
+            if (ehdr.type_ == perf_abi::k_record_auxtrace) {
+                // The aux data follows the record (and isn't included in the
+                // header size).
+                perf_data_cursor_t cursor = rec.body();
+                uint64_t           aux_size;
+                if (!cursor.get(&aux_size) || aux_size > (data_end - off)) {
+                    TLO_perr("Error: bad auxtrace record at %lu\n", off);
+                    return false;
+                }
+                off += aux_size;
+            }
+            if (!fn(rec, off - data_off)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Pass 1. Decode all info records in time order (perf.data is only
+    // ordered per-cpu), track them, then finalize. `fn` is called with each
+    // decoded `info_sample_t` and the progress in bytes.
+    template<typename T_func_t>
+    bool
+    collect_info(T_func_t && fn) {
+        struct todo_t {
+            uint64_t ts_;
+            uint64_t off_;
+        };
+        vec_t<todo_t> todo{};
+        bool          ok = for_each_record(
+            [this, &todo](perf_data_record_t rec, size_t) -> bool {
+                uint64_t ts;
+                if (!is_info_record(rec.type_)) {
+                    return true;
+                }
+                if (!record_time(rec, &ts)) {
+                    return false;
+                }
+                todo.push_back(
+                    { ts, static_cast<uint64_t>(rec.base_ - file_.region(0, 0)) });
+                return true;
+            });
+        if (!ok) {
+            return false;
+        }
+        std::stable_sort(todo.begin(), todo.end(), ts_cmp_t{});
+        for (const todo_t & item : todo) {
+            perf_abi::event_header_t ehdr;
+            std::memcpy(&ehdr, file_.region(item.off_, sizeof(ehdr)),
+                        sizeof(ehdr));
+            info_sample_t sample;  // NOLINT
+            size_t        res = decode_info(
+                { file_.region(item.off_, ehdr.size_), ehdr.type_, ehdr.misc_,
+                  ehdr.size_ },
+                &sample);
+            if (res == k_parse_error) {
+                return false;
+            }
+            if (res == k_parse_done) {
+                track_info(sample);
+                // The text path never sees kernel mappings (they are
+                // PERF_RECORD_MMAP with pid -1) so only use them for naming.
+                if (!is_kernel_mmap(sample)) {
+                    fn(sample, item.off_ - hdr_.data_.offset_);
+                }
+            }
+        }
+        finalize_info();
+        return true;
+    }
+
+    // Pass 2. Decode all samples. `fn` is called with the decoded sample, if
+    // it has branch info (or just a simple sample), and the progress in
+    // bytes.
+    template<typename T_func_t>
+    bool
+    collect_samples(T_func_t && fn) {
+        return for_each_record(
+            [this, &fn](perf_data_record_t rec, size_t progress) -> bool {
+                if (rec.type_ != perf_abi::k_record_sample) {
+                    return true;
+                }
+                lbr_sample_t sample;  // NOLINT
+                const size_t res = decode_sample(rec, &sample);
+                if (res == k_parse_error) {
+                    return false;
+                }
+                fn(&sample, res == k_parse_done, progress);
+                return true;
+            });
+    }
+
+    static constexpr bool
+    is_info_record(uint32_t type) {
+        return type == perf_abi::k_record_mmap ||
+               type == perf_abi::k_record_mmap2 ||
+               type == perf_abi::k_record_comm ||
+               type == perf_abi::k_record_fork ||
+               type == perf_abi::k_record_exit;
+    }
+
+    static bool
+    is_kernel_mmap(const info_sample_t & sample) {
+        const sample_mmap_t * mmap = sample.get_mmap();
+        return mmap != nullptr && mmap->pid_ == static_cast<uint32_t>(-1);
+    }
+
+    // perf.data timestamps are in ns. `perf script` prints them as
+    // `<sec>.<usec>` which the text parser turns into `(sec << 32) + usec`.
+    // Use the same encoding so the two paths are interchangeable.
+    static constexpr uint64_t
+    time_to_ts(uint64_t time_ns) {
+        constexpr uint64_t k_ns_per_sec  = 1000UL * 1000UL * 1000UL;
+        constexpr uint64_t k_ns_per_usec = 1000UL;
+        return ((time_ns / k_ns_per_sec) << 32U) +
+               (time_ns % k_ns_per_sec) / k_ns_per_usec;
+    }
+
+    // Internal helpers.
+    const perf_data_attr_t * sample_attr(perf_data_record_t rec) const;
+    const perf_data_attr_t * info_attr(perf_data_record_t rec) const;
+    bool record_time(perf_data_record_t rec, uint64_t * ts_out) const;
+    bool decode_sample_id(perf_data_record_t rec, sample_hdr_t * hdr_out) const;
+    bool decode_time(perf_data_record_t rec, sample_hdr_t * hdr_out) const;
+    small_str_t<char const *> lookup_dso(uint32_t pid,
+                                         uint64_t ts,
+                                         uint64_t addr) const;
+    small_str_t<char const *> lookup_comm(uint32_t tid, uint64_t ts);
+    bool                      init_attrs();
+};
+
+}  // namespace perf
+}  // namespace tlo
+
+
+#endif
@@ -1,15 +1,29 @@
 #include "src/perf/perf-file.h"
 #include "src/perf/perf-parse.h"
+#include "src/perf/perf-sample-cache.h"
+#include "src/perf/perf-sym-lookup.h"
+
+#include "src/util/global-stats.h"
+#include "src/util/vec.h"
+#include "src/util/work-queue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <time.h>
 
 
 namespace tlo {
 namespace perf {
 
 static size_t
-handle_maybe_err(size_t res, size_t err_cnt, const char * line) {
+handle_maybe_err(size_t res, size_t err_cnt, std::string_view line) {
     if (TLO_UNLIKELY(res == k_parse_error)) {
         if (tlo::has_verbosity(2)) {
-            TLO_perr("Warning: Bad Line ->\n\"%s\"\n", line);
+            TLO_perr("Warning: Bad Line ->\n\"%.*s\"\n",
+                     static_cast<int>(line.length()), line.data());
         }
         else {
             TLO_perr("\rWarning: Bad Line(%zu)", ++err_cnt);
@@ -18,24 +32,20 @@ handle_maybe_err(size_t res, size_t err_cnt, const char * line) {
     return err_cnt;
 }
 
-bool
-collect_perf_file_info(file_reader_t * fr_map, perf_stats_t * pstats) {
-    bool             ret = false;
-    std::string_view buf;
-    progress_bar_t   progress(fr_map->nbytes_total(), 0, "Info Events Parsed");
-    size_t           err_cnt = 0;
-    for (;;) {
-        // Parse each line in the file (until empty).
-        buf = fr_map->nextline();
-        progress.update_progress(fr_map->nbytes_read());
-        if (buf.empty()) {
-            pstats->finalize_mappings();
-            return ret;
-        }
+static bool
+collect_info_lines(const line_batch_t & batch,
+                   perf_stats_t *       pstats,
+                   perf_time_range_t *  range,
+                   size_t *             err_cnt) {
+    bool ret = false;
+    for (const std::string_view buf : batch.lines_) {
         info_sample_t sample;  // NOLINT
         const size_t  res = parse_info_line(buf, &sample);
         if (res == k_parse_done) {
             assert(sample.active());
+            if (range != nullptr) {
+                range->add(sample.hdr_.timestamp_);
+            }
             if (sample.is_mmap()) {
                 ret |= pstats->collect_mmap_sample(sample);
             }
@@ -45,41 +55,1019 @@ collect_perf_file_info(file_reader_t * fr_map, perf_stats_t * pstats) {
                 ret |= pstats->collect_fork_sample(sample);
             }
         }
-        err_cnt = handle_maybe_err(res, err_cnt, buf.data());
+        *err_cnt = handle_maybe_err(res, *err_cnt, buf);
     }
+    return ret;
+}
+
+bool
+collect_perf_file_info(file_reader_t *     fr_map,
+                       perf_stats_t *      pstats,
+                       perf_time_range_t * range) {
+    bool           ret = false;
+    line_batch_t   batch{};
+    progress_bar_t progress(fr_map->nbytes_total(), 0, "Info Events Parsed");
+    size_t         err_cnt = 0;
+    // Parse each line in the file (until empty).
+    while (fr_map->nextlines(&batch)) {
+        progress.update_progress(fr_map->nbytes_read());
+        ret |= collect_info_lines(batch, pstats, range, &err_cnt);
+    }
+    pstats->finalize_mappings();
+    return ret;
+}
+
+// Parse a line of `perf script` output into `sample`. `*is_lbr` is set if it
+// was an LBR sample (otherwise it was a simple sample). With `dso_offsets` the
+// line is `brstackoff` output (always LBR). The LBR entries are parsed with
+// `lbr_parser` (which must be used for all lines of the file).
+static size_t
+parse_event_line(std::string_view    buf,
+                 bool                dso_offsets,
+                 lbr_line_parser_t * lbr_parser,
+                 lbr_sample_t *      sample,
+                 bool *              is_lbr) {
+    if (dso_offsets) {
+        *is_lbr = true;
+        return lbr_parser->parse_lbr_offsets_line(buf, sample);
+    }
+    size_t res = parse_sample_line(buf, sample);
+    *is_lbr    = false;
+    // If return is k_parse_done this was a simple sample.
+    if (res != k_parse_done && res != k_parse_error) {
+        // Otherwise it was an LBR sample.
+        res     = lbr_parser->parse_lbr_line(buf, res, sample);
+        *is_lbr = true;
+    }
+    return res;
+}
+
+// Parse a line of `perf script` output and hand the sample to
+// `collect(sample, is_lbr)`.
+template<typename T_collect_t>
+static size_t
+parse_and_collect_event_line(std::string_view    buf,
+                             bool                dso_offsets,
+                             lbr_line_parser_t * lbr_parser,
+                             bool *              ret,
+                             T_collect_t         collect) {
+    // NOTE: We MUST consume the sample before starting the next line.
+    // Some of what the sample stores are just pointers to locations in
+    // the parsed line (strings for sym/dso).
+    lbr_sample_t sample;  // NOLINT
+    bool         is_lbr;
+    const size_t res =
+        parse_event_line(buf, dso_offsets, lbr_parser, &sample, &is_lbr);
+    if (res == k_parse_done) {
+        *ret |= collect(&sample, is_lbr);
+    }
+    return res;
+}
+
+// Bytes of the events file to skip before collecting. Seeks past them if the
+// reader can, otherwise they are skipped by `skip_collected_lines`.
+static uint64_t
+resume_from_checkpoint(file_reader_t *           fr_events,
+                       const perf_checkpoint_t * checkpoint) {
+    if (checkpoint == nullptr || checkpoint->nbytes_done_ == 0 ||
+        fr_events->seek(checkpoint->nbytes_done_)) {
+        return 0;
+    }
+    return checkpoint->nbytes_done_;
+}
+
+// Number of lines at the start of `batch` that were already collected before
+// resuming from a checkpoint. `*nskip` is what is left of their bytes.
+static size_t
+skip_collected_lines(const line_batch_t & batch, uint64_t * nskip) {
+    size_t n = 0;
+    for (; n < batch.lines_.size() && *nskip != 0; ++n) {
+        assert(batch.lines_[n].length() <= *nskip);
+        *nskip -= batch.lines_[n].length();
+    }
+    return n;
+}
+
+// Writes `checkpoint` (if there is one) as lines are collected. Only used by
+// the thread collecting into `pstats`.
+struct perf_checkpointer_t {
+    static constexpr uint64_t k_sec_to_ns = 1000UL * 1000UL * 1000UL;
+
+    const perf_checkpoint_t * checkpoint_;
+    // Including the bytes collected before resuming.
+    uint64_t nbytes_;
+    uint64_t next_ns_;
+
+    explicit perf_checkpointer_t(const perf_checkpoint_t * checkpoint)
+        : checkpoint_(checkpoint),
+          nbytes_(checkpoint == nullptr ? 0 : checkpoint->nbytes_done_),
+          next_ns_(0) {
+        schedule();
+    }
+
+    static uint64_t
+    now_ns() {
+        TLO_DISABLE_WREDUNDANT_TAGS
+        struct timespec ts;
+        TLO_REENABLE_WREDUNDANT_TAGS
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+            return 0;
+        }
+        return static_cast<uint64_t>(ts.tv_sec) * k_sec_to_ns +
+               static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    void
+    schedule() {
+        if (checkpoint_ != nullptr) {
+            next_ns_ = now_ns() + checkpoint_->interval_sec_ * k_sec_to_ns;
+        }
+    }
+
+    bool
+    due() const {
+        return checkpoint_ != nullptr && now_ns() >= next_ns_;
+    }
+
+    // Another `nbytes` bytes of lines have been collected into `pstats`.
+    // Returns true if flushing the preaggregated samples collected any.
+    bool
+    collected(perf_stats_t * pstats, size_t nbytes) {
+        if (checkpoint_ == nullptr) {
+            return false;
+        }
+        nbytes_ += nbytes;
+        if (!due()) {
+            return false;
+        }
+        const bool ret = pstats->flush_preagr();
+        if (!perf_sample_cache_t::save_checkpoint(
+                checkpoint_->path_, checkpoint_->key_, *pstats, nbytes_)) {
+            TLO_perr("\nWarning: Unable to write checkpoint: %s\n",
+                     checkpoint_->path_);
+        }
+        schedule();
+        return ret;
+    }
+};
+
+static bool
+collect_perf_file_events_serial(file_reader_t *           fr_events,
+                                perf_stats_t *            pstats,
+                                const perf_checkpoint_t * checkpoint) {
+    bool                ret = false;
+    line_batch_t        batch{};
+    progress_bar_t      progress(fr_events->nbytes_total(), 0,
+                                 "Perf Events Parsed");
+    size_t              err_cnt = 0;
+    lbr_line_parser_t   lbr_parser{};
+    perf_checkpointer_t checkpointer(checkpoint);
+    uint64_t            nskip = resume_from_checkpoint(fr_events, checkpoint);
+    // Parse each line in the file (until empty).
+    while (fr_events->nextlines(&batch)) {
+        progress.update_progress(fr_events->nbytes_read());
+        const size_t first  = skip_collected_lines(batch, &nskip);
+        size_t       nbytes = 0;
+        for (size_t i = first; i < batch.lines_.size(); ++i) {
+            const std::string_view buf = batch.lines_[i];
+            nbytes += buf.length();
+            const size_t           res = parse_and_collect_event_line(
+                buf, pstats->mappings_.dso_offsets_, &lbr_parser, &ret,
+                [pstats](lbr_sample_t * sample, bool is_lbr) {
+                    return is_lbr ? pstats->collect_lbr_sample_stats(sample)
+                                  : pstats->collect_simple_sample_stats(sample);
+                });
+            err_cnt = handle_maybe_err(res, err_cnt, buf);
+        }
+        ret |= checkpointer.collected(pstats, nbytes);
+    }
+    ret |= pstats->flush_preagr();
+    return ret;
 }
 
 bool
 collect_perf_file_events(file_reader_t * fr_events, perf_stats_t * pstats) {
-    bool             ret = false;
-    std::string_view buf;
+    return collect_perf_file_events_serial(fr_events, pstats, nullptr);
+}
+
+// Batch of whole lines from the events file. Lines that stay valid for the
+// whole parse (see `line_batch_t::stable_`) are referenced directly, anything
+// else is copied.
+struct perf_lines_chunk_t {
+    static constexpr size_t k_target_bytes = 1024 * 1024;
+
+    vec_t<std::string_view> lines_;
+    vec_t<char>             buf_;
+    vec_t<size_t>           ends_;
+    size_t                  nbytes_;
+
+    bool
+    full() const {
+        return nbytes_ >= k_target_bytes;
+    }
+
+    // Add the lines of `batch` after its first `first`.
+    void
+    add(const line_batch_t & batch, size_t first = 0) {
+        for (size_t i = first; i < batch.lines_.size(); ++i) {
+            const std::string_view line = batch.lines_[i];
+            if (batch.stable_) {
+                lines_.emplace_back(line);
+            }
+            else {
+                buf_.insert(buf_.end(), line.begin(), line.end());
+                ends_.emplace_back(buf_.size());
+            }
+            nbytes_ += line.length();
+        }
+    }
+
+    void
+    clear() {
+        lines_.clear();
+        buf_.clear();
+        ends_.clear();
+        nbytes_ = 0;
+    }
+
+    template<typename T_fn_t>
+    void
+    for_each_line(T_fn_t fn) const {
+        for (const std::string_view line : lines_) {
+            fn(line);
+        }
+        size_t begin = 0;
+        for (const size_t end : ends_) {
+            fn(std::string_view{ buf_.data() + begin, end - begin });
+            begin = end;
+        }
+    }
+};
+
+using perf_lines_queue_t = work_queue_t<perf_lines_chunk_t *>;
+
+// Samples parsed from a chunk of lines. The samples point into the lines
+// (comm/dso names) so the chunk is passed along with them.
+struct perf_samples_batch_t {
+    perf_lines_chunk_t * chunk_;
+    vec_t<lbr_sample_t>  samples_;
+    vec_t<uint8_t>       is_lbr_;
+    size_t               nsamples_;
+
+    // Slot for the next sample. Only kept if `commit` is called. Samples are
+    // big so the slots are reused rather than reinitialized for each batch.
+    lbr_sample_t *
+    next_sample() {
+        if (nsamples_ == samples_.size()) {
+            samples_.emplace_back();
+            is_lbr_.emplace_back(0);
+        }
+        return &samples_[nsamples_];
+    }
+
+    void
+    commit(bool is_lbr) {
+        is_lbr_[nsamples_++] = is_lbr;
+    }
+
+    void
+    clear() {
+        chunk_    = nullptr;
+        nsamples_ = 0;
+    }
+};
+
+using perf_samples_queue_t = work_queue_t<perf_samples_batch_t *>;
+
+// Everything a worker thread collects. Merged back on the main thread once the
+// worker is done.
+struct perf_events_worker_t {
+    perf_stats_shard_t       shard_;
+    perf_shared_sym_lookup_t lookup_;
+    lbr_line_parser_t        lbr_parser_;
+    total_stats_t            stats_;
+    size_t                   err_cnt_;
+    bool                     ret_;
+
+    perf_events_worker_t(sym::sym_state_t * state,
+                         std::mutex *       sym_mtx,
+                         perf_agr_key_t     agr_key,
+                         bool               preaggregate)
+        : shard_(agr_key, preaggregate),
+          lookup_(state, sym_mtx),
+          err_cnt_(0),
+          ret_(false) {}
+
+    void
+    collect_line(std::string_view buf, const perf_mappings_t * mappings) {
+        const size_t res = parse_and_collect_event_line(
+            buf, mappings->dso_offsets_, &lbr_parser_, &ret_,
+            [this, mappings](lbr_sample_t * sample, bool is_lbr) {
+                return is_lbr ? shard_.collect_lbr_sample_stats(
+                                    &lookup_, mappings, sample)
+                              : shard_.collect_simple_sample_stats(
+                                    &lookup_, mappings, sample);
+            });
+        err_cnt_ = handle_maybe_err(res, err_cnt_, buf);
+    }
+
+    void
+    finish(const perf_mappings_t * mappings) {
+        ret_ |= shard_.flush_preagr(&lookup_, mappings);
+        lookup_.flush();
+        stats_ = G_total_stats;
+    }
+
+    // Move what has been collected so far into `pstats` (for a checkpoint).
+    // Only while the worker is waiting for lines.
+    void
+    drain(perf_stats_t * pstats) {
+        ret_ |= shard_.flush_preagr(&lookup_, &(pstats->mappings_));
+        lookup_.flush();
+        pstats->merge(shard_);
+        shard_.clear();
+    }
+
+    void
+    run(perf_lines_queue_t *     full_chunks,
+        perf_lines_queue_t *     free_chunks,
+        const perf_mappings_t * mappings) {
+        perf_lines_chunk_t * chunk = nullptr;
+        while (full_chunks->pop(&chunk)) {
+            chunk->for_each_line([this, mappings](std::string_view buf) {
+                collect_line(buf, mappings);
+            });
+            chunk->clear();
+            free_chunks->push(chunk);
+        }
+        finish(mappings);
+    }
+
+    // Read the lines directly (this worker has its own reader).
+    void
+    run(file_reader_t * fr_events, const perf_mappings_t * mappings) {
+        line_batch_t batch{};
+        while (fr_events->nextlines(&batch)) {
+            for (const std::string_view buf : batch.lines_) {
+                collect_line(buf, mappings);
+            }
+        }
+        finish(mappings);
+    }
+};
+
+// Reading (and decompressing / `perf script`), parsing, and collecting each
+// get their own thread, connected by bounded queues. Collecting stays on this
+// thread so `pstats` is used exactly as in the serial version.
+static bool
+collect_perf_file_events_pipelined(file_reader_t *           fr_events,
+                                   perf_stats_t *            pstats,
+                                   const perf_checkpoint_t * checkpoint) {
+    // Batches in flight between the parser and collector. Each holds a chunk,
+    // so there are a few more chunks for the reader / parser to work on.
+    static constexpr size_t k_nbatches = 3;
+    static constexpr size_t k_nchunks  = k_nbatches + 3;
+
+    vec_t<perf_lines_chunk_t>   chunks(k_nchunks);
+    vec_t<perf_samples_batch_t> batches(k_nbatches);
+    perf_lines_queue_t          full_chunks(k_nchunks);
+    perf_lines_queue_t          free_chunks(k_nchunks);
+    perf_samples_queue_t        full_batches(k_nbatches);
+    perf_samples_queue_t        free_batches(k_nbatches);
+    for (perf_lines_chunk_t & chunk : chunks) {
+        free_chunks.push(&chunk);
+    }
+    for (perf_samples_batch_t & batch : batches) {
+        free_batches.push(&batch);
+    }
+
+    std::thread reader([fr_events, &full_chunks, &free_chunks, checkpoint]() {
+        line_batch_t         batch{};
+        perf_lines_chunk_t * chunk = nullptr;
+        progress_bar_t progress(fr_events->nbytes_total(), 0,
+                                "Perf Events Parsed");
+        uint64_t nskip = resume_from_checkpoint(fr_events, checkpoint);
+        while (fr_events->nextlines(&batch)) {
+            progress.update_progress(fr_events->nbytes_read());
+            if (chunk == nullptr && !free_chunks.pop(&chunk)) {
+                break;
+            }
+            chunk->add(batch, skip_collected_lines(batch, &nskip));
+            if (chunk->full()) {
+                full_chunks.push(chunk);
+                chunk = nullptr;
+            }
+        }
+        if (chunk != nullptr) {
+            full_chunks.push(chunk);
+        }
+        full_chunks.close();
+    });
+
+    const bool  dso_offsets = pstats->mappings_.dso_offsets_;
+    std::thread parser([&full_chunks, &full_batches, &free_batches,
+                        dso_offsets]() {
+        perf_lines_chunk_t *   chunk   = nullptr;
+        perf_samples_batch_t * batch   = nullptr;
+        size_t                 err_cnt = 0;
+        lbr_line_parser_t      lbr_parser{};
+        while (full_chunks.pop(&chunk)) {
+            if (!free_batches.pop(&batch)) {
+                break;
+            }
+            batch->clear();
+            batch->chunk_ = chunk;
+            chunk->for_each_line([batch, &err_cnt, &lbr_parser,
+                                  dso_offsets](std::string_view buf) {
+                bool         is_lbr;
+                const size_t res =
+                    parse_event_line(buf, dso_offsets, &lbr_parser,
+                                     batch->next_sample(), &is_lbr);
+                if (res == k_parse_done) {
+                    batch->commit(is_lbr);
+                }
+                err_cnt = handle_maybe_err(res, err_cnt, buf);
+            });
+            full_batches.push(batch);
+        }
+        full_batches.close();
+    });
+
+    bool                   ret   = false;
+    perf_samples_batch_t * batch = nullptr;
+    perf_checkpointer_t    checkpointer(checkpoint);
+    while (full_batches.pop(&batch)) {
+        for (size_t i = 0; i < batch->nsamples_; ++i) {
+            lbr_sample_t * sample = &(batch->samples_[i]);
+            ret |= batch->is_lbr_[i] != 0
+                       ? pstats->collect_lbr_sample_stats(sample)
+                       : pstats->collect_simple_sample_stats(sample);
+        }
+        ret |= checkpointer.collected(pstats, batch->chunk_->nbytes_);
+        batch->chunk_->clear();
+        free_chunks.push(batch->chunk_);
+        batch->clear();
+        free_batches.push(batch);
+    }
+    ret |= pstats->flush_preagr();
+    reader.join();
+    parser.join();
+    return ret;
+}
+
+bool
+collect_perf_file_events(file_reader_t *           fr_events,
+                         perf_stats_t *            pstats,
+                         size_t                    njobs,
+                         const perf_checkpoint_t * checkpoint) {
+    njobs = resolve_num_jobs(njobs);
+    if (njobs == 1) {
+        return collect_perf_file_events_serial(fr_events, pstats, checkpoint);
+    }
+    if (njobs == 2) {
+        return collect_perf_file_events_pipelined(fr_events, pstats,
+                                                  checkpoint);
+    }
+
+    // This thread just reads lines and batches them up. The workers do the
+    // parsing/collecting into their own tables. The only shared state they
+    // write is the symbol state (see perf-sym-lookup.h); mappings were
+    // finalized by the info pass and are read-only from here on.
+    const size_t               nchunks = 2 * njobs;
+    vec_t<perf_lines_chunk_t>  chunks(nchunks);
+    perf_lines_queue_t         full_chunks(nchunks);
+    perf_lines_queue_t         free_chunks(nchunks);
+    std::mutex                 sym_mtx;
+    vec_t<perf_events_worker_t> workers;
+    vec_t<std::thread>          threads;
+    for (perf_lines_chunk_t & chunk : chunks) {
+        free_chunks.push(&chunk);
+    }
+    workers.reserve(njobs);
+    threads.reserve(njobs);
+    for (size_t i = 0; i < njobs; ++i) {
+        perf_events_worker_t * worker =
+            &(workers.emplace_back(pstats->state_, &sym_mtx,
+                                   pstats->agr_key_, pstats->preaggregate_));
+        threads.emplace_back([worker, &full_chunks, &free_chunks, pstats]() {
+            worker->run(&full_chunks, &free_chunks, &(pstats->mappings_));
+        });
+    }
+
+    // The workers' tables are only merged at the end. For a checkpoint wait
+    // until every chunk handed out has come back (so the workers are idle)
+    // and merge what they have so far.
+    bool                ret = false;
+    perf_checkpointer_t checkpointer(checkpoint);
+    uint64_t            nbytes_pending = 0;
+    auto                drain_workers  = [&]() {
+        vec_t<perf_lines_chunk_t *> idle{};
+        perf_lines_chunk_t *        free_chunk = nullptr;
+        while (idle.size() != nchunks && free_chunks.pop(&free_chunk)) {
+            idle.emplace_back(free_chunk);
+        }
+        for (perf_events_worker_t & worker : workers) {
+            worker.drain(pstats);
+        }
+        for (perf_lines_chunk_t * idle_chunk : idle) {
+            free_chunks.push(idle_chunk);
+        }
+    };
+
+    line_batch_t         batch{};
+    perf_lines_chunk_t * chunk = nullptr;
     progress_bar_t progress(fr_events->nbytes_total(), 0, "Perf Events Parsed");
-    size_t         err_cnt = 0;
-    for (;;) {
-        // Parse each line in the file (until empty).
-        buf = fr_events->nextline();
+    uint64_t       nskip = resume_from_checkpoint(fr_events, checkpoint);
+    while (fr_events->nextlines(&batch)) {
         progress.update_progress(fr_events->nbytes_read());
-        if (buf.empty()) {
-            return ret;
-        }
-        // NOTE: We MUST consume the sample before starting the next line.
-        // Some of what the sample stores are just pointers to locations in
-        // the parsed line (strings for sym/dso).
-        lbr_sample_t sample;  // NOLINT
-        size_t       res = parse_sample_line(buf, &sample);
-        // If return is k_parse_done this was a simple sample.
-        if (res == k_parse_done) {
-            ret |= pstats->collect_simple_sample_stats(&sample);
+        if (chunk == nullptr && !free_chunks.pop(&chunk)) {
+            break;
         }
-        else if (res != k_parse_error) {
-            // Otherwise it was an LBR sample.
-            res = parse_lbr_line(buf, res, &sample);
-            if (res == k_parse_done) {
-                ret |= pstats->collect_lbr_sample_stats(&sample);
+        chunk->add(batch, skip_collected_lines(batch, &nskip));
+        if (chunk->full()) {
+            nbytes_pending += chunk->nbytes_;
+            full_chunks.push(chunk);
+            chunk = nullptr;
+            if (checkpointer.due()) {
+                drain_workers();
+                ret |= checkpointer.collected(pstats, nbytes_pending);
+                nbytes_pending = 0;
             }
         }
-        err_cnt = handle_maybe_err(res, err_cnt, buf.data());
     }
+    if (chunk != nullptr) {
+        full_chunks.push(chunk);
+    }
+    full_chunks.close();
+
+    for (size_t i = 0; i < njobs; ++i) {
+        threads[i].join();
+        pstats->merge(workers[i].shard_);
+        G_total_stats.add(workers[i].stats_);
+        ret |= workers[i].ret_;
+    }
+    return ret;
+}
+
+static bool
+append_perf_time(uint64_t ns, char ** it, const char * end) {
+    constexpr uint64_t k_ns_per_sec = 1000UL * 1000UL * 1000UL;
+    const int          res = snprintf(*it, static_cast<size_t>(end - *it),
+                                      "%lu.%09lu", ns / k_ns_per_sec,
+                                      ns % k_ns_per_sec);
+    if (res < 0 || res >= end - *it) {
+        return false;
+    }
+    *it += res;
+    return true;
+}
+
+bool
+create_perf_events_slice_cmdline(std::string_view          input_file,
+                                 const perf_time_range_t & range,
+                                 size_t                    slice,
+                                 size_t                    nslices,
+                                 preader_t::cmdline_t *    outbuf) {
+    assert(slice < nslices);
+    if (nslices == 1 || !range.valid()) {
+        return create_perf_events_cmdline(input_file, outbuf);
+    }
+    // `--time` bounds are inclusive so each slice ends 1ns before the next one
+    // starts.
+    const uint64_t lo_ns   = perf_time_range_t::ts_to_ns(range.lo_);
+    const uint64_t step_ns = (perf_time_range_t::ts_to_ns(range.hi_) - lo_ns) /
+                             nslices;
+    assert(step_ns != 0);
+    static constexpr std::string_view k_cmd =
+        "perf script -F comm,pid,tid,time,ip,dso,brstack --time ";
+    static constexpr std::string_view k_input = " -i ";
+
+    char *       it  = outbuf->data();
+    const char * end = outbuf->data() + outbuf->size();
+    it               = std::copy(k_cmd.begin(), k_cmd.end(), it);
+    if (slice != 0 && !append_perf_time(lo_ns + step_ns * slice, &it, end)) {
+        return false;
+    }
+    *it++ = ',';
+    if (slice + 1 != nslices &&
+        !append_perf_time(lo_ns + step_ns * (slice + 1) - 1, &it, end)) {
+        return false;
+    }
+    if (static_cast<size_t>(end - it) <=
+        k_input.length() + input_file.length()) {
+        return false;
+    }
+    it  = std::copy(k_input.begin(), k_input.end(), it);
+    it  = std::copy(input_file.begin(), input_file.end(), it);
+    *it = '\0';
+    return true;
+}
+
+bool
+collect_perf_data_events_sliced(std::string_view          perf_data,
+                                const perf_time_range_t & info_range,
+                                perf_stats_t *            pstats,
+                                size_t                    njobs) {
+    // Info events are usually bunched up at the start of the recording, the
+    // header (if present) has the real extent of the samples.
+    perf_time_range_t range = info_range;
+    if (perf_data_reader_t::is_perf_data(perf_data.data())) {
+        perf_data_reader_t pdr;
+        uint64_t           first_ns, last_ns;
+        if (pdr.init(perf_data.data()) &&
+            pdr.sample_time(&first_ns, &last_ns)) {
+            range.add(perf_data_reader_t::time_to_ts(first_ns));
+            range.add(perf_data_reader_t::time_to_ts(last_ns));
+        }
+    }
+
+    // Every slice must be at least 1ns.
+    size_t nslices = 1;
+    if (range.valid()) {
+        const uint64_t span_ns = perf_time_range_t::ts_to_ns(range.hi_) -
+                                 perf_time_range_t::ts_to_ns(range.lo_);
+        nslices = std::min<uint64_t>(resolve_num_jobs(njobs),
+                                     std::max<uint64_t>(span_ns, 1));
+    }
+
+    vec_t<preader_t::cmdline_t> cmdlines(nslices);
+    for (size_t i = 0; i < nslices; ++i) {
+        if (!create_perf_events_slice_cmdline(perf_data, range, i, nslices,
+                                              &cmdlines[i])) {
+            TLO_perr("Perf filename too long!\n");
+            return false;
+        }
+        TLO_printv("Perf events slice %zu: %s\n", i, cmdlines[i].data());
+    }
+
+    // Each slice gets its own `perf script` and tables. Like the parallel
+    // path the only shared state the workers write is the symbol state.
+    std::mutex                  sym_mtx;
+    vec_t<perf_events_worker_t> workers;
+    vec_t<std::thread>          threads;
+    vec_t<uint8_t>              started(nslices, 0);
+    workers.reserve(nslices);
+    threads.reserve(nslices);
+    for (size_t i = 0; i < nslices; ++i) {
+        perf_events_worker_t * worker =
+            &(workers.emplace_back(pstats->state_, &sym_mtx,
+                                   pstats->agr_key_, pstats->preaggregate_));
+        threads.emplace_back([worker, i, &cmdlines, &started, pstats]() {
+            file_reader_t fr_events;
+            fr_events.init(cmdlines[i].data());
+            if (fr_events.active()) {
+                started[i] = 1;
+                worker->run(&fr_events, &(pstats->mappings_));
+            }
+            else {
+                worker->finish(&(pstats->mappings_));
+            }
+        });
+    }
+
+    bool ret = false;
+    bool ok  = true;
+    for (size_t i = 0; i < nslices; ++i) {
+        threads[i].join();
+        if (started[i] == 0) {
+            TLO_perr("Unable to run: \"%s\"\n", cmdlines[i].data());
+            ok = false;
+        }
+        pstats->merge(workers[i].shard_);
+        G_total_stats.add(workers[i].stats_);
+        ret |= workers[i].ret_;
+    }
+    return ok && ret;
+}
+
+// One of the profiles of `collect_perf_profiles`. The DSO names of its
+// mappings go in its own table so the info events of different profiles can be
+// collected concurrently. `stats_` points at `map_tab_` so it can't be copied
+// or moved.
+struct perf_profile_stats_t {
+    strtab_t<true> map_tab_;
+    perf_stats_t   stats_;
+    bool           ok_;
+
+    explicit perf_profile_stats_t(const perf_stats_t & pstats)
+        : stats_(pstats.state_, pstats.agr_key_, pstats.preaggregate_),
+          ok_(false) {
+        stats_.map_tab_               = &map_tab_;
+        stats_.mappings_.dso_offsets_ = pstats.mappings_.dso_offsets_;
+    }
+
+    perf_profile_stats_t(const perf_profile_stats_t &)             = delete;
+    perf_profile_stats_t(perf_profile_stats_t &&)                  = delete;
+    perf_profile_stats_t & operator=(const perf_profile_stats_t &) = delete;
+    perf_profile_stats_t & operator=(perf_profile_stats_t &&)      = delete;
+    ~perf_profile_stats_t()                                        = default;
+};
+
+// Each thread takes the next profile until there are none left.
+struct perf_profile_jobs_t {
+    vec_t<std::thread>    threads_;
+    vec_t<total_stats_t>  stats_;
+    std::atomic<size_t>   next_;
+
+    template<typename T_job_t>
+    void
+    start(size_t nprofiles, size_t njobs, T_job_t job) {
+        next_ = 0;
+        stats_.resize(njobs);
+        threads_.reserve(njobs);
+        for (size_t i = 0; i < njobs; ++i) {
+            threads_.emplace_back([this, nprofiles, i, job]() {
+                for (size_t idx = next_.fetch_add(1); idx < nprofiles;
+                     idx        = next_.fetch_add(1)) {
+                    job(idx);
+                }
+                stats_[i] = G_total_stats;
+            });
+        }
+    }
+
+    void
+    join() {
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            threads_[i].join();
+            G_total_stats.add(stats_[i]);
+        }
+        threads_.clear();
+        stats_.clear();
+    }
+};
+
+// Open one of the files of a profile. perf.data files are decoded with
+// `create_cmdline`.
+static bool
+open_profile_file(std::string_view path,
+                  bool (*create_cmdline)(std::string_view,
+                                         preader_t::cmdline_t *),
+                  file_reader_t * fr) {
+    if (path.ends_with(".data")) {
+        preader_t::cmdline_t cmdline;
+        if (!create_cmdline(path, &cmdline)) {
+            TLO_perr("Perf filename too long!\n");
+            return false;
+        }
+        fr->init(cmdline.data());
+    }
+    else {
+        fr->init(path);
+    }
+    if (!fr->active()) {
+        TLO_perr("Warning: Unable to read file: \"%s\"\n", path.data());
+        return false;
+    }
+    return true;
+}
+
+static void
+collect_profile_info(const perf_profile_t & profile,
+                     perf_profile_stats_t * pprofile) {
+    perf_stats_t * pstats = &(pprofile->stats_);
+    if (pstats->mappings_.dso_offsets_) {
+        pprofile->ok_ = true;
+        return;
+    }
+    file_reader_t fr_map;
+    if (!open_profile_file(profile.info_, create_perf_info_cmdline,
+                           &fr_map)) {
+        return;
+    }
+    bool         ret = false;
+    line_batch_t batch{};
+    size_t       err_cnt = 0;
+    while (fr_map.nextlines(&batch)) {
+        ret |= collect_info_lines(batch, pstats, nullptr, &err_cnt);
+    }
+    fr_map.cleanup();
+    pstats->finalize_mappings();
+    if (!ret) {
+        TLO_perr("Warning: No mappings in info events: \"%s\"\n",
+                 profile.info_.data());
+    }
+    pprofile->ok_ = ret;
+}
+
+static void
+collect_profile_events(const perf_profile_t & profile,
+                       std::mutex *           sym_mtx,
+                       perf_profile_stats_t * pprofile) {
+    perf_stats_t * pstats = &(pprofile->stats_);
+    if (!pprofile->ok_) {
+        return;
+    }
+    pprofile->ok_ = false;
+    file_reader_t fr_events;
+    if (!open_profile_file(profile.events_,
+                           pstats->mappings_.dso_offsets_
+                               ? create_perf_events_offsets_cmdline
+                               : create_perf_events_cmdline,
+                           &fr_events)) {
+        return;
+    }
+    perf_events_worker_t worker(pstats->state_, sym_mtx, pstats->agr_key_,
+                                pstats->preaggregate_);
+    worker.run(&fr_events, &(pstats->mappings_));
+    fr_events.cleanup();
+    pstats->merge(worker.shard_);
+    if (!worker.ret_ || !pstats->valid()) {
+        TLO_perr("Warning: Error collecting stats from perf file: \"%s\"\n",
+                 profile.events_.data());
+        return;
+    }
+    pprofile->ok_ = true;
+}
+
+// Scale the function samples / edge counts exactly as reloading a save state
+// does (see `reload_pf_stats` / `reload_pe_stats`), so `--profiles A,B`
+// matches saving A and B and reloading them together. Unlike a save state the
+// edges haven't been summed into the tracked branches yet, so the branch
+// totals are scaled with them.
+static void
+scale_profile_stats(const perf_stats_scaler_t & pf_stats_scaler,
+                    const perf_stats_scaler_t & pe_stats_scaler,
+                    perf_stats_shard_t *        pstats) {
+    pstats->agr_func_stats_ = {};
+    pstats->agr_edge_stats_ = {};
+    for (auto & tpid_and_stats : pstats->tpids_) {
+        perf_tpid_stats_t & tpid_stats = tpid_and_stats.second;
+        tpid_stats.agr_func_stats_     = {};
+        for (const perf_func_t & pfunc : tpid_stats.funcs_) {
+            pf_stats_scaler.scale(&(pfunc.stats_));
+            pe_stats_scaler.scale_br_samples(&(pfunc.stats_));
+            tpid_stats.agr_func_stats_.add(pfunc.stats_);
+        }
+        tpid_stats.agr_edge_stats_ = {};
+        for (const perf_edge_t & pedge : tpid_stats.edges_) {
+            pe_stats_scaler.scale(&(pedge.stats_));
+            tpid_stats.agr_edge_stats_.add(pedge.stats_);
+        }
+        pstats->agr_func_stats_.add(tpid_stats.agr_func_stats_);
+        pstats->agr_edge_stats_.add(tpid_stats.agr_edge_stats_);
+    }
+}
+
+// Edges within a function are never saved (the clumper drops them), so a
+// reloaded save state is normalized by the edges between functions only.
+static perf_edge_stats_t
+saveable_edge_stats(const perf_stats_shard_t & pstats) {
+    perf_edge_stats_t agr_edge_stats{};
+    for (const auto & tpid_and_stats : pstats.tpids_) {
+        for (const perf_edge_t & pedge : tpid_and_stats.second.edges_) {
+            if (pedge.from_ != pedge.to_) {
+                agr_edge_stats.add(pedge.stats_);
+            }
+        }
+    }
+    return agr_edge_stats;
+}
+
+bool
+collect_perf_profiles(const vec_t<perf_profile_t> & profiles,
+                      perf_stats_t *                pstats,
+                      perf_state_scaling_t *        scaling_todo,
+                      size_t                        njobs) {
+    const size_t nprofiles = profiles.size();
+    if (nprofiles == 0) {
+        return false;
+    }
+    njobs                 = resolve_num_jobs(njobs);
+    const size_t nthreads = std::min(njobs, nprofiles);
+
+    vec_t<std::unique_ptr<perf_profile_stats_t>> pprofiles;
+    pprofiles.reserve(nprofiles);
+    for (size_t i = 0; i < nprofiles; ++i) {
+        pprofiles.emplace_back(std::make_unique<perf_profile_stats_t>(*pstats));
+    }
+
+    // Info events don't touch the symbol state.
+    perf_profile_jobs_t jobs;
+    jobs.start(nprofiles, nthreads, [&profiles, &pprofiles](size_t idx) {
+        collect_profile_info(profiles[idx], pprofiles[idx].get());
+    });
+    jobs.join();
+
+    vec_t<strbuf_t<>> dsos{};
+    for (const auto & pprofile : pprofiles) {
+        if (pprofile->ok_) {
+            const vec_t<strbuf_t<>> pdsos =
+                pprofile->stats_.mappings_.mapped_dsos();
+            dsos.insert(dsos.end(), pdsos.begin(), pdsos.end());
+        }
+    }
+    pstats->state_->prefetch_dsos(dsos);
+    if (njobs != 1) {
+        pstats->state_->preload_dsos(dsos, njobs);
+    }
+
+    // The events of every profile are collected like the slices of
+    // `collect_perf_data_events_sliced`. Profiles are added to `pstats` in
+    // order as they finish so the result doesn't depend on which finished
+    // first. A worker doesn't start a profile more than `max_ahead` past the
+    // next one to be added so only the tables of that many profiles are ever
+    // kept around (the oldest unmerged profile never waits).
+    const size_t                max_ahead = 2 * nthreads;
+    std::mutex                  sym_mtx;
+    vec_t<std::atomic<uint8_t>> done(nprofiles);
+    std::atomic<size_t>         nmerged{ 0 };
+    jobs.start(nprofiles, nthreads,
+               [&profiles, &pprofiles, &done, &sym_mtx, &nmerged,
+                max_ahead](size_t idx) {
+                   for (size_t n = nmerged.load(std::memory_order_acquire);
+                        idx >= n + max_ahead;
+                        n = nmerged.load(std::memory_order_acquire)) {
+                       nmerged.wait(n, std::memory_order_acquire);
+                   }
+                   collect_profile_events(profiles[idx], &sym_mtx,
+                                          pprofiles[idx].get());
+                   done[idx].store(1, std::memory_order_release);
+                   done[idx].notify_one();
+               });
+
+    bool ret            = false;
+    bool did_func_scale = false;
+    bool did_edge_scale = false;
+    for (size_t i = 0; i < nprofiles; ++i) {
+        // Everything before `i` has been added.
+        nmerged.store(i, std::memory_order_release);
+        nmerged.notify_all();
+        done[i].wait(0, std::memory_order_acquire);
+        perf_profile_stats_t * pprofile = pprofiles[i].get();
+        const char * const     path     = profiles[i].events_.data();
+        if (!pprofile->ok_) {
+            TLO_perr("Warning: Skipping profile: %s\n", path);
+            continue;
+        }
+
+        perf_stats_scaler_t pf_stats_scaler{ 1.0 };
+        perf_stats_scaler_t pe_stats_scaler{ 1.0 };
+        if (scaling_todo->should_scale(perf_state_scaling_t::k_func_only) &&
+            !pf_stats_scaler.init(pprofile->stats_.agr_func_stats_)) {
+            TLO_perr("Unable to normalize perf function stats\n\t%s\n", path);
+        }
+        if (scaling_todo->should_scale(perf_state_scaling_t::k_edge_only) &&
+            !pe_stats_scaler.init(saveable_edge_stats(pprofile->stats_))) {
+            TLO_perr("Unable to normalize perf edge stats\n\t%s\n", path);
+        }
+        if (pf_stats_scaler.modifies() || pe_stats_scaler.modifies()) {
+            scale_profile_stats(pf_stats_scaler, pe_stats_scaler,
+                                &(pprofile->stats_));
+        }
+        did_func_scale |= pf_stats_scaler.modifies();
+        did_edge_scale |= pe_stats_scaler.modifies();
+
+        pstats->merge(pprofile->stats_);
+        pprofile->stats_.tpids_.clear();
+        TLO_printv("Collected profile %zu/%zu: %s\n", i + 1, nprofiles, path);
+        ret = true;
+    }
+    jobs.join();
+
+    scaling_todo->set_did_scale(did_func_scale,
+                                perf_state_scaling_t::k_func_only);
+    scaling_todo->set_did_scale(did_edge_scale,
+                                perf_state_scaling_t::k_edge_only);
+    return ret;
+}
+
+bool
+collect_perf_file_info(perf_data_reader_t * pdr, perf_stats_t * pstats) {
+    bool           ret = false;
+    progress_bar_t progress(pdr->nbytes_total(), 0, "Info Events Decoded");
+    const bool     ok = pdr->collect_info(
+        [pstats, &ret, &progress](const info_sample_t & sample,
+                                  size_t                progress_bytes) {
+            progress.update_progress(progress_bytes);
+            if (sample.is_mmap()) {
+                ret |= pstats->collect_mmap_sample(sample);
+            }
+            else if (sample.is_fork()) {
+                ret |= pstats->collect_fork_sample(sample);
+            }
+        });
+    pstats->finalize_mappings();
+    return ok && ret;
+}
+
+bool
+collect_perf_file_events(perf_data_reader_t * pdr, perf_stats_t * pstats) {
+    bool           ret = false;
+    progress_bar_t progress(pdr->nbytes_total(), 0, "Perf Events Decoded");
+    const bool     ok = pdr->collect_samples(
+        [pstats, &ret, &progress](lbr_sample_t * sample, bool is_lbr,
+                                  size_t progress_bytes) {
+            progress.update_progress(progress_bytes);
+            if (is_lbr) {
+                ret |= pstats->collect_lbr_sample_stats(sample);
+            }
+            else {
+                ret |= pstats->collect_simple_sample_stats(sample);
+            }
+        });
+    ret |= pstats->flush_preagr();
+    return ok && ret;
 }
 
 }  // namespace perf
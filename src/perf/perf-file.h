@@ -1,10 +1,17 @@
 #ifndef SRC_D_PERF_D_PERF_FILE_H_
 #define SRC_D_PERF_D_PERF_FILE_H_
 
+#include "src/perf/perf-data-reader.h"
 #include "src/perf/perf-parse.h"
+#include "src/perf/perf-saver.h"
 #include "src/perf/perf-stats.h"
 
 #include "src/util/file-reader.h"
+#include "src/util/vec.h"
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -48,10 +55,125 @@ create_perf_events_cmdline(std::string_view       input_file,
         outbuf);
 }
 
+// Create the cmdline for `perf script` to get dump of LBR events with
+// DSO-relative addresses (see `perf_stats_t::use_dso_offsets`).
+static bool
+create_perf_events_offsets_cmdline(std::string_view       input_file,
+                                   preader_t::cmdline_t * outbuf) {
+    return create_perf_cmdline(
+        "perf script -F comm,pid,tid,time,brstackoff -i ", input_file, outbuf);
+}
+
+// Range of timestamps seen in a recording. Uses the same encoding as
+// `sample_hdr_t::timestamp_` ((sec << 32) + usec).
+struct perf_time_range_t {
+    uint64_t lo_;
+    uint64_t hi_;
+
+    perf_time_range_t() : lo_(std::numeric_limits<uint64_t>::max()), hi_(0) {}
+
+    void
+    add(uint64_t ts) {
+        // Events perf synthesizes for already running processes have no time.
+        if (ts != 0) {
+            lo_ = std::min(lo_, ts);
+            hi_ = std::max(hi_, ts);
+        }
+    }
+
+    bool
+    valid() const {
+        return lo_ <= hi_;
+    }
+
+    static constexpr uint64_t
+    ts_to_ns(uint64_t ts) {
+        constexpr uint64_t k_ns_per_sec  = 1000UL * 1000UL * 1000UL;
+        constexpr uint64_t k_ns_per_usec = 1000UL;
+        return (ts >> 32U) * k_ns_per_sec + (ts & 0xffffffffU) * k_ns_per_usec;
+    }
+};
+
+// Create the cmdline for `perf script` to get the LBR/sample events in time
+// slice `slice` of `nslices` equal slices of `range`. The first/last slices are
+// open ended so samples outside `range` are still seen exactly once.
+bool create_perf_events_slice_cmdline(std::string_view          input_file,
+                                      const perf_time_range_t & range,
+                                      size_t                    slice,
+                                      size_t                    nslices,
+                                      preader_t::cmdline_t *    outbuf);
+
 // Parses entire file and accumulates the samples intos pstats.
 // The important stuff is in perf-parse / perf-stats
 bool collect_perf_file_events(file_reader_t * fr_events, perf_stats_t * pstats);
-bool collect_perf_file_info(file_reader_t * fr_map, perf_stats_t * pstats);
+// If `range` is given it is extended with the timestamp of every info event.
+bool collect_perf_file_info(file_reader_t *     fr_map,
+                            perf_stats_t *      pstats,
+                            perf_time_range_t * range = nullptr);
+
+// Checkpoint for a long events pass. What has been collected so far is saved
+// every `interval_sec_` (see `perf_sample_cache_t::save_checkpoint`) so an
+// interrupted run can resume from it. The mappings aren't saved, the resumed
+// run rebuilds them with the info pass before loading the checkpoint.
+struct perf_checkpoint_t {
+    const char *     path_;
+    std::string_view key_;
+    uint64_t         interval_sec_;
+    // Bytes (of whole lines) of the events file collected by the checkpoint
+    // we resumed from. Plain files are read from there on (see
+    // `file_reader_t::seek`), anything else reads them again without parsing.
+    uint64_t         nbytes_done_;
+};
+
+// Same as `collect_perf_file_events` but using `njobs` threads (0 for one per
+// core). With 2 jobs reading, parsing and collecting run as a pipeline,
+// otherwise the parsing/collecting is split across the threads. Info must be
+// collected first (the mappings are shared read-only between the threads).
+// With a `checkpoint` the threads collecting in parallel are stopped and
+// merged into `pstats` each time one is written.
+bool collect_perf_file_events(file_reader_t *           fr_events,
+                              perf_stats_t *            pstats,
+                              size_t                    njobs,
+                              const perf_checkpoint_t * checkpoint = nullptr);
+
+// Collect the events of a perf.data file by splitting the recording into up to
+// `njobs` time slices (0 for one per core), each decoded by its own concurrent
+// `perf script`. Slices are taken from `range` (the info events), widened to
+// the sample times in the perf.data header if it has them. Each slice is
+// collected into its own tables which are merged in time order. Info must be
+// collected first.
+bool collect_perf_data_events_sliced(std::string_view          perf_data,
+                                     const perf_time_range_t & range,
+                                     perf_stats_t *            pstats,
+                                     size_t                    njobs);
+
+// One of the profiles for `collect_perf_profiles`. Either file can be text
+// (optionally compressed) `perf script` output or a perf.data file, which is
+// decoded with `perf script`. There is no info file with DSO offsets.
+struct perf_profile_t {
+    std::string_view events_;
+    std::string_view info_;
+};
+
+// Collect many profiles (i.e one per host) into `pstats`. Up to `njobs` (0 for
+// one per core) profiles are collected at once, each with its own mappings and
+// tables. Profiles that can't be read or aren't valid are skipped (with a
+// warning). The rest are added to `pstats` in order.
+//
+// Unless `scaling_todo` disables it, each profile is normalized first the same
+// way reloading save states are, so every profile has the same weight no
+// matter how many samples it has. Profiles are checked with `valid` before
+// being normalized, the normalized weights aren't exact so `pstats` is not.
+bool collect_perf_profiles(const vec_t<perf_profile_t> & profiles,
+                           perf_stats_t *                pstats,
+                           perf_state_scaling_t *        scaling_todo,
+                           size_t                        njobs);
+
+// Same as `collect_perf_file_events` but decoding a perf.data file directly
+// (no `perf script`).
+// Info must be collected before events.
+bool collect_perf_file_events(perf_data_reader_t * pdr, perf_stats_t * pstats);
+bool collect_perf_file_info(perf_data_reader_t * pdr, perf_stats_t * pstats);
 
 }  // namespace perf
 }  // namespace tlo
@@ -11,6 +11,9 @@
 #include "src/util/vec.h"
 #include "src/util/xxhash.h"
 
+#include <algorithm>
+#include <limits>
+
 ////////////////////////////////////////////////////////////////////////////////
 // Handle mapping pids -> address space. Used to translate IP (from events) to
 // locations in the elf (for function/branch info).
@@ -21,10 +24,14 @@ namespace perf {
 
 struct perf_map_info_t {
     // Keep timestamp incase multiple mappings (this is rarely if ever happens).
-    uint64_t ts_;
-    uint64_t base_;
-    uint64_t size_;
-    uint64_t off_;
+    uint64_t   ts_;
+    uint64_t   base_;
+    uint64_t   size_;
+    uint64_t   off_;
+    strbuf_t<> dso_;
+    // Timestamp of the first later mapping of the same DSO that overlaps this
+    // one. Until then this is the only possible mapping for addresses in it.
+    uint64_t shadow_ts_;
 
 
     constexpr uint64_t
@@ -38,168 +45,211 @@ struct perf_map_info_t {
         return addr - base_ + off_;
     }
 
-    struct cmp_t {
-        template<typename T0_t, typename T1_t>
-        constexpr bool
-        operator()(T0_t const & lhs, T1_t const & rhs) {
-            uint64_t lhs_ts, rhs_ts;
-            if constexpr (std::is_integral_v<T0_t>) {
-                lhs_ts = lhs;
-            }
-            else {
-                lhs_ts = lhs.ts_;
-            }
+    constexpr uint64_t
+    end_addr() const {
+        // Kernel mappings may run to the end of the address space.
+        return (base_ + size_) < base_ ? std::numeric_limits<uint64_t>::max()
+                                       : base_ + size_;
+    }
 
-            if constexpr (std::is_integral_v<T1_t>) {
-                rhs_ts = rhs;
-            }
-            else {
-                rhs_ts = rhs.ts_;
-            }
+    constexpr bool
+    overlaps(const perf_map_info_t & other) const {
+        return base_ < other.end_addr() && other.base_ < end_addr();
+    }
 
-            return lhs_ts < rhs_ts;
+    struct base_cmp_t {
+        constexpr bool
+        operator()(const perf_map_info_t & lhs,
+                   const perf_map_info_t & rhs) const {
+            if (lhs.base_ != rhs.base_) {
+                return lhs.base_ < rhs.base_;
+            }
+            return lhs.ts_ < rhs.ts_;
         }
     };
 
     void
     dump(int vlvl, FILE * fp, const char * prefix = "") const {
-        TLO_fprint_ifv(vlvl, fp, "%s%lx: [%lx + %lx -> %lx]\n", prefix, ts_,
-                       base_, off_, size_);
+        TLO_fprint_ifv(vlvl, fp, "%s%lx: [%lx + %lx -> %lx] %s\n", prefix, ts_,
+                       base_, off_, size_, dso_.str());
     }
 };
-struct perf_dso_mappings_t {
-    using mapping_t = small_vec_t<perf_map_info_t>;
-    mapping_t mappings_;
 
-    perf_dso_mappings_t() = default;
+// Last mapping a thread resolved a sample to. Consecutive samples (and the
+// from/to of most branches) tend to land in the same mapping so it is checked
+// before searching.
+struct perf_map_hint_t {
+    uint64_t                pid_;
+    const sym::dso_t *      dso_;
+    const perf_map_info_t * map_;
+};
 
+// All the executable mappings of a process. After `finalize` they are sorted
+// by base address and `max_end_` is an implicit binary tree over them (leaves
+// at `[ntree_, 2 * ntree_)`) where each node has the highest end address of
+// any mapping below it. Lookups are a binary search for the mappings based at
+// or below the address, then a descent into just the subtrees that reach past
+// it, so a single large (or long-lived) mapping doesn't make every lookup walk
+// all the mappings before it.
+//
+// `epochs_` is the sorted (unique) timestamps of the mappings. Lookups only
+// care about which mappings are at or before the sample's timestamp, so two
+// samples between the same pair of them always resolve the same way.
+struct perf_pid_mappings_t {
+    using mapping_t = vec_t<perf_map_info_t>;
+    mapping_t       mappings_;
+    vec_t<uint64_t> max_end_;
+    size_t          ntree_ = 0;
+    vec_t<uint64_t> epochs_;
+
+    template<bool k_unused>
     bool
-    merge(const perf_dso_mappings_t & other) {
-        std::copy(other.mappings_.begin(), other.mappings_.end(),
-                  std::back_inserter(mappings_));
-        return true;
-    }
-    bool
-    add_sample(const info_sample_t & sample) {
+    add_sample(strtab_t<k_unused> * stab, const info_sample_t & sample) {
         assert(sample.is_mmap());
-        const sample_mmap_t * mmap = sample.get_mmap();
-        mappings_.emplace_back(
-            perf_map_info_t{ sample.hdr_.timestamp_, mmap->map_base_,
-                             mmap->map_size_, mmap->map_off_ });
+        const sample_mmap_t * mmap_sample = sample.get_mmap();
+        if (mmap_sample == nullptr) {
+            return false;
+        }
+        mappings_.emplace_back(perf_map_info_t{
+            sample.hdr_.timestamp_, mmap_sample->map_base_,
+            mmap_sample->map_size_, mmap_sample->map_off_,
+            stab->get_sbuf(mmap_sample->dso_),
+            std::numeric_limits<uint64_t>::max() });
         return true;
     }
 
     bool
-    finalize() {
-        std::sort(mappings_.begin(), mappings_.end(), perf_map_info_t::cmp_t{});
-        return !mappings_.empty();
+    merge(const perf_pid_mappings_t & other) {
+        std::copy(other.mappings_.begin(), other.mappings_.end(),
+                  std::back_inserter(mappings_));
+        return !other.mappings_.empty();
     }
 
     bool
-    fillin_sample_loc(const sym::dso_t *   dso,
-                      const sample_hdr_t & hdr,
-                      sample_loc_t *       loc,
-                      system::br_insn_t *  br_insn_out) const {
-        for (auto it = mappings_.end(); it != mappings_.begin();) {
-            --it;
-            // Start from most recent and try to find map info that contains our
-            // IP.
-            if (it->ts_ <= hdr.timestamp_) {
-                if (it->contains_addr(loc->mapped_addr_)) {
-                    // Set samples unmapped addr field.
-                    loc->unmapped_addr_ = it->unmap_addr(loc->mapped_addr_);
-                    if (br_insn_out == nullptr) {
-                        return true;
-                    }
-                    // Read raw bytes from file. They should be a branch.
-                    std::array<uint8_t, system::k_max_insn_sz> insn_bytes;
-                    uint64_t insn_loc = loc->unmapped_addr_;
-
-                    dso->read_insn(insn_loc,
-                                   { insn_bytes.data(), insn_bytes.size() });
-                    system::br_insn_t br_insn =
-                        system::br_insn_t::find(insn_bytes);
-                    TLO_INCR_STAT(total_insn_searched_);
-                    if (!br_insn.good()) {
-                        if (tlo::has_verbosity(2)) {
-                            TLO_perrvv("%s + %lx\n", dso->str(), insn_loc);
-                            TLO_perrvv("\t.byte ");
-                            for (uint32_t i = 0; i < insn_bytes.size(); ++i) {
-                                TLO_perrvv("0x%02x", insn_bytes[i]);
-                                if ((i + 1) < insn_bytes.size()) {
-                                    TLO_perrvv(",");
-                                }
-                                else {
-                                    TLO_perrvv("\n");
-                                }
-                            }
-                        }
-                    }
-                    else {
-                        TLO_INCR_STAT(total_insn_decoded_);
-                    }
-
-
-                    *br_insn_out = br_insn;
-
-                    return true;
-                }
+    finalize() {
+        std::sort(mappings_.begin(), mappings_.end(),
+                  perf_map_info_t::base_cmp_t{});
+        ntree_ = 1;
+        while (ntree_ < mappings_.size()) {
+            ntree_ *= 2;
+        }
+        max_end_.assign(2 * ntree_, 0);
+        for (size_t i = 0; i < mappings_.size(); ++i) {
+            max_end_[ntree_ + i] = mappings_[i].end_addr();
+        }
+        for (size_t node = ntree_ - 1; node != 0; --node) {
+            max_end_[node] =
+                std::max(max_end_[2 * node], max_end_[2 * node + 1]);
+        }
+
+        for (size_t i = 0; i < mappings_.size(); ++i) {
+            perf_map_info_t * mapinfo = &mappings_[i];
+            mapinfo->shadow_ts_       = std::numeric_limits<uint64_t>::max();
+            // Everything before us that we overlap.
+            visit_ending_after(mapinfo->base_, i, [&](size_t j) {
+                update_shadow(mapinfo, mappings_[j]);
+            });
+            // Everything after us that we overlap.
+            for (size_t j = i + 1; j < mappings_.size() &&
+                                   mappings_[j].base_ < mapinfo->end_addr();
+                 ++j) {
+                update_shadow(mapinfo, mappings_[j]);
             }
         }
-        return false;
-    }
 
-    void
-    dump(int vlvl, FILE * fp, const char * prefix = "") const {
-        for (const auto & mapinfo : mappings_) {
-            mapinfo.dump(vlvl, fp, prefix);
+        epochs_.clear();
+        for (const perf_map_info_t & mapinfo : mappings_) {
+            epochs_.emplace_back(mapinfo.ts_);
         }
+        std::sort(epochs_.begin(), epochs_.end());
+        epochs_.erase(std::unique(epochs_.begin(), epochs_.end()),
+                      epochs_.end());
+        return !mappings_.empty();
     }
-};
 
-struct perf_pid_mappings_t {
-    using mapping_t = basic_umap<strbuf_t<>, perf_dso_mappings_t>;
-    mapping_t mappings_;
-    template<bool k_unused>
-    bool
-    add_sample(strtab_t<k_unused> * stab, const info_sample_t & sample) {
-        assert(sample.is_mmap());
-        const sample_mmap_t * mmap_sample = sample.get_mmap();
-        assert(mmap_sample != nullptr);
-        auto res = mappings_.emplace(stab->get_sbuf(mmap_sample->dso_),
-                                     perf_dso_mappings_t{});
-        return res.first->second.add_sample(sample);
+    // Number of distinct mapping timestamps at or before `ts`.
+    uint32_t
+    epoch(uint64_t ts) const {
+        return static_cast<uint32_t>(
+            std::upper_bound(epochs_.begin(), epochs_.end(), ts) -
+            epochs_.begin());
     }
 
-    bool
-    merge(const perf_pid_mappings_t & other) {
-        bool ret = false;
-        for (const auto & kvp : other.mappings_) {
-            auto res = mappings_.emplace(kvp.first, perf_dso_mappings_t{});
-            ret |= res.first->second.merge(kvp.second);
+    // Call `visit(i)` (in order) for each of the first `n` mappings that ends
+    // after `addr`.
+    template<typename T_visit_t>
+    void
+    visit_ending_after(uint64_t addr, size_t n, T_visit_t visit) const {
+        if (n != 0) {
+            visit_ending_after(1, 0, ntree_, addr, n, visit);
         }
-        return ret;
     }
 
-    bool
-    finalize() {
-        bool ret = false;
-        for (auto & kvp : mappings_) {
-            ret |= kvp.second.finalize();
+    template<typename T_visit_t>
+    void
+    visit_ending_after(size_t      node,
+                       size_t      lo,
+                       size_t      hi,
+                       uint64_t    addr,
+                       size_t      n,
+                       T_visit_t & visit) const {
+        if (lo >= n || max_end_[node] <= addr) {
+            return;
         }
-        return ret;
+        if (node >= ntree_) {
+            visit(lo);
+            return;
+        }
+        const size_t mid = lo + (hi - lo) / 2;
+        visit_ending_after(2 * node, lo, mid, addr, n, visit);
+        visit_ending_after(2 * node + 1, mid, hi, addr, n, visit);
     }
 
-    bool
-    fillin_sample_loc(const sym::dso_t *   dso,
-                      const sample_hdr_t & hdr,
-                      sample_loc_t *       loc,
-                      system::br_insn_t *  br_insn_out) const {
-        auto res = mappings_.find(dso->name_.without_extra());
-        if (res == mappings_.end()) {
-            return false;
+    static void
+    update_shadow(perf_map_info_t * mapinfo, const perf_map_info_t & other) {
+        if (other.ts_ >= mapinfo->ts_ && mapinfo->overlaps(other) &&
+            mapinfo->dso_.eq(other.dso_)) {
+            mapinfo->shadow_ts_ = std::min(mapinfo->shadow_ts_, other.ts_);
         }
-        return res->second.fillin_sample_loc(dso, hdr, loc, br_insn_out);
+    }
+
+    // Most recent mapping of `dso` (that isn't in the future) that contains
+    // `addr`.
+    const perf_map_info_t *
+    find(const sym::dso_t * dso, uint64_t ts, uint64_t addr) const {
+        return find_if(ts, addr, [dso](const perf_map_info_t & mapinfo) {
+            return mapinfo.dso_.eq(dso->name_.without_extra());
+        });
+    }
+
+    // Same, but of any dso.
+    const perf_map_info_t *
+    find(uint64_t ts, uint64_t addr) const {
+        return find_if(ts, addr,
+                       [](const perf_map_info_t &) { return true; });
+    }
+
+    template<typename T_pred_t>
+    const perf_map_info_t *
+    find_if(uint64_t ts, uint64_t addr, T_pred_t pred) const {
+        auto it = std::upper_bound(
+            mappings_.begin(), mappings_.end(), addr,
+            [](uint64_t lhs, const perf_map_info_t & rhs) {
+                return lhs < rhs.base_;
+            });
+        const size_t n = static_cast<size_t>(it - mappings_.begin());
+        const perf_map_info_t * best = nullptr;
+        // Based at or below `addr` and ending after it, so contains it. On a
+        // tie the later (higher base) mapping wins.
+        visit_ending_after(addr, n, [&](size_t i) {
+            const perf_map_info_t & mapinfo = mappings_[i];
+            if (mapinfo.ts_ <= ts &&
+                (best == nullptr || mapinfo.ts_ >= best->ts_) &&
+                pred(mapinfo)) {
+                best = &mapinfo;
+            }
+        });
+        return best;
     }
 
     void
@@ -207,9 +257,8 @@ struct perf_pid_mappings_t {
         if (!has_verbosity(vlvl)) {
             return;
         }
-        for (const auto & dso_and_mappings : mappings_) {
-            TLO_fprint_ifv(vlvl, fp, "%s\n", dso_and_mappings.first.str());
-            dso_and_mappings.second.dump(vlvl, fp, "\t");
+        for (const auto & mapinfo : mappings_) {
+            mapinfo.dump(vlvl, fp, "\t");
         }
     }
 };
@@ -217,6 +266,9 @@ struct perf_pid_mappings_t {
 struct perf_mappings_t {
     using mapping_t = umap<uint64_t, perf_pid_mappings_t>;
     mapping_t mappings_;
+    // Sample addresses are already offsets into their dso (`perf script -F
+    // brstackoff`) so there are no mappings to look them up in.
+    bool dso_offsets_ = false;
 
     // Add an mmap sample.
     template<bool k_unused>
@@ -272,27 +324,124 @@ struct perf_mappings_t {
         return ret;
     }
 
-    bool
-    fillin_sample_loc_impl(const sym::dso_t *   dso,
-                           const sample_hdr_t & hdr,
-                           sample_loc_t *       loc,
-                           system::br_insn_t *  br_insn_out,
-                           uint64_t             pid_or_tpid) const {
-        auto res = mappings_.find(pid_or_tpid);
+    // Samples from the same pid and epoch resolve every address the same way
+    // (see `perf_pid_mappings_t`).
+    uint32_t
+    epoch(const sample_hdr_t & hdr) const {
+        auto res = mappings_.find(hdr.pid_);
+        return res == mappings_.end() ? 0 : res->second.epoch(hdr.timestamp_);
+    }
+
+    // Every DSO mapped by any process.
+    vec_t<strbuf_t<>>
+    mapped_dsos() const {
+        basic_uset<strbuf_t<>> dsos{};
+        for (const auto & pid_and_mappings : mappings_) {
+            for (const perf_map_info_t & mapinfo :
+                 pid_and_mappings.second.mappings_) {
+                dsos.emplace(mapinfo.dso_);
+            }
+        }
+        return { dsos.begin(), dsos.end() };
+    }
+
+    // Read raw bytes from file. They should be a branch.
+    static system::br_insn_t
+    decode_br_insn(const sym::dso_t * dso, uint64_t insn_loc) {
+        std::array<uint8_t, system::k_max_insn_sz> insn_bytes;
+        dso->read_insn(insn_loc, { insn_bytes.data(), insn_bytes.size() });
+        system::br_insn_t br_insn = system::br_insn_t::find(insn_bytes);
+        if (!br_insn.good() && tlo::has_verbosity(2)) {
+            TLO_perrvv("%s + %lx\n", dso->str(), insn_loc);
+            TLO_perrvv("\t.byte ");
+            for (uint32_t i = 0; i < insn_bytes.size(); ++i) {
+                TLO_perrvv("0x%02x", insn_bytes[i]);
+                if ((i + 1) < insn_bytes.size()) {
+                    TLO_perrvv(",");
+                }
+                else {
+                    TLO_perrvv("\n");
+                }
+            }
+        }
+        return br_insn;
+    }
+
+    static void
+    fillin_br_insn(const sym::dso_t *  dso,
+                   uint64_t            insn_loc,
+                   system::br_insn_t * br_insn_out,
+                   bool                shared) {
+        system::br_insn_t br_insn;
+        TLO_INCR_STAT(total_insn_searched_);
+        if (dso->find_cached_br_insn(insn_loc, &br_insn, shared)) {
+            TLO_INCR_STAT(total_insn_cache_hits_);
+        }
+        else {
+            br_insn = decode_br_insn(dso, insn_loc);
+            dso->cache_br_insn(insn_loc, br_insn, shared);
+        }
+        if (br_insn.good()) {
+            TLO_INCR_STAT(total_insn_decoded_);
+        }
+        *br_insn_out = br_insn;
+    }
+
+    const perf_map_info_t *
+    find_mapping(const sym::dso_t *   dso,
+                 const sample_hdr_t & hdr,
+                 uint64_t             addr,
+                 perf_map_hint_t *    hint) const {
+        if (hint != nullptr && hint->map_ != nullptr &&
+            hint->pid_ == hdr.pid_ && hint->dso_ == dso &&
+            hint->map_->contains_addr(addr) &&
+            hint->map_->ts_ <= hdr.timestamp_ &&
+            hdr.timestamp_ < hint->map_->shadow_ts_) {
+            return hint->map_;
+        }
+
+        auto res = mappings_.find(hdr.pid_);
         if (res == mappings_.end()) {
-            return false;
+            return nullptr;
+        }
+        const perf_map_info_t * mapinfo =
+            res->second.find(dso, hdr.timestamp_, addr);
+        if (hint != nullptr && mapinfo != nullptr) {
+            *hint = perf_map_hint_t{ hdr.pid_, dso, mapinfo };
         }
-        return res->second.fillin_sample_loc(dso, hdr, loc, br_insn_out);
+        return mapinfo;
     }
+
     // Get the unmapped addr and optionally assosiated br_insn for the samples
-    // IP.
+    // IP. `hint` is an optional per-thread cache of the last mapping found.
+    // `shared` if other threads are collecting samples at the same time.
     bool
     fillin_sample_loc(const sym::dso_t *   dso,
                       const sample_hdr_t & hdr,
                       sample_loc_t *       loc,
-                      system::br_insn_t *  br_insn_out = nullptr) const {
-        bool r = fillin_sample_loc_impl(dso, hdr, loc, br_insn_out, hdr.pid_);
-        return r;
+                      system::br_insn_t *  br_insn_out = nullptr,
+                      perf_map_hint_t *    hint        = nullptr,
+                      bool                 shared      = false) const {
+        if (dso_offsets_) {
+            // perf leaves addresses it couldn't map as is.
+            if (dso->is_unknown()) {
+                return false;
+            }
+            loc->unmapped_addr_ = loc->mapped_addr_;
+        }
+        else {
+            const perf_map_info_t * mapinfo =
+                find_mapping(dso, hdr, loc->mapped_addr_, hint);
+            if (mapinfo == nullptr) {
+                return false;
+            }
+            // Set samples unmapped addr field.
+            loc->unmapped_addr_ = mapinfo->unmap_addr(loc->mapped_addr_);
+        }
+        if (br_insn_out != nullptr) {
+            fillin_br_insn(dso, loc->unmapped_addr_, br_insn_out, shared);
+        }
+        return true;
     }
 };
 
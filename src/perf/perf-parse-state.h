@@ -1,10 +1,10 @@
 #include "src/util/compiler.h"
 #include "src/util/macro.h"
 #include "src/util/memory.h"
+#include "src/util/str-scan.h"
 
 #include "src/util/verbosity.h"
 
-#include <charconv>
 #include <string_view>
 #include <tuple>
 
@@ -37,17 +37,17 @@ struct parse_state_t {
             off_ += 1;
         }
 
-        T_t  out = 0;
-        auto res = std::from_chars(buf_.begin() + off_, buf_.end(), out, base);
+        T_t          out = 0;
+        const size_t len = base == 16 ? scan::parse_hex(cur(), remaining(), &out)
+                                      : scan::parse_dec(cur(), remaining(), &out);
         if (neg) {
             out = static_cast<T_t>(-out);
         }
 
-        if (TLO_UNLIKELY((res.ec != std::errc()) ||
-                         (res.ptr <= (buf_.begin() + off_)))) {
+        if (TLO_UNLIKELY(len == 0)) {
             return { out, true };
         }
-        off_ = static_cast<size_t>(res.ptr - buf_.begin());
+        off_ += len;
         return { out, false };
     }
 
@@ -95,40 +95,23 @@ struct parse_state_t {
 
     bool
     skip_to(char c) {
-        size_t i, e;
-        for (i = off_, e = buf_.size(); i < e && buf_[i] != c; ++i) {
-        }
-        off_ = i;
-        return i != e;
+        return skip_to(c, c);
     }
 
     bool
     skip_to(char c0, char c1) {
-        size_t i, e;
-        for (i = off_, e = buf_.size(); i < e && buf_[i] != c0 && buf_[i] != c1;
-             ++i) {
-        }
-        off_ = i;
-        return i != e;
+        off_ += scan::find_first_of(cur(), remaining(), c0, c1);
+        return off_ != buf_.size();
     }
 
     bool
     skip_to_or_ws(char c) {
-        size_t i, e;
-        for (i = off_, e = buf_.size();
-             i < e && buf_[i] != c && !is_ws(buf_[i]); ++i) {
-        }
-        off_ = i;
-        return i != e;
+        return skip_to(c, ' ');
     }
 
     bool
     skip_to_ws() {
-        size_t i, e;
-        for (i = off_, e = buf_.size(); i < e && !is_ws(buf_[i]); ++i) {
-        }
-        off_ = i;
-        return i != e;
+        return skip_to(' ', ' ');
     }
 
     bool
@@ -170,20 +153,13 @@ struct parse_state_t {
 
     bool
     skip_at(char c) {
-        size_t i, e;
-        for (i = off_, e = buf_.size(); i < e && buf_[i] == c; ++i) {
-        }
-        off_ = i;
-        return i != e;
+        off_ += scan::find_first_not_of(cur(), remaining(), c);
+        return off_ != buf_.size();
     }
 
     bool
     skip_ws() {
-        size_t i, e;
-        for (i = off_, e = buf_.size(); i < e && is_ws(buf_[i]); ++i) {
-        }
-        off_ = i;
-        return i != e;
+        return skip_at(' ');
     }
 
     bool
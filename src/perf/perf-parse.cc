@@ -1,3 +1,4 @@
+#include "src/perf/perf-brtype.h"
 #include "src/perf/perf-parse.h"
 #include "src/perf/perf-parse-state.h"
 #include "src/system/br-insn.h"
@@ -419,20 +420,19 @@ parse_lbr_entry_prepare(const std::string_view buf, size_t off) {
     return tlo::perf::k_parse_incomplete;
 }
 
+// The entry's flags in format `k_fmt` (see `lbr_fmt_t`). Only
+// `k_lbr_fmt_any` checks which format each entry is in.
+template<lbr_fmt_t k_fmt>
 static size_t
 parse_lbr_entry_flags(const std::string_view buf,
                       size_t                 off,
                       lbr_br_sample_t *      sample_out) {
-    // perf < 5.15
-    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>
-    // perf < 6.3.0
-    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>/<str:brtype>
-    // perf >= 6.3.0
-    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>/<str:brtype>/<str:brdesc>
+    static_assert(k_fmt != k_lbr_fmt_unknown);
 
     parse_state_t parser = { buf, off };
     uint32_t      predicted, cycles;
     bool          in_tx, aborted, err;
+    perf_brtype_t brtype;
     // <char:predicted>/
     PARSE_ASSERT(parser.at_c('P') || parser.at_c('M') || parser.at_c('-'));
     predicted = parser.at_c('-')
@@ -457,10 +457,54 @@ parse_lbr_entry_flags(const std::string_view buf,
     PARSE_ASSERT(parser.at_c('/'));
     PARSE_ASSERT(parser.skip_fwd(1));
 
-    // <u32:cycles>/
+    // <u32:cycles>
     std::tie(cycles, err) = parser.get_decint<uint32_t>();
     PARSE_ASSERT(!err);
-    if (parser.at_c('/')) {
+
+    brtype = k_perf_br_unknown;
+    if constexpr (k_fmt == k_lbr_fmt_cycles) {
+        // Nothing else in the entry.
+        PARSE_ASSERT(parser.at_ws() || parser.at_end());
+    }
+    else if constexpr (k_fmt == k_lbr_fmt_any) {
+        // /<str:brtype>(/<str:brdesc>)?
+        if (parser.at_c('/')) {
+            PARSE_ASSERT(parser.skip_fwd(1));
+            const size_t brtype_off = parser.bytes_parsed();
+            parser.skip_to_or_ws('/');
+            std::string_view brtype_str =
+                buf.substr(brtype_off, parser.bytes_parsed() - brtype_off);
+            // Last entry on the line.
+            while (!brtype_str.empty() &&
+                   parse_state_t::is_end(brtype_str.back())) {
+                brtype_str.remove_suffix(1);
+            }
+            brtype = perf_brtype_from_str(brtype_str);
+            parser.skip_to_ws();
+        }
+    }
+    else {
+        // /<str:brtype>
+        PARSE_ASSERT(parser.at_c('/'));
+        PARSE_ASSERT(parser.skip_fwd(1));
+        const size_t brtype_off = parser.bytes_parsed();
+        if constexpr (k_fmt == k_lbr_fmt_brtype) {
+            parser.skip_to_or_ws('/');
+            PARSE_ASSERT(!parser.at_c('/'));
+        }
+        else {
+            // /<str:brdesc> (which we don't use).
+            parser.skip_to_or_ws('/');
+            PARSE_ASSERT(parser.at_c('/'));
+        }
+        std::string_view brtype_str =
+            buf.substr(brtype_off, parser.bytes_parsed() - brtype_off);
+        // Last entry on the line.
+        while (!brtype_str.empty() &&
+               parse_state_t::is_end(brtype_str.back())) {
+            brtype_str.remove_suffix(1);
+        }
+        brtype = perf_brtype_from_str(brtype_str);
         parser.skip_to_ws();
     }
 
@@ -468,7 +512,8 @@ parse_lbr_entry_flags(const std::string_view buf,
     sample_out->predicted_ = predicted & 3U;
     sample_out->in_tx_     = in_tx;
     sample_out->aborted_   = aborted;
-    sample_out->br_insn_   = {};
+    sample_out->brtype_    = brtype & 0xfU;
+    sample_out->br_insn_   = system::br_insn_t::make_bad();
     return parser.bytes_parsed();
 }
 
@@ -501,10 +546,11 @@ parse_lbr_entry_till_slash(const std::string_view buf,
 }
 
 
-size_t
-parse_lbr_line(const std::string_view buf,
-               size_t                 off,
-               lbr_sample_t *         sample_out) {
+template<lbr_fmt_t k_fmt>
+static size_t
+parse_lbr_line_impl(const std::string_view buf,
+                    size_t                 off,
+                    lbr_sample_t *         sample_out) {
     uint32_t i;
     for (i = 0; i < lbr_sample_t::k_max_lbr_samples; ++i) {
         off = parse_lbr_entry_prepare(buf, off);
@@ -519,7 +565,8 @@ parse_lbr_line(const std::string_view buf,
         off = parse_lbr_entry_till_slash(buf, off,
                                          &(sample_out->samples_[index].to_));
         PARSE_ASSERT(off != tlo::perf::k_parse_error);
-        off = parse_lbr_entry_flags(buf, off, &(sample_out->samples_[index]));
+        off = parse_lbr_entry_flags<k_fmt>(buf, off,
+                                           &(sample_out->samples_[index]));
         PARSE_ASSERT(off != tlo::perf::k_parse_error);
     }
     if (i == 0) {
@@ -535,5 +582,164 @@ parse_lbr_line(const std::string_view buf,
     return tlo::perf::k_parse_done;
 }
 
+size_t
+parse_lbr_line(const std::string_view buf,
+               size_t                 off,
+               lbr_sample_t *         sample_out,
+               lbr_fmt_t              fmt) {
+    switch (fmt) {
+        case k_lbr_fmt_cycles:
+            return parse_lbr_line_impl<k_lbr_fmt_cycles>(buf, off, sample_out);
+        case k_lbr_fmt_brtype:
+            return parse_lbr_line_impl<k_lbr_fmt_brtype>(buf, off, sample_out);
+        case k_lbr_fmt_brdesc:
+            return parse_lbr_line_impl<k_lbr_fmt_brdesc>(buf, off, sample_out);
+        case k_lbr_fmt_any:
+            return parse_lbr_line_impl<k_lbr_fmt_any>(buf, off, sample_out);
+        case k_lbr_fmt_unknown:
+        default:
+            assert(0 && "Parsing lbr entries of unknown format!");
+            return k_parse_error;
+    }
+}
+
+lbr_fmt_t
+detect_lbr_fmt(const std::string_view buf, size_t off) {
+    sample_loc_t    loc;
+    lbr_br_sample_t entry;
+    off = parse_lbr_entry_prepare(buf, off);
+    if (off == k_parse_incomplete) {
+        return k_lbr_fmt_unknown;
+    }
+    off = parse_lbr_entry_till_slash(buf, off, &loc);
+    if (off == k_parse_error) {
+        return k_lbr_fmt_unknown;
+    }
+    off = parse_lbr_entry_till_slash(buf, off, &loc);
+    if (off == k_parse_error) {
+        return k_lbr_fmt_unknown;
+    }
+
+    // The flags are the rest of the entry, the format is just how many
+    // fields they have.
+    parse_state_t parser = { buf, off };
+    parser.skip_to_ws();
+    const std::string_view flags =
+        buf.substr(off, parser.bytes_parsed() - off);
+    size_t nfields = 1;
+    for (const char c : flags) {
+        nfields += c == '/' ? 1 : 0;
+    }
+    // NOLINTBEGIN(*magic*)
+    lbr_fmt_t fmt = k_lbr_fmt_unknown;
+    size_t    res = k_parse_error;
+    switch (nfields) {
+        case 4:
+            fmt = k_lbr_fmt_cycles;
+            res = parse_lbr_entry_flags<k_lbr_fmt_cycles>(buf, off, &entry);
+            break;
+        case 5:
+            fmt = k_lbr_fmt_brtype;
+            res = parse_lbr_entry_flags<k_lbr_fmt_brtype>(buf, off, &entry);
+            break;
+        case 6:
+            fmt = k_lbr_fmt_brdesc;
+            res = parse_lbr_entry_flags<k_lbr_fmt_brdesc>(buf, off, &entry);
+            break;
+        default:
+            break;
+    }
+    // NOLINTEND(*magic*)
+    return res == k_parse_error ? k_lbr_fmt_unknown : fmt;
+}
+
+// `parse_lbr(buf, off, sample_out)` parses the entries.
+template<typename T_parse_lbr_t>
+static size_t
+parse_lbr_offsets_line_impl(const std::string_view buf,
+                            lbr_sample_t *         sample_out,
+                            T_parse_lbr_t          parse_lbr) {
+    // <{hdr}> <{brstackoff entries}>
+    const size_t pre_parsed = parse_sample_hdr(buf, &(sample_out->hdr_));
+    if (pre_parsed == k_parse_error) {
+        return k_parse_error;
+    }
+    const size_t res = parse_lbr(buf, pre_parsed, sample_out);
+    if (res != k_parse_done) {
+        return res;
+    }
+    // There is no IP. Nothing is taken between the newest branch's target and
+    // the IP so it is in the same function (barring falling through into the
+    // next one).
+    sample_out->loc_ =
+        sample_out->samples_[sample_out->num_lbr_samples() - 1].to_;
+    return k_parse_done;
+}
+
+size_t
+parse_lbr_offsets_line(const std::string_view buf,
+                       lbr_sample_t *         sample_out,
+                       lbr_fmt_t              fmt) {
+    return parse_lbr_offsets_line_impl(
+        buf, sample_out,
+        [fmt](const std::string_view line, size_t off, lbr_sample_t * sample) {
+            return parse_lbr_line(line, off, sample, fmt);
+        });
+}
+
+bool
+lbr_line_parser_t::detect(const std::string_view buf, size_t off) {
+    if (TLO_LIKELY(fmt_ != k_lbr_fmt_unknown)) {
+        return true;
+    }
+    fmt_ = detect_lbr_fmt(buf, off);
+    if (fmt_ != k_lbr_fmt_unknown) {
+        TLO_printv("Perf lbr format: %s\n", lbr_fmt_name(fmt_));
+        return true;
+    }
+    // A line without any entries doesn't tell us anything.
+    off = parse_lbr_entry_prepare(buf, off);
+    if (off == k_parse_incomplete) {
+        return false;
+    }
+    if (!reported_) {
+        reported_            = true;
+        parse_state_t parser = { buf, off };
+        parser.skip_to_ws();
+        std::string_view entry = buf.substr(off, parser.bytes_parsed() - off);
+        while (!entry.empty() && parse_state_t::is_end(entry.back())) {
+            entry.remove_suffix(1);
+        }
+        TLO_perr(
+            "\nError: Unknown perf brstack format. Expected entries like:\n"
+            "    <from>/<to>/<P|M|->/<X|->/<A|->/<cycles>[/<brtype>[/<brdesc>]]"
+            "\nBut got:\n    \"%.*s\"\n",
+            static_cast<int>(entry.length()), entry.data());
+    }
+    return false;
+}
+
+size_t
+lbr_line_parser_t::parse_lbr_line(const std::string_view buf,
+                                  size_t                 off,
+                                  lbr_sample_t *         sample_out) {
+    if (TLO_UNLIKELY(!detect(buf, off))) {
+        return parse_lbr_entry_prepare(buf, off) == k_parse_incomplete
+                   ? k_parse_incomplete
+                   : k_parse_error;
+    }
+    return perf::parse_lbr_line(buf, off, sample_out, fmt_);
+}
+
+size_t
+lbr_line_parser_t::parse_lbr_offsets_line(const std::string_view buf,
+                                          lbr_sample_t *         sample_out) {
+    return parse_lbr_offsets_line_impl(
+        buf, sample_out,
+        [this](const std::string_view line, size_t off, lbr_sample_t * sample) {
+            return parse_lbr_line(line, off, sample);
+        });
+}
+
 }  // namespace perf
 }  // namespace tlo
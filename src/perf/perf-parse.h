@@ -31,20 +31,91 @@ parse_sample_line(const char * buf, size_t len, simple_sample_t * sample_out) {
     return parse_sample_line(std::string_view{ buf, len }, sample_out);
 }
 
+// Layout of the flags at the end of each lbr entry. It depends on the perf
+// version that wrote the file (but is the same for every entry in it).
+enum lbr_fmt_t : uint8_t {
+    k_lbr_fmt_unknown,
+    // perf < 5.15
+    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>
+    k_lbr_fmt_cycles,
+    // perf < 6.3.0
+    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>/<str:brtype>
+    k_lbr_fmt_brtype,
+    // perf >= 6.3.0
+    // <char:predicted>/<char:in_tx>/<char:abort>/<u32:cycles>/<str:brtype>/<str:brdesc>
+    k_lbr_fmt_brdesc,
+    // Any of the above, checked for each entry.
+    k_lbr_fmt_any,
+};
+
+static const char *
+lbr_fmt_name(lbr_fmt_t fmt) {
+    switch (fmt) {
+        case k_lbr_fmt_cycles:
+            return "perf < 5.15 (no brtype)";
+        case k_lbr_fmt_brtype:
+            return "perf < 6.3 (brtype)";
+        case k_lbr_fmt_brdesc:
+            return "perf >= 6.3 (brtype and brdesc)";
+        case k_lbr_fmt_any:
+            return "any";
+        case k_lbr_fmt_unknown:
+        default:
+            return "unknown";
+    }
+}
+
+// Format of the first lbr entry in the line (`off` as returned by
+// `parse_sample_line`). `k_lbr_fmt_unknown` if there are no entries or we
+// don't recognize it.
+lbr_fmt_t detect_lbr_fmt(const std::string_view buf, size_t off);
+
 // Called only after `parse_sample_line` was called on the line. Parses an lbr
-// entry.
+// entry. Every entry must be in format `fmt` (which can't be
+// `k_lbr_fmt_unknown`).
 size_t parse_lbr_line(const std::string_view buf,
                       size_t                 off,
-                      lbr_sample_t *         sample_out);
+                      lbr_sample_t *         sample_out,
+                      lbr_fmt_t              fmt = k_lbr_fmt_any);
 
 static size_t
 parse_lbr_line(const char *   buf,
                size_t         len,
                size_t         off,
-               lbr_sample_t * sample_out) {
-    return parse_lbr_line(std::string_view(buf, len), off, sample_out);
+               lbr_sample_t * sample_out,
+               lbr_fmt_t      fmt = k_lbr_fmt_any) {
+    return parse_lbr_line(std::string_view(buf, len), off, sample_out, fmt);
 }
 
+// Parse a whole `perf script -F comm,pid,tid,time,brstackoff` line. The
+// addresses are already offsets into the dsos. As there is no IP field, the
+// sample's location is set to the newest branch's target. Returns
+// `k_parse_incomplete` if the line has no branches.
+size_t parse_lbr_offsets_line(const std::string_view buf,
+                              lbr_sample_t *         sample_out,
+                              lbr_fmt_t              fmt = k_lbr_fmt_any);
+
+// Parses the lbr entries of all the lines of one file. The format is detected
+// from the first line with any entries, after that every line is parsed with
+// the parser for that format (so there are no per-entry format checks). If the
+// format isn't recognized we print what we expected (once) and the lines
+// fail to parse.
+struct lbr_line_parser_t {
+    lbr_fmt_t fmt_;
+    bool      reported_;
+
+    constexpr lbr_line_parser_t() : fmt_(k_lbr_fmt_unknown), reported_(false) {}
+
+    // Same as the free functions but with the detected format.
+    size_t parse_lbr_line(const std::string_view buf,
+                          size_t                 off,
+                          lbr_sample_t *         sample_out);
+    size_t parse_lbr_offsets_line(const std::string_view buf,
+                                  lbr_sample_t *         sample_out);
+
+    bool detect(const std::string_view buf, size_t off);
+};
+
 
 }  // namespace perf
 }  // namespace tlo
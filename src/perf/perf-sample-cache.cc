@@ -0,0 +1,552 @@
+#include "src/perf/perf-sample-cache.h"
+#include "src/perf/perf-stats.h"
+
+#include "src/sym/dso.h"
+#include "src/sym/syms.h"
+
+#include "src/util/compiler.h"
+#include "src/util/file-ops.h"
+#include "src/util/global-stats.h"
+#include "src/util/random.h"
+#include "src/util/umap.h"
+#include "src/util/verbosity.h"
+#include "src/util/xxhash.h"
+
+#include <array>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tlo {
+namespace perf {
+
+using cache_t = perf_sample_cache_t;
+
+static void
+sample_cache_append(vec_t<char> * buf, std::string_view sv) {
+    std::copy(sv.begin(), sv.end(), std::back_inserter(*buf));
+}
+
+bool
+perf_sample_cache_t::make_key(std::span<const std::string_view> paths,
+                              vec_t<char> *                     key_out) {
+    key_out->clear();
+    for (std::string_view path : paths) {
+        struct stat st {};
+        if (stat(path.data(), &st) != 0) {
+            return false;
+        }
+        std::array<char, 64> stat_buf{};
+        (void)snprintf(stat_buf.data(), stat_buf.size(), ":%lu:%lu;",
+                       static_cast<uint64_t>(st.st_size),
+                       static_cast<uint64_t>(st.st_mtim.tv_sec) *
+                               1000000000UL +
+                           static_cast<uint64_t>(st.st_mtim.tv_nsec));
+        sample_cache_append(key_out, path);
+        sample_cache_append(key_out, stat_buf.data());
+    }
+    return true;
+}
+
+// Validated view of a mapped cache entry.
+struct sample_cache_view_t {
+    cache_t::hdr_t               hdr_;
+    const cache_t::str_ent_t *   strs_;
+    const cache_t::stat_ent_t *  stats_;
+    const cache_t::dso_ent_t *   dsos_;
+    const uint32_t *             comms_;
+    const cache_t::clump_ent_t * clumps_;
+    const cache_t::tpid_ent_t *  tpids_;
+    const cache_t::func_ent_t *  funcs_;
+    const cache_t::edge_ent_t *  edges_;
+    const char *                 blob_;
+
+    std::string_view
+    sview(uint32_t idx) const {
+        assert(idx < hdr_.nstrs_);
+        return { blob_ + strs_[idx].off_, strs_[idx].len_ };
+    }
+
+    bool
+    init(const uint8_t *  p,
+         size_t           sz,
+         std::string_view key,
+         perf_agr_key_t   agr_key,
+         bool             partial) {
+        if (sz < sizeof(cache_t::hdr_t)) {
+            return false;
+        }
+        memcpy(&hdr_, p, sizeof(cache_t::hdr_t));
+        if (hdr_.magic_ != cache_t::k_magic ||
+            hdr_.version_ != cache_t::k_version || hdr_.agr_key_ != agr_key ||
+            (hdr_.partial_ != 0) != partial ||
+            hdr_.size_ != sz || hdr_.str_bytes_ > sz || hdr_.nfuncs_ > sz ||
+            hdr_.nedges_ > sz) {
+            return false;
+        }
+        const cache_t::layout_t layout = cache_t::layout_t::make(hdr_);
+        if (layout.size_ != sz) {
+            return false;
+        }
+        if (xxhash::run(p + sizeof(cache_t::hdr_t),
+                        sz - sizeof(cache_t::hdr_t)) != hdr_.checksum_) {
+            return false;
+        }
+
+        // Sections are 8-byte aligned and the mapping is page aligned.
+        TLO_DISABLE_WCAST_ALIGN
+        strs_  = reinterpret_cast<const cache_t::str_ent_t *>(p + layout.strs_);
+        stats_ = reinterpret_cast<const cache_t::stat_ent_t *>(p +
+                                                               layout.stats_);
+        dsos_  = reinterpret_cast<const cache_t::dso_ent_t *>(p + layout.dsos_);
+        comms_ = reinterpret_cast<const uint32_t *>(p + layout.comms_);
+        clumps_ = reinterpret_cast<const cache_t::clump_ent_t *>(
+            p + layout.clumps_);
+        tpids_ = reinterpret_cast<const cache_t::tpid_ent_t *>(p +
+                                                               layout.tpids_);
+        funcs_ = reinterpret_cast<const cache_t::func_ent_t *>(p +
+                                                               layout.funcs_);
+        edges_ = reinterpret_cast<const cache_t::edge_ent_t *>(p +
+                                                               layout.edges_);
+        TLO_REENABLE_WCAST_ALIGN
+        blob_ = reinterpret_cast<const char *>(p + layout.blob_);
+
+        for (uint32_t i = 0; i < hdr_.nstrs_; ++i) {
+            const uint64_t end = static_cast<uint64_t>(strs_[i].off_) +
+                                 static_cast<uint64_t>(strs_[i].len_);
+            if (end >= hdr_.str_bytes_ || blob_[end] != '\0' ||
+                !strbuf_t<>::fits(strs_[i].len_)) {
+                return false;
+            }
+        }
+        if (hdr_.key_ >= hdr_.nstrs_ || sview(hdr_.key_) != key) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < hdr_.nstats_; ++i) {
+            if (stats_[i].name_ >= hdr_.nstrs_) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < hdr_.ncomms_; ++i) {
+            if (comms_[i] >= hdr_.nstrs_) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < hdr_.ndsos_; ++i) {
+            const cache_t::dso_ent_t & dso = dsos_[i];
+            if (dso.name_ >= hdr_.nstrs_ ||
+                static_cast<uint64_t>(dso.comms_) + dso.ncomms_ >
+                    hdr_.ncomms_) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < hdr_.nclumps_; ++i) {
+            const cache_t::clump_ent_t & clump = clumps_[i];
+            if (clump.dso_ >= hdr_.ndsos_ ||
+                (clump.idx_ != cache_t::k_unknown_clump &&
+                 clump.idx_ >= dsos_[clump.dso_].nclumps_)) {
+                return false;
+            }
+        }
+
+        // Tpids must exactly cover the funcs/edges in order.
+        uint64_t next_func = 0;
+        uint64_t next_edge = 0;
+        for (uint32_t i = 0; i < hdr_.ntpids_; ++i) {
+            const cache_t::tpid_ent_t & tpid = tpids_[i];
+            if (tpid.funcs_ != next_func || tpid.edges_ != next_edge ||
+                tpid.nfuncs_ > hdr_.nfuncs_ - next_func ||
+                tpid.nedges_ > hdr_.nedges_ - next_edge) {
+                return false;
+            }
+            next_func += tpid.nfuncs_;
+            next_edge += tpid.nedges_;
+        }
+        if (next_func != hdr_.nfuncs_ || next_edge != hdr_.nedges_) {
+            return false;
+        }
+        for (uint64_t i = 0; i < hdr_.nfuncs_; ++i) {
+            if (funcs_[i].clump_ >= hdr_.nclumps_) {
+                return false;
+            }
+        }
+        for (uint64_t i = 0; i < hdr_.nedges_; ++i) {
+            const cache_t::edge_ent_t & edge = edges_[i];
+            if (edge.from_ >= hdr_.nclumps_ || edge.to_ >= hdr_.nclumps_ ||
+                !system::br_insn_t{ edge.br_insn_ }.valid()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The clumps depend on the DSO symbols so make sure they still match what
+    // we collected with.
+    bool
+    check_dsos(std::span<sym::dso_t * const> dsos) const {
+        for (uint32_t i = 0; i < hdr_.ndsos_; ++i) {
+            if (dsos[i]->num_func_clumps() != dsos_[i].nclumps_) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < hdr_.nclumps_; ++i) {
+            const cache_t::clump_ent_t & clump = clumps_[i];
+            if (clump.idx_ == cache_t::k_unknown_clump) {
+                continue;
+            }
+            const sym::func_clump_t & fc =
+                dsos[clump.dso_]->func_clumps()[clump.idx_];
+            if (fc.first()->name_.hash() != clump.name_hash_) {
+                return false;
+            }
+            // Ranges of clumps that track their samples are restored later.
+            if (!fc.tracks_sample_addrs() &&
+                (fc.clumped_range_.lo_addr_inclusive_ != clump.lo_ ||
+                 fc.clumped_range_.hi_addr_exclusive_ != clump.hi_)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void
+    apply(sym::sym_state_t *            state,
+          std::span<sym::dso_t * const> dsos,
+          perf_stats_t *                pstats) const {
+        // The stats from when the samples were collected replace whatever
+        // loading the DSOs just added.
+        G_total_stats = total_stats_t{};
+        for (uint32_t i = 0; i < hdr_.nstats_; ++i) {
+            global_stats_reload(stat_counter_t{ sview(stats_[i].name_).data(),
+                                                stats_[i].val_ });
+        }
+
+        for (uint32_t i = 0; i < hdr_.ndsos_; ++i) {
+            const cache_t::dso_ent_t & dso = dsos_[i];
+            for (uint32_t j = 0; j < dso.ncomms_; ++j) {
+                dsos[i]->add_comm_use(state->get_strtab()->get_sbuf(
+                    sview(comms_[dso.comms_ + j])));
+            }
+        }
+
+        vec_t<sym::func_clump_t *> fcs(hdr_.nclumps_);
+        for (uint32_t i = 0; i < hdr_.nclumps_; ++i) {
+            const cache_t::clump_ent_t & clump = clumps_[i];
+            const sym::addr_range_t first_range{ clump.first_lo_,
+                                                 clump.first_hi_ };
+            if (clump.idx_ == cache_t::k_unknown_clump) {
+                fcs[i] = state->get_unknown_func(dsos[clump.dso_], first_range);
+            }
+            else {
+                fcs[i] = &(dsos[clump.dso_]->func_clumps()[clump.idx_]);
+            }
+            if (fcs[i]->tracks_sample_addrs()) {
+                fcs[i]->restore_sample_range(
+                    first_range, sym::addr_range_t{ clump.lo_, clump.hi_ },
+                    clump.size_);
+            }
+        }
+
+        for (uint32_t i = 0; i < hdr_.ntpids_; ++i) {
+            const cache_t::tpid_ent_t & tpid_ent = tpids_[i];
+            perf_tpid_stats_t &         tpid =
+                pstats->tpids_.emplace(tpid_ent.tpid_, perf_tpid_stats_t{})
+                    .first->second;
+            for (uint64_t j = 0; j < tpid_ent.nfuncs_; ++j) {
+                const cache_t::func_ent_t & func = funcs_[tpid_ent.funcs_ + j];
+                tpid.funcs_.emplace(
+                    perf_func_t{ fcs[func.clump_], func.stats_ });
+            }
+            for (uint64_t j = 0; j < tpid_ent.nedges_; ++j) {
+                const cache_t::edge_ent_t & edge = edges_[tpid_ent.edges_ + j];
+                tpid.edges_.emplace(perf_edge_t{
+                    fcs[edge.from_], fcs[edge.to_],
+                    system::br_insn_t{ edge.br_insn_ }, edge.stats_ });
+            }
+            tpid.agr_func_stats_ = tpid_ent.agr_func_stats_;
+            tpid.agr_edge_stats_ = tpid_ent.agr_edge_stats_;
+        }
+        pstats->agr_func_stats_   = hdr_.agr_func_stats_;
+        pstats->agr_edge_stats_   = hdr_.agr_edge_stats_;
+        pstats->nskipped_samples_ = hdr_.nskipped_samples_;
+    }
+};
+
+static bool
+sample_cache_load(const char *     path,
+                  std::string_view key,
+                  perf_stats_t *   pstats,
+                  size_t           njobs,
+                  uint64_t *       nbytes_out) {
+    assert(pstats->tpids_.empty());
+    const bool partial = nbytes_out != nullptr;
+    if (!file_ops::exists(path)) {
+        return false;
+    }
+    file_ops::mapped_file_t mapping =
+        file_ops::map_file(path, file_ops::k_map_read, false);
+    if (!mapping.active()) {
+        return false;
+    }
+
+    auto [p, sz] = mapping.to_pair();
+    sample_cache_view_t view{};
+    bool                okay =
+        view.init(p, sz, key, pstats->agr_key_, partial);
+    if (okay) {
+        sym::sym_state_t * state = pstats->state_;
+        vec_t<strbuf_t<>>  names{};
+        names.reserve(view.hdr_.ndsos_);
+        for (uint32_t i = 0; i < view.hdr_.ndsos_; ++i) {
+            names.emplace_back(
+                state->get_strtab()->get_sbuf(view.sview(view.dsos_[i].name_)));
+        }
+        if (njobs != 1) {
+            state->preload_dsos(names, njobs);
+        }
+        vec_t<sym::dso_t *> dsos{};
+        dsos.reserve(names.size());
+        for (strbuf_t<> name : names) {
+            dsos.emplace_back(state->get_dso(name));
+        }
+
+        okay = view.check_dsos(dsos);
+        if (okay) {
+            view.apply(state, dsos, pstats);
+        }
+    }
+    if (!okay) {
+        TLO_printv("Ignoring stale %s: %s\n",
+                   partial ? "checkpoint" : "sample cache", path);
+    }
+    else if (partial) {
+        *nbytes_out = view.hdr_.nbytes_;
+    }
+    file_ops::unmap_file(mapping);
+    return okay;
+}
+
+bool
+perf_sample_cache_t::load(const char *     path,
+                          std::string_view key,
+                          perf_stats_t *   pstats,
+                          size_t           njobs) {
+    return sample_cache_load(path, key, pstats, njobs, nullptr);
+}
+
+bool
+perf_sample_cache_t::load_checkpoint(const char *     path,
+                                     std::string_view key,
+                                     perf_stats_t *   pstats,
+                                     size_t           njobs,
+                                     uint64_t *       nbytes_out) {
+    assert(nbytes_out != nullptr);
+    return sample_cache_load(path, key, pstats, njobs, nbytes_out);
+}
+
+// Builds the string section, each unique string is stored once.
+struct sample_cache_strs_t {
+    vec_t<cache_t::str_ent_t>        strs_;
+    vec_t<char>                      blob_;
+    basic_umap<strbuf_t<>, uint32_t> idxs_;
+
+    uint32_t
+    add(std::string_view sv) {
+        auto res = idxs_.emplace(strbuf_t<>{ sv },
+                                 static_cast<uint32_t>(strs_.size()));
+        if (res.second) {
+            strs_.emplace_back(
+                cache_t::str_ent_t{ static_cast<uint32_t>(blob_.size()),
+                                    static_cast<uint32_t>(sv.size()) });
+            sample_cache_append(&blob_, sv);
+            blob_.emplace_back('\0');
+        }
+        return res.first->second;
+    }
+};
+
+// Assigns each function clump an index in the clump section.
+struct sample_cache_clumps_t {
+    vec_t<cache_t::clump_ent_t>                clumps_;
+    umap<const sym::func_clump_t *, uint32_t>  idxs_;
+    const umap<const sym::dso_t *, uint32_t> * dso_idxs_;
+
+    uint32_t
+    add(const sym::func_clump_t * fc) {
+        auto res = idxs_.emplace(fc, static_cast<uint32_t>(clumps_.size()));
+        if (res.second) {
+            const sym::dso_t * dso     = fc->dso();
+            const auto         dso_res = dso_idxs_->find(dso);
+            assert(dso_res != dso_idxs_->end());
+            const sym::addr_range_t first = fc->first()->get_addr_range();
+            clumps_.emplace_back(cache_t::clump_ent_t{
+                dso_res->second,
+                fc->is_unknown()
+                    ? cache_t::k_unknown_clump
+                    : static_cast<uint32_t>(fc - dso->func_clumps().data()),
+                fc->first()->name_.hash(),
+                fc->clumped_range_.lo_addr_inclusive_,
+                fc->clumped_range_.hi_addr_exclusive_, fc->size(),
+                first.lo_addr_inclusive_, first.hi_addr_exclusive_ });
+        }
+        return res.first->second;
+    }
+};
+
+// Write to a temporary and rename so concurrent runs never see a partial
+// cache.
+static bool
+sample_cache_write(const char * path, const vec_t<uint8_t> & bytes) {
+    vec_t<char> tmp_path{};
+    sample_cache_append(&tmp_path, path);
+    sample_cache_append(&tmp_path, ".tmp-");
+    std::array<char, 16> suffix{};
+    if (!randomize_str(suffix.data(), suffix.size())) {
+        return false;
+    }
+    sample_cache_append(&tmp_path, { suffix.data(), suffix.size() });
+    tmp_path.emplace_back('\0');
+
+    int fd = open(tmp_path.data(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                  0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool okay =
+        file_ops::ensure_write(fd, bytes.data(), bytes.size()) == bytes.size();
+    close(fd);
+    if (!okay || rename(tmp_path.data(), path) != 0) {
+        (void)unlink(tmp_path.data());
+        return false;
+    }
+    return true;
+}
+
+bool
+perf_sample_cache_t::save_entry(const char *         path,
+                                std::string_view     key,
+                                const perf_stats_t & pstats,
+                                bool                 partial,
+                                uint64_t             nbytes) {
+    if (!strbuf_t<>::fits(key)) {
+        return false;
+    }
+    hdr_t hdr{};
+    hdr.magic_            = k_magic;
+    hdr.version_          = k_version;
+    hdr.agr_key_          = pstats.agr_key_;
+    hdr.partial_          = partial ? 1U : 0U;
+    hdr.nbytes_           = nbytes;
+    hdr.nskipped_samples_ = pstats.nskipped_samples_;
+    hdr.agr_func_stats_   = pstats.agr_func_stats_;
+    hdr.agr_edge_stats_   = pstats.agr_edge_stats_;
+
+    sample_cache_strs_t strs{};
+    hdr.key_ = strs.add(key);
+
+    vec_t<stat_counter_t> gbl_stats{};
+    global_stats_collect(&gbl_stats);
+    vec_t<stat_ent_t> stats{};
+    for (const stat_counter_t & stat : gbl_stats) {
+        stats.emplace_back(stat_ent_t{ strs.add(stat.first), 0, stat.second });
+    }
+
+    vec_t<dso_ent_t>                   dsos{};
+    vec_t<uint32_t>                    comms{};
+    umap<const sym::dso_t *, uint32_t> dso_idxs{};
+    for (const sym::dso_t * dso : pstats.state_->dsos()) {
+        const uint32_t first_comm = static_cast<uint32_t>(comms.size());
+        if (dso->has_comm_uses()) {
+            for (const strbuf_t<> & comm : dso->comm_uses()) {
+                comms.emplace_back(strs.add(comm.sview()));
+            }
+        }
+        dso_idxs.emplace(dso, static_cast<uint32_t>(dsos.size()));
+        dsos.emplace_back(dso_ent_t{
+            strs.add(dso->complete_filename()),
+            static_cast<uint32_t>(dso->num_func_clumps()), first_comm,
+            static_cast<uint32_t>(comms.size()) - first_comm });
+    }
+
+    sample_cache_clumps_t clumps{};
+    clumps.dso_idxs_ = &dso_idxs;
+    vec_t<tpid_ent_t> tpids{};
+    vec_t<func_ent_t> funcs{};
+    vec_t<edge_ent_t> edges{};
+    for (const auto & tpid_and_stats : pstats.tpids_) {
+        const perf_tpid_stats_t & tpid = tpid_and_stats.second;
+        tpids.emplace_back(tpid_ent_t{ tpid_and_stats.first, funcs.size(),
+                                       tpid.funcs_.size(), edges.size(),
+                                       tpid.edges_.size(),
+                                       tpid.agr_func_stats_,
+                                       tpid.agr_edge_stats_ });
+        for (const perf_func_t & pfunc : tpid.funcs_) {
+            funcs.emplace_back(
+                func_ent_t{ clumps.add(pfunc.func_clump_), 0, pfunc.stats_ });
+        }
+        for (const perf_edge_t & pedge : tpid.edges_) {
+            edges.emplace_back(edge_ent_t{ clumps.add(pedge.from_),
+                                           clumps.add(pedge.to_),
+                                           pedge.br_insn_.desc_idx_,
+                                           { 0, 0, 0 },
+                                           pedge.stats_ });
+        }
+    }
+
+    hdr.nstrs_     = static_cast<uint32_t>(strs.strs_.size());
+    hdr.nstats_    = static_cast<uint32_t>(stats.size());
+    hdr.ndsos_     = static_cast<uint32_t>(dsos.size());
+    hdr.ncomms_    = static_cast<uint32_t>(comms.size());
+    hdr.nclumps_   = static_cast<uint32_t>(clumps.clumps_.size());
+    hdr.ntpids_    = static_cast<uint32_t>(tpids.size());
+    hdr.nfuncs_    = funcs.size();
+    hdr.nedges_    = edges.size();
+    hdr.str_bytes_ = strs.blob_.size();
+
+    const layout_t layout = layout_t::make(hdr);
+    hdr.size_             = layout.size_;
+
+    vec_t<uint8_t> bytes(layout.size_, 0);
+    auto           copy_section = [&bytes](uint64_t off, const auto & vec) {
+        if (!vec.empty()) {
+            memcpy(bytes.data() + off, vec.data(),
+                   vec.size() * sizeof(vec[0]));
+        }
+    };
+    copy_section(layout.strs_, strs.strs_);
+    copy_section(layout.stats_, stats);
+    copy_section(layout.dsos_, dsos);
+    copy_section(layout.comms_, comms);
+    copy_section(layout.clumps_, clumps.clumps_);
+    copy_section(layout.tpids_, tpids);
+    copy_section(layout.funcs_, funcs);
+    copy_section(layout.edges_, edges);
+    copy_section(layout.blob_, strs.blob_);
+    hdr.checksum_ =
+        xxhash::run(bytes.data() + sizeof(hdr_t), bytes.size() - sizeof(hdr_t));
+    memcpy(bytes.data(), &hdr, sizeof(hdr_t));
+
+    return sample_cache_write(path, bytes);
+}
+
+bool
+perf_sample_cache_t::save(const char *         path,
+                          std::string_view     key,
+                          const perf_stats_t & pstats) {
+    return save_entry(path, key, pstats, false, 0);
+}
+
+bool
+perf_sample_cache_t::save_checkpoint(const char *         path,
+                                     std::string_view     key,
+                                     const perf_stats_t & pstats,
+                                     uint64_t             nbytes) {
+    return save_entry(path, key, pstats, true, nbytes);
+}
+
+}  // namespace perf
+}  // namespace tlo
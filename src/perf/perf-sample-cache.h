@@ -0,0 +1,219 @@
+#ifndef SRC_D_PERF_D_PERF_SAMPLE_CACHE_H_
+#define SRC_D_PERF_D_PERF_SAMPLE_CACHE_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Optional on-disk cache of the resolved samples in a `perf_stats_t`. Unlike a
+// save-state (which stores the final filtered/normalized funcs and edges) it
+// stores the per-tpid tables exactly as they were collected, so any filtering,
+// clumping, or scaling can still be done after reloading it. What it skips is
+// reading/parsing the profile, rebuilding the mappings, and looking up every
+// sampled address.
+//
+// Functions are stored as (DSO, index of the clump in the DSO) so the DSO
+// symbols still have to be loaded (use --sym-cache to make that fast as
+// well). The entry is keyed by the size/mtime of the profile it was collected
+// from and it is ignored if that key, the aggregation key, or the symbols of
+// any DSO it references no longer match.
+//
+// The same format is used for the checkpoints of a long events pass (see
+// `perf_checkpoint_t`). A checkpoint also records how many bytes (of whole
+// lines) of the events it had collected and is never loaded as a complete
+// entry (or vice versa).
+
+#include "src/perf/perf-stats-types.h"
+
+#include "src/util/vec.h"
+
+#include <span>
+#include <string_view>
+
+#include <stdint.h>
+
+namespace tlo {
+namespace perf {
+
+struct perf_stats_t;
+
+struct perf_sample_cache_t {
+    static constexpr uint64_t k_magic   = 0x4c504d4153524c54UL;  // TLRSAMPL
+    static constexpr uint32_t k_version = 3;
+
+    // `clump_ent_t::idx_` of the "[unknown]" function of a DSO.
+    static constexpr uint32_t k_unknown_clump = 0xffffffffU;
+
+    // On-disk layout. Offsets are relative to the start of the file and all
+    // sections are 8-byte aligned.
+    struct hdr_t {
+        uint64_t magic_;
+        uint32_t version_;
+        // `perf_agr_key_t` the samples were aggregated by.
+        uint32_t agr_key_;
+        // Checksum of everything after the header.
+        uint64_t checksum_;
+        uint64_t size_;
+        uint32_t nstrs_;
+        uint32_t nstats_;
+        uint32_t ndsos_;
+        uint32_t ncomms_;
+        uint32_t nclumps_;
+        uint32_t ntpids_;
+        uint64_t nfuncs_;
+        uint64_t nedges_;
+        uint64_t str_bytes_;
+        uint64_t nskipped_samples_;
+        // String index.
+        uint32_t key_;
+        // Non-zero for a checkpoint.
+        uint32_t partial_;
+        // Bytes of the events file collected (only for a checkpoint).
+        uint64_t nbytes_;
+
+        perf_func_stats_t agr_func_stats_;
+        perf_edge_stats_t agr_edge_stats_;
+    };
+
+    struct str_ent_t {
+        uint32_t off_;
+        uint32_t len_;
+    };
+
+    struct stat_ent_t {
+        uint32_t name_;
+        uint32_t reserved_;
+        double   val_;
+    };
+
+    // `comms_` is the start of its comm uses in the comm section.
+    struct dso_ent_t {
+        uint32_t name_;
+        uint32_t nclumps_;
+        uint32_t comms_;
+        uint32_t ncomms_;
+    };
+
+    // Either the index of the clump in its DSO or `k_unknown_clump`. The name
+    // hash (of its first function) and ranges are used to check the DSO
+    // symbols haven't changed and to restore clumps that track their sampled
+    // addresses.
+    struct clump_ent_t {
+        uint32_t dso_;
+        uint32_t idx_;
+        uint64_t name_hash_;
+        uint64_t lo_;
+        uint64_t hi_;
+        uint64_t size_;
+        uint64_t first_lo_;
+        uint64_t first_hi_;
+    };
+
+    struct tpid_ent_t {
+        uint64_t          tpid_;
+        uint64_t          funcs_;
+        uint64_t          nfuncs_;
+        uint64_t          edges_;
+        uint64_t          nedges_;
+        perf_func_stats_t agr_func_stats_;
+        perf_edge_stats_t agr_edge_stats_;
+    };
+
+    struct func_ent_t {
+        uint32_t          clump_;
+        uint32_t          reserved_;
+        perf_func_stats_t stats_;
+    };
+
+    struct edge_ent_t {
+        uint32_t          from_;
+        uint32_t          to_;
+        uint16_t          br_insn_;
+        uint16_t          reserved_[3];  // NOLINT(*c-arrays)
+        perf_edge_stats_t stats_;
+    };
+
+    // Section offsets of an entry with the counts in `hdr`.
+    struct layout_t {
+        uint64_t strs_;
+        uint64_t stats_;
+        uint64_t dsos_;
+        uint64_t comms_;
+        uint64_t clumps_;
+        uint64_t tpids_;
+        uint64_t funcs_;
+        uint64_t edges_;
+        uint64_t blob_;
+        uint64_t size_;
+
+        static constexpr uint64_t
+        align(uint64_t off) {
+            return (off + 7U) & -8UL;
+        }
+
+        static constexpr layout_t
+        make(const hdr_t & hdr) {
+            layout_t layout{};
+            layout.strs_   = sizeof(hdr_t);
+            layout.stats_  = layout.strs_ + hdr.nstrs_ * sizeof(str_ent_t);
+            layout.dsos_   = layout.stats_ + hdr.nstats_ * sizeof(stat_ent_t);
+            layout.comms_  = layout.dsos_ + hdr.ndsos_ * sizeof(dso_ent_t);
+            layout.clumps_ =
+                align(layout.comms_ + hdr.ncomms_ * sizeof(uint32_t));
+            layout.tpids_ = layout.clumps_ + hdr.nclumps_ * sizeof(clump_ent_t);
+            layout.funcs_ = layout.tpids_ + hdr.ntpids_ * sizeof(tpid_ent_t);
+            layout.edges_ = layout.funcs_ + hdr.nfuncs_ * sizeof(func_ent_t);
+            layout.blob_  = layout.edges_ + hdr.nedges_ * sizeof(edge_ent_t);
+            layout.size_  = align(layout.blob_ + hdr.str_bytes_);
+            return layout;
+        }
+    };
+
+    // Key for the profile files in `paths`. False if any of them can't be
+    // stat'd.
+    static bool make_key(std::span<const std::string_view> paths,
+                         vec_t<char> *                     key_out);
+
+    // Fill in `pstats` (which must be empty) from the cache entry at `path`.
+    // DSOs are loaded with `njobs` threads. False (and `pstats` left empty) if
+    // there is no valid entry for `key`.
+    static bool load(const char *     path,
+                     std::string_view key,
+                     perf_stats_t *   pstats,
+                     size_t           njobs);
+
+    // Write the collected samples in `pstats` to `path`.
+    static bool save(const char *         path,
+                     std::string_view     key,
+                     const perf_stats_t & pstats);
+
+    // Same as `load` but for a checkpoint, `*nbytes_out` is set to the bytes
+    // of the events file it had collected.
+    static bool load_checkpoint(const char *     path,
+                                std::string_view key,
+                                perf_stats_t *   pstats,
+                                size_t           njobs,
+                                uint64_t *       nbytes_out);
+
+    // Same as `save` but `pstats` has only collected the first `nbytes` bytes
+    // of the events file. Preaggregated samples must have been flushed.
+    static bool save_checkpoint(const char *         path,
+                                std::string_view     key,
+                                const perf_stats_t & pstats,
+                                uint64_t             nbytes);
+
+    // Shared by `save` and `save_checkpoint`.
+    static bool save_entry(const char *         path,
+                           std::string_view     key,
+                           const perf_stats_t & pstats,
+                           bool                 partial,
+                           uint64_t             nbytes);
+};
+
+static_assert(sizeof(perf_sample_cache_t::hdr_t) % 8 == 0);
+static_assert(sizeof(perf_sample_cache_t::clump_ent_t) % 8 == 0);
+static_assert(sizeof(perf_sample_cache_t::tpid_ent_t) % 8 == 0);
+static_assert(sizeof(perf_sample_cache_t::func_ent_t) % 8 == 0);
+static_assert(sizeof(perf_sample_cache_t::edge_ent_t) % 8 == 0);
+
+}  // namespace perf
+}  // namespace tlo
+
+#endif
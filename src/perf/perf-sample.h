@@ -45,6 +45,10 @@ struct lbr_br_sample_t {
     uint8_t  predicted_ : 2;
     uint8_t  in_tx_     : 1;
     uint8_t  aborted_   : 1;
+    // Branch type reported by perf (`perf_brtype_t`). If it maps to a
+    // `br_insn_t` we don't need to decode the instruction to fill in
+    // `br_insn_`.
+    uint8_t  brtype_    : 4;
     // Used to see if we want to track this (i.e we don't want to add `ret`
     // (0xc3) edges to the CFG.
     system::br_insn_t br_insn_;
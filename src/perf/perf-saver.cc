@@ -1,4 +1,5 @@
 #include "src/perf/perf-saver.h"
+#include "src/perf/perf-state-bin.h"
 #include "src/perf/perf-stats.h"
 
 #include "src/util/file-ops.h"
@@ -6,8 +7,11 @@
 
 #include "src/util/debug.h"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
 
+#include <fcntl.h>
 #include <time.h>
 
 
@@ -15,89 +19,15 @@
 // Implementation for producing save states
 //
 // Puts all accumulated information from parsing/processing perf events into
-// a json / reloads said information.
+// a save state (binary, or json for debugging) / reloads said information.
 
 namespace tlo {
 namespace perf {
 
 // When combining multiple save states, we have option to scale the data by
 // either custom factor, or scale all save states s.t there weights will be
-// equal (i.e state A has 10 events and state B has 30 events, we would scale
-// all event in A by factor of 3).
+// equal (see `perf_stats_scaler_t`).
 static constexpr double k_extremely_large_scale_factor = 1000.0 * 1000.0;
-struct perf_stats_scaler_t {
-    static constexpr double k_func_scale_point_dbl =
-        static_cast<double>(k_func_scale_point);
-    static constexpr double k_edge_scale_point_dbl =
-        static_cast<double>(k_edge_scale_point);
-
-    double scale_;
-
-    bool
-    modifies() const {
-        return usable() && scale_ != 1.0;
-    }
-
-    bool
-    usable() const {
-        return scale_ != 0.0;
-    }
-
-    void
-    mul(double scale) {
-        scale_ *= scale;
-    }
-
-
-    bool
-    init(double scale) {
-        scale_ = scale;
-        return true;
-    }
-
-    bool
-    init(const perf_edge_stats_t & pe_stats) {
-        if (pe_stats.empty() || pe_stats.num_edges_ == 0) {
-            scale_ = 1.0;
-            return false;
-        }
-        scale_ =
-            k_edge_scale_point_dbl / static_cast<double>(pe_stats.num_edges_);
-
-        return true;
-    }
-
-    bool
-    init(const perf_func_stats_t & pf_stats) {
-        if (pf_stats.empty() || pf_stats.num_samples_ == 0) {
-            scale_ = 1.0;
-            return false;
-        }
-        scale_ =
-            k_func_scale_point_dbl / static_cast<double>(pf_stats.num_samples_);
-
-        return true;
-    }
-
-    psample_val_t
-    scale_val(double v) const {
-        assert(usable());
-        return static_cast<psample_val_t>(v * scale_);
-    }
-
-    void
-    scale(perf_edge_stats_t * pe_stats_inout) const {
-        assert(usable());
-        pe_stats_inout->num_edges_ =
-            scale_val(static_cast<double>(pe_stats_inout->num_edges_));
-    }
-    void
-    scale(perf_func_stats_t * pf_stats_inout) const {
-        assert(usable());
-        pf_stats_inout->num_samples_ =
-            scale_val(static_cast<double>(pf_stats_inout->num_samples_));
-    }
-};
 
 static bool
 is_perf_edge_stats_normalized(const perf_edge_stats_t & edge_stats) {
@@ -109,18 +39,15 @@ is_perf_func_stats_normalized(const perf_func_stats_t & func_stats) {
     return func_stats.num_samples_ == k_func_scale_point;
 }
 
-static bool
+static void
 write_edge_stats(json_t * js_out, const perf_edge_stats_t & edge_stats) {
     // Only "cnt" (weight) for edges
     (*js_out)["edge_stats"]        = json_t{};
     (*js_out)["edge_stats"]["cnt"] = edge_stats.num_edges_;
-    return true;
 }
 
 static bool
-read_edge_stats(const json_t &              js_in,
-                perf_edge_stats_t *         edge_stats_out,
-                const perf_stats_scaler_t * pe_stats_scaler) {
+read_edge_stats(const json_t & js_in, perf_edge_stats_t * edge_stats_out) {
     if (!js_in.contains("edge_stats")) {
         TLO_TRACE("Missing edge_stats");
         return false;
@@ -131,21 +58,13 @@ read_edge_stats(const json_t &              js_in,
         return false;
     }
 
-    const double        cnt = js_pe_stats["cnt"];
-    perf_stats_scaler_t default_scaler{};
-    if (pe_stats_scaler == nullptr) {
-        default_scaler.init(1.0);
-        pe_stats_scaler = &default_scaler;
-        assert(!pe_stats_scaler->modifies());
-    }
-
-
-    *edge_stats_out = { pe_stats_scaler->scale_val(cnt) };
+    const double cnt = js_pe_stats["cnt"];
+    *edge_stats_out  = { cnt };
     return true;
 }
 
 
-static bool
+static void
 write_func_stats(json_t * js_out, const perf_func_stats_t & func_stats) {
     (*js_out)["func_stats"]        = json_t{};
     (*js_out)["func_stats"]["cnt"] = func_stats.num_samples_;
@@ -155,13 +74,10 @@ write_func_stats(json_t * js_out, const perf_func_stats_t & func_stats) {
         func_stats.num_tracked_br_samples_out_;
     (*js_out)["func_stats"]["total_br_in"]  = func_stats.num_br_samples_in_;
     (*js_out)["func_stats"]["total_br_out"] = func_stats.num_br_samples_out_;
-    return true;
 }
 
 static bool
-read_func_stats(const json_t &              js_in,
-                perf_func_stats_t *         func_stats_out,
-                const perf_stats_scaler_t * pf_stats_scaler) {
+read_func_stats(const json_t & js_in, perf_func_stats_t * func_stats_out) {
     if (!js_in.contains("func_stats")) {
         TLO_TRACE("Missing func_stats");
         return false;
@@ -194,211 +110,424 @@ read_func_stats(const json_t &              js_in,
     const double total_br_in  = js_pf_stats["total_br_in"];
     const double total_br_out = js_pf_stats["total_br_out"];
 
-    perf_stats_scaler_t default_scaler{};
-    if (pf_stats_scaler == nullptr) {
-        default_scaler.init(1.0);
-        pf_stats_scaler = &default_scaler;
-        assert(!pf_stats_scaler->modifies());
-    }
-
-
-    *func_stats_out = { pf_stats_scaler->scale_val(cnt),
-                        static_cast<psample_val_t>(track_br_in),
-                        static_cast<psample_val_t>(track_br_out),
-                        static_cast<psample_val_t>(total_br_in),
-                        static_cast<psample_val_t>(total_br_out) };
+    *func_stats_out = { cnt, track_br_in, track_br_out, total_br_in,
+                        total_br_out };
     return true;
 }
 
-static bool
-write_perf_func(json_t *                                js_out,
-                const perf_func_t &                     pf,
-                basic_uset<const sym::func_clump_t *> * all_fcs) {
-
-    (*js_out)["func_uid"] = reinterpret_cast<uintptr_t>(pf.func_clump_);
-    all_fcs->emplace(pf.func_clump_);
-    return write_func_stats(js_out, pf.stats());
-}
-
-static bool
-write_perf_edge(json_t *                                js_out,
-                const perf_edge_t &                     pe,
-                basic_uset<const sym::func_clump_t *> * all_fcs) {
-    (*js_out)["func_from_uid"] = reinterpret_cast<uintptr_t>(pe.from_);
-    (*js_out)["func_to_uid"]   = reinterpret_cast<uintptr_t>(pe.to_);
-    all_fcs->emplace(pe.from_);
-    all_fcs->emplace(pe.to_);
-    return write_edge_stats(js_out, pe.stats());
-}
-
-
-static bool
-write_func(json_t * js_out, const sym::func_t * func) {
-    (*js_out)["name"]       = func->name_.sview();
-    (*js_out)["ident"]      = func->ident_.sview();
-    (*js_out)["ident_meta"] = func->ident_.extra();
-    (*js_out)["exact_info"] = func->has_elfinfo();
-
-    return true;
-}
-
-static bool
-write_func_clump(json_t * js_out, const sym::func_clump_t * fc) {
-    (*js_out)["uid"]       = reinterpret_cast<uintptr_t>(fc);
-    (*js_out)["dso_uid"]   = reinterpret_cast<uintptr_t>(fc->dso());
-    (*js_out)["size"]      = fc->size();
-    (*js_out)["num_funcs"] = fc->num_funcs();
-
-
-    (*js_out)["funcs"] = json_t::array();
-    for (const sym::func_t & func : fc->funcs()) {
-        json_t js_func{};
-        if (!write_func(&js_func, &func)) {
-            TLO_TRACE("Failure");
-            return false;
+static std::string_view
+make_timestamp(std::array<char, 32> * tmpbuf) {
+    TLO_DISABLE_WREDUNDANT_TAGS
+    struct tm result;
+    TLO_REENABLE_WREDUNDANT_TAGS
+    (*tmpbuf)[0]          = '\0';
+    const time_t cur_time = time(nullptr);
+    if (localtime_r(&cur_time, &result) != nullptr) {
+        // NOLINTNEXTLINE(bugprone-unsafe-functions,cert-msc24-c,cert-msc33-c)
+        if (asctime_r(&result, tmpbuf->data()) == nullptr) {
+            (*tmpbuf)[0] = '\0';
+        }
+        char * nl = reinterpret_cast<char *>(
+            std::memchr(tmpbuf->data(), '\n', tmpbuf->size()));
+        if (nl != nullptr) {
+            *nl = '\0';
         }
-
-        (*js_out)["funcs"].emplace_back(js_func);
     }
-
-
-    return true;
+    return std::string_view{ tmpbuf->data() };
 }
 
-
-static bool
-write_dso(json_t * js_out, const sym::dso_t * dso) {
-    (*js_out)["name"]     = dso->name_.sview();
-    (*js_out)["uid"]      = reinterpret_cast<uintptr_t>(dso);
-    (*js_out)["findable"] = dso->is_findable();
-    if (dso->has_buildids()) {
-        (*js_out)["buildids"] = json_t::array();
-        for (const strbuf_t<> & buildid : dso->buildids()) {
-            (*js_out)["buildids"].emplace_back(buildid.sview());
-        }
+template<typename T_t>
+static void
+add_sviews(vec_t<std::string_view> * svs_out, const T_t & strs) {
+    svs_out->clear();
+    for (const strbuf_t<> & str : strs) {
+        svs_out->emplace_back(str.sview());
     }
-    if (dso->has_comm_uses()) {
-        (*js_out)["comm_uses"] = json_t::array();
-        for (const strbuf_t<> & comm : dso->comm_uses()) {
-            (*js_out)["comm_uses"].emplace_back(comm.sview());
-        }
-    }
-    (*js_out)["deps"] = json_t::array();
-    for (const strbuf_t<> & dep : dso->deps()) {
-        (*js_out)["deps"].emplace_back(dep.sview());
-    }
-    return true;
 }
 
 static bool
-save_state_impl(const char *                 file_path,
+save_state_impl(perf_state_bin_writer_t *    writer,
+                int                          fd,
                 const vec_t<perf_func_t> *   funcs,
                 const vec_t<perf_edge_t> *   edges,
                 const sym::sym_state_t *     state,
                 const perf_state_scaling_t * scaling_todo) {
-    json_t js_out{};
-    js_out["ver"] = k_perf_state_saver_ver;
-    json_t js_scaling{};
-    js_scaling["func_normalized"] =
-        scaling_todo->did_scale(perf_state_scaling_t::k_func_only);
-    js_scaling["edge_normalized"] =
-        scaling_todo->did_scale(perf_state_scaling_t::k_edge_only);
+    using bin_t = perf_state_bin_t;
+
+    uint32_t flags      = 0;
+    double   func_scale = 0.0;
+    double   edge_scale = 0.0;
+    if (scaling_todo->did_scale(perf_state_scaling_t::k_func_only)) {
+        flags |= bin_t::k_func_normalized;
+    }
+    if (scaling_todo->did_scale(perf_state_scaling_t::k_edge_only)) {
+        flags |= bin_t::k_edge_normalized;
+    }
     if (scaling_todo->has_add_scale(perf_state_scaling_t::k_func_only)) {
-        js_scaling["func_scale"] = scaling_todo->added_func_scale();
+        flags |= bin_t::k_has_func_scale;
+        func_scale = scaling_todo->added_func_scale();
     }
     if (scaling_todo->has_add_scale(perf_state_scaling_t::k_edge_only)) {
-        js_scaling["edge_scale"] = scaling_todo->added_edge_scale();
+        flags |= bin_t::k_has_edge_scale;
+        edge_scale = scaling_todo->added_edge_scale();
     }
 
-    js_out["scaling"] = js_scaling;
+    // NOLINTNEXTLINE(*magic*)
+    std::array<char, 32> tmpbuf{ "" };
+    writer->begin(fd, flags, func_scale, edge_scale, make_timestamp(&tmpbuf));
 
+    // Sorted so that the order matches the JSON object.
     vec_t<stat_counter_t> gbl_stats{};
     global_stats_collect(&gbl_stats);
-    json_t js_stats{};
+    std::sort(gbl_stats.begin(), gbl_stats.end(),
+              [](const stat_counter_t & lhs, const stat_counter_t & rhs) {
+                  return std::strcmp(lhs.first, rhs.first) < 0;
+              });
     for (const auto & pair : gbl_stats) {
-        js_stats[pair.first] = pair.second;
-    }
-    js_out["global_stats"] = js_stats;
-
-    {
-        TLO_DISABLE_WREDUNDANT_TAGS
-        struct tm result;
-        TLO_REENABLE_WREDUNDANT_TAGS
-        // NOLINTNEXTLINE(*magic*)
-        std::array<char, 32> tmpbuf{ "" };
-        const time_t         cur_time = time(nullptr);
-        if (localtime_r(&cur_time, &result) != nullptr) {
-            // NOLINTNEXTLINE(bugprone-unsafe-functions,cert-msc24-c,cert-msc33-c)
-            if (asctime_r(&result, tmpbuf.data()) == nullptr) {
-                tmpbuf[0] = '\0';
-            }
-            char * nl = reinterpret_cast<char *>(
-                std::memchr(tmpbuf.data(), '\n', tmpbuf.size()));
-            if (nl != nullptr) {
-                *nl = '\0';
-            }
-        }
-        js_out["timestamp"] = std::string_view{ tmpbuf.data() };
+        writer->add_stat(pair.first, pair.second);
     }
-    js_out["dsos"] = json_t::array();
+
+    vec_t<std::string_view> deps{};
+    vec_t<std::string_view> buildids{};
+    vec_t<std::string_view> comm_uses{};
     for (const sym::dso_t * dso : state->dsos()) {
-        json_t js_dso_out{};
-        if (!write_dso(&js_dso_out, dso)) {
-            TLO_TRACE("Failure");
-            return false;
+        uint32_t dso_flags = 0;
+        if (dso->is_findable()) {
+            dso_flags |= bin_t::k_dso_findable;
+        }
+        add_sviews(&deps, dso->deps());
+        buildids.clear();
+        if (dso->has_buildids()) {
+            dso_flags |= bin_t::k_dso_has_buildids;
+            add_sviews(&buildids, dso->buildids());
         }
-        js_out["dsos"].emplace_back(js_dso_out);
+        comm_uses.clear();
+        if (dso->has_comm_uses()) {
+            dso_flags |= bin_t::k_dso_has_comm_uses;
+            add_sviews(&comm_uses, dso->comm_uses());
+        }
+        writer->add_dso(reinterpret_cast<uintptr_t>(dso), dso->name_.sview(),
+                        dso_flags, deps, buildids, comm_uses);
     }
 
     basic_uset<const sym::func_clump_t *> all_fcs{};
-    js_out["perf_funcs"] = json_t::array();
-    perf_func_stats_t agr_pf_stats{};
+    perf_func_stats_t                     agr_pf_stats{};
     for (const perf_func_t & pf : (*funcs)) {
         agr_pf_stats.add(pf.stats());
-        json_t js_pf_out{};
-        if (!write_perf_func(&js_pf_out, pf, &all_fcs)) {
-            TLO_TRACE("Failure");
-            return false;
-        }
-        js_out["perf_funcs"].emplace_back(js_pf_out);
+        all_fcs.emplace(pf.func_clump_);
+        writer->add_perf_func(reinterpret_cast<uintptr_t>(pf.func_clump_),
+                              pf.stats());
     }
 
-    js_out["perf_edges"] = json_t::array();
     perf_edge_stats_t agr_pe_stats{};
     for (const perf_edge_t & pe : (*edges)) {
-        json_t js_pe_out{};
         agr_pe_stats.add(pe.stats());
-        if (!write_perf_edge(&js_pe_out, pe, &all_fcs)) {
-            TLO_TRACE("Failure");
-            return false;
-        }
-        js_out["perf_edges"].emplace_back(js_pe_out);
+        all_fcs.emplace(pe.from_);
+        all_fcs.emplace(pe.to_);
+        writer->add_perf_edge(reinterpret_cast<uintptr_t>(pe.from_),
+                              reinterpret_cast<uintptr_t>(pe.to_), pe.stats());
     }
-    json_t js_agr_stats{};
-    write_func_stats(&js_agr_stats, agr_pf_stats);
-    write_edge_stats(&js_agr_stats, agr_pe_stats);
-    js_out["perf_aggregate_stats"] = js_agr_stats;
-
 
     if (all_fcs.empty()) {
         TLO_TRACE("Failure");
         return false;
     }
 
-    json_t js_fcs_out{};
-    js_fcs_out["func_clumps"]     = json_t::array();
-    js_fcs_out["num_func_clumps"] = all_fcs.size();
     for (const sym::func_clump_t * fc : all_fcs) {
-        json_t js_fc_out{};
-        if (!write_func_clump(&js_fc_out, fc)) {
-            TLO_TRACE("Failure");
-            return false;
+        writer->add_clump(reinterpret_cast<uintptr_t>(fc),
+                          reinterpret_cast<uintptr_t>(fc->dso()), fc->size(),
+                          fc->num_funcs());
+        for (const sym::func_t & func : fc->funcs()) {
+            writer->add_func(func.name_.sview(), func.ident_.sview(),
+                             func.ident_.extra(), func.has_elfinfo());
+        }
+    }
+
+    return writer->finish(&agr_pf_stats, &agr_pe_stats);
+}
+
+// The JSON save-state is always produced from the binary one so the two
+// formats can't drift apart.
+static void
+perf_state_bin_to_json(const perf_state_bin_view_t & view, json_t * js_out) {
+    using bin_t = perf_state_bin_t;
+
+    (*js_out)["ver"] = k_perf_state_saver_json_ver;
+    json_t js_scaling{};
+    js_scaling["func_normalized"] = view.has(bin_t::k_func_normalized);
+    js_scaling["edge_normalized"] = view.has(bin_t::k_edge_normalized);
+    if (view.has(bin_t::k_has_func_scale)) {
+        js_scaling["func_scale"] = view.hdr_.func_scale_;
+    }
+    if (view.has(bin_t::k_has_edge_scale)) {
+        js_scaling["edge_scale"] = view.hdr_.edge_scale_;
+    }
+    (*js_out)["scaling"] = js_scaling;
+
+    json_t js_stats = json_t::object();
+    for (const bin_t::stat_ent_t & stat : view.stats()) {
+        js_stats[view.sview(stat.name_)] = stat.val_;
+    }
+    (*js_out)["global_stats"] = js_stats;
+    (*js_out)["timestamp"]    = view.sview(view.hdr_.timestamp_);
+
+    auto js_strs = [&view](uint32_t first, uint32_t num) {
+        json_t js_arr = json_t::array();
+        for (const uint32_t str : view.str_list(first, num)) {
+            js_arr.emplace_back(view.sview(str));
+        }
+        return js_arr;
+    };
+    (*js_out)["dsos"] = json_t::array();
+    for (const bin_t::dso_ent_t & dso : view.dsos()) {
+        json_t js_dso{};
+        js_dso["name"]     = view.sview(dso.name_);
+        js_dso["uid"]      = dso.uid_;
+        js_dso["findable"] = (dso.flags_ & bin_t::k_dso_findable) != 0;
+        if ((dso.flags_ & bin_t::k_dso_has_buildids) != 0) {
+            js_dso["buildids"] = js_strs(dso.buildids_, dso.nbuildids_);
+        }
+        if ((dso.flags_ & bin_t::k_dso_has_comm_uses) != 0) {
+            js_dso["comm_uses"] = js_strs(dso.comm_uses_, dso.ncomm_uses_);
+        }
+        js_dso["deps"] = js_strs(dso.deps_, dso.ndeps_);
+        (*js_out)["dsos"].emplace_back(js_dso);
+    }
+
+    (*js_out)["perf_funcs"] = json_t::array();
+    for (const bin_t::perf_func_ent_t & pf : view.perf_funcs()) {
+        json_t js_pf{};
+        js_pf["func_uid"] = pf.uid_;
+        write_func_stats(&js_pf, pf.stats_);
+        (*js_out)["perf_funcs"].emplace_back(js_pf);
+    }
+
+    (*js_out)["perf_edges"] = json_t::array();
+    for (const bin_t::perf_edge_ent_t & pe : view.perf_edges()) {
+        json_t js_pe{};
+        js_pe["func_from_uid"] = pe.from_uid_;
+        js_pe["func_to_uid"]   = pe.to_uid_;
+        write_edge_stats(&js_pe, pe.stats_);
+        (*js_out)["perf_edges"].emplace_back(js_pe);
+    }
+
+    if (view.has(bin_t::k_has_agr_func_stats) ||
+        view.has(bin_t::k_has_agr_edge_stats)) {
+        json_t js_agr_stats{};
+        if (view.has(bin_t::k_has_agr_func_stats)) {
+            write_func_stats(&js_agr_stats, view.hdr_.agr_func_stats_);
+        }
+        if (view.has(bin_t::k_has_agr_edge_stats)) {
+            write_edge_stats(&js_agr_stats, view.hdr_.agr_edge_stats_);
+        }
+        (*js_out)["perf_aggregate_stats"] = js_agr_stats;
+    }
+
+    json_t js_fcs{};
+    js_fcs["func_clumps"]     = json_t::array();
+    js_fcs["num_func_clumps"] = view.clumps().size();
+    for (const bin_t::clump_ent_t & fc : view.clumps()) {
+        json_t js_fc{};
+        js_fc["uid"]       = fc.uid_;
+        js_fc["dso_uid"]   = fc.dso_uid_;
+        js_fc["size"]      = fc.size_;
+        js_fc["num_funcs"] = fc.nfuncs_;
+        js_fc["funcs"]     = json_t::array();
+        for (const bin_t::func_ent_t & func : view.funcs(fc)) {
+            json_t js_func{};
+            js_func["name"]       = view.sview(func.name_);
+            js_func["ident"]      = view.sview(func.ident_);
+            js_func["ident_meta"] = func.ident_meta_;
+            js_func["exact_info"] = func.exact_info_ != 0;
+            js_fc["funcs"].emplace_back(js_func);
+        }
+        js_fcs["func_clumps"].emplace_back(js_fc);
+    }
+    (*js_out)["all_funcs"] = js_fcs;
+}
+
+static bool
+json_to_sviews(const json_t &            js_in,
+               const char *              key,
+               vec_t<std::string_view> * svs_out,
+               vec_t<std::string> *      strs_buf) {
+    svs_out->clear();
+    strs_buf->clear();
+    if (!js_in.contains(key)) {
+        return false;
+    }
+    for (const json_t & js_str : js_in[key]) {
+        strs_buf->emplace_back(js_str.get<std::string>());
+    }
+    for (const std::string & str : *strs_buf) {
+        svs_out->emplace_back(str);
+    }
+    return true;
+}
+
+// Inverse of `perf_state_bin_to_json`. The calls to `writer` are made in the
+// same order `save_state_impl` makes them so this reproduces the original
+// binary save-state exactly.
+TLO_DISABLE_WSTACK_PROTECTOR
+static bool
+perf_state_json_to_bin(const json_t &            js_in,
+                       perf_state_bin_writer_t * writer,
+                       int                       fd) {
+    using bin_t = perf_state_bin_t;
+
+    uint32_t flags      = 0;
+    double   func_scale = 0.0;
+    double   edge_scale = 0.0;
+    if (js_in.contains("scaling")) {
+        const json_t & js_scaling = js_in["scaling"];
+        if (js_scaling.contains("func_normalized") &&
+            js_scaling["func_normalized"].get<bool>()) {
+            flags |= bin_t::k_func_normalized;
+        }
+        if (js_scaling.contains("edge_normalized") &&
+            js_scaling["edge_normalized"].get<bool>()) {
+            flags |= bin_t::k_edge_normalized;
+        }
+        // Older save states have a single "scale" for both.
+        if (js_scaling.contains("scale")) {
+            flags |= bin_t::k_has_func_scale | bin_t::k_has_edge_scale;
+            func_scale = js_scaling["scale"];
+            edge_scale = func_scale;
+        }
+        else {
+            if (js_scaling.contains("func_scale")) {
+                flags |= bin_t::k_has_func_scale;
+                func_scale = js_scaling["func_scale"];
+            }
+            if (js_scaling.contains("edge_scale")) {
+                flags |= bin_t::k_has_edge_scale;
+                edge_scale = js_scaling["edge_scale"];
+            }
+        }
+    }
+
+    const std::string timestamp =
+        js_in.contains("timestamp") ? js_in["timestamp"].get<std::string>()
+                                    : std::string{};
+    writer->begin(fd, flags, func_scale, edge_scale, timestamp);
+
+    if (js_in.contains("global_stats")) {
+        const json_t & js_gstats = js_in["global_stats"];
+        for (auto it = js_gstats.begin(); it != js_gstats.end(); ++it) {
+            writer->add_stat(it.key(), it.value().get<double>());
+        }
+    }
+
+    vec_t<std::string_view> deps{};
+    vec_t<std::string_view> buildids{};
+    vec_t<std::string_view> comm_uses{};
+    vec_t<std::string>      comm_uses_buf{};
+    vec_t<std::string>      deps_buf{};
+    vec_t<std::string>      buildids_buf{};
+    if (js_in.contains("dsos")) {
+        for (const json_t & js_dso : js_in["dsos"]) {
+            if (!js_dso.contains("name") || !js_dso.contains("uid") ||
+                !js_dso.contains("findable") || !js_dso.contains("deps")) {
+                TLO_TRACE("Failure");
+                return false;
+            }
+            uint32_t dso_flags = 0;
+            if (js_dso["findable"].get<bool>()) {
+                dso_flags |= bin_t::k_dso_findable;
+            }
+            json_to_sviews(js_dso, "deps", &deps, &deps_buf);
+            if (json_to_sviews(js_dso, "buildids", &buildids, &buildids_buf)) {
+                dso_flags |= bin_t::k_dso_has_buildids;
+            }
+            if (json_to_sviews(js_dso, "comm_uses", &comm_uses,
+                               &comm_uses_buf)) {
+                dso_flags |= bin_t::k_dso_has_comm_uses;
+            }
+            writer->add_dso(js_dso["uid"].get<uint64_t>(),
+                            js_dso["name"].get<std::string>(), dso_flags, deps,
+                            buildids, comm_uses);
+        }
+    }
+
+    if (js_in.contains("perf_funcs")) {
+        for (const json_t & js_pf : js_in["perf_funcs"]) {
+            perf_func_stats_t pf_stats{};
+            if (!js_pf.contains("func_uid") ||
+                !read_func_stats(js_pf, &pf_stats)) {
+                TLO_TRACE("Failure");
+                return false;
+            }
+            writer->add_perf_func(js_pf["func_uid"].get<uint64_t>(), pf_stats);
+        }
+    }
+
+    if (js_in.contains("perf_edges")) {
+        for (const json_t & js_pe : js_in["perf_edges"]) {
+            perf_edge_stats_t pe_stats{};
+            if (!js_pe.contains("func_from_uid") ||
+                !js_pe.contains("func_to_uid") ||
+                !read_edge_stats(js_pe, &pe_stats)) {
+                TLO_TRACE("Failure");
+                return false;
+            }
+            writer->add_perf_edge(js_pe["func_from_uid"].get<uint64_t>(),
+                                  js_pe["func_to_uid"].get<uint64_t>(),
+                                  pe_stats);
+        }
+    }
+
+    if (js_in.contains("all_funcs") &&
+        js_in["all_funcs"].contains("func_clumps")) {
+        for (const json_t & js_fc : js_in["all_funcs"]["func_clumps"]) {
+            if (!js_fc.contains("uid") || !js_fc.contains("dso_uid") ||
+                !js_fc.contains("size") || !js_fc.contains("num_funcs") ||
+                !js_fc.contains("funcs")) {
+                TLO_TRACE("Failure");
+                return false;
+            }
+            const uint64_t num_funcs = js_fc["num_funcs"];
+            if (js_fc["funcs"].size() != num_funcs) {
+                TLO_TRACE("Failure");
+                return false;
+            }
+            writer->add_clump(js_fc["uid"].get<uint64_t>(),
+                              js_fc["dso_uid"].get<uint64_t>(),
+                              js_fc["size"].get<uint64_t>(), num_funcs);
+            for (const json_t & js_func : js_fc["funcs"]) {
+                if (!js_func.contains("name") || !js_func.contains("ident") ||
+                    !js_func.contains("ident_meta") ||
+                    !js_func.contains("exact_info")) {
+                    TLO_TRACE("Failure");
+                    return false;
+                }
+                writer->add_func(js_func["name"].get<std::string>(),
+                                 js_func["ident"].get<std::string>(),
+                                 js_func["ident_meta"].get<uint16_t>(),
+                                 js_func["exact_info"].get<bool>());
+            }
         }
-        js_fcs_out["func_clumps"].emplace_back(js_fc_out);
     }
-    js_out["all_funcs"] = js_fcs_out;
 
+    perf_func_stats_t agr_pf_stats{};
+    perf_edge_stats_t agr_pe_stats{};
+    bool              has_agr_pf_stats = false;
+    bool              has_agr_pe_stats = false;
+    if (js_in.contains("perf_aggregate_stats")) {
+        has_agr_pf_stats =
+            read_func_stats(js_in["perf_aggregate_stats"], &agr_pf_stats);
+        has_agr_pe_stats =
+            read_edge_stats(js_in["perf_aggregate_stats"], &agr_pe_stats);
+    }
+    return writer->finish(has_agr_pf_stats ? &agr_pf_stats : nullptr,
+                          has_agr_pe_stats ? &agr_pe_stats : nullptr);
+}
+TLO_REENABLE_WSTACK_PROTECTOR
 
+static bool
+write_perf_state_json(const char *                  file_path,
+                      const perf_state_bin_view_t & view) {
+    json_t js_out{};
+    perf_state_bin_to_json(view, &js_out);
     std::string js_content = js_out.dump(1);
     return file_ops::writefile(
         file_path,
@@ -408,15 +537,94 @@ save_state_impl(const char *                 file_path,
 }
 
 bool
-perf_state_saver_t::save_state(
-    const char *                 file_path,
-    const vec_t<perf_func_t> *   funcs,
-    const vec_t<perf_edge_t> *   edges,
-    const perf_state_scaling_t * scaling_todo) const {
+perf_state_saver_t::save_state(const char *                 file_path,
+                               const vec_t<perf_func_t> *   funcs,
+                               const vec_t<perf_edge_t> *   edges,
+                               const perf_state_scaling_t * scaling_todo,
+                               perf_state_fmt_t             fmt) const {
 #if (defined TLO_MSAN)
     assert(0 && "State saving unsupported w/ MSAN");
 #endif
-    return save_state_impl(file_path, funcs, edges, state_, scaling_todo);
+    perf_state_bin_writer_t writer{};
+    if (fmt == k_perf_state_json) {
+        perf_state_bin_view_t view{};
+        if (!save_state_impl(&writer, -1, funcs, edges, state_,
+                             scaling_todo) ||
+            !view.init(writer.bytes().data(), writer.bytes().size())) {
+            return false;
+        }
+        return write_perf_state_json(file_path, view);
+    }
+
+    const int fd = open(file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool okay =
+        save_state_impl(&writer, fd, funcs, edges, state_, scaling_todo);
+    close(fd);
+    return okay;
+}
+
+// A save state from either format. Binary save states are used directly from
+// the mapping, JSON ones are converted to binary in memory.
+struct perf_state_input_t {
+    file_ops::mapped_file_t mapping_;
+    perf_state_bin_writer_t converted_;
+    perf_state_bin_view_t   view_;
+
+    bool
+    init(const char * path) {
+        mapping_ = file_ops::map_file(path, file_ops::k_map_read, false);
+        if (!mapping_.active()) {
+            return false;
+        }
+        const auto [p, sz] = mapping_.to_pair();
+        if (perf_state_bin_t::is_binary(p, sz)) {
+            return view_.init(p, sz);
+        }
+
+        TLO_TRACE("Parseing\n");
+        const json_t js_in = json_t::parse(
+            std::string_view{ reinterpret_cast<const char *>(p), sz }, nullptr,
+            false);
+        if (js_in.is_discarded() ||
+            !perf_state_json_to_bin(js_in, &converted_, -1)) {
+            return false;
+        }
+        return view_.init(converted_.bytes().data(),
+                          converted_.bytes().size());
+    }
+
+    void
+    cleanup() {
+        if (mapping_.active()) {
+            file_ops::unmap_file(mapping_);
+            mapping_.deactivate();
+        }
+    }
+};
+
+bool
+convert_perf_state(const char *     in_path,
+                   const char *     out_path,
+                   perf_state_fmt_t fmt) {
+    perf_state_input_t input{};
+    bool               okay = input.init(in_path);
+    if (!okay) {
+        TLO_perr("Unable to load save-state from: %s\n", in_path);
+    }
+    else if (fmt == k_perf_state_json) {
+        okay = write_perf_state_json(out_path, input.view_);
+    }
+    else {
+        okay = file_ops::writefile(
+            out_path,
+            file_ops::filebuf_t{ input.view_.base_, input.view_.size_ },
+            O_TRUNC);
+    }
+    input.cleanup();
+    return okay;
 }
 
 struct uid_t {
@@ -451,109 +659,62 @@ using uid_to_dso_map_t = basic_umap<uid_t, sym::dso_t *>;
 using pe_set_t = basic_uset<perf_edge_t>;
 using pf_set_t = basic_uset<perf_func_t>;
 
-static bool
-reload_func_state_from_json(const json_t &      js_func,
-                            sym::func_t *       func_out,
-                            const sym ::dso_t * dso,
-                            sym::sym_state_t *  state) {
-    if (!js_func.contains("name")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_func.contains("ident")) {
-        TLO_TRACE("Missing: \"ident\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_func.contains("ident_meta")) {
-        TLO_TRACE("Missing: \"ident_meta\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_func.contains("exact_info")) {
-        TLO_TRACE("Missing: \"exact_info\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-
-    const std::string name_str   = js_func["name"];
-    const std::string ident_str  = js_func["ident"];
-    const uint16_t    ident_meta = js_func["ident_meta"];
-    const bool        exact      = js_func["exact_info"];
-
+static void
+reload_func_state(const perf_state_bin_view_t &       view,
+                  const perf_state_bin_t::func_ent_t & func,
+                  sym::func_t *                       func_out,
+                  const sym ::dso_t *                 dso,
+                  sym::sym_state_t *                  state) {
+    const bool         exact = func.exact_info_ != 0;
     const sym::ident_t ident = {
-        state->get_strtab()->get(std::string_view{ ident_str }).sview(),
-        ident_meta
+        state->get_strtab()->get(view.sview(func.ident_)).sview(),
+        func.ident_meta_
     };
     const strbuf_t<> name_sb =
-        state->get_strtab()->get_sbuf(std::string_view{ name_str });
+        state->get_strtab()->get_sbuf(view.sview(func.name_));
 
     *func_out =
         sym::func_t{ dso, exact, name_sb, ident, sym::addr_range_t{ 0, 0 } };
     assert(func_out->name_.eq(name_sb));
     assert(func_out->ident_.eq(ident));
     assert(func_out->has_elfinfo() == exact);
-    assert(func_out->ident_.extra() == ident_meta);
-    return true;
+    assert(func_out->ident_.extra() == func.ident_meta_);
 }
 
 TLO_DISABLE_WSTACK_PROTECTOR
 static sym::func_clump_t *
-reload_fc_state_from_json(const json_t &           js_fc,
-                          uint64_t                 file_uid,
-                          sym::func_clump_t *      fc_out,
-                          uid_to_fc_map_t *        uids_to_fc_map,
-                          const uid_to_dso_map_t * uids_to_dso_map,
-                          func_to_fc_map_t *       funcs_map,
-                          sym::sym_state_t *       state) {
+reload_fc_state(const perf_state_bin_view_t &        view,
+                const perf_state_bin_t::clump_ent_t & clump,
+                uint64_t                             file_uid,
+                sym::func_clump_t *                  fc_out,
+                uid_to_fc_map_t *                    uids_to_fc_map,
+                const uid_to_dso_map_t *             uids_to_dso_map,
+                func_to_fc_map_t *                   funcs_map,
+                sym::sym_state_t *                   state) {
 
     if (fc_out == nullptr) {
         fc_out = state->get_allocator()->getzT<sym::func_clump_t>();
     }
 
-    if (!js_fc.contains("uid")) {
+    const uid_t dso_and_file_uid = uid_t{ clump.dso_uid_, file_uid };
+    auto        dso_res          = uids_to_dso_map->find(dso_and_file_uid);
+    if (dso_res == uids_to_dso_map->end()) {
         TLO_TRACE("Failure");
         return fc_out;
     }
-    if (!js_fc.contains("dso_uid")) {
-        TLO_TRACE("Failure");
-        return fc_out;
-    }
-    if (!js_fc.contains("size")) {
-        TLO_TRACE("Failure");
-        return fc_out;
-    }
-    if (!js_fc.contains("num_funcs")) {
-        TLO_TRACE("Failure");
-        return fc_out;
-    }
-    if (!js_fc.contains("funcs")) {
-        TLO_TRACE("Failure");
-        return fc_out;
-    }
-
-    const uint64_t dso_uid          = js_fc["dso_uid"];
-    const uid_t    dso_and_file_uid = uid_t{ dso_uid, file_uid };
-    auto           dso_res          = uids_to_dso_map->find(dso_and_file_uid);
-    assert(dso_res != uids_to_dso_map->end());
     sym::dso_t * dso = dso_res->second;
     assert(dso != nullptr);
 
 
-    const uint64_t size      = js_fc["size"];
-    const uint64_t num_funcs = js_fc["num_funcs"];
+    const uint64_t size      = clump.size_;
+    const uint64_t num_funcs = clump.nfuncs_;
 
     sym::func_t * funcs_mem =
         state->get_allocator()->getz_arr<sym::func_t>(num_funcs);
 
     size_t i = 0;
-
-    for (const json_t & js_func : js_fc["funcs"]) {
-        assert(i < num_funcs);
-        if (!reload_func_state_from_json(js_func, funcs_mem + i, dso, state)) {
-            TLO_TRACE("Failure");
-            return fc_out;
-        }
+    for (const perf_state_bin_t::func_ent_t & func : view.funcs(clump)) {
+        reload_func_state(view, func, funcs_mem + i, dso, state);
         ++i;
     }
     assert(i == num_funcs);
@@ -569,9 +730,8 @@ reload_fc_state_from_json(const json_t &           js_fc,
     assert(fc_out->is_reloaded());
     assert(fc_out->is_contiguous());
 
-    const uint64_t      addr_uid = js_fc["uid"];
-    uid_t               uid      = uid_t{ addr_uid, file_uid };
-    sym::func_clump_t * cur_fc   = fc_out;
+    uid_t               uid    = uid_t{ clump.uid_, file_uid };
+    sym::func_clump_t * cur_fc = fc_out;
     for (i = 0; i < num_funcs; ++i) {
         auto res = funcs_map->emplace(
             funcs_mem[i], std::pair<uid_t, sym::func_clump_t *>{ uid, cur_fc });
@@ -622,44 +782,24 @@ TLO_REENABLE_WSTACK_PROTECTOR
 
 TLO_DISABLE_WSTACK_PROTECTOR
 static bool
-reload_dso_state_from_json(const json_t &     js_dso,
-                           uint64_t           file_uid,
-                           uid_to_dso_map_t * uids_to_dso_map,
-                           sym::sym_state_t * state) {
-
-    if (!js_dso.contains("name")) {
-        TLO_TRACE("Missing: \"name\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-
-    const std::string name = js_dso["name"];
-    sym::dso_t *      dso  = state->get_reloaded_dso(std::string_view{ name });
-
-    if (!js_dso.contains("uid")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-
-    const uint64_t addr_uid = js_dso["uid"];
-    const uid_t    uid{ addr_uid, file_uid };
-    assert(uids_to_dso_map->emplace(uid, dso).second);
+reload_dso_state(const perf_state_bin_view_t &      view,
+                 const perf_state_bin_t::dso_ent_t & dso_ent,
+                 uint64_t                           file_uid,
+                 uid_to_dso_map_t *                 uids_to_dso_map,
+                 sym::sym_state_t *                 state) {
+    sym::dso_t * dso = state->get_reloaded_dso(view.sview(dso_ent.name_));
+
+    const uid_t uid{ dso_ent.uid_, file_uid };
+    const bool  inserted = uids_to_dso_map->emplace(uid, dso).second;
+    assert(inserted);
+    (void)inserted;
     assert(dso->from_reload());
 
-    if (!js_dso.contains("findable")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_dso.contains("deps")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-
     basic_uset<strbuf_t<>> deps{};
-    for (const std::string str : js_dso["deps"]) {
-        deps.emplace(state->get_strtab()->get_sbuf(std::string_view{ str }));
+    for (const uint32_t str : view.str_list(dso_ent.deps_, dso_ent.ndeps_)) {
+        deps.emplace(state->get_strtab()->get_sbuf(view.sview(str)));
     }
-    bool findable = js_dso["findable"];
+    bool findable = (dso_ent.flags_ & perf_state_bin_t::k_dso_findable) != 0;
 
     if (dso->finalized_) {
         findable |= dso->is_findable();
@@ -673,16 +813,18 @@ reload_dso_state_from_json(const json_t &     js_dso,
         arr_free<strbuf_t<>>(dso->deps_.data(), dso->deps_.size());
     }
 
-    if (dso->has_comm_uses() && js_dso.contains("comm_uses")) {
-        for (const std::string str : js_dso["comm_uses"]) {
-            dso->add_comm_use(
-                state->get_strtab()->get_sbuf(std::string_view{ str }));
+    if (dso->has_comm_uses() &&
+        (dso_ent.flags_ & perf_state_bin_t::k_dso_has_comm_uses) != 0) {
+        for (const uint32_t str :
+             view.str_list(dso_ent.comm_uses_, dso_ent.ncomm_uses_)) {
+            dso->add_comm_use(state->get_strtab()->get_sbuf(view.sview(str)));
         }
     }
-    if (dso->has_buildids() && js_dso.contains("buildids")) {
-        for (const std::string str : js_dso["buildids"]) {
-            dso->add_buildid(
-                state->get_strtab()->get_sbuf(std::string_view{ str }));
+    if (dso->has_buildids() &&
+        (dso_ent.flags_ & perf_state_bin_t::k_dso_has_buildids) != 0) {
+        for (const uint32_t str :
+             view.str_list(dso_ent.buildids_, dso_ent.nbuildids_)) {
+            dso->add_buildid(state->get_strtab()->get_sbuf(view.sview(str)));
         }
     }
 
@@ -691,8 +833,8 @@ reload_dso_state_from_json(const json_t &     js_dso,
         size_t       i       = 0;
         for (const strbuf_t<> & dep : deps) {
             dep_mem[i] = dep;
+            ++i;
         }
-        ++i;
         dso->deps_ = { dep_mem, deps.size() };
     }
     else {
@@ -710,25 +852,13 @@ reload_dso_state_from_json(const json_t &     js_dso,
 TLO_REENABLE_WSTACK_PROTECTOR
 
 static bool
-reload_pf_stats_from_json(const json_t &              js_pf,
-                          uint64_t                    file_uid,
-                          const uid_to_fc_map_t *     uids_to_fc_map,
-                          pf_set_t *                  funcs_out,
-                          const perf_stats_scaler_t & pf_stats_scaler) {
-    if (!js_pf.contains("func_uid")) {
-        TLO_TRACE("Missing: \"func_uid\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_pf.contains("func_stats")) {
-        TLO_TRACE("Missing: \"func_stats\"");
-        TLO_TRACE("Failure");
-        return false;
-    }
-
-    const uint64_t addr_uid = js_pf["func_uid"];
-    const uid_t    uid{ addr_uid, file_uid };
-    auto           res = uids_to_fc_map->find(uid);
+reload_pf_stats(const perf_state_bin_t::perf_func_ent_t & pf_ent,
+                uint64_t                                  file_uid,
+                const uid_to_fc_map_t *                   uids_to_fc_map,
+                pf_set_t *                                funcs_out,
+                const perf_stats_scaler_t &               pf_stats_scaler) {
+    const uid_t uid{ pf_ent.uid_, file_uid };
+    auto        res = uids_to_fc_map->find(uid);
     if (res == uids_to_fc_map->end()) {
         return false;
     }
@@ -740,40 +870,20 @@ reload_pf_stats_from_json(const json_t &              js_pf,
 
     auto pf_res = funcs_out->emplace(pf);
 
-
-    perf_func_stats_t pf_stats{};
-    if (!read_func_stats(js_pf, &pf_stats, &pf_stats_scaler)) {
-        return false;
-    }
-
+    perf_func_stats_t pf_stats = pf_ent.stats_;
+    pf_stats_scaler.scale(&pf_stats);
     pf_res.first->stats_.add(pf_stats);
     return true;
 }
 
 static bool
-reload_pe_stats_from_json(const json_t &              js_pe,
-                          uint64_t                    file_uid,
-                          const uid_to_fc_map_t *     uids_to_fc_map,
-                          pe_set_t *                  edges_out,
-                          const perf_stats_scaler_t & pe_stats_scaler) {
-    if (!js_pe.contains("func_from_uid")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_pe.contains("func_to_uid")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-    if (!js_pe.contains("edge_stats")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-
-    const uint64_t from_addr_uid = js_pe["func_from_uid"];
-    const uint64_t to_addr_uid   = js_pe["func_to_uid"];
-
-    const uid_t from_uid{ from_addr_uid, file_uid };
-    const uid_t to_uid{ to_addr_uid, file_uid };
+reload_pe_stats(const perf_state_bin_t::perf_edge_ent_t & pe_ent,
+                uint64_t                                  file_uid,
+                const uid_to_fc_map_t *                   uids_to_fc_map,
+                pe_set_t *                                edges_out,
+                const perf_stats_scaler_t &               pe_stats_scaler) {
+    const uid_t from_uid{ pe_ent.from_uid_, file_uid };
+    const uid_t to_uid{ pe_ent.to_uid_, file_uid };
 
     assert(!from_uid.eq(to_uid));
 
@@ -809,33 +919,25 @@ reload_pe_stats_from_json(const json_t &              js_pe,
 
     auto pe_res = edges_out->emplace(pe);
 
-
-    perf_edge_stats_t pe_stats{};
-    if (!read_edge_stats(js_pe, &pe_stats, &pe_stats_scaler)) {
-        return false;
-    }
+    perf_edge_stats_t pe_stats = pe_ent.stats_;
+    pe_stats_scaler.scale(&pe_stats);
     pe_res.first->stats_.add(pe_stats);
     return true;
 }
 
 static bool
-reload_state_from_func_clumps(const json_t &           js_in,
-                              uint64_t                 file_uid,
-                              uid_to_fc_map_t *        uids_to_fc_map,
-                              const uid_to_dso_map_t * uids_to_dso_map,
-                              func_to_fc_map_t *       funcs_map,
-                              sym::sym_state_t *       state) {
-    if (!js_in.contains("func_clumps")) {
-        TLO_TRACE("Failure");
-        return false;
-    }
-
+reload_state_from_func_clumps(const perf_state_bin_view_t & view,
+                              uint64_t                      file_uid,
+                              uid_to_fc_map_t *             uids_to_fc_map,
+                              const uid_to_dso_map_t *      uids_to_dso_map,
+                              func_to_fc_map_t *            funcs_map,
+                              sym::sym_state_t *            state) {
     bool                ret        = false;
     sym::func_clump_t * fc_realloc = nullptr;
-    for (const json_t & js_fc : js_in["func_clumps"]) {
-        fc_realloc = reload_fc_state_from_json(js_fc, file_uid, fc_realloc,
-                                               uids_to_fc_map, uids_to_dso_map,
-                                               funcs_map, state);
+    for (const perf_state_bin_t::clump_ent_t & clump : view.clumps()) {
+        fc_realloc = reload_fc_state(view, clump, file_uid, fc_realloc,
+                                     uids_to_fc_map, uids_to_dso_map,
+                                     funcs_map, state);
         if (fc_realloc == nullptr) {
             ret = true;
         }
@@ -849,6 +951,7 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
                                     vec_t<perf_func_t> *            funcs_out,
                                     vec_t<perf_edge_t> *            edges_out,
                                     perf_state_scaling_t * scaling_todo) const {
+    using bin_t = perf_state_bin_t;
 
 #if (defined TLO_MSAN)
     assert(0 && "State saving unsupported w/ MSAN");
@@ -858,30 +961,26 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
         scaling_todo = &default_scaling_todo;
     }
     TLO_TRACE("At reload\n");
-    bool          ret = false;
-    vec_t<json_t> js_inputs{};
-    js_inputs.reserve(file_paths->size());
+    bool                      ret = false;
+    vec_t<perf_state_input_t> inputs{};
+    vec_t<std::string_view>   input_paths{};
+    inputs.reserve(file_paths->size());
     for (const std::string_view & sview : *file_paths) {
         TLO_printv("Reload From: %s\n", sview.data());
-        TLO_TRACE("Parseing\n");
-        file_ops::filebuf_t content = file_ops::readfile(sview.data());
-        if (!content.active()) {
+        inputs.emplace_back();
+        if (!inputs.back().init(sview.data())) {
             TLO_perr("Warning: Unable to load save-state from: %s\n",
                      sview.data());
+            inputs.back().cleanup();
+            inputs.pop_back();
             continue;
         }
-        js_inputs.emplace_back(json_t::parse(std::string_view{
-            reinterpret_cast<const char *>(content.data()), content.size() }));
-
-        content.cleanup();
+        input_paths.emplace_back(sview);
     }
-    for (const json_t & js_in : js_inputs) {
-        if (js_in.contains("global_stats")) {
-            const json_t & js_gstats = js_in["global_stats"];
-            for (auto it = js_gstats.begin(); it != js_gstats.end(); ++it) {
-                const uint64_t val = js_gstats[it.key()];
-                global_stats_reload(stat_counter_t{ it.key().c_str(), val });
-            }
+    for (const perf_state_input_t & input : inputs) {
+        for (const bin_t::stat_ent_t & stat : input.view_.stats()) {
+            global_stats_reload(stat_counter_t{
+                input.view_.sview(stat.name_).data(), stat.val_ });
         }
     }
 
@@ -896,12 +995,10 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
 
     uint64_t file_uid = 0;
     TLO_TRACE("Doing DSOS");
-    for (const json_t & js_in : js_inputs) {
-        if (js_in.contains("dsos")) {
-            for (const json_t & js_dso : js_in["dsos"]) {
-                ret |= reload_dso_state_from_json(js_dso, file_uid,
-                                                  &uids_to_dso_map, state_);
-            }
+    for (const perf_state_input_t & input : inputs) {
+        for (const bin_t::dso_ent_t & dso : input.view_.dsos()) {
+            ret |= reload_dso_state(input.view_, dso, file_uid,
+                                    &uids_to_dso_map, state_);
         }
         ++file_uid;
     }
@@ -909,53 +1006,37 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
     TLO_TRACE("Doing Funcs");
     file_uid = 0;
     // reload functions first so we can create edges as we reload them.
-    for (const json_t & js_in : js_inputs) {
-        if (js_in.contains("all_funcs")) {
-            ret |= reload_state_from_func_clumps(
-                js_in["all_funcs"], file_uid, &uids_to_fc_map, &uids_to_dso_map,
-                &funcs_map, state_);
-        }
+    for (const perf_state_input_t & input : inputs) {
+        ret |= reload_state_from_func_clumps(input.view_, file_uid,
+                                             &uids_to_fc_map, &uids_to_dso_map,
+                                             &funcs_map, state_);
         ++file_uid;
     }
 
     file_uid = 0;
     TLO_TRACE("Doing Perf Info");
-    for (const json_t & js_in : js_inputs) {
-        bool   is_func_scaled     = false;
-        bool   is_edge_scaled     = false;
-        double local_func_scaling = 1.0;
-        double local_edge_scaling = 1.0;
-        if (js_in.contains("scaling")) {
-            if (js_in["scaling"].contains("func_normalized")) {
-                is_func_scaled = js_in["scaling"]["func_normalized"];
-            }
-            if (js_in["scaling"].contains("edge_normalized")) {
-                is_edge_scaled = js_in["scaling"]["edge_normalized"];
-            }
-            if (js_in["scaling"].contains("scale")) {
-                local_func_scaling = js_in["scaling"]["scale"];
-                local_edge_scaling = js_in["scaling"]["scale"];
-            }
-            else {
-                if (js_in["scaling"].contains("func_scale")) {
-                    local_func_scaling = js_in["scaling"]["func_scale"];
-                }
-
-                if (js_in["scaling"].contains("edge_scale")) {
-                    local_edge_scaling = js_in["scaling"]["edge_scale"];
-                }
-            }
-        }
+    for (const perf_state_input_t & input : inputs) {
+        const perf_state_bin_view_t & view = input.view_;
+        const char * const            path = input_paths[file_uid].data();
+
+        const bool is_func_scaled     = view.has(bin_t::k_func_normalized);
+        const bool is_edge_scaled     = view.has(bin_t::k_edge_normalized);
+        double     local_func_scaling = view.has(bin_t::k_has_func_scale)
+                                            ? view.hdr_.func_scale_
+                                            : 1.0;
+        double     local_edge_scaling = view.has(bin_t::k_has_edge_scale)
+                                            ? view.hdr_.edge_scale_
+                                            : 1.0;
         if (local_func_scaling <= 0.0) {
             TLO_perr(
                 "Func scaling is invalid:\n\t%s -> %lf\nDefaulting to 1.0\n",
-                (*file_paths)[file_uid].data(), local_func_scaling);
+                path, local_func_scaling);
             local_func_scaling = 1.0;
         }
         if (local_edge_scaling <= 0.0) {
             TLO_perr(
                 "Edge scaling is invalid:\n\t%s -> %lf\nDefaulting to 1.0\n",
-                (*file_paths)[file_uid].data(), local_edge_scaling);
+                path, local_edge_scaling);
             local_edge_scaling = 1.0;
         }
 
@@ -964,20 +1045,12 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
         perf_func_stats_t agr_pf_stats{};
         perf_edge_stats_t agr_pe_stats{};
         if (scaling_todo->should_scale(perf_state_scaling_t::k_func_only)) {
-            if (!js_in.contains("perf_aggregate_stats") ||
-                !read_func_stats(js_in["perf_aggregate_stats"], &agr_pf_stats,
-                                 nullptr)) {
-
-                for (const json_t & js_pf : js_in["perf_funcs"]) {
-                    perf_func_stats_t pf_stats{};
-                    if (!read_func_stats(js_pf, &pf_stats, nullptr)) {
-                        TLO_perr(
-                            "Unable to aggregate perf function stats for normalization\n\t%s\n",
-                            (*file_paths)[file_uid].data());
-                        agr_pf_stats = {};
-                        break;
-                    }
-                    agr_pf_stats.add(pf_stats);
+            if (view.has(bin_t::k_has_agr_func_stats)) {
+                agr_pf_stats = view.hdr_.agr_func_stats_;
+            }
+            else {
+                for (const bin_t::perf_func_ent_t & pf : view.perf_funcs()) {
+                    agr_pf_stats.add(pf.stats_);
                 }
             }
         }
@@ -985,33 +1058,24 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
         if (!pf_stats_scaler.init(agr_pf_stats)) {
             if (scaling_todo->should_scale(perf_state_scaling_t::k_func_only)) {
                 TLO_perr("Unable to normalize perf function stats\n\t%s\n",
-                         (*file_paths)[file_uid].data());
+                         path);
             }
         }
 
         if (scaling_todo->should_scale(perf_state_scaling_t::k_edge_only)) {
-            if (!js_in.contains("perf_aggregate_stats") ||
-                !read_edge_stats(js_in["perf_aggregate_stats"], &agr_pe_stats,
-                                 nullptr)) {
-
-                for (const json_t & js_pe : js_in["perf_edges"]) {
-                    perf_edge_stats_t pe_stats{};
-                    if (!read_edge_stats(js_pe, &pe_stats, nullptr)) {
-                        TLO_perr(
-                            "Unable to aggregate perf edge stats for normalization\n\t%s\n",
-                            (*file_paths)[file_uid].data());
-                        agr_pe_stats = {};
-                        break;
-                    }
-                    agr_pe_stats.add(pe_stats);
+            if (view.has(bin_t::k_has_agr_edge_stats)) {
+                agr_pe_stats = view.hdr_.agr_edge_stats_;
+            }
+            else {
+                for (const bin_t::perf_edge_ent_t & pe : view.perf_edges()) {
+                    agr_pe_stats.add(pe.stats_);
                 }
             }
         }
         perf_stats_scaler_t pe_stats_scaler{};
         if (!pe_stats_scaler.init(agr_pe_stats)) {
             if (scaling_todo->should_scale(perf_state_scaling_t::k_edge_only)) {
-                TLO_perr("Unable to normalize perf edge stats\n\t%s\n",
-                         (*file_paths)[file_uid].data());
+                TLO_perr("Unable to normalize perf edge stats\n\t%s\n", path);
             }
         }
 
@@ -1019,10 +1083,10 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
             !is_perf_func_stats_normalized(agr_pf_stats)) {
             TLO_perr(
                 "Normalization is disabled but save state has already been normalized\n\t%s\n",
-                (*file_paths)[file_uid].data());
+                path);
             if (!scaling_todo->force_no_scale(
                     perf_state_scaling_t::k_func_only)) {
-                return false;
+                break;
             }
         }
 
@@ -1030,10 +1094,10 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
             !is_perf_edge_stats_normalized(agr_pe_stats)) {
             TLO_perr(
                 "Normalization is disabled but save state has already been normalized\n\t%s\n",
-                (*file_paths)[file_uid].data());
+                path);
             if (!scaling_todo->force_no_scale(
                     perf_state_scaling_t::k_edge_only)) {
-                return false;
+                break;
             }
         }
 
@@ -1070,32 +1134,33 @@ perf_state_reloader_t::reload_state(const vec_t<std::string_view> * file_paths,
             !pe_stats_scaler.modifies());
 
 
-        if (js_in.contains("perf_funcs")) {
-            for (const json_t & js_pf : js_in["perf_funcs"]) {
-                ret |= reload_pf_stats_from_json(
-                    js_pf, file_uid, &uids_to_fc_map, &all_pf, pf_stats_scaler);
-            }
+        if (view.perf_funcs().empty()) {
+            TLO_perr("No perf function stats in save state: %s\n", path);
         }
-        else {
-            TLO_perr("No perf function stats in save state: %s\n",
-                     (*file_paths)[file_uid].data());
+        for (const bin_t::perf_func_ent_t & pf : view.perf_funcs()) {
+            ret |= reload_pf_stats(pf, file_uid, &uids_to_fc_map, &all_pf,
+                                   pf_stats_scaler);
         }
 
         TLO_TRACE("Doing Perf Edges");
 
-        if (js_in.contains("perf_edges")) {
-            for (const json_t & js_pe : js_in["perf_edges"]) {
-                ret |= reload_pe_stats_from_json(
-                    js_pe, file_uid, &uids_to_fc_map, &all_pe, pe_stats_scaler);
-            }
+        if (view.perf_edges().empty()) {
+            TLO_perr("No perf edges stats in save state: %s\n", path);
         }
-        else {
-            TLO_perr("No perf edges stats in save state: %s\n",
-                     (*file_paths)[file_uid].data());
+        for (const bin_t::perf_edge_ent_t & pe : view.perf_edges()) {
+            ret |= reload_pe_stats(pe, file_uid, &uids_to_fc_map, &all_pe,
+                                   pe_stats_scaler);
         }
         ++file_uid;
     }
 
+    for (perf_state_input_t & input : inputs) {
+        input.cleanup();
+    }
+    if (file_uid != inputs.size()) {
+        return false;
+    }
+
 
     funcs_out->clear();
     funcs_out->reserve(all_pf.size());
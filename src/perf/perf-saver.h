@@ -12,13 +12,106 @@
 namespace tlo {
 namespace perf {
 
-static constexpr uint32_t      k_perf_state_saver_ver = 0;
+// Version of the binary save-state format (see perf-state-bin.h). JSON
+// save-states still have the original version.
+static constexpr uint32_t      k_perf_state_saver_ver      = 1;
+static constexpr uint32_t      k_perf_state_saver_json_ver = 0;
 static constexpr psample_val_t k_func_scale_point =
     static_cast<psample_val_t>(1UL << 20U);
 static constexpr psample_val_t k_edge_scale_point =
     static_cast<psample_val_t>(1UL << 30U);
 
 
+// When combining multiple profiles/save states they can be scaled s.t their
+// weights are equal (i.e state A has 10 events and state B has 30 events, we
+// would scale all event in A by factor of 3).
+struct perf_stats_scaler_t {
+    static constexpr double k_func_scale_point_dbl =
+        static_cast<double>(k_func_scale_point);
+    static constexpr double k_edge_scale_point_dbl =
+        static_cast<double>(k_edge_scale_point);
+
+    double scale_;
+
+    bool
+    modifies() const {
+        return usable() && scale_ != 1.0;
+    }
+
+    bool
+    usable() const {
+        return scale_ != 0.0;
+    }
+
+    void
+    mul(double scale) {
+        scale_ *= scale;
+    }
+
+
+    bool
+    init(double scale) {
+        scale_ = scale;
+        return true;
+    }
+
+    bool
+    init(const perf_edge_stats_t & pe_stats) {
+        if (pe_stats.empty() || pe_stats.num_edges_ == 0) {
+            scale_ = 1.0;
+            return false;
+        }
+        scale_ =
+            k_edge_scale_point_dbl / static_cast<double>(pe_stats.num_edges_);
+
+        return true;
+    }
+
+    bool
+    init(const perf_func_stats_t & pf_stats) {
+        if (pf_stats.empty() || pf_stats.num_samples_ == 0) {
+            scale_ = 1.0;
+            return false;
+        }
+        scale_ =
+            k_func_scale_point_dbl / static_cast<double>(pf_stats.num_samples_);
+
+        return true;
+    }
+
+    psample_val_t
+    scale_val(double v) const {
+        assert(usable());
+        return static_cast<psample_val_t>(v * scale_);
+    }
+
+    void
+    scale(perf_edge_stats_t * pe_stats_inout) const {
+        assert(usable());
+        pe_stats_inout->num_edges_ =
+            scale_val(static_cast<double>(pe_stats_inout->num_edges_));
+    }
+    void
+    scale(perf_func_stats_t * pf_stats_inout) const {
+        assert(usable());
+        pf_stats_inout->num_samples_ =
+            scale_val(static_cast<double>(pf_stats_inout->num_samples_));
+    }
+
+    // The branch totals of a function bound the tracked branches summed from
+    // its edges. If the edges are scaled before they are summed (i.e
+    // collecting `--profiles`) the totals have to be scaled with them.
+    void
+    scale_br_samples(perf_func_stats_t * pf_stats_inout) const {
+        assert(usable());
+        pf_stats_inout->num_br_samples_in_ =
+            scale_val(static_cast<double>(pf_stats_inout->num_br_samples_in_));
+        pf_stats_inout->num_br_samples_out_ =
+            scale_val(static_cast<double>(pf_stats_inout->num_br_samples_out_));
+    }
+};
+
+
 // Scaling information for how we want to reload / save a given state.
 struct perf_state_scaling_t {
 
@@ -155,6 +248,14 @@ struct perf_state_scaling_t {
     }
 };
 
+// Save-states are written as JSON by default (scripts/ read them as such). The
+// compact binary format holds the same information and is much faster to write
+// and reload. Reloading accepts either.
+enum perf_state_fmt_t : uint8_t {
+    k_perf_state_binary,
+    k_perf_state_json,
+};
+
 // Create save state at file path
 struct perf_state_saver_t {
     const sym::sym_state_t * const state_;
@@ -162,9 +263,16 @@ struct perf_state_saver_t {
     bool save_state(const char *                 file_path,
                     const vec_t<perf_func_t> *   funcs,
                     const vec_t<perf_edge_t> *   edges,
-                    const perf_state_scaling_t * scaling_todo) const;
+                    const perf_state_scaling_t * scaling_todo,
+                    perf_state_fmt_t             fmt = k_perf_state_json) const;
 };
 
+// Convert the save state at `in_path` (either format) to `fmt` at `out_path`.
+// Converting back gives exactly the original.
+bool convert_perf_state(const char *     in_path,
+                        const char *     out_path,
+                        perf_state_fmt_t fmt);
+
 // Reload all save states from the vec for file_paths.
 struct perf_state_reloader_t {
     sym::sym_state_t * const state_;
@@ -0,0 +1,297 @@
+#include "src/perf/perf-state-bin.h"
+#include "src/perf/perf-saver.h"
+
+#include "src/util/file-ops.h"
+
+namespace tlo {
+namespace perf {
+
+bool
+perf_state_bin_view_t::init(const uint8_t * p, size_t sz) {
+    base_ = p;
+    size_ = sz;
+    if (sz < sizeof(bin_t::hdr_t)) {
+        return false;
+    }
+    memcpy(&hdr_, p, sizeof(bin_t::hdr_t));
+    if (hdr_.magic_ != bin_t::k_magic ||
+        hdr_.version_ != k_perf_state_saver_ver || hdr_.size_ != sz ||
+        (hdr_.flags_ & (~bin_t::k_known_flags)) != 0) {
+        return false;
+    }
+
+    // Sections must be in order, not overlap the header or each other, and
+    // (other than the blob) be 8-byte aligned.
+    uint64_t min_off = sizeof(bin_t::hdr_t);
+    for (uint32_t i = 0; i < bin_t::k_num_sections; ++i) {
+        const bin_t::section_t & section = hdr_.sections_[i];
+        if (section.off_ < min_off || section.off_ > sz ||
+            section.num_ > (sz - section.off_) / bin_t::k_ent_sizes[i]) {
+            return false;
+        }
+        if (i != bin_t::k_blob && (section.off_ % 8) != 0) {
+            return false;
+        }
+        min_off = section.off_ + section.num_ * bin_t::k_ent_sizes[i];
+    }
+
+    const uint64_t nstrs      = hdr_.sections_[bin_t::k_strs].num_;
+    const uint64_t blob_bytes = hdr_.sections_[bin_t::k_blob].num_;
+    const char *   blob       = reinterpret_cast<const char *>(
+        base_ + hdr_.sections_[bin_t::k_blob].off_);
+    for (const bin_t::str_ent_t & str :
+         section<bin_t::str_ent_t>(bin_t::k_strs)) {
+        if (str.off_ >= blob_bytes || str.len_ >= blob_bytes - str.off_ ||
+            blob[str.off_ + str.len_] != '\0') {
+            return false;
+        }
+    }
+    if (hdr_.timestamp_ >= nstrs) {
+        return false;
+    }
+
+    for (const bin_t::stat_ent_t & stat : stats()) {
+        if (stat.name_ >= nstrs) {
+            return false;
+        }
+    }
+
+    const std::span<const uint32_t> str_lists =
+        section<uint32_t>(bin_t::k_str_lists);
+    for (const uint32_t str : str_lists) {
+        if (str >= nstrs) {
+            return false;
+        }
+    }
+    auto valid_list = [&str_lists](uint32_t first, uint32_t num) {
+        return first <= str_lists.size() && num <= str_lists.size() - first;
+    };
+    for (const bin_t::dso_ent_t & dso : dsos()) {
+        if (dso.name_ >= nstrs ||
+            (dso.flags_ & (~bin_t::k_dso_known_flags)) != 0 ||
+            !valid_list(dso.deps_, dso.ndeps_) ||
+            !valid_list(dso.buildids_, dso.nbuildids_) ||
+            !valid_list(dso.comm_uses_, dso.ncomm_uses_)) {
+            return false;
+        }
+    }
+
+    for (const bin_t::func_ent_t & func :
+         section<bin_t::func_ent_t>(bin_t::k_funcs)) {
+        if (func.name_ >= nstrs || func.ident_ >= nstrs ||
+            func.exact_info_ > 1) {
+            return false;
+        }
+    }
+
+    uint64_t next_func = 0;
+    for (const bin_t::clump_ent_t & clump : clumps()) {
+        if (clump.funcs_ != next_func ||
+            clump.nfuncs_ > hdr_.sections_[bin_t::k_funcs].num_ - next_func) {
+            return false;
+        }
+        next_func += clump.nfuncs_;
+    }
+    return next_func == hdr_.sections_[bin_t::k_funcs].num_;
+}
+
+void
+perf_state_bin_writer_t::begin(int              fd,
+                               uint32_t         flags,
+                               double           func_scale,
+                               double           edge_scale,
+                               std::string_view timestamp) {
+    fd_               = fd;
+    okay_             = true;
+    cur_section_      = bin_t::k_stats;
+    flushed_          = 0;
+    clump_funcs_left_ = 0;
+
+    hdr_             = bin_t::hdr_t{};
+    hdr_.magic_      = bin_t::k_magic;
+    hdr_.version_    = k_perf_state_saver_ver;
+    hdr_.flags_      = flags;
+    hdr_.func_scale_ = func_scale;
+    hdr_.edge_scale_ = edge_scale;
+
+    buf_.clear();
+    clumps_.clear();
+    str_lists_.clear();
+    strs_.clear();
+    blob_.clear();
+    str_idxs_.clear();
+
+    // Filled in by `finish`.
+    buf_.resize(sizeof(bin_t::hdr_t), 0);
+    hdr_.sections_[bin_t::k_stats].off_ = sizeof(bin_t::hdr_t);
+    hdr_.timestamp_                     = intern(timestamp);
+}
+
+uint32_t
+perf_state_bin_writer_t::intern(std::string_view sv) {
+    auto res = str_idxs_.find(sv);
+    if (res != str_idxs_.end()) {
+        return res->second;
+    }
+    const uint32_t idx = static_cast<uint32_t>(strs_.size());
+    strs_.emplace_back(bin_t::str_ent_t{ blob_.size(), sv.size() });
+    std::copy(sv.begin(), sv.end(), std::back_inserter(blob_));
+    blob_.emplace_back('\0');
+    str_idxs_.emplace(std::string{ sv }, idx);
+    return idx;
+}
+
+void
+perf_state_bin_writer_t::flush() {
+    if (fd_ < 0 || buf_.empty()) {
+        return;
+    }
+    if (file_ops::ensure_write(fd_, buf_.data(), buf_.size()) != buf_.size()) {
+        okay_ = false;
+    }
+    flushed_ += buf_.size();
+    buf_.clear();
+}
+
+void
+perf_state_bin_writer_t::append(const void * p, size_t sz) {
+    const uint8_t * bytes = reinterpret_cast<const uint8_t *>(p);
+    buf_.insert(buf_.end(), bytes, bytes + sz);
+    if (fd_ >= 0 && buf_.size() >= k_flush_size) {
+        flush();
+    }
+}
+
+// Sections we skip over are left empty at the current offset.
+void
+perf_state_bin_writer_t::enter(bin_t::section_idx_t idx) {
+    assert(idx >= cur_section_);
+    if (idx == cur_section_) {
+        return;
+    }
+    static constexpr std::array<uint8_t, 8> k_pad = { {} };
+    uint64_t                                 off  = flushed_ + buf_.size();
+    if (idx != bin_t::k_blob && (off % 8) != 0) {
+        append(k_pad.data(), 8 - (off % 8));
+        off = flushed_ + buf_.size();
+    }
+    for (uint32_t i = cur_section_ + 1; i <= idx; ++i) {
+        hdr_.sections_[i].off_ = off;
+    }
+    cur_section_ = idx;
+}
+
+void
+perf_state_bin_writer_t::add_stat(std::string_view name, double val) {
+    append_ent(bin_t::k_stats, bin_t::stat_ent_t{ intern(name), 0, val });
+}
+
+void
+perf_state_bin_writer_t::add_dso(uint64_t                        uid,
+                                 std::string_view                name,
+                                 uint32_t                        flags,
+                                 const vec_t<std::string_view> & deps,
+                                 const vec_t<std::string_view> & buildids,
+                                 const vec_t<std::string_view> & comm_uses) {
+    bin_t::dso_ent_t dso{};
+    dso.uid_   = uid;
+    dso.name_  = intern(name);
+    dso.flags_ = flags;
+
+    dso.deps_  = static_cast<uint32_t>(str_lists_.size());
+    dso.ndeps_ = static_cast<uint32_t>(deps.size());
+    for (const std::string_view sv : deps) {
+        str_lists_.emplace_back(intern(sv));
+    }
+    dso.buildids_  = static_cast<uint32_t>(str_lists_.size());
+    dso.nbuildids_ = static_cast<uint32_t>(buildids.size());
+    for (const std::string_view sv : buildids) {
+        str_lists_.emplace_back(intern(sv));
+    }
+    dso.comm_uses_  = static_cast<uint32_t>(str_lists_.size());
+    dso.ncomm_uses_ = static_cast<uint32_t>(comm_uses.size());
+    for (const std::string_view sv : comm_uses) {
+        str_lists_.emplace_back(intern(sv));
+    }
+    append_ent(bin_t::k_dsos, dso);
+}
+
+void
+perf_state_bin_writer_t::add_perf_func(uint64_t                  uid,
+                                       const perf_func_stats_t & stats) {
+    append_ent(bin_t::k_perf_funcs, bin_t::perf_func_ent_t{ uid, stats });
+}
+
+void
+perf_state_bin_writer_t::add_perf_edge(uint64_t                  from_uid,
+                                       uint64_t                  to_uid,
+                                       const perf_edge_stats_t & stats) {
+    append_ent(bin_t::k_perf_edges,
+               bin_t::perf_edge_ent_t{ from_uid, to_uid, stats });
+}
+
+void
+perf_state_bin_writer_t::add_clump(uint64_t uid,
+                                   uint64_t dso_uid,
+                                   uint64_t size,
+                                   uint64_t nfuncs) {
+    assert(clump_funcs_left_ == 0);
+    enter(bin_t::k_funcs);
+    clumps_.emplace_back(bin_t::clump_ent_t{
+        uid, dso_uid, size, hdr_.sections_[bin_t::k_funcs].num_, nfuncs });
+    clump_funcs_left_ = nfuncs;
+}
+
+void
+perf_state_bin_writer_t::add_func(std::string_view name,
+                                  std::string_view ident,
+                                  uint16_t         ident_meta,
+                                  bool             exact_info) {
+    assert(clump_funcs_left_ != 0);
+    --clump_funcs_left_;
+    append_ent(bin_t::k_funcs,
+               bin_t::func_ent_t{ intern(name), intern(ident), ident_meta,
+                                  static_cast<uint16_t>(exact_info), 0 });
+}
+
+bool
+perf_state_bin_writer_t::finish(const perf_func_stats_t * agr_func_stats,
+                                const perf_edge_stats_t * agr_edge_stats) {
+    assert(clump_funcs_left_ == 0);
+    if (agr_func_stats != nullptr) {
+        hdr_.flags_ |= bin_t::k_has_agr_func_stats;
+        hdr_.agr_func_stats_ = *agr_func_stats;
+    }
+    if (agr_edge_stats != nullptr) {
+        hdr_.flags_ |= bin_t::k_has_agr_edge_stats;
+        hdr_.agr_edge_stats_ = *agr_edge_stats;
+    }
+
+    auto write_section = [this](bin_t::section_idx_t idx, const auto & vec) {
+        enter(idx);
+        if (!vec.empty()) {
+            append(vec.data(), vec.size() * sizeof(vec[0]));
+        }
+        hdr_.sections_[idx].num_ = vec.size();
+    };
+    write_section(bin_t::k_clumps, clumps_);
+    write_section(bin_t::k_str_lists, str_lists_);
+    write_section(bin_t::k_strs, strs_);
+    write_section(bin_t::k_blob, blob_);
+    hdr_.size_ = flushed_ + buf_.size();
+
+    if (fd_ < 0) {
+        memcpy(buf_.data(), &hdr_, sizeof(bin_t::hdr_t));
+        return okay_;
+    }
+    flush();
+    if (file_ops::ensure_write(fd_, reinterpret_cast<const uint8_t *>(&hdr_),
+                               sizeof(bin_t::hdr_t),
+                               0) != sizeof(bin_t::hdr_t)) {
+        okay_ = false;
+    }
+    return okay_;
+}
+
+}  // namespace perf
+}  // namespace tlo
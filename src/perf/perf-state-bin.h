@@ -0,0 +1,327 @@
+#ifndef SRC_D_PERF_D_PERF_STATE_BIN_H_
+#define SRC_D_PERF_D_PERF_STATE_BIN_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Binary save-state format. It holds exactly what the JSON save-state does
+// (see perf-saver.cc), but as fixed-width records that reference a shared
+// string table, so reloading is just mapping the file and walking the records.
+//
+// Records are streamed out section by section (stats, dsos, perf funcs, perf
+// edges, funcs). Only the small sections (clumps, string lists, and the
+// strings themselves) are kept in memory until `finish`, which writes them and
+// then fills in the header. Records keep the order they are added in, and
+// strings are numbered in the order they are first seen, so converting
+// between the binary and JSON formats gives back exactly what we started with.
+
+#include "src/perf/perf-stats-types.h"
+
+#include "src/util/compiler.h"
+#include "src/util/umap.h"
+#include "src/util/vec.h"
+#include "src/util/xxhash.h"
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace tlo {
+namespace perf {
+
+struct perf_state_bin_t {
+    static constexpr uint64_t k_magic = 0x45544154534f4c54UL;  // TLOSTATE
+
+    // Header flags.
+    static constexpr uint32_t k_func_normalized    = 0x1;
+    static constexpr uint32_t k_edge_normalized    = 0x2;
+    static constexpr uint32_t k_has_func_scale     = 0x4;
+    static constexpr uint32_t k_has_edge_scale     = 0x8;
+    static constexpr uint32_t k_has_agr_func_stats = 0x10;
+    static constexpr uint32_t k_has_agr_edge_stats = 0x20;
+    static constexpr uint32_t k_known_flags        = 0x3f;
+    // DSO flags.
+    static constexpr uint32_t k_dso_findable      = 0x1;
+    static constexpr uint32_t k_dso_has_buildids  = 0x2;
+    static constexpr uint32_t k_dso_has_comm_uses = 0x4;
+    static constexpr uint32_t k_dso_known_flags   = 0x7;
+
+    // In file order. Everything up to (and including) `k_funcs` is streamed.
+    enum section_idx_t : uint32_t {
+        k_stats,
+        k_dsos,
+        k_perf_funcs,
+        k_perf_edges,
+        k_funcs,
+        k_clumps,
+        k_str_lists,
+        k_strs,
+        k_blob,
+        k_num_sections,
+    };
+
+    struct section_t {
+        uint64_t off_;
+        uint64_t num_;
+    };
+
+    struct hdr_t {
+        uint64_t          magic_;
+        uint32_t          version_;
+        uint32_t          flags_;
+        uint64_t          size_;
+        double            func_scale_;
+        double            edge_scale_;
+        perf_func_stats_t agr_func_stats_;
+        perf_edge_stats_t agr_edge_stats_;
+        uint32_t          timestamp_;
+        uint32_t          reserved_;
+
+        std::array<section_t, k_num_sections> sections_;
+    };
+
+    struct stat_ent_t {
+        uint32_t name_;
+        uint32_t reserved_;
+        double   val_;
+    };
+
+    // `deps_`, `buildids_`, and `comm_uses_` are the start of their lists in
+    // the string list section.
+    struct dso_ent_t {
+        uint64_t uid_;
+        uint32_t name_;
+        uint32_t flags_;
+        uint32_t deps_;
+        uint32_t ndeps_;
+        uint32_t buildids_;
+        uint32_t nbuildids_;
+        uint32_t comm_uses_;
+        uint32_t ncomm_uses_;
+    };
+
+    struct perf_func_ent_t {
+        uint64_t          uid_;
+        perf_func_stats_t stats_;
+    };
+
+    struct perf_edge_ent_t {
+        uint64_t          from_uid_;
+        uint64_t          to_uid_;
+        perf_edge_stats_t stats_;
+    };
+
+    struct func_ent_t {
+        uint32_t name_;
+        uint32_t ident_;
+        uint16_t ident_meta_;
+        uint16_t exact_info_;
+        uint32_t reserved_;
+    };
+
+    // Clumps cover the functions, in order.
+    struct clump_ent_t {
+        uint64_t uid_;
+        uint64_t dso_uid_;
+        uint64_t size_;
+        uint64_t funcs_;
+        uint64_t nfuncs_;
+    };
+
+    // Strings are NUL terminated in the blob (`len_` doesn't include it).
+    struct str_ent_t {
+        uint64_t off_;
+        uint64_t len_;
+    };
+
+    static constexpr std::array<size_t, k_num_sections> k_ent_sizes = { {
+        sizeof(stat_ent_t),
+        sizeof(dso_ent_t),
+        sizeof(perf_func_ent_t),
+        sizeof(perf_edge_ent_t),
+        sizeof(func_ent_t),
+        sizeof(clump_ent_t),
+        sizeof(uint32_t),
+        sizeof(str_ent_t),
+        sizeof(char),
+    } };
+
+    static bool
+    is_binary(const uint8_t * p, size_t sz) {
+        uint64_t magic;
+        if (sz < sizeof(magic)) {
+            return false;
+        }
+        memcpy(&magic, p, sizeof(magic));
+        return magic == k_magic;
+    }
+};
+
+static_assert(sizeof(perf_state_bin_t::hdr_t) % 8 == 0);
+static_assert(sizeof(perf_state_bin_t::perf_func_ent_t) == 48);
+static_assert(sizeof(perf_state_bin_t::perf_edge_ent_t) == 24);
+
+// Validated view of a binary save-state in memory.
+struct perf_state_bin_view_t {
+    using bin_t = perf_state_bin_t;
+
+    const uint8_t * base_;
+    size_t          size_;
+    bin_t::hdr_t    hdr_;
+
+    bool init(const uint8_t * p, size_t sz);
+
+    template<typename T_t>
+    std::span<const T_t>
+    section(bin_t::section_idx_t idx) const {
+        assert(bin_t::k_ent_sizes[idx] == sizeof(T_t));
+        TLO_DISABLE_WCAST_ALIGN
+        return { reinterpret_cast<const T_t *>(base_ +
+                                               hdr_.sections_[idx].off_),
+                 hdr_.sections_[idx].num_ };
+        TLO_REENABLE_WCAST_ALIGN
+    }
+
+    std::span<const bin_t::stat_ent_t>
+    stats() const {
+        return section<bin_t::stat_ent_t>(bin_t::k_stats);
+    }
+    std::span<const bin_t::dso_ent_t>
+    dsos() const {
+        return section<bin_t::dso_ent_t>(bin_t::k_dsos);
+    }
+    std::span<const bin_t::perf_func_ent_t>
+    perf_funcs() const {
+        return section<bin_t::perf_func_ent_t>(bin_t::k_perf_funcs);
+    }
+    std::span<const bin_t::perf_edge_ent_t>
+    perf_edges() const {
+        return section<bin_t::perf_edge_ent_t>(bin_t::k_perf_edges);
+    }
+    std::span<const bin_t::clump_ent_t>
+    clumps() const {
+        return section<bin_t::clump_ent_t>(bin_t::k_clumps);
+    }
+    std::span<const bin_t::func_ent_t>
+    funcs(const bin_t::clump_ent_t & clump) const {
+        return section<bin_t::func_ent_t>(bin_t::k_funcs)
+            .subspan(clump.funcs_, clump.nfuncs_);
+    }
+    std::span<const uint32_t>
+    str_list(uint32_t first, uint32_t num) const {
+        return section<uint32_t>(bin_t::k_str_lists).subspan(first, num);
+    }
+
+    std::string_view
+    sview(uint32_t idx) const {
+        assert(idx < hdr_.sections_[bin_t::k_strs].num_);
+        const bin_t::str_ent_t & str =
+            section<bin_t::str_ent_t>(bin_t::k_strs)[idx];
+        return { reinterpret_cast<const char *>(
+                     base_ + hdr_.sections_[bin_t::k_blob].off_ + str.off_),
+                 str.len_ };
+    }
+
+    bool
+    has(uint32_t flag) const {
+        return (hdr_.flags_ & flag) != 0;
+    }
+};
+
+// Writes a binary save-state either to `fd` or (if `fd` is negative) to
+// memory. Records must be added in section order, and each clump's functions
+// right after it.
+struct perf_state_bin_writer_t {
+    using bin_t = perf_state_bin_t;
+
+    static constexpr size_t k_flush_size = 1UL << 20U;
+
+    struct str_hasher_t {
+        using is_transparent = void;
+        using is_avalanching = void;
+
+        uint64_t
+        operator()(std::string_view sv) const noexcept {
+            return xxhash::run(sv.data(), sv.size());
+        }
+    };
+
+    int      fd_;
+    bool     okay_;
+    uint32_t cur_section_;
+    uint64_t flushed_;
+    uint64_t clump_funcs_left_;
+
+    bin_t::hdr_t              hdr_;
+    vec_t<uint8_t>            buf_;
+    vec_t<bin_t::clump_ent_t> clumps_;
+    vec_t<uint32_t>           str_lists_;
+    vec_t<bin_t::str_ent_t>   strs_;
+    vec_t<char>               blob_;
+    umap<std::string, uint32_t, str_hasher_t, std::equal_to<>> str_idxs_;
+
+    void begin(int              fd,
+               uint32_t         flags,
+               double           func_scale,
+               double           edge_scale,
+               std::string_view timestamp);
+
+    void add_stat(std::string_view name, double val);
+
+    void add_dso(uint64_t                        uid,
+                 std::string_view                name,
+                 uint32_t                        flags,
+                 const vec_t<std::string_view> & deps,
+                 const vec_t<std::string_view> & buildids,
+                 const vec_t<std::string_view> & comm_uses);
+
+    void add_perf_func(uint64_t uid, const perf_func_stats_t & stats);
+
+    void add_perf_edge(uint64_t                  from_uid,
+                       uint64_t                  to_uid,
+                       const perf_edge_stats_t & stats);
+
+    void add_clump(uint64_t uid,
+                   uint64_t dso_uid,
+                   uint64_t size,
+                   uint64_t nfuncs);
+
+    void add_func(std::string_view name,
+                  std::string_view ident,
+                  uint16_t         ident_meta,
+                  bool             exact_info);
+
+    // Either aggregate can be nullptr if it is unknown. Returns false if any
+    // write failed.
+    bool finish(const perf_func_stats_t * agr_func_stats,
+                const perf_edge_stats_t * agr_edge_stats);
+
+    // The whole save-state for an in-memory writer (valid after `finish`).
+    std::span<const uint8_t>
+    bytes() const {
+        assert(fd_ < 0);
+        return { buf_.data(), buf_.size() };
+    }
+
+    uint32_t intern(std::string_view sv);
+    void     enter(bin_t::section_idx_t idx);
+    void     append(const void * p, size_t sz);
+    void     flush();
+
+    template<typename T_t>
+    void
+    append_ent(bin_t::section_idx_t idx, const T_t & ent) {
+        assert(bin_t::k_ent_sizes[idx] == sizeof(T_t));
+        enter(idx);
+        append(&ent, sizeof(T_t));
+        ++hdr_.sections_[idx].num_;
+    }
+};
+
+}  // namespace perf
+}  // namespace tlo
+
+#endif
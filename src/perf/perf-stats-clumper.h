@@ -10,6 +10,10 @@
 #include "src/util/global-stats.h"
 #include "src/util/umap.h"
 #include "src/util/verbosity.h"
+
+#include <algorithm>
+#include <utility>
+
 namespace tlo {
 namespace perf {
 struct perf_stats_clumper_t {
@@ -22,7 +26,52 @@ struct perf_stats_clumper_t {
 };
 
 
+// Clumps perf functions together if they overlap (first by address, then by
+// name). Which functions end up together is tracked with a union-find over
+// their index in the address sorted functions. Address merges always go into
+// the lowest index, name merges into the same clump the original fixpoint
+// picked.
 struct perf_stats_function_order_clumper_t : perf_stats_clumper_t {
+    struct clump_sets_t {
+        vec_t<size_t> parents_;
+
+        void
+        init(size_t n) {
+            parents_.clear();
+            parents_.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                parents_.emplace_back(i);
+            }
+        }
+
+        size_t
+        find(size_t i) {
+            while (parents_[i] != i) {
+                parents_[i] = parents_[parents_[i]];
+                i           = parents_[i];
+            }
+            return i;
+        }
+
+        bool
+        unite(size_t lhs, size_t rhs) {
+            lhs = find(lhs);
+            rhs = find(rhs);
+            if (lhs == rhs) {
+                return false;
+            }
+            if (rhs < lhs) {
+                std::swap(lhs, rhs);
+            }
+            parents_[rhs] = lhs;
+            return true;
+        }
+
+        bool
+        is_root(size_t i) const {
+            return parents_[i] == i;
+        }
+    };
 
     void
     clump(vec_t<perf_func_t> * pfuncs_inout,
@@ -35,154 +84,163 @@ struct perf_stats_function_order_clumper_t : perf_stats_clumper_t {
         TLO_ADD_STAT(total_funcs_, pfuncs_inout->size());
         TLO_ADD_STAT(total_edges_, pedges_inout->size());
 
-        // Clump any functions whose addressed overlap.
-        vec_t<perf_func_t *> remapping;
+        vec_t<perf_func_t> & pfuncs = *pfuncs_inout;
+        const size_t         nfuncs = pfuncs.size();
+        clump_sets_t         sets;
         size_t               i, e;
-        perf_func_t *        last = &(*pfuncs_inout)[0];
-        remapping.reserve(pfuncs_inout->size());
-        remapping.emplace_back(last);
-        for (i = 1, e = pfuncs_inout->size(); i < e; ++i) {
-            perf_func_t * cur = &(*pfuncs_inout)[i];
-            assert(last != cur);
-            assert(last->func_clump_ != cur->func_clump_);
-
-            if (perf_func_t::overlap(last, cur)) {
-                last->func_clump_->dump(2, stdout, "Addr Adding To:   ");
+        sets.init(nfuncs);
+
+        // Clump any functions whose addressed overlap. The functions are
+        // sorted by address so this is a single sweep. We merge as we go as
+        // the next function needs to be checked against the whole clump.
+        size_t last = 0;
+        for (i = 1; i < nfuncs; ++i) {
+            perf_func_t * cur = &pfuncs[i];
+            assert(pfuncs[last].func_clump_ != cur->func_clump_);
+
+            if (perf_func_t::overlap(&pfuncs[last], cur)) {
+                pfuncs[last].func_clump_->dump(2, stdout, "Addr Adding To:   ");
                 cur->func_clump_->dump(2, stdout, "Addr Adding From: ");
-                last->merge(cur);
-                last->func_clump_->dump(2, stdout, "Addr Merged:   ");
+                pfuncs[last].merge(cur);
+                pfuncs[last].func_clump_->dump(2, stdout, "Addr Merged:   ");
+                sets.parents_[i] = last;
             }
             else {
-                last = cur;
-            }
-            remapping.emplace_back(last);
-        }
-
-
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            if (&(*pfuncs_inout)[i] != remapping[i]) {
-                for (size_t j = 0; j < e; ++j) {
-                    assert(remapping[j] != &(*pfuncs_inout)[i]);
-                }
+                last = i;
             }
         }
 
-        for (const perf_func_t * pf : remapping) {
-            assert(pf->valid());
-        }
-
 #if (defined TLO_DEBUG_ENABLED) || (defined TLO_DEBUG_ENABLED_GLBL)
         // test:
-        assert(remapping.size() == pfuncs_inout->size());
-        for (i = 0, e = pfuncs_inout->size(); i < e; ++i) {
-            assert(perf_func_t::overlap(remapping[i], &(*pfuncs_inout)[i]));
-            if (remapping[i] == &(*pfuncs_inout)[i]) {
-                assert(remapping[i]->func_clump_->num_funcs() >=
-                       (*pfuncs_inout)[i].func_clump_->num_funcs());
-                assert(remapping[i]->func_clump_->size() >=
-                       (*pfuncs_inout)[i].func_clump_->size());
+        for (i = 0; i < nfuncs; ++i) {
+            const size_t root = sets.parents_[i];
+            assert(sets.is_root(root));
+            assert(perf_func_t::overlap(&pfuncs[root], &pfuncs[i]));
+            if (root == i) {
+                assert(pfuncs[i].valid());
             }
             else {
-                assert(!remapping[i]->func_clump_->is_contiguous());
-                assert(!remapping[i]->func_clump_->is_single());
-                assert(remapping[i]->func_clump_->num_funcs() >
-                       (*pfuncs_inout)[i].func_clump_->num_funcs());
-                assert(remapping[i]->func_clump_->size() >
-                       (*pfuncs_inout)[i].func_clump_->size());
+                assert(!pfuncs[root].func_clump_->is_contiguous());
+                assert(!pfuncs[root].func_clump_->is_single());
+                assert(pfuncs[root].func_clump_->num_funcs() >
+                       pfuncs[i].func_clump_->num_funcs());
+                assert(pfuncs[root].func_clump_->size() >
+                       pfuncs[i].func_clump_->size());
             }
         }
-
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            if (&(*pfuncs_inout)[i] != remapping[i]) {
-                for (size_t j = 0; j < e; ++j) {
-                    assert(remapping[j] != &(*pfuncs_inout)[i]);
-                }
-            }
-        }
-        for (const perf_func_t * pf : remapping) {
-            assert(pf->valid());
-        }
 #endif
-        // Clump any functions with the same name.
-        bool changed = false;
-        umap<const sym::func_t *, perf_func_t *, sym::func_t::name_hasher_t,
+
+        // Clump any functions with the same name. Every name maps to the
+        // first clump it was seen in, and any later clump with the name is
+        // joined to that one. That is one pass to find which clumps end up
+        // together.
+        vec_t<size_t> addr_roots;
+        umap<const sym::func_t *, size_t, sym::func_t::name_hasher_t,
              sym::func_t::name_equals_t>
             name_to_clump;
         TLO_DISABLE_WALLOC_ZERO
-        name_to_clump.reserve(remapping.size() + 256UL);
+        name_to_clump.reserve(nfuncs + 256UL);
         TLO_REENABLE_WALLOC_ZERO
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            if (remapping[i] != &(*pfuncs_inout)[i]) {
-                //                continue;
+        for (i = 0; i < nfuncs; ++i) {
+            if (!sets.is_root(i)) {
+                continue;
             }
-            perf_func_t * cur = remapping[i];
-            for (const sym::func_t & func : cur->func_clump_->funcs_) {
-                name_to_clump.emplace(&func, cur);
+            addr_roots.emplace_back(i);
+            for (const sym::func_t & func : pfuncs[i].func_clump_->funcs_) {
+                auto res = name_to_clump.emplace(&func, i);
+                if (!res.second) {
+                    sets.unite(res.first->second, i);
+                }
+            }
+        }
+
+        // Which clump they merge into (and so the order of the functions in
+        // it) must match what the old fixpoint did: in index order, each clump
+        // merges into whatever clump the first of its names that maps
+        // elsewhere maps to, until nothing changes. In a chain that isn't
+        // always the lowest one so replay that within each group of clumps
+        // sharing names. The groups are independent and almost always just a
+        // couple of clumps.
+        vec_t<std::pair<size_t, size_t>> named;
+        for (const size_t idx : addr_roots) {
+            const size_t root = sets.find(idx);
+            if (root != idx) {
+                named.emplace_back(root, idx);
             }
         }
-        do {
-            changed = false;
-            for (i = 0, e = remapping.size(); i < e; ++i) {
-                if (remapping[i] != &(*pfuncs_inout)[i]) {
-                    for (;;) {
-                        perf_func_t * remap = remapping[i];
-                        size_t        idx =
-                            static_cast<size_t>(remap - pfuncs_inout->data());
-                        assert(idx < e);
-                        if (remapping[idx] == &(*pfuncs_inout)[idx]) {
+        for (const auto & root_and_idx : named) {
+            sets.parents_[root_and_idx.second] = root_and_idx.second;
+        }
+        std::sort(named.begin(), named.end());
+        vec_t<size_t> group;
+        for (size_t lo = 0, hi = 0; lo < named.size(); lo = hi) {
+            group.clear();
+            group.emplace_back(named[lo].first);
+            for (hi = lo;
+                 hi < named.size() && named[hi].first == named[lo].first;
+                 ++hi) {
+                group.emplace_back(named[hi].second);
+            }
+
+            bool changed = false;
+            do {
+                changed = false;
+                for (const size_t idx : group) {
+                    if (!sets.is_root(idx)) {
+                        continue;
+                    }
+                    size_t tgt = idx;
+                    for (const sym::func_t & func :
+                         pfuncs[idx].func_clump_->funcs_) {
+                        auto res = name_to_clump.find(&func);
+                        assert(res != name_to_clump.end());
+                        if (res->second != idx) {
+                            tgt = res->second;
                             break;
                         }
-                        changed      = true;
-                        remapping[i] = remapping[idx];
                     }
-
-                    continue;
-                }
-                perf_func_t * cur = remapping[i];
-                perf_func_t * tgt = nullptr;
-                for (const sym::func_t & func : cur->func_clump_->funcs_) {
-                    auto res = name_to_clump.find(&func);
-                    assert(res != name_to_clump.end());
-                    if (res->second != cur) {
-                        tgt = res->second;
-                        break;
+                    if (tgt == idx) {
+                        continue;
                     }
-                }
-                if (tgt != nullptr) {
                     changed = true;
-                    for (const sym::func_t & func : cur->func_clump_->funcs_) {
+                    for (const sym::func_t & func :
+                         pfuncs[idx].func_clump_->funcs_) {
                         name_to_clump.erase(&func);
                     }
-                    for (const sym::func_t & func : tgt->func_clump_->funcs_) {
+                    for (const sym::func_t & func :
+                         pfuncs[tgt].func_clump_->funcs_) {
                         name_to_clump.erase(&func);
                     }
-                    tgt->func_clump_->dump(2, stdout, "Name Adding To:   ");
-                    cur->func_clump_->dump(2, stdout, "Name Adding From: ");
-                    tgt->merge(cur);
-                    remapping[i] = tgt;
-                    tgt->func_clump_->dump(2, stdout, "Name Merged:   ");
-                    for (const sym::func_t & func : tgt->func_clump_->funcs_) {
+                    pfuncs[tgt].func_clump_->dump(2, stdout,
+                                                  "Name Adding To:   ");
+                    pfuncs[idx].func_clump_->dump(2, stdout,
+                                                  "Name Adding From: ");
+                    pfuncs[tgt].merge(&pfuncs[idx]);
+                    sets.parents_[idx] = tgt;
+                    pfuncs[tgt].func_clump_->dump(2, stdout,
+                                                  "Name Merged:   ");
+                    for (const sym::func_t & func :
+                         pfuncs[tgt].func_clump_->funcs_) {
                         name_to_clump[&func] = tgt;
                     }
                 }
-            }
-        } while (changed);
+            } while (changed);
+        }
+        for (i = 0; i < nfuncs; ++i) {
+            sets.parents_[i] = sets.find(i);
+        }
+
 #if (defined TLO_DEBUG_ENABLED) || (defined TLO_DEBUG_ENABLED_GLBL)
         // test:
         name_to_clump.clear();
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            perf_func_t * cur = remapping[i];
-            for (const sym::func_t & func : cur->func_clump_->funcs_) {
-                auto res = name_to_clump.emplace(&func, cur);
-                assert(!res.second || res.first->second == cur);
+        for (i = 0; i < nfuncs; ++i) {
+            if (!sets.is_root(i)) {
+                assert(sets.is_root(sets.parents_[i]));
+                continue;
             }
-        }
-
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            if (&(*pfuncs_inout)[i] != remapping[i]) {
-                for (size_t j = 0; j < e; ++j) {
-                    assert(remapping[j] != &(*pfuncs_inout)[i]);
-                }
+            for (const sym::func_t & func : pfuncs[i].func_clump_->funcs_) {
+                [[maybe_unused]] auto res = name_to_clump.emplace(&func, i);
+                assert(res.second || res.first->second == i);
             }
         }
 #endif
@@ -191,12 +249,15 @@ struct perf_stats_function_order_clumper_t : perf_stats_clumper_t {
         // the same time.
         basic_umap<const sym::func_clump_t *, perf_func_t *> fc_remapping;
         TLO_DISABLE_WALLOC_ZERO
-        fc_remapping.reserve(remapping.size());
+        fc_remapping.reserve(nfuncs);
         TLO_REENABLE_WALLOC_ZERO
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            assert(fc_remapping
-                       .emplace((*pfuncs_inout)[i].func_clump_, remapping[i])
-                       .second);
+        for (i = 0; i < nfuncs; ++i) {
+            const bool inserted =
+                fc_remapping
+                    .emplace(pfuncs[i].func_clump_, &pfuncs[sets.parents_[i]])
+                    .second;
+            assert(inserted);
+            (void)inserted;
         }
 
 
@@ -247,62 +308,31 @@ struct perf_stats_function_order_clumper_t : perf_stats_clumper_t {
             mapped_to->second->add_edge_stats(pe.stats(), true);
         }
 
-
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            perf_func_t *lo, *hi;
-            lo = &(*pfuncs_inout)[i];
-            if (lo == remapping[i]) {
+        // Move the clumps we kept to the front, filling each hole with the
+        // last kept clump.
+        size_t lo = 0, hi = nfuncs;
+        while (lo < hi) {
+            if (sets.is_root(lo)) {
+                ++lo;
                 continue;
             }
-            for (; i < (--e);) {
-                hi = &(*pfuncs_inout)[e];
-                if (hi == remapping[e]) {
-                    std::swap((*pfuncs_inout)[i], (*pfuncs_inout)[e]);
-                    remapping[e] = remapping[i];
-                    remapping[i] = &(*pfuncs_inout)[i];
-                    assert(&(*pfuncs_inout)[i] == remapping[i]);
-                    assert(&(*pfuncs_inout)[e] != remapping[e]);
-                    break;
-                }
-            }
-        }
-        assert(i == e);
-        size_t pfuncs_out_size = i;
-
-        // test:
-        name_to_clump.clear();
-        bool expec_same = true;
-        for (i = 0, e = remapping.size(); i < e; ++i) {
-            assert((*pfuncs_inout)[i].valid());
-            if (&(*pfuncs_inout)[i] == remapping[i]) {
-                assert(i < pfuncs_out_size);
-                assert(expec_same);
-            }
-            else {
-                assert(i >= pfuncs_out_size);
-                expec_same = false;
-
-                bool okay = false;
-                for (size_t j = 0; j < i; ++j) {
-                    if (&(*pfuncs_inout)[j] == remapping[i]) {
-                        assert(!okay);
-                        okay = true;
-                    }
-                }
-                assert(okay);
+            --hi;
+            if (sets.is_root(hi)) {
+                std::swap(pfuncs[lo], pfuncs[hi]);
+                sets.parents_[hi] = sets.parents_[lo];
+                sets.parents_[lo] = lo;
+                ++lo;
             }
         }
-
-
-        pfuncs_inout->resize(pfuncs_out_size);
+        pfuncs_inout->resize(lo);
 
 
 #if (defined TLO_DEBUG_ENABLED) || (defined TLO_DEBUG_ENABLED_GLBL)
         // final validation
-        for (const perf_func_t & pf : *pfuncs_inout) {
+        for ([[maybe_unused]] const perf_func_t & pf : *pfuncs_inout) {
             assert(pf.valid());
         }
-        for (const perf_edge_t & pe : *pedges_inout) {
+        for ([[maybe_unused]] const perf_edge_t & pe : *pedges_inout) {
             assert(pe.valid());
         }
 #endif
@@ -0,0 +1,111 @@
+#ifndef SRC_D_PERF_D_PERF_STATS_PREAGR_H_
+#define SRC_D_PERF_D_PERF_STATS_PREAGR_H_
+
+#include "src/sym/syms.h"
+
+#include "src/util/umap.h"
+#include "src/util/xxhash.h"
+
+#include <stdint.h>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////
+// Pre-aggregation of raw samples (see `perf_stats_shard_t`).
+//
+// Resolving a sample (mapping search, insn decode, function lookup, and the
+// func/edge table updates) is most of the cost of collecting, but the same
+// (pid, from, to) triples show up over and over. When enabled, samples are
+// first just counted here by their raw addresses and each distinct entry is
+// resolved once with its count as the weight.
+//
+// Which mapping an address resolves to only depends on the pid, the dso, and
+// which of the pid's mappings exist at the time of the sample, so along with
+// the addresses the key has the mapping "epoch" (see `perf_mappings_t::epoch`)
+// rather than the timestamp. The dso names point into the line being parsed so
+// the dso (and its comm use) is still looked up for every sample.
+//
+// Entries are resolved in the order they were first seen so functions/edges
+// (and unknown functions) are created in the same order as without
+// pre-aggregation.
+
+namespace tlo {
+namespace perf {
+
+struct perf_preagr_key_t {
+    // What the sample is aggregated by (see `perf_stats_shard_t::agr_key`).
+    uint64_t           agr_key_;
+    const sym::dso_t * from_dso_;
+    // nullptr for simple (IP) samples.
+    const sym::dso_t * to_dso_;
+    uint64_t           from_addr_;
+    uint64_t           to_addr_;
+    uint32_t           pid_;
+    uint32_t           epoch_;
+    // Perf's branch type (see `perf_brtype_t`).
+    uint8_t  brtype_;
+    // Padding (zero so the key can be hashed as bytes). Not an array so
+    // the on-stack keys don't trip -Wstack-protector.
+    uint8_t  reserved0_;
+    uint16_t reserved1_;
+    uint32_t reserved2_;
+
+    constexpr bool
+    is_br() const {
+        return to_dso_ != nullptr;
+    }
+
+    constexpr bool
+    eq(const perf_preagr_key_t & other) const {
+        return agr_key_ == other.agr_key_ && from_dso_ == other.from_dso_ &&
+               to_dso_ == other.to_dso_ && from_addr_ == other.from_addr_ &&
+               to_addr_ == other.to_addr_ && pid_ == other.pid_ &&
+               epoch_ == other.epoch_ && brtype_ == other.brtype_;
+    }
+
+    uint64_t
+    hash() const {
+        return xxhash::run(*this);
+    }
+};
+static_assert(std::has_unique_object_representations_v<perf_preagr_key_t>);
+
+struct perf_preagr_val_t {
+    // Timestamp of the first sample (any in the epoch resolves the same).
+    uint64_t timestamp_;
+    uint64_t count_;
+};
+
+struct perf_preagr_table_t {
+    // Past this many distinct entries they are resolved and the table is
+    // cleared so memory stays bounded on profiles that don't repeat much.
+    static constexpr size_t k_max_entries = 1UL << 18U;
+
+    using entry_map_t = basic_umap<perf_preagr_key_t, perf_preagr_val_t>;
+    entry_map_t entries_;
+
+    void
+    add(const perf_preagr_key_t & key, uint64_t timestamp) {
+        auto res = entries_.emplace(key, perf_preagr_val_t{ timestamp, 0 });
+        ++(res.first->second.count_);
+    }
+
+    bool
+    full() const {
+        return entries_.size() >= k_max_entries;
+    }
+
+    bool
+    empty() const {
+        return entries_.empty();
+    }
+
+    void
+    clear() {
+        entries_.clear();
+    }
+};
+
+}  // namespace perf
+}  // namespace tlo
+
+#endif
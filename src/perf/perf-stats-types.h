@@ -22,15 +22,17 @@ struct perf_edge_stats_t {
     // Could add other stuff like pred/mispred or insn type or w.e.
     psample_val_t num_edges_;
 
+    // `count` is the number of times the sample was seen (see
+    // perf-stats-preagr.h).
     constexpr static perf_edge_stats_t
-    create(const lbr_br_sample_t * sample) {
-        return perf_edge_stats_t{ 1 };
+    create(const lbr_br_sample_t * sample, uint64_t count = 1) {
+        return perf_edge_stats_t{ static_cast<psample_val_t>(count) };
         (void)sample;
     }
 
     constexpr perf_edge_stats_t
-    add_br_sample(const lbr_br_sample_t * sample) {
-        perf_edge_stats_t stat = create(sample);
+    add_br_sample(const lbr_br_sample_t * sample, uint64_t count = 1) {
+        perf_edge_stats_t stat = create(sample, count);
         add(stat);
         return stat;
     }
@@ -80,30 +82,37 @@ struct perf_func_stats_t {
     psample_val_t num_br_samples_out_;
 
     constexpr static perf_func_stats_t
-    create(const simple_sample_t * sample) {
-        return perf_func_stats_t{ 1, 0, 0, 0, 0 };
+    create(const simple_sample_t * sample, uint64_t count = 1) {
+        return perf_func_stats_t{ static_cast<psample_val_t>(count), 0, 0, 0,
+                                  0 };
         (void)sample;
     }
 
     constexpr perf_func_stats_t
-    add_simple_sample(const simple_sample_t * sample) {
-        perf_func_stats_t stat = create(sample);
+    add_simple_sample(const simple_sample_t * sample, uint64_t count = 1) {
+        perf_func_stats_t stat = create(sample, count);
         add(stat);
         return stat;
     }
 
     constexpr static perf_func_stats_t
-    create_br_sample(const lbr_br_sample_t * sample, bool in) {
+    create_br_sample(const lbr_br_sample_t * sample,
+                     bool                    in,
+                     uint64_t                count = 1) {
         uint64_t in64 = static_cast<uint64_t>(in);
-        return perf_func_stats_t{ 0, 0, 0, static_cast<psample_val_t>(in64),
-                                  static_cast<psample_val_t>(1u - in64) };
+        return perf_func_stats_t{
+            0, 0, 0, static_cast<psample_val_t>(in64 * count),
+            static_cast<psample_val_t>((1u - in64) * count)
+        };
         (void)sample;
     }
 
 
     constexpr perf_func_stats_t
-    add_br_sample(const lbr_br_sample_t * sample, bool in) {
-        perf_func_stats_t stat = create_br_sample(sample, in);
+    add_br_sample(const lbr_br_sample_t * sample,
+                  bool                    in,
+                  uint64_t                count = 1) {
+        perf_func_stats_t stat = create_br_sample(sample, in, count);
         add(stat);
         return stat;
     }
@@ -220,15 +229,18 @@ struct perf_func_t {
     sym::func_clump_t *       func_clump_;
     mutable perf_func_stats_t stats_;
 
-    constexpr perf_func_stats_t
-    add_simple_sample(const simple_sample_t * sample) const {
-        TLO_INCR_STAT(total_tracked_samples_);
-        return stats_.add_simple_sample(sample);
+    perf_func_stats_t
+    add_simple_sample(const simple_sample_t * sample,
+                      uint64_t                count = 1) const {
+        TLO_ADD_STAT(total_tracked_samples_, count);
+        return stats_.add_simple_sample(sample, count);
     }
 
     constexpr perf_func_stats_t
-    add_br_sample(const lbr_br_sample_t * sample, bool in) const {
-        return stats_.add_br_sample(sample, in);
+    add_br_sample(const lbr_br_sample_t * sample,
+                  bool                    in,
+                  uint64_t                count = 1) const {
+        return stats_.add_br_sample(sample, in, count);
     }
 
     constexpr perf_func_stats_t
@@ -339,8 +351,8 @@ struct perf_edge_t {
 
 
     constexpr perf_edge_stats_t
-    add_br_sample(const lbr_br_sample_t * sample) const {
-        return stats_.add_br_sample(sample);
+    add_br_sample(const lbr_br_sample_t * sample, uint64_t count = 1) const {
+        return stats_.add_br_sample(sample, count);
     }
 
     constexpr void
@@ -1,11 +1,14 @@
 #ifndef SRC_D_PERF_D_PERF_STATS_H_
 #define SRC_D_PERF_D_PERF_STATS_H_
 
+#include "src/perf/perf-brtype.h"
 #include "src/perf/perf-mappings.h"
 #include "src/perf/perf-sample.h"
 #include "src/perf/perf-stats-clumper.h"
 #include "src/perf/perf-stats-filter.h"
+#include "src/perf/perf-stats-preagr.h"
 #include "src/perf/perf-stats-types.h"
+#include "src/perf/perf-sym-lookup.h"
 
 
 #include "src/sym/syms.h"
@@ -21,6 +24,7 @@
 #include "src/util/verbosity.h"
 #include "src/util/xxhash.h"
 
+#include <string_view>
 #include <utility>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +37,18 @@
 //
 // Note that function is unique to its dso (so a 'memcpy' in GLIBC and 'memcpy'
 // and MUSL would not map to the same function).
+//
+// The tables can be split across threads (`perf_stats_shard_t`), each collects
+// into its own tables and they are merged into the `perf_stats_t` at the end.
+// Symbol lookups go through a `T_lookup_t` (see perf-sym-lookup.h).
+//
+// "tpid" is really whatever key samples are aggregated by (see
+// `perf_agr_key_t`). By default it is the tid/pid pair, but coarser keys keep
+// a lot fewer tables around (i.e for servers with thousands of threads) when
+// only the per-process / global totals are wanted.
+//
+// Optionally a shard can first just count the raw samples and resolve each
+// distinct one once (see perf-stats-preagr.h).
 
 
 namespace tlo {
@@ -53,116 +69,148 @@ struct perf_tpid_stats_t {
     perf_edge_stats_t
     add_edge_br_sample(const lbr_br_sample_t * sample,
                        sym::func_clump_t *     from,
-                       sym::func_clump_t *     to) {
+                       sym::func_clump_t *     to,
+                       uint64_t                count) {
 
         auto pedge = edges_.emplace(
             perf_edge_t{ from, to, sample->br_insn_, perf_edge_stats_t{} });
-        return pedge.first->add_br_sample(sample);
+        return pedge.first->add_br_sample(sample, count);
     }
 
 
     perf_func_stats_t
     add_func_br_sample(const lbr_br_sample_t * sample,
                        sym::func_clump_t *     from,
-                       sym::func_clump_t *     to) {
+                       sym::func_clump_t *     to,
+                       uint64_t                count) {
         // branch sample. Its used both to update/add a new perf_edge and is
         // used to updated the perf_func assosiated with both from/to.
         auto pfunc = funcs_.emplace(perf_func_t{ from, perf_func_stats_t{} });
-        perf_func_stats_t stats = pfunc.first->add_br_sample(sample, false);
+        perf_func_stats_t stats =
+            pfunc.first->add_br_sample(sample, false, count);
 
         pfunc = funcs_.emplace(perf_func_t{ to, perf_func_stats_t{} });
-        stats.add(pfunc.first->add_br_sample(sample, true));
+        stats.add(pfunc.first->add_br_sample(sample, true, count));
         return stats;
     }
 
+    // Add `count` of the same branch (from/to dso already looked up). The
+    // stats are added to `agr_edge_stats`/`agr_func_stats`, not this tpid's
+    // totals.
+    template<typename T_lookup_t>
+    void
+    add_br_sample(T_lookup_t *            lookup,
+                  const perf_mappings_t * mappings_,
+                  const sample_hdr_t &    hdr,
+                  const sym::dso_t *      from_dso,
+                  const sym::dso_t *      to_dso,
+                  lbr_br_sample_t *       br_sample,
+                  uint64_t                count,
+                  perf_edge_stats_t *     agr_edge_stats,
+                  perf_func_stats_t *     agr_func_stats) {
+        TLO_ADD_STAT(total_branches_, count);
+        // If perf told us the branch type there is no need to decode.
+        br_sample->br_insn_ = perf_brtype_to_br_insn(br_sample->brtype_);
+        if (!mappings_->fillin_sample_loc(
+                from_dso, hdr, &(br_sample->from_),
+                br_sample->br_insn_.good() ? nullptr : &(br_sample->br_insn_),
+                &(lookup->map_hint_), T_lookup_t::k_shared) ||
+            !mappings_->fillin_sample_loc(to_dso, hdr, &(br_sample->to_),
+                                          nullptr, &(lookup->map_hint_))) {
+
+            TLO_print_if(tlo::has_verbosity(3),
+                         "Unable to filling: %s -> %s (%lx -> %lx)\n",
+                         from_dso->str(), to_dso->str(),
+                         br_sample->from_.mapped_addr_,
+                         br_sample->to_.mapped_addr_);
+            return;
+        }
+
+
+        sym::func_clump_t * from_func =
+            lookup->get_func(from_dso, &(br_sample->from_));
+        sym::func_clump_t * to_func =
+            lookup->get_func(to_dso, &(br_sample->to_));
+        TLO_ADD_STAT(total_tracked_branches_, count);
+
+        if (from_func != to_func && br_sample->is_trackable_call()) {
+            TLO_ADD_STAT(total_true_calls_, count);
+            TLO_ADD_STAT(average_call_dist_,
+                         (std::max(br_sample->from_.unmapped_addr_,
+                                   br_sample->to_.unmapped_addr_) -
+                          std::min(br_sample->from_.unmapped_addr_,
+                                   br_sample->to_.unmapped_addr_)) *
+                             count);
+            if ((br_sample->from_.unmapped_addr_ ^
+                 br_sample->to_.unmapped_addr_) > 4096) {
+                TLO_ADD_STAT(total_page_cross_calls_, count);
+            }
+        }
+        agr_edge_stats->add(
+            add_edge_br_sample(br_sample, from_func, to_func, count));
+        agr_func_stats->add(
+            add_func_br_sample(br_sample, from_func, to_func, count));
+    }
 
+    template<typename T_lookup_t>
     std::tuple<perf_edge_stats_t, perf_func_stats_t>
-    add_lbr_sample(sym::sym_state_t *      state,
+    add_lbr_sample(T_lookup_t *            lookup,
                    const perf_mappings_t * mappings_,
                    lbr_sample_t *          sample) {
         perf_edge_stats_t agr_edge_stats{};
         perf_func_stats_t agr_func_stats{};
-        strbuf_t<> comm = state->get_strtab()->get_sbuf(sample->hdr_.comm_);
+        strbuf_t<>        comm = lookup->get_comm(sample->hdr_);
         // Add each sample for each branch in lbr sample.
         for (uint32_t i = 0; i < sample->num_lbr_samples(); ++i) {
             lbr_br_sample_t * br_sample = &(sample->samples_[i]);
 
-            sym::dso_t * from_dso = state->get_dso(&(br_sample->from_));
-            sym::dso_t * to_dso   = state->get_dso(&(br_sample->to_));
-            from_dso->add_comm_use(comm);
-            to_dso->add_comm_use(comm);
+            sym::dso_t * from_dso = lookup->get_dso(&(br_sample->from_), comm);
+            sym::dso_t * to_dso   = lookup->get_dso(&(br_sample->to_), comm);
 
             assert(from_dso != nullptr && to_dso != nullptr);
-            TLO_INCR_STAT(total_branches_);
-            if (!mappings_->fillin_sample_loc(from_dso, sample->hdr_,
-                                              &(br_sample->from_),
-                                              &(br_sample->br_insn_)) ||
-                !mappings_->fillin_sample_loc(to_dso, sample->hdr_,
-                                              &(br_sample->to_))) {
-
-                TLO_print_if(tlo::has_verbosity(3),
-                             "Unable to filling: %s -> %s (%lx -> %lx)\n",
-                             from_dso->str(), to_dso->str(),
-                             br_sample->from_.mapped_addr_,
-                             br_sample->to_.mapped_addr_);
-                continue;
-            }
-
-
-            sym::func_clump_t * from_func =
-                state->get_func(from_dso, &(br_sample->from_));
-            sym::func_clump_t * to_func =
-                state->get_func(to_dso, &(br_sample->to_));
-            TLO_INCR_STAT(total_tracked_branches_);
-
-            from_func->add_sample_addr(br_sample->from_.unmapped_addr_);
-            to_func->add_sample_addr(br_sample->to_.unmapped_addr_);
-
-            if (from_func != to_func && br_sample->is_trackable_call()) {
-                TLO_INCR_STAT(total_true_calls_);
-                TLO_ADD_STAT(average_call_dist_,
-                             std::max(br_sample->from_.unmapped_addr_,
-                                      br_sample->to_.unmapped_addr_) -
-                                 std::min(br_sample->from_.unmapped_addr_,
-                                          br_sample->to_.unmapped_addr_));
-                if ((br_sample->from_.unmapped_addr_ ^
-                     br_sample->to_.unmapped_addr_) > 4096) {
-                    TLO_INCR_STAT(total_page_cross_calls_);
-                }
-            }
-            agr_edge_stats.add(
-                add_edge_br_sample(br_sample, from_func, to_func));
-            agr_func_stats.add(
-                add_func_br_sample(br_sample, from_func, to_func));
+            add_br_sample(lookup, mappings_, sample->hdr_, from_dso, to_dso,
+                          br_sample, 1, &agr_edge_stats, &agr_func_stats);
         }
         agr_edge_stats_.add(agr_edge_stats);
         agr_func_stats_.add(agr_func_stats);
         return { agr_edge_stats, agr_func_stats };
     }
 
+    // Add `count` of the same simple sample (dso already looked up).
+    template<typename T_lookup_t>
     perf_func_stats_t
-    add_simple_sample(sym::sym_state_t *      state,
+    add_simple_sample(T_lookup_t *            lookup,
                       const perf_mappings_t * mappings_,
-                      simple_sample_t *       sample) {
-        // Add a simple sample to the function it was in.
-        sym::dso_t * dso = state->get_dso(&(sample->loc_));
-        dso->add_comm_use(state->get_strtab()->get_sbuf(sample->hdr_.comm_));
-        assert(dso != nullptr);
-        if (!mappings_->fillin_sample_loc(dso, sample->hdr_, &(sample->loc_))) {
+                      const sym::dso_t *      dso,
+                      simple_sample_t *       sample,
+                      uint64_t                count) {
+        if (!mappings_->fillin_sample_loc(dso, sample->hdr_, &(sample->loc_),
+                                          nullptr, &(lookup->map_hint_))) {
             TLO_printvvv("Unable to filling: %s -> %lx\n", dso->str(),
                          sample->loc_.mapped_addr_);
             return {};
         }
 
-        sym::func_clump_t * func = state->get_func(dso, &(sample->loc_));
+        sym::func_clump_t * func = lookup->get_func(dso, &(sample->loc_));
 
-        func->add_sample_addr(sample->loc_.unmapped_addr_);
         auto pfunc = funcs_.emplace(perf_func_t{ func, perf_func_stats_t{} });
-        perf_func_stats_t stats = pfunc.first->add_simple_sample(sample);
+        perf_func_stats_t stats = pfunc.first->add_simple_sample(sample, count);
         agr_func_stats_.add(stats);
         return stats;
     }
 
+    template<typename T_lookup_t>
+    perf_func_stats_t
+    add_simple_sample(T_lookup_t *            lookup,
+                      const perf_mappings_t * mappings_,
+                      simple_sample_t *       sample) {
+        // Add a simple sample to the function it was in.
+        sym::dso_t * dso =
+            lookup->get_dso(&(sample->loc_), lookup->get_comm(sample->hdr_));
+        assert(dso != nullptr);
+        return add_simple_sample(lookup, mappings_, dso, sample, 1);
+    }
+
     const perf_func_stats_t &
     func_stats() const {
         return agr_func_stats_;
@@ -285,12 +333,42 @@ struct perf_tpid_stats_t {
     }
 };
 
-struct perf_stats_t {
-    using tpid_map_t = umap<uint64_t, perf_tpid_stats_t, xxhasher_t<uint64_t>>;
+// What samples are aggregated by. This is the "tpid" the filters see:
+//  - k_agr_tpid:   pid << 32 | tid.
+//  - k_agr_pid:    pid << 32.
+//  - k_agr_comm:   hash of the comm.
+//  - k_agr_global: 0.
+enum perf_agr_key_t : uint8_t {
+    k_agr_tpid,
+    k_agr_pid,
+    k_agr_comm,
+    k_agr_global,
+};
 
+static bool
+perf_agr_key_from_str(std::string_view str, perf_agr_key_t * agr_key_out) {
+    if (str == "tpid") {
+        *agr_key_out = k_agr_tpid;
+    }
+    else if (str == "pid") {
+        *agr_key_out = k_agr_pid;
+    }
+    else if (str == "comm") {
+        *agr_key_out = k_agr_comm;
+    }
+    else if (str == "global") {
+        *agr_key_out = k_agr_global;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
 
-    sym::sym_state_t * const state_;
-    perf_mappings_t          mappings_;
+// Per-tpid tables and totals. One of these is used by each thread collecting
+// samples in parallel (the `perf_stats_t` itself is one as well).
+struct perf_stats_shard_t {
+    using tpid_map_t = umap<uint64_t, perf_tpid_stats_t, xxhasher_t<uint64_t>>;
 
     tpid_map_t tpids_;
 
@@ -299,26 +377,226 @@ struct perf_stats_t {
 
     uint64_t nskipped_samples_;
 
+    // Shards that are merged together must use the same key.
+    perf_agr_key_t agr_key_;
 
-    perf_stats_t() = delete;
-    perf_stats_t(sym::sym_state_t * state)
-        : state_(state),
-          tpids_(64),
+    // Samples counted but not yet resolved (only used if `preaggregate_`).
+    bool                preaggregate_;
+    bool                preagr_ret_;
+    perf_preagr_table_t preagr_;
+
+    explicit perf_stats_shard_t(perf_agr_key_t agr_key      = k_agr_tpid,
+                                bool           preaggregate = false)
+        : tpids_(agr_key == k_agr_global ? 1 : 64),
           agr_func_stats_({}),
           agr_edge_stats_({}),
-          nskipped_samples_(0) {}
-
+          nskipped_samples_(0),
+          agr_key_(agr_key),
+          preaggregate_(preaggregate),
+          preagr_ret_(false) {}
+
+    uint64_t
+    agr_key(const sample_hdr_t & hdr) const {
+        switch (agr_key_) {
+            case k_agr_pid:
+                return static_cast<uint64_t>(hdr.pid_) << 32U;
+            case k_agr_comm:
+                return xxhash::run(hdr.comm_.str(), hdr.comm_.len());
+            case k_agr_global:
+                return 0;
+            case k_agr_tpid:
+            default:
+                return hdr.tpid();
+        }
+    }
 
     perf_tpid_stats_t *
     emplace_sample(const simple_sample_t * sample) {
-        return &(
-            tpids_.emplace(sample->tpid(), perf_tpid_stats_t{}).first->second);
+        return &(tpids_.emplace(agr_key(sample->hdr_), perf_tpid_stats_t{})
+                     .first->second);
+    }
+
+    template<typename T_lookup_t>
+    bool
+    collect_simple_sample_stats(T_lookup_t *            lookup,
+                                const perf_mappings_t * mappings,
+                                simple_sample_t *       sample) {
+        TLO_INCR_STAT(total_samples_);
+        if (!sample->valid()) {
+            ++nskipped_samples_;
+            return false;
+        }
+        if (preaggregate_) {
+            perf_preagr_key_t key = preagr_key(mappings, sample->hdr_);
+            key.from_dso_  = lookup->get_dso(&(sample->loc_),
+                                             lookup->get_comm(sample->hdr_));
+            key.from_addr_ = sample->loc_.mapped_addr_;
+            add_preagr(lookup, mappings, key, sample->hdr_.timestamp_);
+            return false;
+        }
+        perf_func_stats_t stats =
+            emplace_sample(sample)->add_simple_sample(lookup, mappings, sample);
+        agr_func_stats_.add(stats);
+        return !stats.empty();
     }
 
+    template<typename T_lookup_t>
+    bool
+    collect_lbr_sample_stats(T_lookup_t *            lookup,
+                             const perf_mappings_t * mappings,
+                             lbr_sample_t *          sample) {
+        if (!sample->valid()) {
+            ++nskipped_samples_;
+            return false;
+        }
+        bool ret = collect_simple_sample_stats(lookup, mappings, sample);
+        if (preaggregate_) {
+            perf_preagr_key_t key  = preagr_key(mappings, sample->hdr_);
+            strbuf_t<>        comm = lookup->get_comm(sample->hdr_);
+            for (uint32_t i = 0; i < sample->num_lbr_samples(); ++i) {
+                const lbr_br_sample_t * br_sample = &(sample->samples_[i]);
+                key.from_dso_  = lookup->get_dso(&(br_sample->from_), comm);
+                key.to_dso_    = lookup->get_dso(&(br_sample->to_), comm);
+                key.from_addr_ = br_sample->from_.mapped_addr_;
+                key.to_addr_   = br_sample->to_.mapped_addr_;
+                key.brtype_    = br_sample->brtype_;
+                add_preagr(lookup, mappings, key, sample->hdr_.timestamp_);
+            }
+            return ret;
+        }
+        auto [edge_stats, func_stats] =
+            emplace_sample(sample)->add_lbr_sample(lookup, mappings, sample);
+        agr_edge_stats_.add(edge_stats);
+        agr_func_stats_.add(func_stats);
+        ret |= !(edge_stats.empty() && func_stats.empty());
+        return ret;
+    }
+
+    perf_preagr_key_t
+    preagr_key(const perf_mappings_t * mappings,
+               const sample_hdr_t &    hdr) const {
+        return perf_preagr_key_t{ agr_key(hdr),
+                                  nullptr,
+                                  nullptr,
+                                  0,
+                                  0,
+                                  hdr.pid_,
+                                  mappings->epoch(hdr),
+                                  {},
+                                  {},
+                                  {},
+                                  {} };
+    }
+
+    template<typename T_lookup_t>
+    void
+    add_preagr(T_lookup_t *              lookup,
+               const perf_mappings_t *   mappings,
+               const perf_preagr_key_t & key,
+               uint64_t                  timestamp) {
+        preagr_.add(key, timestamp);
+        if (preagr_.full()) {
+            resolve_preagr(lookup, mappings);
+        }
+    }
+
+    // Resolve each counted sample once, in the order they were first seen.
+    template<typename T_lookup_t>
+    void
+    resolve_preagr(T_lookup_t * lookup, const perf_mappings_t * mappings) {
+        for (const auto & [key, val] : preagr_.entries_) {
+            perf_tpid_stats_t * tpid_stats =
+                &(tpids_.emplace(key.agr_key_, perf_tpid_stats_t{})
+                      .first->second);
+            simple_sample_t sample{
+                sample_hdr_t{ key.pid_, 0, val.timestamp_, {} },
+                sample_loc_t{ key.from_addr_, 0, {} }
+            };
+            if (!key.is_br()) {
+                perf_func_stats_t stats = tpid_stats->add_simple_sample(
+                    lookup, mappings, key.from_dso_, &sample, val.count_);
+                agr_func_stats_.add(stats);
+                preagr_ret_ |= !stats.empty();
+                continue;
+            }
+
+            lbr_br_sample_t br_sample{};
+            br_sample.from_    = sample.loc_;
+            br_sample.to_      = sample_loc_t{ key.to_addr_, 0, {} };
+            br_sample.brtype_  = key.brtype_ & 0xfU;
+            perf_edge_stats_t edge_stats{};
+            perf_func_stats_t func_stats{};
+            tpid_stats->add_br_sample(lookup, mappings, sample.hdr_,
+                                      key.from_dso_, key.to_dso_, &br_sample,
+                                      val.count_, &edge_stats, &func_stats);
+            tpid_stats->agr_edge_stats_.add(edge_stats);
+            tpid_stats->agr_func_stats_.add(func_stats);
+            agr_edge_stats_.add(edge_stats);
+            agr_func_stats_.add(func_stats);
+            preagr_ret_ |= !(edge_stats.empty() && func_stats.empty());
+        }
+        preagr_.clear();
+    }
+
+    // Resolve everything still counted in the pre-aggregation table. Must be
+    // called once done collecting (before the lookup is flushed). Returns
+    // true if any samples were collected since the last call.
+    template<typename T_lookup_t>
+    bool
+    flush_preagr(T_lookup_t * lookup, const perf_mappings_t * mappings) {
+        resolve_preagr(lookup, mappings);
+        return std::exchange(preagr_ret_, false);
+    }
+
+    // Add all the samples from another shard.
+    void
+    merge(const perf_stats_shard_t & other) {
+        assert(agr_key_ == other.agr_key_);
+        assert(other.preagr_.empty());
+        for (auto const & tpid_and_stats : other.tpids_) {
+            auto res = tpids_.emplace(tpid_and_stats.first, perf_tpid_stats_t{});
+            res.first->second.add(tpid_and_stats.second);
+        }
+        agr_func_stats_.add(other.agr_func_stats_);
+        agr_edge_stats_.add(other.agr_edge_stats_);
+        nskipped_samples_ += other.nskipped_samples_;
+    }
+
+    // Drop everything collected (i.e once it has been merged elsewhere).
+    void
+    clear() {
+        assert(preagr_.empty());
+        tpids_.clear();
+        agr_func_stats_   = {};
+        agr_edge_stats_   = {};
+        nskipped_samples_ = 0;
+    }
+};
+
+struct perf_stats_t : perf_stats_shard_t {
+    sym::sym_state_t * const state_;
+    perf_mappings_t          mappings_;
+    perf_sym_lookup_t        lookup_;
+    // Where the DSO names of mappings are interned. Normally the symbol
+    // state's table, but profiles collecting their info concurrently each
+    // have their own (see `collect_perf_profiles`).
+    strtab_t<true> * map_tab_;
+
+
+    perf_stats_t() = delete;
+    perf_stats_t(sym::sym_state_t * state,
+                 perf_agr_key_t     agr_key      = k_agr_tpid,
+                 bool               preaggregate = false)
+        : perf_stats_shard_t(agr_key, preaggregate),
+          state_(state),
+          lookup_(perf_sym_lookup_t{ state, {} }),
+          map_tab_(state->get_strtab()) {}
+
+
     bool
     collect_mmap_sample(const info_sample_t & sample) {
         assert(sample.is_mmap());
-        return mappings_.add_sample(state_->get_strtab(), sample);
+        return mappings_.add_sample(map_tab_, sample);
     }
 
     bool
@@ -327,38 +605,52 @@ struct perf_stats_t {
         return mappings_.add_fork_sample(sample);
     }
 
+    // After this the mappings are read-only so are safe to share between
+    // threads collecting samples.
     bool
     finalize_mappings() {
         return mappings_.finalize();
     }
 
+    // Events have DSO-relative addresses (`perf script -F brstackoff`). No
+    // info events need to be collected. Must be set before collecting events.
+    void
+    use_dso_offsets() {
+        mappings_.dso_offsets_ = true;
+    }
+
+    // Start reading every mapped DSO in the background (see
+    // `sym_state_t::prefetch_dsos`).
+    void
+    prefetch_dsos() {
+        const vec_t<strbuf_t<>> dsos = mappings_.mapped_dsos();
+        state_->prefetch_dsos(dsos);
+    }
+
+    // Load the symbols for every mapped DSO up front with `njobs` threads
+    // (rather than one at a time as samples first hit them).
+    void
+    preload_dsos(size_t njobs) {
+        const vec_t<strbuf_t<>> dsos = mappings_.mapped_dsos();
+        state_->preload_dsos(dsos, njobs);
+    }
+
 
     bool
     collect_simple_sample_stats(simple_sample_t * sample) {
-        TLO_INCR_STAT(total_samples_);
-        if (!sample->valid()) {
-            ++nskipped_samples_;
-            return false;
-        }
-        perf_func_stats_t stats = emplace_sample(sample)->add_simple_sample(
-            state_, &mappings_, sample);
-        agr_func_stats_.add(stats);
-        return !stats.empty();
+        return perf_stats_shard_t::collect_simple_sample_stats(
+            &lookup_, &mappings_, sample);
     }
 
     bool
     collect_lbr_sample_stats(lbr_sample_t * sample) {
-        if (!sample->valid()) {
-            ++nskipped_samples_;
-            return false;
-        }
-        bool ret = collect_simple_sample_stats(sample);
-        auto [edge_stats, func_stats] =
-            emplace_sample(sample)->add_lbr_sample(state_, &mappings_, sample);
-        agr_edge_stats_.add(edge_stats);
-        agr_func_stats_.add(func_stats);
-        ret |= !(edge_stats.empty() && func_stats.empty());
-        return ret;
+        return perf_stats_shard_t::collect_lbr_sample_stats(&lookup_, &mappings_,
+                                                            sample);
+    }
+
+    bool
+    flush_preagr() {
+        return perf_stats_shard_t::flush_preagr(&lookup_, &mappings_);
     }
 
 
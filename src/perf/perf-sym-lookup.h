@@ -0,0 +1,207 @@
+#ifndef SRC_D_PERF_D_PERF_SYM_LOOKUP_H_
+#define SRC_D_PERF_D_PERF_SYM_LOOKUP_H_
+
+#include "src/perf/perf-mappings.h"
+#include "src/perf/perf-sample.h"
+
+#include "src/sym/syms.h"
+
+#include "src/util/global-stats.h"
+#include "src/util/strbuf.h"
+#include "src/util/umap.h"
+#include "src/util/xxhash.h"
+
+#include <mutex>
+
+////////////////////////////////////////////////////////////////////////////////
+// Symbol lookups done while accumulating samples (see perf-stats.h).
+//
+// `perf_sym_lookup_t` just forwards to the `sym_state_t`.
+//
+// `perf_shared_sym_lookup_t` is used when multiple threads are collecting
+// samples against the same `sym_state_t`. Each thread has its own instance
+// which caches everything it has already seen so that the shared lock is only
+// taken the first time a thread sees a dso/comm/unknown function. The only
+// state touched without the lock is read-only after creation (a dso's function
+// table and its file descriptor).
+//
+// Both also carry the thread's `perf_map_hint_t` for mapping lookups.
+
+
+namespace tlo {
+namespace perf {
+
+struct perf_sym_lookup_t {
+    // Only this thread is collecting samples.
+    static constexpr bool k_shared = false;
+
+    sym::sym_state_t * const state_;
+    perf_map_hint_t          map_hint_;
+
+    strbuf_t<>
+    get_comm(const sample_hdr_t & hdr) {
+        return state_->get_strtab()->get_sbuf(hdr.comm_);
+    }
+
+    // Get dso of the sample and note that `comm` uses it.
+    sym::dso_t *
+    get_dso(const sample_loc_t * loc, strbuf_t<> comm) {
+        sym::dso_t * dso = state_->get_dso(loc);
+        dso->add_comm_use(comm);
+        return dso;
+    }
+
+    // Get function of the sample (and note the address was sampled).
+    sym::func_clump_t *
+    get_func(const sym::dso_t * dso, const sample_loc_t * loc) {
+        sym::func_clump_t * func = state_->get_func(dso, loc);
+        func->add_sample_addr(loc->unmapped_addr_);
+        return func;
+    }
+
+    // Nothing is deferred.
+    void
+    flush() {}
+};
+
+struct perf_shared_sym_lookup_t {
+    struct dso_comm_t {
+        const sym::dso_t * dso_;
+        const char *       comm_;
+
+        constexpr bool
+        eq(const dso_comm_t & other) const {
+            return dso_ == other.dso_ && comm_ == other.comm_;
+        }
+
+        uint64_t
+        hash() const {
+            return xxhash::run(reinterpret_cast<uintptr_t>(dso_)) ^
+                   reinterpret_cast<uintptr_t>(comm_);
+        }
+    };
+
+    // Lowest/highest address sampled for a function (applied on `flush`).
+    struct sample_addrs_t {
+        uint64_t lo_;
+        uint64_t hi_;
+    };
+
+    using comm_set_t         = basic_uset<strbuf_t<>>;
+    using dso_map_t          = basic_umap<strbuf_t<>, sym::dso_t *>;
+    using dso_comm_set_t     = basic_uset<dso_comm_t>;
+    using unknown_map_t      = umap<const sym::dso_t *, sym::func_clump_t *>;
+    using sample_addrs_map_t = umap<sym::func_clump_t *, sample_addrs_t>;
+
+    static constexpr bool k_shared = true;
+
+    sym::sym_state_t * const state_;
+    std::mutex * const       mtx_;
+
+    perf_map_hint_t    map_hint_;
+    comm_set_t         comms_;
+    dso_map_t          dsos_;
+    dso_comm_set_t     dso_comms_;
+    unknown_map_t      unknown_funcs_;
+    sample_addrs_map_t sample_addrs_;
+
+    perf_shared_sym_lookup_t(sym::sym_state_t * state, std::mutex * mtx)
+        : state_(state), mtx_(mtx), map_hint_({}) {}
+
+    strbuf_t<>
+    get_comm(const sample_hdr_t & hdr) {
+        const strbuf_t<> comm{ hdr.comm_ };
+        auto             res = comms_.find(comm);
+        if (res != comms_.end()) {
+            return *res;
+        }
+        strbuf_t<> ret;
+        {
+            const std::lock_guard<std::mutex> lock(*mtx_);
+            ret = state_->get_strtab()->get_sbuf(hdr.comm_);
+        }
+        comms_.emplace(ret);
+        return ret;
+    }
+
+    sym::dso_t *
+    get_dso(const sample_loc_t * loc, strbuf_t<> comm) {
+        const strbuf_t<> name{ loc->dso_ };
+        sym::dso_t *     dso = nullptr;
+        auto             res = dsos_.find(name);
+        if (res != dsos_.end()) {
+            dso = res->second;
+        }
+        else {
+            {
+                const std::lock_guard<std::mutex> lock(*mtx_);
+                dso = state_->get_dso(name);
+            }
+            // Key must outlive the line being parsed.
+            dsos_.emplace(strbuf_t<>{ dso->name_.without_extra() }, dso);
+        }
+        if (dso_comms_.emplace(dso_comm_t{ dso, comm.str() }).second) {
+            const std::lock_guard<std::mutex> lock(*mtx_);
+            dso->add_comm_use(comm);
+        }
+        return dso;
+    }
+
+    sym::func_clump_t *
+    get_func(const sym::dso_t * dso, const sample_loc_t * loc) {
+        const uint64_t      addr = loc->unmapped_addr_;
+        sym::func_clump_t * func =
+            dso->lookup_func_clump(sym::addr_range_t{ addr });
+        if (func != nullptr) {
+            TLO_INCR_STAT(total_known_funcs_);
+        }
+        else {
+            TLO_INCR_STAT(total_unknown_funcs_);
+            auto res = unknown_funcs_.find(dso);
+            if (res != unknown_funcs_.end()) {
+                func = res->second;
+            }
+            else {
+                {
+                    const std::lock_guard<std::mutex> lock(*mtx_);
+                    func = state_->get_unknown_func(
+                        dso, sym::addr_range_t{ addr });
+                }
+                unknown_funcs_.emplace(dso, func);
+            }
+        }
+
+        // Functions are shared with other threads so batch up the range
+        // updates and apply them on `flush`. Address 0 is skipped:
+        // `addr_range_t::add_addr` ignores it once the range is active, but
+        // applied as a batch's low end it would reset the range to a point.
+        if (func->tracks_sample_addrs() && addr != 0) {
+            auto res = sample_addrs_.emplace(func, sample_addrs_t{ addr, addr });
+            if (!res.second) {
+                res.first->second.lo_ = std::min(res.first->second.lo_, addr);
+                res.first->second.hi_ = std::max(res.first->second.hi_, addr);
+            }
+        }
+        return func;
+    }
+
+    // Apply deferred updates to the shared state. Must be called once this
+    // thread is done collecting.
+    void
+    flush() {
+        const std::lock_guard<std::mutex> lock(*mtx_);
+        for (auto & func_and_addrs : sample_addrs_) {
+            func_and_addrs.first->add_sample_addr(func_and_addrs.second.lo_);
+            if (func_and_addrs.second.hi_ != func_and_addrs.second.lo_) {
+                func_and_addrs.first->add_sample_addr(
+                    func_and_addrs.second.hi_);
+            }
+        }
+        sample_addrs_.clear();
+    }
+};
+
+}  // namespace perf
+}  // namespace tlo
+
+#endif
@@ -1,5 +1,6 @@
 #include "src/sym/dso.h"
 #include "src/sym/elffile.h"
+#include "src/sym/sym-cache.h"
 #include "src/util/global-stats.h"
 
 namespace tlo {
@@ -236,18 +237,91 @@ dso_t::find_debug_file_for_dso(
 }
 
 
+bool
+dso_t::map_text() {
+    assert(fd_ > 0);
+    assert(text_map_ == nullptr);
+    Elf64_Ehdr ehdr;
+    if (file_ops::ensure_read(fd_, reinterpret_cast<uint8_t *>(&ehdr),
+                              sizeof(ehdr), 0) == file_ops::k_err) {
+        return false;
+    }
+    if (std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr.e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr.e_phentsize != sizeof(Elf64_Phdr) || ehdr.e_phnum == 0) {
+        return false;
+    }
+
+    vec_t<Elf64_Phdr> phdrs(ehdr.e_phnum);
+    if (file_ops::ensure_read(
+            fd_, reinterpret_cast<uint8_t *>(phdrs.data()),
+            phdrs.size() * sizeof(Elf64_Phdr),
+            static_cast<ssize_t>(ehdr.e_phoff)) == file_ops::k_err) {
+        return false;
+    }
+
+    // Map one range covering all the executable segments. It is only virtual
+    // address space; we only ever touch the pages with branches in them.
+    uint64_t lo = std::numeric_limits<uint64_t>::max();
+    uint64_t hi = 0;
+    for (const Elf64_Phdr & phdr : phdrs) {
+        if (phdr.p_type != PT_LOAD || (phdr.p_flags & PF_X) == 0 ||
+            phdr.p_filesz == 0) {
+            continue;
+        }
+        lo = std::min(lo, phdr.p_offset);
+        hi = std::max(hi, phdr.p_offset + phdr.p_filesz);
+    }
+    if (lo >= hi) {
+        return false;
+    }
+    size_t fsize = file_ops::filesize(fd_);
+    if (fsize == file_ops::k_err || hi > fsize) {
+        return false;
+    }
+
+    lo &= -k_page_size;
+    void * p = mmap(nullptr, hi - lo, PROT_READ, MAP_PRIVATE, fd_,
+                    static_cast<off_t>(lo));
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    text_map_ = reinterpret_cast<const uint8_t *>(p);
+    text_off_ = lo;
+    text_len_ = hi - lo;
+    return true;
+}
+
 template<bool k_tab_type_unused>
 void
 dso_t::finalize_from_perf(
     char * str_ptr,  // NOLINT(readability-non-const-parameter)
     strtab_t<k_tab_type_unused> * name_tab) {
     (void)str_ptr;
+    load_from_perf(name_tab);
+}
+
+template<bool k_tab_type_unused>
+void
+dso_t::load_from_perf(strtab_t<k_tab_type_unused> * name_tab) {
+    assert(!from_reload_);
+    assert(!finalized_);
     all_funcs_ = {};
     deps_      = {};
     std::array<char, k_dso_pathlen> path{};
     fmt_path(&path);
     TLO_INCR_STAT(total_dsos_);
+    vec_t<char> cache_key{};
     if (file_ops::exists(path.data())) {
+        if (sym_cache_t::active() &&
+            sym_cache_t::make_key(path.data(), &cache_key) &&
+            sym_cache_t::load(this, { cache_key.data(), cache_key.size() },
+                              name_tab)) {
+            TLO_printv("Loaded DSO from symbol cache: %s\n", str());
+            open_dso();
+            finalized_ = true;
+            return;
+        }
         elf_file_t ef{};
         TLO_printv("Try to read DSO: %s\n", str());
         if (ef.init(path.data())) {
@@ -262,7 +336,8 @@ dso_t::finalize_from_perf(
     else {
         set_non_findable();
     }
-    if (find_debug_file_for_dso(&path)) {
+    const bool found_dbg = find_debug_file_for_dso(&path);
+    if (found_dbg) {
         TLO_printv("Found Debug For: %s\n\t-> %s\n", str(), path.data());
 
         elf_file_t ef{};
@@ -274,11 +349,17 @@ dso_t::finalize_from_perf(
         ef.cleanup();
     }
     func_clumps_ = create_func_clumps(all_funcs_);
+    if (!cache_key.empty()) {
+        (void)sym_cache_t::save(this, { cache_key.data(), cache_key.size() },
+                                found_dbg ? path.data() : nullptr);
+    }
     open_dso();
     finalized_ = true;
 }
 template void dso_t::finalize_from_perf<true>(char *, strtab_t<true> *);
 template void dso_t::finalize_from_perf<false>(char *, strtab_t<false> *);
+template void dso_t::load_from_perf<true>(strtab_t<true> *);
+template void dso_t::load_from_perf<false>(strtab_t<false> *);
 
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables,bugprone-string-constructor)
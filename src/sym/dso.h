@@ -9,6 +9,7 @@
 // (later before CFG generation).
 
 #include "src/sym/func.h"
+#include "src/sym/insn-cache.h"
 #include "src/util/file-ops.h"
 #include "src/util/memory.h"
 #include "src/util/path.h"
@@ -234,12 +235,19 @@ struct func_clump_t {
     }
 
     void dump(int vlvl = 1, FILE * fp = stdout, const char * prefix = "") const;
+
+    // Only functions we have no elf info for grow with the sample addresses.
+    bool
+    tracks_sample_addrs() const {
+        return !first()->has_elfinfo();
+    }
+
     void
     add_sample_addr(uint64_t addr) {
         assert(!is_cg_ready());
         assert(is_contiguous());
         assert(!is_temporary());
-        if (!first()->has_elfinfo()) {
+        if (tracks_sample_addrs()) {
             assert(num_funcs() == 1);
             first()->add_sample_addr(addr);
             clumped_range_.merge(first()->get_addr_range());
@@ -247,6 +255,20 @@ struct func_clump_t {
         }
     }
 
+    // Restore what `add_sample_addr` had built up (i.e when reloading samples
+    // that were already collected).
+    void
+    restore_sample_range(addr_range_t func_range,
+                         addr_range_t clumped_range,
+                         uint64_t     size) {
+        assert(!is_cg_ready());
+        assert(is_contiguous());
+        assert(tracks_sample_addrs() && num_funcs() == 1);
+        first()->loc_  = func_range;
+        clumped_range_ = clumped_range;
+        size_          = size;
+    }
+
 
     std::string_view
     label(vec_t<char> * buf, std::string_view postfix = {}) const {
@@ -453,13 +475,25 @@ struct dso_t {
     buildids_set_t *        buildids_;
     bool                    has_dbg_;
     bool                    from_reload_;
+    // ELF loading is done later by `load_from_perf` (see
+    // `sym_state_t::preload_dsos`).
+    bool                    defer_load_;
     bool                    finalized_;
     int                     fd_;
+    // Read-only mapping of the file range covering the executable segments
+    // (file offsets [text_off_, text_off_ + text_len_)) and the cache of
+    // branches we have decoded from this file.
+    const uint8_t *         text_map_;
+    uint64_t                text_off_;
+    uint64_t                text_len_;
+    insn_cache_t *          insn_cache_;
     static std::string_view G_dso_root_path;
 
 
     constexpr dso_t() = default;
-    constexpr dso_t(strbuf_t<> name, bool from_rematerialize)
+    constexpr dso_t(strbuf_t<> name,
+                    bool       from_rematerialize,
+                    bool       defer_load = false)
         : name_(name),
           func_clumps_({}),
           deps_({}),
@@ -468,14 +502,24 @@ struct dso_t {
           buildids_(nullptr),
           has_dbg_(false),
           from_reload_(from_rematerialize),
+          defer_load_(defer_load),
           finalized_(false),
-          fd_(0) {}
+          fd_(0),
+          text_map_(nullptr),
+          text_off_(0),
+          text_len_(0),
+          insn_cache_(nullptr) {}
 
     void
     cleanup() const {
         if (fd_ > 0) {
             close(fd_);
         }
+        unmap_text();
+        if (insn_cache_ != nullptr) {
+            insn_cache_->~insn_cache_t();
+            buf_free(insn_cache_, sizeof(insn_cache_t));
+        }
         if (!func_clumps_.empty()) {
             for (size_t i = 0; i < func_clumps_.size(); ++i) {
                 func_clumps_[i].cleanup();
@@ -740,7 +784,7 @@ struct dso_t {
 
         name_.save_to(str_ptr);
         assert(is_findable());
-        if (!from_reload_) {
+        if (!from_reload_ && !defer_load_) {
             TLO_DISABLE_WUNDEFINED_FUNC_TEMPLATE
             finalize_from_perf<k_tab_type_unused>(str_ptr, name_tab);
             TLO_REENABLE_WUNDEFINED_FUNC_TEMPLATE
@@ -763,6 +807,32 @@ struct dso_t {
     void finalize_from_perf(char *                        str_ptr,
                             strtab_t<k_tab_type_unused> * name_tab);
 
+    // Load functions/deps/buildids from the DSO's ELF (and debug file). Only
+    // touches this DSO and `name_tab` so DSOs can be loaded concurrently as
+    // long as each thread has its own `name_tab` (see `move_to_tab`).
+    template<bool k_tab_type_unused>
+    void load_from_perf(strtab_t<k_tab_type_unused> * name_tab);
+
+    // Re-intern all strings we reference into `name_tab`. Used to move a DSO
+    // loaded with a thread-local string table to the shared one.
+    template<bool k_tab_type_unused>
+    void
+    move_to_tab(strtab_t<k_tab_type_unused> * name_tab) {
+        for (func_t & func : all_funcs_) {
+            func.finalize_in_tab(name_tab);
+        }
+        for (strbuf_t<> & dep : deps_) {
+            dep = name_tab->get_sbuf(dep);
+        }
+        if (has_buildids() && !buildids_->empty()) {
+            vec_t<strbuf_t<>> buildids{ buildids_->begin(), buildids_->end() };
+            buildids_->clear();
+            for (const strbuf_t<> & buildid : buildids) {
+                buildids_->emplace(name_tab->get_sbuf(buildid));
+            }
+        }
+    }
+
     constexpr void
     set_non_findable() {
         name_.set_extra(1);
@@ -777,6 +847,15 @@ struct dso_t {
         return name_.extra() == 0;
     }
 
+    bool map_text();
+
+    void
+    unmap_text() const {
+        if (text_map_ != nullptr) {
+            munmap(const_cast<uint8_t *>(text_map_), text_len_);
+        }
+    }
+
     bool
     open_dso() {
         if (fd_ <= 0) {
@@ -789,6 +868,12 @@ struct dso_t {
             if (fd_ < 0) {
                 return false;
             }
+            // Not fatal, we just fallback to reading the file.
+            map_text();
+            if (insn_cache_ == nullptr) {
+                insn_cache_ = new (buf_alloc(sizeof(insn_cache_t)))
+                    insn_cache_t{};
+            }
         }
         return true;
     }
@@ -798,6 +883,10 @@ struct dso_t {
             close(fd_);
             fd_ = 0;
         }
+        unmap_text();
+        text_map_ = nullptr;
+        text_off_ = 0;
+        text_len_ = 0;
     }
 
     bool
@@ -807,7 +896,14 @@ struct dso_t {
         if (fd_ <= 0) {
             return false;
         }
-        // TODO: share the mapping with the elffile and do this w.o syscall.
+        // Near the end of the mapping the rest of the bytes come from the
+        // file (like the rest of the text section they may be code).
+        if (addr >= text_off_ &&
+            (addr - text_off_) + insn_bytes.size() <= text_len_) {
+            std::memcpy(insn_bytes.data(), text_map_ + (addr - text_off_),
+                        insn_bytes.size());
+            return true;
+        }
         if (file_ops::ensure_read(fd_, insn_bytes.data(), insn_bytes.size(),
                                   static_cast<ssize_t>(addr)) ==
             file_ops::k_err) {
@@ -816,6 +912,23 @@ struct dso_t {
         return true;
     }
 
+    // Branch decoded at file offset `addr` (if we have seen it before).
+    // `shared` if other threads may be using the cache at the same time.
+    bool
+    find_cached_br_insn(uint64_t            addr,
+                        system::br_insn_t * br_insn_out,
+                        bool                shared) const {
+        return insn_cache_ != nullptr &&
+               insn_cache_->find(addr, br_insn_out, shared);
+    }
+
+    void
+    cache_br_insn(uint64_t addr, system::br_insn_t br_insn, bool shared) const {
+        if (insn_cache_ != nullptr) {
+            insn_cache_->insert(addr, br_insn, shared);
+        }
+    }
+
     constexpr bool
     from_reload() const {
         return from_reload_;
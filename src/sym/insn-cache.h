@@ -0,0 +1,69 @@
+#ifndef SRC_D_SYM_D_INSN_CACHE_H_
+#define SRC_D_SYM_D_INSN_CACHE_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Per-DSO cache of decoded branch instructions keyed by file offset. The same
+// branch sites show up over and over in a profile so this saves re-reading and
+// re-decoding them. Multiple threads may collect samples against the same DSO
+// so the table is split into shards which each have their own lock. The lock
+// is only taken if `shared` (some other thread may be using the cache).
+
+#include "src/system/br-insn.h"
+
+#include "src/util/umap.h"
+
+#include <array>
+#include <mutex>
+
+#include <stdint.h>
+
+namespace tlo {
+namespace sym {
+
+struct insn_cache_t {
+    static constexpr size_t k_num_shards = 16;
+    static_assert(k_num_shards == (1UL << 4U));
+
+    struct shard_t {
+        std::mutex                        mtx_;
+        umap<uint64_t, system::br_insn_t> insns_;
+    };
+
+    std::array<shard_t, k_num_shards> shards_;
+
+    shard_t *
+    get_shard(uint64_t off) {
+        // Fibonacci hash, top bits pick the shard.
+        return &shards_[(off * 0x9e3779b97f4a7c15UL) >> 60U];
+    }
+
+    bool
+    find(uint64_t off, system::br_insn_t * br_insn_out, bool shared) {
+        shard_t *                    shard = get_shard(off);
+        std::unique_lock<std::mutex> lock(shard->mtx_, std::defer_lock);
+        if (shared) {
+            lock.lock();
+        }
+        auto res = shard->insns_.find(off);
+        if (res == shard->insns_.end()) {
+            return false;
+        }
+        *br_insn_out = res->second;
+        return true;
+    }
+
+    void
+    insert(uint64_t off, system::br_insn_t br_insn, bool shared) {
+        shard_t *                    shard = get_shard(off);
+        std::unique_lock<std::mutex> lock(shard->mtx_, std::defer_lock);
+        if (shared) {
+            lock.lock();
+        }
+        shard->insns_.emplace(off, br_insn);
+    }
+};
+
+}  // namespace sym
+}  // namespace tlo
+
+#endif
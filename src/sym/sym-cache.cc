@@ -0,0 +1,522 @@
+#include "src/sym/sym-cache.h"
+#include "src/sym/dso.h"
+
+#include "src/util/compiler.h"
+#include "src/util/file-ops.h"
+#include "src/util/global-stats.h"
+#include "src/util/memory.h"
+#include "src/util/path.h"
+#include "src/util/random.h"
+#include "src/util/str-ops.h"
+#include "src/util/umap.h"
+#include "src/util/verbosity.h"
+#include "src/util/xxhash.h"
+
+#include <array>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tlo {
+namespace sym {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables,bugprone-string-constructor)
+std::string_view sym_cache_t::G_cache_dir = { "", 0 };
+
+static void
+sym_cache_append(vec_t<char> * buf, std::string_view sv) {
+    std::copy(sv.begin(), sv.end(), std::back_inserter(*buf));
+}
+
+// Path of the cache entry for `key`. Entries are named by the hash of their
+// key (the key itself is stored in the entry and checked on load).
+static const char *
+sym_cache_entry_path(std::string_view key, vec_t<char> * path_out) {
+    std::array<char, 32> name{};
+    (void)snprintf(name.data(), name.size(), "%016lx.sym",
+                   xxhash::run(key.data(), key.size()));
+    path_out->clear();
+    sym_cache_append(path_out, sym_cache_t::G_cache_dir);
+    return path_join(path_out, std::string_view{ name.data() }).data();
+}
+
+static bool
+sym_cache_stat(const char * path, uint64_t * size_out, uint64_t * mtime_out) {
+    struct stat st {};
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    *size_out  = static_cast<uint64_t>(st.st_size);
+    *mtime_out = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000UL +
+                 static_cast<uint64_t>(st.st_mtim.tv_nsec);
+    return true;
+}
+
+// Find the NT_GNU_BUILD_ID note through the program headers. This is just
+// enough ELF parsing to build a key without initializing an `elf_file_t`.
+static std::string_view
+sym_cache_read_buildid(int fd, std::array<char, 256> * str_out) {
+    Elf64_Ehdr ehdr;
+    if (file_ops::ensure_read(fd, reinterpret_cast<uint8_t *>(&ehdr),
+                              sizeof(ehdr), 0) != sizeof(ehdr)) {
+        return {};
+    }
+    if (memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr.e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr.e_phentsize != sizeof(Elf64_Phdr) || ehdr.e_phnum == 0 ||
+        ehdr.e_phnum == PN_XNUM) {
+        return {};
+    }
+
+    vec_t<Elf64_Phdr> phdrs(ehdr.e_phnum);
+    const size_t      phdrs_sz = phdrs.size() * sizeof(Elf64_Phdr);
+    if (file_ops::ensure_read(fd, reinterpret_cast<uint8_t *>(phdrs.data()),
+                              phdrs_sz, static_cast<ssize_t>(ehdr.e_phoff)) !=
+        phdrs_sz) {
+        return {};
+    }
+
+    // Build-id notes are tiny, don't bother with anything large.
+    static constexpr size_t k_max_notes_sz = 64 * 1024;
+    vec_t<uint8_t>          notes{};
+    for (const Elf64_Phdr & phdr : phdrs) {
+        if (phdr.p_type != PT_NOTE || phdr.p_filesz == 0 ||
+            phdr.p_filesz > k_max_notes_sz) {
+            continue;
+        }
+        notes.resize(phdr.p_filesz);
+        if (file_ops::ensure_read(fd, notes.data(), notes.size(),
+                                  static_cast<ssize_t>(phdr.p_offset)) !=
+            notes.size()) {
+            continue;
+        }
+        const size_t align = phdr.p_align == 8 ? 8 : 4;
+        size_t       off   = 0;
+        while ((off + sizeof(Elf64_Nhdr)) <= notes.size()) {
+            Elf64_Nhdr nhdr;
+            memcpy(&nhdr, notes.data() + off, sizeof(nhdr));
+            off += sizeof(nhdr);
+            const size_t namesz = (nhdr.n_namesz + align - 1) & -align;
+            const size_t descsz = (nhdr.n_descsz + align - 1) & -align;
+            if ((off + namesz + descsz) > notes.size()) {
+                break;
+            }
+            if (nhdr.n_type == NT_GNU_BUILD_ID && nhdr.n_namesz == 4 &&
+                nhdr.n_descsz != 0 &&
+                memcmp(notes.data() + off, ELF_NOTE_GNU, 4) == 0) {
+                return to_hex_string(
+                    { notes.data() + off + namesz, nhdr.n_descsz }, str_out);
+            }
+            off += namesz + descsz;
+        }
+    }
+    return {};
+}
+
+bool
+sym_cache_t::make_key(const char * path, vec_t<char> * key_out) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    std::array<char, 256> buildid_buf{};
+    const std::string_view buildid = sym_cache_read_buildid(fd, &buildid_buf);
+    close(fd);
+
+    key_out->clear();
+    if (!buildid.empty()) {
+        sym_cache_append(key_out, "b:");
+        sym_cache_append(key_out, buildid);
+        return true;
+    }
+
+    uint64_t size, mtime;
+    if (!sym_cache_stat(path, &size, &mtime)) {
+        return false;
+    }
+    std::array<char, 64> stat_buf{};
+    (void)snprintf(stat_buf.data(), stat_buf.size(), ":%lu:%lu", size, mtime);
+    sym_cache_append(key_out, "p:");
+    sym_cache_append(key_out, path);
+    sym_cache_append(key_out, stat_buf.data());
+    return true;
+}
+
+// Validated view of a mapped cache entry.
+struct sym_cache_view_t {
+    sym_cache_t::hdr_t                 hdr_;
+    const sym_cache_t::str_ent_t *   strs_;
+    const sym_cache_t::func_ent_t *  funcs_;
+    const sym_cache_t::clump_ent_t * clumps_;
+    const uint32_t *                 deps_;
+    const uint32_t *                 buildids_;
+    const char *                     blob_;
+
+    std::string_view
+    sview(uint32_t idx) const {
+        assert(idx < hdr_.nstrs_);
+        return { blob_ + strs_[idx].off_, strs_[idx].len_ };
+    }
+
+    strbuf_t<>
+    sbuf(uint32_t idx) const {
+        assert(idx < hdr_.nstrs_);
+        return strbuf_t<>{
+            small_str_t<const char *>{ blob_ + strs_[idx].off_,
+                                       static_cast<uint16_t>(strs_[idx].len_) },
+            strs_[idx].hash_
+        };
+    }
+
+    ident_t
+    ident(uint32_t idx, uint16_t meta) const {
+        assert(idx < hdr_.nstrs_);
+        ident_t ident{};
+        ident.str_ = strbuf_t<ident_t::k_num_meta_bits>{
+            small_str_t<const char *, ident_t::k_num_meta_bits>{
+                blob_ + strs_[idx].off_, static_cast<uint16_t>(strs_[idx].len_),
+                meta },
+            strs_[idx].hash_
+        };
+        return ident;
+    }
+
+    bool
+    init(const uint8_t * p, size_t sz, std::string_view key) {
+        using hdr_t    = sym_cache_t::hdr_t;
+        using layout_t = sym_cache_t::layout_t;
+        if (sz < sizeof(hdr_t)) {
+            return false;
+        }
+        memcpy(&hdr_, p, sizeof(hdr_t));
+        if (hdr_.magic_ != sym_cache_t::k_magic ||
+            hdr_.version_ != sym_cache_t::k_version || hdr_.size_ != sz ||
+            hdr_.str_bytes_ > sz) {
+            return false;
+        }
+        const layout_t layout = layout_t::make(hdr_);
+        if (layout.size_ != sz) {
+            return false;
+        }
+        if (xxhash::run(p + sizeof(hdr_t), sz - sizeof(hdr_t)) !=
+            hdr_.checksum_) {
+            return false;
+        }
+
+        // Sections are 8-byte aligned and the mapping is page aligned.
+        TLO_DISABLE_WCAST_ALIGN
+        strs_ = reinterpret_cast<const sym_cache_t::str_ent_t *>(p +
+                                                                  layout.strs_);
+        funcs_ = reinterpret_cast<const sym_cache_t::func_ent_t *>(
+            p + layout.funcs_);
+        clumps_ = reinterpret_cast<const sym_cache_t::clump_ent_t *>(
+            p + layout.clumps_);
+        deps_     = reinterpret_cast<const uint32_t *>(p + layout.deps_);
+        buildids_ = reinterpret_cast<const uint32_t *>(p + layout.buildids_);
+        TLO_REENABLE_WCAST_ALIGN
+        blob_     = reinterpret_cast<const char *>(p + layout.blob_);
+
+        for (uint32_t i = 0; i < hdr_.nstrs_; ++i) {
+            const uint64_t end = static_cast<uint64_t>(strs_[i].off_) +
+                                 static_cast<uint64_t>(strs_[i].len_);
+            if (end >= hdr_.str_bytes_ || blob_[end] != '\0' ||
+                !strbuf_t<ident_t::k_num_meta_bits>::fits(strs_[i].len_)) {
+                return false;
+            }
+        }
+        if (hdr_.key_ >= hdr_.nstrs_ || hdr_.dbg_path_ >= hdr_.nstrs_ ||
+            sview(hdr_.key_) != key) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < hdr_.nfuncs_; ++i) {
+            const sym_cache_t::func_ent_t & func = funcs_[i];
+            if (func.name_ >= hdr_.nstrs_ || func.ident_ >= hdr_.nstrs_ ||
+                !strbuf_t<ident_t::k_num_meta_bits>::extra_will_fit(
+                    func.ident_meta_) ||
+                func.has_elfinfo_ > 1 || func.lo_ > func.hi_) {
+                return false;
+            }
+        }
+
+        // Clumps must exactly cover the functions in order.
+        uint64_t next_func = 0;
+        for (uint32_t i = 0; i < hdr_.nclumps_; ++i) {
+            const sym_cache_t::clump_ent_t & clump = clumps_[i];
+            if (clump.first_ != next_func || clump.nfuncs_ == 0 ||
+                clump.lo_ > clump.hi_) {
+                return false;
+            }
+            next_func += clump.nfuncs_;
+        }
+        if (next_func != hdr_.nfuncs_) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < hdr_.ndeps_; ++i) {
+            if (deps_[i] >= hdr_.nstrs_) {
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < hdr_.nbuildids_; ++i) {
+            if (buildids_[i] >= hdr_.nstrs_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The functions depend on the debug file as well so make sure we would
+    // still pick the same one (and it hasn't changed).
+    bool
+    check_debug_file(const dso_t * dso) const {
+        std::array<char, dso_t::k_dso_pathlen> path{};
+        const std::string_view expec_path = sview(hdr_.dbg_path_);
+        if (!dso->find_debug_file_for_dso(&path)) {
+            return expec_path.empty();
+        }
+        if (expec_path != std::string_view{ path.data() }) {
+            return false;
+        }
+        uint64_t size, mtime;
+        return sym_cache_stat(path.data(), &size, &mtime) &&
+               size == hdr_.dbg_size_ && mtime == hdr_.dbg_mtime_;
+    }
+
+    template<bool k_tab_type_unused>
+    void
+    apply(dso_t * dso, strtab_t<k_tab_type_unused> * name_tab) const {
+        func_t * funcs = nullptr;
+        if (hdr_.nfuncs_ != 0) {
+            funcs = arr_alloc<func_t>(hdr_.nfuncs_);
+        }
+        for (uint32_t i = 0; i < hdr_.nfuncs_; ++i) {
+            const sym_cache_t::func_ent_t & func = funcs_[i];
+            new (funcs + i) func_t{ dso, func.has_elfinfo_ != 0,
+                                    sbuf(func.name_),
+                                    ident(func.ident_, func.ident_meta_),
+                                    addr_range_t{ func.lo_, func.hi_ } };
+            funcs[i].finalize_in_tab(name_tab);
+        }
+        dso->all_funcs_ = { funcs, hdr_.nfuncs_ };
+
+        func_clump_t * clumps = nullptr;
+        if (hdr_.nclumps_ != 0) {
+            clumps = arr_alloc<func_clump_t>(hdr_.nclumps_);
+        }
+        for (uint32_t i = 0; i < hdr_.nclumps_; ++i) {
+            const sym_cache_t::clump_ent_t & clump = clumps_[i];
+            clumps[i] =
+                func_clump_t{ { funcs + clump.first_, clump.nfuncs_ },
+                              addr_range_t{ clump.lo_, clump.hi_ } };
+        }
+        dso->func_clumps_ = { clumps, hdr_.nclumps_ };
+
+        strbuf_t<> * deps = nullptr;
+        if (hdr_.ndeps_ != 0) {
+            deps = arr_alloc<strbuf_t<>>(hdr_.ndeps_);
+        }
+        for (uint32_t i = 0; i < hdr_.ndeps_; ++i) {
+            deps[i] = name_tab->get_sbuf(sbuf(deps_[i]));
+        }
+        dso->deps_ = { deps, hdr_.ndeps_ };
+
+        dso->has_dbg_ = (hdr_.flags_ & sym_cache_t::k_has_dbg) != 0;
+    }
+};
+
+template<bool k_tab_type_unused>
+bool
+sym_cache_t::load(dso_t *                       dso,
+                  std::string_view              key,
+                  strtab_t<k_tab_type_unused> * name_tab) {
+    assert(dso->all_funcs_.empty() && dso->deps_.empty());
+    assert(!dso->has_buildids() || dso->num_buildids() == 0);
+    if (!active()) {
+        return false;
+    }
+    vec_t<char>  path_buf{};
+    const char * path = sym_cache_entry_path(key, &path_buf);
+    if (!file_ops::exists(path)) {
+        return false;
+    }
+    file_ops::mapped_file_t mapping =
+        file_ops::map_file(path, file_ops::k_map_read, false);
+    if (!mapping.active()) {
+        return false;
+    }
+
+    auto [p, sz] = mapping.to_pair();
+    sym_cache_view_t view{};
+    bool             okay = view.init(p, sz, key);
+    if (okay) {
+        // Need the buildids to find the debug file.
+        for (uint32_t i = 0; i < view.hdr_.nbuildids_; ++i) {
+            dso->add_buildid(name_tab->get_sbuf(view.sbuf(view.buildids_[i])));
+        }
+        okay = view.check_debug_file(dso);
+        if (okay) {
+            view.apply(dso, name_tab);
+            TLO_INCR_STAT(total_sym_cache_hits_);
+        }
+        else if (dso->has_buildids()) {
+            dso->buildids_->clear();
+        }
+    }
+    if (!okay) {
+        TLO_printv("Ignoring stale symbol cache entry for %s: %s\n", dso->str(),
+                   path);
+    }
+    file_ops::unmap_file(mapping);
+    return okay;
+}
+
+// Builds the string section, each unique string is stored once.
+struct sym_cache_strs_t {
+    vec_t<sym_cache_t::str_ent_t>    strs_;
+    vec_t<char>                      blob_;
+    basic_umap<strbuf_t<>, uint32_t> idxs_;
+
+    uint32_t
+    add(strbuf_t<> sb) {
+        auto res = idxs_.emplace(sb, static_cast<uint32_t>(strs_.size()));
+        if (res.second) {
+            strs_.emplace_back(sym_cache_t::str_ent_t{
+                sb.hash(), static_cast<uint32_t>(blob_.size()),
+                static_cast<uint32_t>(sb.len()) });
+            sym_cache_append(&blob_, sb.sview());
+            blob_.emplace_back('\0');
+        }
+        return res.first->second;
+    }
+};
+
+// Write to a temporary and rename so concurrent runs never see a partial
+// entry.
+static bool
+sym_cache_write(const char * path, const vec_t<uint8_t> & bytes) {
+    vec_t<char> tmp_path{};
+    sym_cache_append(&tmp_path, path);
+    sym_cache_append(&tmp_path, ".tmp-");
+    std::array<char, 16> suffix{};
+    if (!randomize_str(suffix.data(), suffix.size())) {
+        return false;
+    }
+    sym_cache_append(&tmp_path, { suffix.data(), suffix.size() });
+    tmp_path.emplace_back('\0');
+
+    int fd = open(tmp_path.data(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                  0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool okay =
+        file_ops::ensure_write(fd, bytes.data(), bytes.size()) == bytes.size();
+    close(fd);
+    if (!okay || rename(tmp_path.data(), path) != 0) {
+        (void)unlink(tmp_path.data());
+        return false;
+    }
+    return true;
+}
+
+bool
+sym_cache_t::save(const dso_t *    dso,
+                  std::string_view key,
+                  const char *     dbg_path) {
+    if (!active() || !strbuf_t<>::fits(key)) {
+        return false;
+    }
+    const std::string_view dbg_sv =
+        dbg_path == nullptr ? std::string_view{} : std::string_view{ dbg_path };
+    if (!strbuf_t<>::fits(dbg_sv)) {
+        return false;
+    }
+
+    hdr_t hdr{};
+    hdr.magic_   = k_magic;
+    hdr.version_ = k_version;
+    hdr.flags_   = dso->has_dbg_ ? k_has_dbg : 0;
+    if (dbg_path != nullptr &&
+        !sym_cache_stat(dbg_path, &hdr.dbg_size_, &hdr.dbg_mtime_)) {
+        return false;
+    }
+
+    sym_cache_strs_t strs{};
+    hdr.key_      = strs.add(strbuf_t<>{ key });
+    hdr.dbg_path_ = strs.add(strbuf_t<>{ dbg_sv });
+
+    vec_t<func_ent_t> funcs{};
+    funcs.reserve(dso->all_funcs_.size());
+    for (const func_t & func : dso->all_funcs_) {
+        funcs.emplace_back(func_ent_t{
+            func.loc_.lo_addr_inclusive_, func.loc_.hi_addr_exclusive_,
+            strs.add(func.name_), strs.add(strbuf_t<>{ func.ident_.str_ }),
+            func.ident_.extra(), static_cast<uint16_t>(func.has_elfinfo()),
+            0 });
+    }
+
+    vec_t<clump_ent_t> clumps{};
+    clumps.reserve(dso->func_clumps_.size());
+    for (const func_clump_t & clump : dso->func_clumps_) {
+        assert(clump.is_contiguous());
+        clumps.emplace_back(clump_ent_t{
+            static_cast<uint32_t>(clump.funcs_.data() - dso->all_funcs_.data()),
+            static_cast<uint32_t>(clump.num_funcs()),
+            clump.clumped_range_.lo_addr_inclusive_,
+            clump.clumped_range_.hi_addr_exclusive_ });
+    }
+
+    vec_t<uint32_t> deps{};
+    for (const strbuf_t<> & dep : dso->deps_) {
+        deps.emplace_back(strs.add(dep));
+    }
+    vec_t<uint32_t> buildids{};
+    if (dso->has_buildids()) {
+        for (const strbuf_t<> & buildid : dso->buildids()) {
+            buildids.emplace_back(strs.add(buildid));
+        }
+    }
+
+    hdr.nstrs_     = static_cast<uint32_t>(strs.strs_.size());
+    hdr.nfuncs_    = static_cast<uint32_t>(funcs.size());
+    hdr.nclumps_   = static_cast<uint32_t>(clumps.size());
+    hdr.ndeps_     = static_cast<uint32_t>(deps.size());
+    hdr.nbuildids_ = static_cast<uint32_t>(buildids.size());
+    hdr.str_bytes_ = strs.blob_.size();
+
+    const layout_t layout = layout_t::make(hdr);
+    hdr.size_             = layout.size_;
+
+    vec_t<uint8_t> bytes(layout.size_, 0);
+    auto           copy_section = [&bytes](uint64_t off, const auto & vec) {
+        if (!vec.empty()) {
+            memcpy(bytes.data() + off, vec.data(),
+                             vec.size() * sizeof(vec[0]));
+        }
+    };
+    copy_section(layout.strs_, strs.strs_);
+    copy_section(layout.funcs_, funcs);
+    copy_section(layout.clumps_, clumps);
+    copy_section(layout.deps_, deps);
+    copy_section(layout.buildids_, buildids);
+    copy_section(layout.blob_, strs.blob_);
+    hdr.checksum_ =
+        xxhash::run(bytes.data() + sizeof(hdr_t), bytes.size() - sizeof(hdr_t));
+    memcpy(bytes.data(), &hdr, sizeof(hdr_t));
+
+    vec_t<char> path_buf{};
+    return sym_cache_write(sym_cache_entry_path(key, &path_buf), bytes);
+}
+
+template bool sym_cache_t::load<true>(dso_t *, std::string_view, strtab_t<true> *);
+template bool sym_cache_t::load<false>(dso_t *,
+                                       std::string_view,
+                                       strtab_t<false> *);
+
+}  // namespace sym
+}  // namespace tlo
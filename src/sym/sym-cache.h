@@ -0,0 +1,135 @@
+#ifndef SRC_D_SYM_D_SYM_CACHE_H_
+#define SRC_D_SYM_D_SYM_CACHE_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Optional on-disk cache of the symbols we load for a DSO (see
+// `dso_t::load_from_perf`). Each entry is keyed by the DSO's build-id (or its
+// path/size/mtime if it doesn't have one) and stores its function clumps, the
+// strings they reference, its deps (DT_NEEDED) and build-ids. Entries are a
+// flat binary file that is just mapped and checked on load. If anything about
+// an entry doesn't match (version, checksum, key, or the debug file we would
+// use now) it is ignored and the DSO is loaded from its ELF.
+
+#include "src/util/strtab.h"
+#include "src/util/vec.h"
+
+#include <string_view>
+
+#include <stdint.h>
+
+namespace tlo {
+namespace sym {
+
+struct dso_t;
+
+struct sym_cache_t {
+    static constexpr uint64_t k_magic   = 0x45484341434d5953UL;  // SYMCACHE
+    static constexpr uint32_t k_version = 1;
+
+    static constexpr uint32_t k_has_dbg = 1;
+
+    // On-disk layout. Offsets are relative to the start of the file and all
+    // sections are 8-byte aligned.
+    struct hdr_t {
+        uint64_t magic_;
+        uint32_t version_;
+        uint32_t flags_;
+        // Checksum of everything after the header.
+        uint64_t checksum_;
+        uint64_t size_;
+        uint32_t nstrs_;
+        uint32_t nfuncs_;
+        uint32_t nclumps_;
+        uint32_t ndeps_;
+        uint32_t nbuildids_;
+        // String indexes.
+        uint32_t key_;
+        uint32_t dbg_path_;
+        uint32_t reserved_;
+        uint64_t dbg_size_;
+        uint64_t dbg_mtime_;
+        uint64_t str_bytes_;
+    };
+
+    struct str_ent_t {
+        uint64_t hash_;
+        uint32_t off_;
+        uint32_t len_;
+    };
+
+    struct func_ent_t {
+        uint64_t lo_;
+        uint64_t hi_;
+        uint32_t name_;
+        uint32_t ident_;
+        uint16_t ident_meta_;
+        uint16_t has_elfinfo_;
+        uint32_t reserved_;
+    };
+
+    struct clump_ent_t {
+        uint32_t first_;
+        uint32_t nfuncs_;
+        uint64_t lo_;
+        uint64_t hi_;
+    };
+
+    // Section offsets of an entry with the counts in `hdr`.
+    struct layout_t {
+        uint64_t strs_;
+        uint64_t funcs_;
+        uint64_t clumps_;
+        uint64_t deps_;
+        uint64_t buildids_;
+        uint64_t blob_;
+        uint64_t size_;
+
+        static constexpr layout_t
+        make(const hdr_t & hdr) {
+            layout_t layout{};
+            layout.strs_   = sizeof(hdr_t);
+            layout.funcs_  = layout.strs_ + hdr.nstrs_ * sizeof(str_ent_t);
+            layout.clumps_ = layout.funcs_ + hdr.nfuncs_ * sizeof(func_ent_t);
+            layout.deps_ = layout.clumps_ + hdr.nclumps_ * sizeof(clump_ent_t);
+            layout.buildids_ = layout.deps_ + hdr.ndeps_ * sizeof(uint32_t);
+            layout.blob_ =
+                (layout.buildids_ + hdr.nbuildids_ * sizeof(uint32_t) + 7U) &
+                -8UL;
+            layout.size_ = layout.blob_ + hdr.str_bytes_;
+            return layout;
+        }
+    };
+
+    static std::string_view G_cache_dir;
+
+    static void
+    set_cache_dir(std::string_view sv) {
+        G_cache_dir = sv;
+    }
+
+    static bool
+    active() {
+        return !G_cache_dir.empty();
+    }
+
+    // Key for the DSO file at `path`. False if the file can't be read.
+    static bool make_key(const char * path, vec_t<char> * key_out);
+
+    // Fill in `dso`'s functions/deps/buildids from the cache. False (and
+    // `dso` left unchanged) if there is no valid entry.
+    template<bool k_tab_type_unused>
+    static bool load(dso_t *                       dso,
+                     std::string_view              key,
+                     strtab_t<k_tab_type_unused> * name_tab);
+
+    // Write `dso`'s (fully loaded) symbols to the cache. `dbg_path` is the
+    // debug file they were loaded from (or nullptr).
+    static bool save(const dso_t *    dso,
+                     std::string_view key,
+                     const char *     dbg_path);
+};
+
+}  // namespace sym
+}  // namespace tlo
+
+#endif
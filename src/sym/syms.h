@@ -4,6 +4,7 @@
 
 #include "src/sym/dso.h"
 #include "src/sym/func.h"
+#include "src/sym/sym-cache.h"
 
 #include "src/perf/perf-sample.h"
 
@@ -17,6 +18,13 @@
 #include "src/util/strbuf.h"
 #include "src/util/type-info.h"
 #include "src/util/global-stats.h"
+#include "src/util/umap.h"
+#include "src/util/uring.h"
+#include "src/util/work-queue.h"
+
+#include <atomic>
+#include <span>
+#include <thread>
 
 #include <stdint.h>
 #include <unistd.h>
@@ -102,6 +110,12 @@ struct sym_state_t {
             return res->ptr_;
         }
 
+        // Start tracking an already allocated/finalized symbol.
+        bool
+        adopt(T_t * item_ptr) {
+            return set_.emplace(wrapper_t{ item_ptr }).second;
+        }
+
         using base_set_t = basic_uset<wrapper_t>;
         base_set_t set_;
     };
@@ -131,9 +145,103 @@ struct sym_state_t {
 
     dso_t *
     get_dso(strbuf_t<> dso_str) {
+        if (!preloaded_dsos_.empty()) {
+            dso_t * dso = dso_tab_.find(dso_str, false);
+            if (dso != nullptr) {
+                return dso;
+            }
+            auto res = preloaded_dsos_.find(dso_str);
+            if (res != preloaded_dsos_.end()) {
+                dso = res->second;
+                preloaded_dsos_.erase(res);
+                dso_tab_.adopt(dso);
+                return dso;
+            }
+        }
         return dso_tab_.get(&alloc_, &name_tab_, dso_str, false);
     }
 
+    // Load the ELF info for all of `dso_strs` (that we haven't already loaded)
+    // using `njobs` threads. The DSOs are only tracked (returned by `dsos()`)
+    // once `get_dso` is called for them so preloading a DSO that is never
+    // sampled has no visible effect.
+    void
+    preload_dsos(std::span<const strbuf_t<>> dso_strs, size_t njobs) {
+        vec_t<dso_t *> todo{};
+        for (strbuf_t<> dso_str : dso_strs) {
+            if (dso_tab_.find(dso_str, false) != nullptr ||
+                preloaded_dsos_.find(dso_str) != preloaded_dsos_.end()) {
+                continue;
+            }
+            void * p = alloc_.getz(sizeof(dso_t) +
+                                       dso_t{ dso_str, false }.extra_size(),
+                                   alignof(dso_t));
+            dso_t * dso = new (p) dso_t{ dso_str, false, true };
+            dso->finalize(reinterpret_cast<char *>(p) + sizeof(dso_t),
+                          &name_tab_);
+            preloaded_dsos_.emplace(dso->name_.without_extra(), dso);
+            todo.emplace_back(dso);
+        }
+        if (todo.empty()) {
+            return;
+        }
+
+        njobs = std::min(resolve_num_jobs(njobs), todo.size());
+        // Each thread interns into its own table. Everything is moved to
+        // `name_tab_` once they are done.
+        vec_t<strtab_t<true>> tabs(njobs);
+        vec_t<total_stats_t>  stats(njobs);
+        vec_t<std::thread>    threads{};
+        std::atomic<size_t>   next{ 0 };
+        threads.reserve(njobs);
+        for (size_t i = 0; i < njobs; ++i) {
+            threads.emplace_back([&todo, &next, tab = &tabs[i],
+                                  stats_out = &stats[i]]() {
+                for (size_t idx = next.fetch_add(1); idx < todo.size();
+                     idx        = next.fetch_add(1)) {
+                    todo[idx]->load_from_perf(tab);
+                }
+                *stats_out = G_total_stats;
+            });
+        }
+        for (size_t i = 0; i < njobs; ++i) {
+            threads[i].join();
+            G_total_stats.add(stats[i]);
+        }
+        for (dso_t * dso : todo) {
+            dso->move_to_tab(&name_tab_);
+        }
+    }
+
+    // Start reading the ELF (and debug) files of `dso_strs` (that we haven't
+    // already loaded) in the background so they are in the page cache by
+    // the time they are loaded. Only if io_uring is enabled. With the symbol
+    // cache most of them are never read so don't bother.
+    void
+    prefetch_dsos(std::span<const strbuf_t<>> dso_strs) {
+        if (!uring_t::enabled() || sym_cache_t::active()) {
+            return;
+        }
+        vec_t<vec_t<char>> paths{};
+        for (strbuf_t<> dso_str : dso_strs) {
+            if (dso_tab_.find(dso_str, false) != nullptr ||
+                preloaded_dsos_.find(dso_str) != preloaded_dsos_.end()) {
+                continue;
+            }
+            const dso_t dso{ dso_str, false };
+            std::array<char, dso_t::k_dso_pathlen> path{};
+            for (const std::string_view postfix : { "", ".debug" }) {
+                const std::span<const char> fpath =
+                    dso.fmt_path(&path, postfix);
+                if (fpath.empty() || !file_ops::exists(fpath.data())) {
+                    continue;
+                }
+                paths.emplace_back(fpath.begin(), fpath.end());
+            }
+        }
+        prefetcher_.start(std::move(paths));
+    }
+
     dso_t *
     find_dso(strbuf_t<> dso_str) {
         return dso_tab_.find(dso_str, false);
@@ -154,6 +262,10 @@ struct sym_state_t {
     alloc_tbl_t<func_clump_t>   func_tab_;
     strtab_t<true>              name_tab_;
     vec_t<const func_clump_t *> fc_to_free_;
+    // DSOs loaded by `preload_dsos` that haven't been requested yet.
+    basic_umap<strbuf_t<>, dso_t *> preloaded_dsos_;
+    // See `prefetch_dsos`.
+    file_prefetcher_t prefetcher_;
     // Helper for easy iteration through all tracked DSOs.
     // We should/could do the same for other symbols (so far no need).
     template<typename T_t>
@@ -232,6 +344,9 @@ struct sym_state_t {
         for (const dso_t * dso : dsos()) {
             dso->cleanup();
         }
+        for (const auto & name_and_dso : preloaded_dsos_) {
+            name_and_dso.second->cleanup();
+        }
         for (const func_clump_t * fc : func_clumps()) {
             fc->cleanup();
         }
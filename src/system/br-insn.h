@@ -298,18 +298,28 @@ struct br_insn_t {
         for (; idx < end_idx; ++idx) {
             enc <<= 8;
             enc |= insn_bytes[idx];
-            const detail::br_insn_desc_t * res =
-                std::lower_bound(start_desc(), end_desc(), enc,
-                                 [](detail::br_insn_desc_t const & desc,
-                                    detail::br_enc_t search_enc) -> bool {
-                                     return desc.lt(search_enc);
-                                 });
-            if (res < end_desc() && res->eq(enc)) {
-                return br_insn_t{ res - start_desc() };
+            br_insn_t res = find_enc(enc);
+            if (res.good()) {
+                return res;
             }
         }
         return make_bad();
     }
+
+    // Lookup the desc with exactly encoding `enc` (no prefix bytes).
+    static br_insn_t TLO_PURE
+    find_enc(detail::br_enc_t enc) {
+        const detail::br_insn_desc_t * res =
+            std::lower_bound(start_desc(), end_desc(), enc,
+                             [](detail::br_insn_desc_t const & desc,
+                                detail::br_enc_t search_enc) -> bool {
+                                 return desc.lt(search_enc);
+                             });
+        if (res < end_desc() && res->eq(enc)) {
+            return br_insn_t{ res - start_desc() };
+        }
+        return make_bad();
+    }
 };
 static_assert(has_okay_type_traits<br_insn_t>::value);
 }  // namespace system
@@ -10,16 +10,35 @@
 #include "src/util/reader.h"
 #include "src/util/std-reader-base.h"
 
+#include <algorithm>
 #include <span>
+
+#include <string.h>
+#include <sys/mman.h>
 namespace tlo {
 
 
 struct areader_t : std_reader_base_t {
-    static constexpr size_t k_default_mem_size = 4096;
+    // How much of the mapping `readlines` returns at a time (mostly so
+    // progress can be reported).
+    static constexpr size_t k_mapped_batch_size = 1024 * 1024;
+
+    // The whole file is mapped on the first `readlines` so the lines can be
+    // returned without copying.
+    file_ops::mapped_file_t mapping_;
+
+    void
+    unmap() {
+        if (mapping_.active()) {
+            file_ops::unmap_file(mapping_);
+            mapping_.deactivate();
+        }
+    }
 
     void
     shutdown() {
         fshutdown();
+        unmap();
     }
 
     void
@@ -30,13 +49,32 @@ struct areader_t : std_reader_base_t {
 
     bool
     init(const char * path) {
+        unmap();
         if (!finit(path)) {
             return false;
         }
+        readahead_init();
         return init_buffers();
     }
 
 
+    // Start reading at byte `off` instead of the beginning. Only before
+    // anything has been read.
+    bool
+    seek(size_t off) {
+        if (nbytes_read() != 0 || remaining_ != 0 || mapping_.active() ||
+            off > nbytes_total()) {
+            return false;
+        }
+        if (readahead_ != nullptr) {
+            uring_readahead_t::destroy(readahead_);
+            readahead_ = nullptr;
+        }
+        fd_off_ = static_cast<ssize_t>(off);
+        readahead_init();
+        return true;
+    }
+
     size_t
     refill() {
         return refill_impl<true>();
@@ -60,6 +98,77 @@ struct areader_t : std_reader_base_t {
     readline(uint8_t ** mem_ptr, size_t * sz_ptr) {
         return readline_impl(this, mem_ptr, sz_ptr);
     }
+
+    // Only map if nothing has been read yet (otherwise keep streaming so we
+    // don't lose what is buffered). If we are reading ahead with io_uring we
+    // also keep streaming, faulting in the mapping would block on every page.
+    bool
+    maybe_map() {
+        if (mapping_.active()) {
+            return true;
+        }
+        if (fd_off_ != 0 || remaining_ != 0 || readahead_ != nullptr) {
+            return false;
+        }
+        mapping_ = file_ops::map_file(fd_, file_ops::k_map_read, false);
+        if (!mapping_.active()) {
+            return false;
+        }
+        if (!mapping_.is_copied()) {
+            auto [addr, sz] = mapping_.to_pair();
+            (void)madvise(addr, sz, MADV_SEQUENTIAL);
+        }
+        return true;
+    }
+
+    // Lines are returned straight from the mapping of the file (and stay valid
+    // until shutdown). Falls back to `readlines_impl` if the file can't be
+    // mapped.
+    size_t
+    readlines(line_batch_t * batch) {
+        if (!maybe_map()) {
+            return readlines_impl(this, batch);
+        }
+        batch->clear();
+        batch->stable_ = true;
+
+        auto [addr, sz] = mapping_.to_pair();
+        size_t off      = nbytes_read();
+        assert(off <= sz);
+        if (off == sz) {
+            return 0;
+        }
+        // End the batch at the last newline before `k_mapped_batch_size` (or
+        // the first newline after it if the line is that long).
+        size_t end = sz;
+        if ((sz - off) > k_mapped_batch_size) {
+            const void * last_nl =
+                memrchr(addr + off, '\n', k_mapped_batch_size);
+            if (last_nl == nullptr) {
+                last_nl = memchr(addr + off + k_mapped_batch_size, '\n',
+                                 sz - off - k_mapped_batch_size);
+            }
+            if (last_nl != nullptr) {
+                end = static_cast<size_t>(
+                          reinterpret_cast<const uint8_t *>(last_nl) - addr) +
+                      1;
+            }
+        }
+
+        while (off < end) {
+            const uint8_t * newline_pos = reinterpret_cast<const uint8_t *>(
+                memchr(addr + off, '\n', end - off));
+            const size_t next_off =
+                newline_pos == nullptr
+                    ? end
+                    : static_cast<size_t>(newline_pos - addr) + 1;
+            batch->lines_.emplace_back(reinterpret_cast<char *>(addr + off),
+                                       next_off - off);
+            off = next_off;
+        }
+        fd_off_ = static_cast<ssize_t>(off);
+        return batch->lines_.size();
+    }
 };
 
 
@@ -8,6 +8,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Class for streaming compressed file.
 // Partially implemented in reader_base_t.
+// Files made up of many independent frames (see zstd-frames.h) can instead be
+// decompressed a frame at a time by a set of worker threads.
 
 #include "src/util/bits.h"
 #include "src/util/memory.h"
@@ -28,6 +30,10 @@
 
 namespace tlo {
 
+// Decompresses the frames of a multi-frame file in parallel (see
+// compressed-reader.cc).
+struct zframes_decoder_t;
+
 // Alot of the functionality is implemented in reader_base_t. This just has the
 // hooks for reading in a compressed data stream.
 struct creader_t : reader_base_t {
@@ -41,10 +47,27 @@ struct creader_t : reader_base_t {
     size_t    cap_compressed_;
 
     zstream_t * zstream_;
+    // Start of the allocation for `mem_` / `mem_compressed_`. When decoding
+    // frames in parallel `mem_` points into the decoder's buffers instead.
+    uint8_t * alloc_;
+
+    // Threads to decompress with, if the file has independent frames (zero
+    // or one to always stream).
+    size_t              njobs_;
+    zframes_decoder_t * zframes_;
 
 
     constexpr creader_t() = default;
 
+    void
+    set_njobs(size_t njobs) {
+        njobs_ = njobs;
+    }
+
+    bool   zframes_init();
+    size_t zframes_refill();
+    void   zframes_shutdown();
+
 
     static size_t
     zstream_buf_compressed_size() {
@@ -88,17 +111,20 @@ struct creader_t : reader_base_t {
     }
 
 
+    // Not `cap_` as that is the size of the current frame when decoding in
+    // parallel.
     size_t
     alloc_size() const {
-        return cap_compressed_ + cap_;
+        return cap_compressed_ + zstream_buf_size();
     }
     uint8_t *
     alloc_start() const {
-        return mem_;
+        return alloc_;
     }
     void
     alloc_null() {
-        mem_ = nullptr;
+        alloc_ = nullptr;
+        mem_   = nullptr;
     }
 
 
@@ -108,10 +134,12 @@ struct creader_t : reader_base_t {
             sys::freemem(alloc_start(), alloc_size());
             alloc_null();
         }
+        release_carry();
     }
 
     void
     shutdown() {
+        zframes_shutdown();
         fshutdown();
         zshutdown();
     }
@@ -145,6 +173,12 @@ struct creader_t : reader_base_t {
     readline(uint8_t ** mem_ptr, size_t * sz_ptr) {
         return readline_impl(this, mem_ptr, sz_ptr);
     }
+
+    // Lines are parsed in place from the decompression output buffer.
+    size_t
+    readlines(line_batch_t * batch) {
+        return readlines_impl(this, batch);
+    }
 };
 
 }  // namespace tlo
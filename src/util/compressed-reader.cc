@@ -3,6 +3,13 @@
 
 #include "src/util/memory.h"
 #include "src/util/verbosity.h"
+#include "src/util/work-queue.h"
+#include "src/util/zstd-frames.h"
+
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <utility>
 
 #include <assert.h>
 #include <stddef.h>
@@ -17,6 +24,173 @@
 // Reader interface for reading from a file compressed with zstd
 
 namespace tlo {
+
+struct zframes_decoder_t {
+    // Don't decode in parallel if it would mean buffering more than this per
+    // frame.
+    static constexpr uint64_t k_max_frame_size = 256UL * 1024 * 1024;
+
+    struct frame_buf_t {
+        uint8_t * mem_;
+        size_t    cap_;
+        size_t    size_;
+        bool      okay_;
+    };
+
+    file_ops::mapped_file_t      mapping_;
+    vec_t<zst_frame_t>           frames_;
+    ordered_slots_t<frame_buf_t> slots_;
+    vec_t<std::thread>           threads_;
+    // Frame currently being read by the consumer (if `held_`).
+    size_t next_;
+    bool   held_;
+
+    zframes_decoder_t(file_ops::mapped_file_t mapping,
+                      vec_t<zst_frame_t>      frames,
+                      size_t                  nthreads)
+        : mapping_(mapping),
+          frames_(std::move(frames)),
+          slots_(2 * nthreads, frames_.size()),
+          next_(0),
+          held_(false) {
+        threads_.reserve(nthreads);
+        for (size_t i = 0; i < nthreads; ++i) {
+            threads_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~zframes_decoder_t() {
+        slots_.close();
+        for (std::thread & thread : threads_) {
+            thread.join();
+        }
+        for (frame_buf_t & buf : slots_.slots_) {
+            if (buf.mem_ != nullptr) {
+                buf_free(buf.mem_, buf.cap_);
+            }
+        }
+        file_ops::unmap_file(mapping_);
+    }
+
+    // Returns null if the file doesn't have enough independent frames to be
+    // worth decoding in parallel.
+    static zframes_decoder_t *
+    create(int fd, size_t njobs) {
+        file_ops::mapped_file_t mapping =
+            file_ops::map_file(fd, file_ops::k_map_read, false);
+        if (!mapping.active()) {
+            return nullptr;
+        }
+        const auto [addr, size] = mapping.to_pair();
+        vec_t<zst_frame_t> frames;
+        if (!zst_frames::find({ addr, size }, &frames) || frames.size() < 2 ||
+            std::any_of(frames.begin(), frames.end(),
+                        [](const zst_frame_t & frame) {
+                            return frame.dsize_ > k_max_frame_size;
+                        })) {
+            file_ops::unmap_file(mapping);
+            return nullptr;
+        }
+        const size_t nthreads = std::min(njobs, frames.size());
+        return new (buf_alloc(sizeof(zframes_decoder_t)))
+            zframes_decoder_t(mapping, std::move(frames), nthreads);
+    }
+
+    static void
+    destroy(zframes_decoder_t * decoder) {
+        decoder->~zframes_decoder_t();
+        buf_free(decoder, sizeof(zframes_decoder_t));
+    }
+
+    void
+    run() {
+        ZSTD_DCtx *   dctx = ZSTD_createDCtx();
+        size_t        idx;
+        frame_buf_t * buf;
+        while (slots_.claim(&idx, &buf)) {
+            const zst_frame_t & frame = frames_[idx];
+            buf->okay_                = false;
+            buf->size_                = 0;
+            if (dctx != nullptr) {
+                if (frame.dsize_ > buf->cap_) {
+                    const size_t cap = roundup(frame.dsize_, 4096);
+                    buf->mem_        = reinterpret_cast<uint8_t *>(
+                        buf_realloc(buf->mem_, buf->cap_, cap));
+                    buf->cap_ = cap;
+                }
+                const size_t res = ZSTD_decompressDCtx(
+                    dctx, buf->mem_, frame.dsize_,
+                    mapping_.region(frame.coff_, frame.csize_), frame.csize_);
+                buf->okay_ = creader_t::zokay(res) && res == frame.dsize_;
+                buf->size_ = buf->okay_ ? res : 0;
+            }
+            slots_.publish(idx);
+        }
+        if (dctx != nullptr) {
+            ZSTD_freeDCtx(dctx);
+        }
+    }
+
+    // Get the next non-empty frame (the previous one is given back to the
+    // workers).
+    size_t
+    next(uint8_t ** mem_out, size_t * size_out, uint64_t * coff_end_out) {
+        for (;;) {
+            if (held_) {
+                slots_.release(next_);
+                held_ = false;
+                ++next_;
+            }
+            if (next_ == frames_.size()) {
+                *coff_end_out = mapping_.to_pair().second;
+                return reader_base_t::k_done;
+            }
+            const frame_buf_t * buf = slots_.wait(next_);
+            if (buf == nullptr || !buf->okay_) {
+                return reader_base_t::k_err;
+            }
+            held_ = true;
+            if (buf->size_ != 0) {
+                *mem_out      = buf->mem_;
+                *size_out     = buf->size_;
+                *coff_end_out = frames_[next_].coff_ + frames_[next_].csize_;
+                return reader_base_t::k_cont;
+            }
+        }
+    }
+};
+
+bool
+creader_t::zframes_init() {
+    zframes_shutdown();
+    if (njobs_ <= 1) {
+        return false;
+    }
+    zframes_ = zframes_decoder_t::create(fd_, njobs_);
+    return zframes_ != nullptr;
+}
+
+size_t
+creader_t::zframes_refill() {
+    uint64_t     coff_end = 0;
+    const size_t res      = zframes_->next(&mem_, &cap_, &coff_end);
+    if (res == k_err) {
+        return k_err;
+    }
+    fd_off_    = static_cast<ssize_t>(coff_end);
+    cur_       = mem_;
+    remaining_ = res == k_cont ? cap_ : 0;
+    return res;
+}
+
+void
+creader_t::zframes_shutdown() {
+    if (zframes_ != nullptr) {
+        zframes_decoder_t::destroy(zframes_);
+        zframes_ = nullptr;
+    }
+}
+
 bool
 creader_t::init(const char * path) {
 #if (defined TLO_MSAN) && !(defined TLO_ZSTD_MSAN)
@@ -28,6 +202,16 @@ creader_t::init(const char * path) {
         return false;
     }
 
+    // If the file is made up of independent frames decompress them in
+    // parallel. Otherwise stream it.
+    if (zframes_init()) {
+        mem_       = nullptr;
+        cur_       = nullptr;
+        remaining_ = 0;
+        cap_       = 0;
+        return true;
+    }
+
     // Initialize out decompression stream.
     if (!zinit()) {
         TLO_perr("Unable to init zstream for: %s\n", path);
@@ -63,6 +247,7 @@ creader_t::init(const char * path) {
     // Initialize our two buffers.
 
     // First buffer, stores decompressed data to be written to user.
+    alloc_     = alloc;
     mem_       = alloc;
     cur_       = mem_ + cap_out;
     remaining_ = 0;
@@ -74,6 +259,7 @@ creader_t::init(const char * path) {
     sz_compressed_  = cap_compressed;
     cap_compressed_ = cap_compressed;
 
+    readahead_init();
     return true;
 }
 
@@ -87,10 +273,9 @@ creader_t::file_fill_buf() {
 
     uint8_t *     omem       = mem_compressed_;
     const size_t  oremaining = cap_compressed_;
-    const int     fd         = fd_;
     const ssize_t fd_off     = fd_off_;
 
-    const size_t nread = file_ops::ensure_read(fd, omem, oremaining, fd_off);
+    const size_t nread = read_at(omem, oremaining);
     if (nread == file_ops::k_err) {
         return k_err;
     }
@@ -102,39 +287,48 @@ creader_t::file_fill_buf() {
 
 size_t
 creader_t::refill() {
+    if (zframes_ != nullptr) {
+        return zframes_refill();
+    }
     assert(pos_compressed_ <= sz_compressed_);
     assert(sz_compressed_ <= cap_compressed_);
 
-    size_t res;
-    // Need to refill decompression buffer.
-    if (pos_compressed_ == sz_compressed_) {
-        // We have filled it all.
-        if (sz_compressed_ != cap_compressed_) {
-            return k_done;
-        }
-
-        // Get new data from file.
-        res = file_fill_buf();
-        if (res == k_err) {
-            return k_err;
-        }
+    // A call can produce no output (i.e at the end of a frame or when
+    // skipping a skippable frame) so keep going until it does.
+    for (;;) {
+        size_t res;
+        // Need to refill decompression buffer.
+        if (pos_compressed_ == sz_compressed_) {
+            // We have filled it all.
+            if (sz_compressed_ != cap_compressed_) {
+                return k_done;
+            }
 
-        assert(pos_compressed_ == 0);
-        assert(sz_compressed_ <= cap_compressed_);
-    }
+            // Get new data from file.
+            res = file_fill_buf();
+            if (res == k_err) {
+                return k_err;
+            }
 
-    // Decompress more bytes.
-    ZSTD_inBuffer buf_in = { mem_compressed_, sz_compressed_, pos_compressed_ };
-    ZSTD_outBuffer buf_out = { mem_, cap_, 0 };
-    res                    = ZSTD_decompressStream(zstream_, &buf_out, &buf_in);
-    cur_                   = mem_;
-    remaining_             = buf_out.pos;
-    pos_compressed_        = buf_in.pos;
+            assert(pos_compressed_ == 0);
+            assert(sz_compressed_ <= cap_compressed_);
+        }
 
+        // Decompress more bytes.
+        ZSTD_inBuffer buf_in = { mem_compressed_, sz_compressed_,
+                                 pos_compressed_ };
+        ZSTD_outBuffer buf_out = { mem_, cap_, 0 };
+        res             = ZSTD_decompressStream(zstream_, &buf_out, &buf_in);
+        cur_            = mem_;
+        remaining_      = buf_out.pos;
+        pos_compressed_ = buf_in.pos;
 
-    if (zokay(res)) {
-        return k_cont;
+        if (!zokay(res)) {
+            return k_err;
+        }
+        if (remaining_ != 0) {
+            return k_cont;
+        }
     }
-    return k_err;
 }
 }  // namespace tlo
@@ -0,0 +1,184 @@
+#include "src/util/compressed-writer.h"
+#include "src/util/file-ops.h"
+#include "src/util/memory.h"
+#include "src/util/verbosity.h"
+#include "src/util/work-queue.h"
+#include "src/util/zstd-frames.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "zstd.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#ifndef TLO_ZSTD
+# error "Compressed writer requires ZSTD"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Compress a file as independent zstd frames + a seek table.
+
+namespace tlo {
+
+struct cframe_buf_t {
+    uint8_t * mem_;
+    size_t    cap_;
+    size_t    size_;
+    bool      okay_;
+};
+
+using cframe_slots_t = ordered_slots_t<cframe_buf_t>;
+
+// Worker thread, compresses frames until there are none left to claim.
+static void
+compress_frames(cframe_slots_t * slots,
+                const uint8_t *  in,
+                size_t           in_size,
+                int              level,
+                size_t           frame_size) {
+    ZSTD_CCtx * cctx = ZSTD_createCCtx();
+    if (cctx != nullptr) {
+        (void)ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+        (void)ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+    }
+    size_t         idx;
+    cframe_buf_t * buf;
+    while (slots->claim(&idx, &buf)) {
+        const size_t off  = idx * frame_size;
+        const size_t size = std::min(frame_size, in_size - off);
+        buf->okay_        = false;
+        buf->size_        = 0;
+        if (cctx != nullptr) {
+            const size_t bound = ZSTD_compressBound(size);
+            if (bound > buf->cap_) {
+                buf->mem_ = reinterpret_cast<uint8_t *>(
+                    buf_realloc(buf->mem_, buf->cap_, bound));
+                buf->cap_ = bound;
+            }
+            const size_t res =
+                ZSTD_compress2(cctx, buf->mem_, buf->cap_, in + off, size);
+            buf->okay_ = !ZSTD_isError(res);
+            buf->size_ = buf->okay_ ? res : 0;
+        }
+        slots->publish(idx);
+    }
+    ZSTD_freeCCtx(cctx);
+}
+
+bool
+compress_file_seekable(const char * in_path,
+                       const char * out_path,
+                       int          level,
+                       size_t       njobs,
+                       size_t       frame_size) {
+    assert(frame_size != 0);
+    // Sizes in the seek table are 32-bit.
+    if (frame_size > UINT32_MAX ||
+        ZSTD_compressBound(frame_size) > UINT32_MAX) {
+        TLO_perr("Frame size too large: %zu\n", frame_size);
+        return false;
+    }
+
+    const int in_fd = open(in_path, O_RDONLY);
+    if (in_fd < 0) {
+        TLO_perr("Unable to open: %s\n", in_path);
+        return false;
+    }
+    const size_t in_size = file_ops::filesize(in_fd);
+    if (in_size == file_ops::k_err) {
+        TLO_perr("Unable to get size of: %s\n", in_path);
+        close(in_fd);
+        return false;
+    }
+    file_ops::mapped_file_t in_mapping = file_ops::mapped_file_t::inactive();
+    if (in_size != 0) {
+        in_mapping = file_ops::map_file(in_fd, file_ops::k_map_read, false);
+    }
+    close(in_fd);
+    if (in_size != 0 && !in_mapping.active()) {
+        TLO_perr("Unable to map: %s\n", in_path);
+        return false;
+    }
+
+    const int out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        TLO_perr("Unable to open: %s\n", out_path);
+        if (in_mapping.active()) {
+            file_ops::unmap_file(in_mapping);
+        }
+        return false;
+    }
+
+    const size_t       nframes = (in_size + frame_size - 1) / frame_size;
+    const size_t       nthreads =
+        std::max(std::min(resolve_num_jobs(njobs), nframes), size_t{ 1 });
+    cframe_slots_t     slots(2 * nthreads, nframes);
+    vec_t<std::thread> threads;
+    threads.reserve(nthreads);
+    for (size_t i = 0; i < nthreads; ++i) {
+        threads.emplace_back([&slots, &in_mapping, in_size, level,
+                              frame_size]() {
+            compress_frames(&slots, in_mapping.to_pair().first, in_size, level,
+                            frame_size);
+        });
+    }
+
+    // Frames are written out in order as they finish.
+    vec_t<zst_frame_t> frames;
+    frames.reserve(nframes);
+    uint64_t coff = 0;
+    bool     ret  = true;
+    for (size_t i = 0; i < nframes; ++i) {
+        const cframe_buf_t * buf = slots.wait(i);
+        if (buf == nullptr || !buf->okay_) {
+            TLO_perr("Error compressing: %s\n", in_path);
+            ret = false;
+            break;
+        }
+        if (file_ops::ensure_write(out_fd, buf->mem_, buf->size_) !=
+            buf->size_) {
+            TLO_perr("Error writing: %s\n", out_path);
+            ret = false;
+            break;
+        }
+        frames.emplace_back(zst_frame_t{
+            coff, buf->size_, std::min(frame_size, in_size - i * frame_size) });
+        coff += buf->size_;
+        slots.release(i);
+    }
+    slots.close();
+    for (std::thread & thread : threads) {
+        thread.join();
+    }
+    for (cframe_buf_t & buf : slots.slots_) {
+        if (buf.mem_ != nullptr) {
+            buf_free(buf.mem_, buf.cap_);
+        }
+    }
+    if (in_mapping.active()) {
+        file_ops::unmap_file(in_mapping);
+    }
+
+    if (ret) {
+        vec_t<uint8_t> seek_table;
+        zst_frames::append_seek_table({ frames.data(), frames.size() },
+                                      &seek_table);
+        if (file_ops::ensure_write(out_fd, seek_table.data(),
+                                   seek_table.size()) != seek_table.size()) {
+            TLO_perr("Error writing: %s\n", out_path);
+            ret = false;
+        }
+    }
+    close(out_fd);
+    if (!ret) {
+        (void)remove(out_path);
+    }
+    return ret;
+}
+
+}  // namespace tlo
@@ -0,0 +1,30 @@
+#ifndef SRC_D_UTIL_D_COMPRESSED_WRITER_H_
+#define SRC_D_UTIL_D_COMPRESSED_WRITER_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Writing zstd files that can be decompressed in parallel (see
+// zstd-frames.h). The input is split into independent frames that are
+// compressed on multiple threads, then a seek table listing every frame is
+// appended. The result is still an ordinary .zst file to any other zstd tool.
+
+#include <stddef.h>
+
+namespace tlo {
+
+static constexpr int k_seekable_default_level = 9;
+// Bigger frames compress a bit better, but smaller ones are still in cache by
+// the time the reader gets to them.
+static constexpr size_t k_seekable_default_frame_size = 1024UL * 1024;
+
+// Compress `in_path` to `out_path` using `njobs` threads (0 for one per
+// core). Each frame holds `frame_size` bytes of the input. Returns false (and
+// removes `out_path`) on failure.
+bool compress_file_seekable(
+    const char * in_path,
+    const char * out_path,
+    int          level      = k_seekable_default_level,
+    size_t       njobs      = 0,
+    size_t       frame_size = k_seekable_default_frame_size);
+
+}  // namespace tlo
+#endif
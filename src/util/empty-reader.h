@@ -1,6 +1,8 @@
 #ifndef SRC_D_UTIL_D_EMPTY_READER_H_
 #define SRC_D_UTIL_D_EMPTY_READER_H_
 
+#include "src/util/reader.h"
+
 #include <assert.h>
 #include <stdint.h>
 
@@ -34,6 +36,10 @@ struct empty_reader_impl_t {
         assert(0 && "Should be unreachable");
     }
     size_t TLO_NORETURN
+    readlines(line_batch_t *) {
+        assert(0 && "Should be unreachable");
+    }
+    size_t TLO_NORETURN
     readn(uint8_t *, size_t) {
         assert(0 && "Should be unreachable");
     }
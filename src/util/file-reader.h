@@ -3,10 +3,11 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementes `file_reader_t`. Helper for reading from user file.
-// Can read from zst compressed file, ascii file, or from  process.
-// Since we parse on line-by-line basis, most important method is `nextline`.
-// Really just a manager for the actually file readers (creader_r, areader_t, or
-// preader_t).
+// Can read from zst/lz4/xz/gzip compressed file, ascii file, or from  process.
+// Since we parse on line-by-line basis, most important methods are `nextline`
+// and `nextlines`.
+// Really just a manager for the actually file readers (creader_r, areader_t,
+// preader_t, or one of the sreader_t).
 #include "src/util/ascii-reader.h"
 #include "src/util/compiler.h"
 #include "src/util/compressed-reader.h"
@@ -14,9 +15,13 @@
 #include "src/util/memory.h"
 #include "src/util/path.h"
 #include "src/util/process-reader.h"
+#include "src/util/stream-reader.h"
 #include "src/util/type-info.h"
+#include "src/util/work-queue.h"
 
 
+#include <algorithm>
+#include <array>
 #include <string_view>
 #include <variant>
 
@@ -30,9 +35,24 @@ namespace tlo {
 
 
 struct file_reader_t {
-    // Different reader type based on file being read (chosen based on file
-    // extension).
-    std::variant<detail::empty_reader_t, creader_t, areader_t, preader_t>
+    // Format of the file being read.
+    enum file_fmt_t : uint8_t {
+        k_fmt_ascii,
+        k_fmt_zst,
+        k_fmt_lz4,
+        k_fmt_xz,
+        k_fmt_gz,
+    };
+
+    // Different reader type based on file being read (chosen based on the
+    // file's magic bytes or extension, see `find_fmt`).
+    std::variant<detail::empty_reader_t,
+                 creader_t,
+                 areader_t,
+                 preader_t,
+                 lz4reader_t,
+                 xzreader_t,
+                 gzreader_t>
         reader_;
 
     uint8_t * line_;
@@ -66,6 +86,21 @@ struct file_reader_t {
         return std::holds_alternative<preader_t>(reader_);
     }
 
+    bool
+    is_lz4() const {
+        return std::holds_alternative<lz4reader_t>(reader_);
+    }
+
+    bool
+    is_xz() const {
+        return std::holds_alternative<xzreader_t>(reader_);
+    }
+
+    bool
+    is_gz() const {
+        return std::holds_alternative<gzreader_t>(reader_);
+    }
+
     bool
     is_empty() const {
         return std::holds_alternative<detail::empty_reader_t>(reader_);
@@ -82,40 +117,134 @@ struct file_reader_t {
     }
 
 
-    // Add new path for reading.
-    bool
-    init(std::string_view path) {
-        if (memchr(path.data(), ' ', path.length()) != nullptr) {
-            if (!is_process()) {
-                cleanup_if_exists();
-                reader_ = preader_t{};
+    // Format of the (null-terminated) `path` from its magic bytes. If it
+    // can't be read (or starts with a skippable frame, which zstd and lz4
+    // share) from its extension.
+    static file_fmt_t
+    find_fmt(std::string_view path) {
+        // NOLINTBEGIN(*magic*)
+        static constexpr std::array<uint8_t, 6> k_xz_magic = {
+            { 0xfd, '7', 'z', 'X', 'Z', 0 }
+        };
+        static constexpr uint32_t k_zst_magic       = 0xfd2fb528;
+        static constexpr uint32_t k_lz4_magic       = 0x184d2204;
+        static constexpr uint32_t k_skippable_magic = 0x184d2a50;
+        // Read a whole 8 bytes, a shorter buffer trips -Wstack-protector.
+        std::array<uint8_t, 8> magic{};
+        size_t                 nread = 0;
+        const int              fd    = open(path.data(), O_RDONLY);
+        if (fd >= 0) {
+            nread = file_ops::ensure_read(fd, magic.data(), magic.size(), 0);
+            close(fd);
+        }
+        if (nread != file_ops::k_err && nread >= 4) {
+            const uint32_t magic32 = static_cast<uint32_t>(magic[0]) |
+                                     (static_cast<uint32_t>(magic[1]) << 8) |
+                                     (static_cast<uint32_t>(magic[2]) << 16) |
+                                     (static_cast<uint32_t>(magic[3]) << 24);
+            if (magic[0] == 0x1f && magic[1] == 0x8b) {
+                return k_fmt_gz;
+            }
+            if (nread >= k_xz_magic.size() &&
+                std::equal(k_xz_magic.begin(), k_xz_magic.end(),
+                           magic.begin())) {
+                return k_fmt_xz;
+            }
+            if (magic32 == k_zst_magic) {
+                return k_fmt_zst;
+            }
+            if (magic32 == k_lz4_magic) {
+                return k_fmt_lz4;
+            }
+            if ((magic32 & 0xfffffff0) != k_skippable_magic) {
+                return k_fmt_ascii;
             }
         }
-        else {
-            bool is_zstd_ext =
-                path.ends_with(".zst") || path.ends_with(".zstd");
-            if (!is_zstd_ext) {
+        // NOLINTEND(*magic*)
 
-                std::string_view ext = path_get_file_start_ext(path);
-                is_zstd_ext = ext.starts_with("zst") || ext.starts_with("zstd");
+        const auto has_ext = [path](std::string_view ext) {
+            if (path.ends_with(ext)) {
+                return true;
             }
-            if (is_zstd_ext) {
-                if (!is_zst()) {
-                    cleanup_if_exists();
-                    reader_ = creader_t{};
-                }
+            // Allow <file>.<ext>.<anything>
+            return path_get_file_start_ext(path).starts_with(ext.substr(1));
+        };
+        if (has_ext(".zst")) {
+            return k_fmt_zst;
+        }
+        if (has_ext(".lz4")) {
+            return k_fmt_lz4;
+        }
+        if (has_ext(".xz")) {
+            return k_fmt_xz;
+        }
+        if (has_ext(".gz")) {
+            return k_fmt_gz;
+        }
+        return k_fmt_ascii;
+    }
+
+    // Switch to reader type `T_reader_t` (if we aren't already using it).
+    template<typename T_reader_t>
+    void
+    use_reader() {
+        if (!std::holds_alternative<T_reader_t>(reader_)) {
+            cleanup_if_exists();
+            reader_ = T_reader_t{};
+        }
+    }
+
+    static bool
+    warn_unsupported(const char * fmt_name) {
+        TLO_fprint_ifv(0, stderr,
+                       "Warning: thin-layout-optimizer was not built with %s "
+                       "support\n",
+                       fmt_name);
+        return false;
+    }
+
+    // Add new path for reading. A zstd file made up of many independent frames
+    // is decompressed on `njobs` threads (0 for one per core).
+    bool
+    init(std::string_view path, [[maybe_unused]] size_t njobs = 1) {
+        if (memchr(path.data(), ' ', path.length()) != nullptr) {
+            use_reader<preader_t>();
+        }
+        else {
+            switch (find_fmt(path)) {
+                case k_fmt_zst:
+                    use_reader<creader_t>();
 #ifndef TLO_ZSTD
-                TLO_fprint_ifv(
-                    0, stderr,
-                    "Warning: perf-hfsort was no built with ZSTD support\n");
-                return false;
+                    return warn_unsupported("ZSTD");
+#else
+                    creader()->set_njobs(resolve_num_jobs(njobs));
+                    break;
 #endif
-            }
-            else {
-                if (!is_ascii()) {
-                    cleanup_if_exists();
-                    reader_ = areader_t{};
-                }
+                case k_fmt_lz4:
+                    use_reader<lz4reader_t>();
+#ifndef TLO_LZ4
+                    return warn_unsupported("LZ4");
+#else
+                    break;
+#endif
+                case k_fmt_xz:
+                    use_reader<xzreader_t>();
+#ifndef TLO_XZ
+                    return warn_unsupported("XZ");
+#else
+                    break;
+#endif
+                case k_fmt_gz:
+                    use_reader<gzreader_t>();
+#ifndef TLO_GZIP
+                    return warn_unsupported("GZIP");
+#else
+                    break;
+#endif
+                case k_fmt_ascii:
+                default:
+                    use_reader<areader_t>();
+                    break;
             }
         }
         return std::visit(
@@ -166,6 +295,14 @@ struct file_reader_t {
             [](const auto & r) noexcept { return r.nbytes_total(); }, reader_);
     }
 
+    // Skip the first `off` bytes of the input without reading them. Only plain
+    // files can (and only before anything was read), returns false otherwise.
+    bool
+    seek(size_t off) {
+        areader_t * r = areader();
+        return r != nullptr && r->seek(off);
+    }
+
     // Get next line of file. Will be null-terminated.
     std::string_view
     nextline() {
@@ -188,6 +325,23 @@ struct file_reader_t {
         line_[res] = 0;
         return std::string_view{ reinterpret_cast<char *>(line_), res + 1 };
     }
+
+    // Get the next batch of lines (see `line_batch_t`, unlike `nextline` they
+    // are not null-terminated). Returns false once the input is exhausted.
+    bool
+    nextlines(line_batch_t * batch) {
+        size_t res = std::visit(
+            [batch](auto & r) noexcept { return r.readlines(batch); }, reader_);
+
+        if (res == reader_base_t::k_err || res == 0) {
+            if (res == reader_base_t::k_err) {
+                (void)fprintf(stderr, "Error reading input lines\n");
+            }
+            batch->clear();
+            return false;
+        }
+        return true;
+    }
 };
 
 }  // namespace tlo
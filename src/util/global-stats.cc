@@ -5,7 +5,7 @@
 
 namespace tlo {
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-total_stats_t G_total_stats{};
+thread_local total_stats_t G_total_stats{};
 void
 total_stats_t::collect(vec_t<stat_counter_t> * stats_out) const {
     stats_out->clear();
@@ -15,6 +15,7 @@ total_stats_t::collect(vec_t<stat_counter_t> * stats_out) const {
     stats_out->emplace_back(average_call_dist_);
     stats_out->emplace_back(total_insn_searched_);
     stats_out->emplace_back(total_insn_decoded_);
+    stats_out->emplace_back(total_insn_cache_hits_);
     stats_out->emplace_back(total_mappings_);
     stats_out->emplace_back(total_bad_mappings_);
     stats_out->emplace_back(total_tracked_samples_);
@@ -26,6 +27,7 @@ total_stats_t::collect(vec_t<stat_counter_t> * stats_out) const {
     stats_out->emplace_back(total_dsos_);
     stats_out->emplace_back(total_processed_dsos_);
     stats_out->emplace_back(total_processed_dso_debugs_);
+    stats_out->emplace_back(total_sym_cache_hits_);
     stats_out->emplace_back(total_funcs_);
     stats_out->emplace_back(total_edges_);
     stats_out->emplace_back(total_clumped_funcs_);
@@ -49,6 +51,9 @@ total_stats_t::reload(stat_counter_t stat_in) {
     else if (std::strcmp(stat_in.first, total_insn_decoded_.first) == 0) {
         total_insn_decoded_.second += stat_in.second;
     }
+    else if (std::strcmp(stat_in.first, total_insn_cache_hits_.first) == 0) {
+        total_insn_cache_hits_.second += stat_in.second;
+    }
     else if (std::strcmp(stat_in.first, total_mappings_.first) == 0) {
         total_mappings_.second += stat_in.second;
     }
@@ -83,6 +88,9 @@ total_stats_t::reload(stat_counter_t stat_in) {
              0) {
         total_processed_dso_debugs_.second += stat_in.second;
     }
+    else if (std::strcmp(stat_in.first, total_sym_cache_hits_.first) == 0) {
+        total_sym_cache_hits_.second += stat_in.second;
+    }
     else if (std::strcmp(stat_in.first, total_funcs_.first) == 0) {
         total_funcs_.second += stat_in.second;
     }
@@ -97,6 +105,14 @@ total_stats_t::reload(stat_counter_t stat_in) {
     }
 }
 
+void
+total_stats_t::add(const total_stats_t & other) {
+    vec_t<stat_counter_t> other_stats{};
+    other.collect(&other_stats);
+    for (const stat_counter_t & stat : other_stats) {
+        reload(stat);
+    }
+}
 
 void
 total_stats_t::dump(int vlvl, FILE * fp) const {
@@ -113,6 +129,10 @@ total_stats_t::dump(int vlvl, FILE * fp) const {
                   total_insn_searched_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_insn_decoded_.first,
                   total_insn_decoded_.second);
+    (void)fprintf(fp, "%-32s: %lf\n", total_insn_cache_hits_.first,
+                  total_insn_cache_hits_.second);
+    (void)fprintf(fp, "%-32s: %lf\n", "insn_cache_hit_rate",
+                  total_insn_cache_hits_.second / total_insn_searched_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_mappings_.first,
                   total_mappings_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_bad_mappings_.first,
@@ -134,6 +154,8 @@ total_stats_t::dump(int vlvl, FILE * fp) const {
                   total_processed_dsos_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_processed_dso_debugs_.first,
                   total_processed_dso_debugs_.second);
+    (void)fprintf(fp, "%-32s: %lf\n", total_sym_cache_hits_.first,
+                  total_sym_cache_hits_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_funcs_.first, total_funcs_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_edges_.first, total_edges_.second);
     (void)fprintf(fp, "%-32s: %lf\n", total_clumped_funcs_.first,
@@ -3,6 +3,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 // Class for tracking various stats about the profile and our processing.
+// The counters are per-thread. Threads doing work on our behalf must hand
+// their counters back (see `total_stats_t::add`) before they exit.
 
 
 #include "src/util/vec.h"
@@ -20,6 +22,7 @@ struct total_stats_t {
     stat_counter_t average_call_dist_      = { "average_call_dist", 0 };
     stat_counter_t total_insn_searched_    = { "total_insn_searched", 0 };
     stat_counter_t total_insn_decoded_     = { "total_insn_decoded", 0 };
+    stat_counter_t total_insn_cache_hits_  = { "total_insn_cache_hits", 0 };
     stat_counter_t total_mappings_         = { "total_mappings", 0 };
     stat_counter_t total_bad_mappings_     = { "total_bad_mappings", 0 };
     stat_counter_t total_tracked_samples_  = { "total_tracked_samples", 0 };
@@ -32,6 +35,7 @@ struct total_stats_t {
     stat_counter_t total_processed_dsos_   = { "total_processed_dsos", 0 };
     stat_counter_t total_processed_dso_debugs_ = { "total_processed_dso_debugs",
                                                    0 };
+    stat_counter_t total_sym_cache_hits_       = { "total_sym_cache_hits", 0 };
     stat_counter_t total_funcs_                = { "total_funcs", 0 };
     stat_counter_t total_edges_                = { "total_edges", 0 };
     stat_counter_t total_clumped_funcs_        = { "total_clumped_funcs", 0 };
@@ -41,9 +45,10 @@ struct total_stats_t {
     void dump(int vlvl = 0, FILE * fp = stdout) const;
     void collect(vec_t<stat_counter_t> * stats_out) const;
     void reload(stat_counter_t stat_in);
+    void add(const total_stats_t & other);
 };
 
-extern total_stats_t G_total_stats;
+extern thread_local total_stats_t G_total_stats;
 
 #define TLO_INCR_STAT(field)     global_stats_incr(&(G_total_stats.field))
 #define TLO_ADD_STAT(field, val) global_stats_add(&(G_total_stats.field), val)
@@ -207,6 +207,19 @@ struct bump_alloc_t {
         }
     }
 
+    // Free everything allocated so far. Start on fresh (zerod) memory so
+    // `getz` still holds.
+    void
+    reset() noexcept {
+        sys::freemem(cur_ - (Tk_buf_sz - remaining_), Tk_buf_sz);
+        for (const free_pair_t & to_free : to_free_) {
+            sys::freemem(to_free.p_, to_free.sz_);
+        }
+        to_free_.clear();
+        cur_       = reinterpret_cast<uint8_t *>(sys::getmem(Tk_buf_sz));
+        remaining_ = Tk_buf_sz;
+    }
+
     // Actual API. Get `nbytes` aligned to `alignment`.
     void *
     get(size_t nbytes, size_t alignment) noexcept {
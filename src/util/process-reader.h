@@ -78,6 +78,11 @@ struct preader_t : std_reader_base_t {
     readline(uint8_t ** mem_ptr, size_t * sz_ptr) {
         return readline_impl(this, mem_ptr, sz_ptr);
     }
+
+    size_t
+    readlines(line_batch_t * batch) {
+        return readlines_impl(this, batch);
+    }
 };
 
 }  // namespace tlo
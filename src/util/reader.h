@@ -3,8 +3,11 @@
 
 #include "src/util/bits.h"
 #include "src/util/file-ops.h"
+#include "src/util/uring.h"
+#include "src/util/vec.h"
 
 #include <span>
+#include <string_view>
 #include <tuple>
 
 #include <fcntl.h>
@@ -21,6 +24,27 @@
 // Should never be used directly, always use either creader_t or areader_t
 
 namespace tlo {
+
+// Batch of whole lines returned by `readlines`. Each line includes its trailing
+// newline (except possibly the last line of the input) and is NOT
+// null-terminated. Unless `stable_` is set, the lines point into the reader's
+// buffers and are only valid until the next read.
+struct line_batch_t {
+    vec_t<std::string_view> lines_;
+    bool                    stable_;
+
+    void
+    clear() {
+        lines_.clear();
+        stable_ = false;
+    }
+
+    bool
+    empty() const {
+        return lines_.empty();
+    }
+};
+
 // TODO: Wrapper in detail:: and pull out return enum.
 struct reader_base_t {
     // Different return statuses common to all readers.
@@ -47,6 +71,14 @@ struct reader_base_t {
     size_t    cap_;
     ssize_t   fd_off_;
     int       fd_;
+    // Reads ahead of `fd_off_` if io_uring is enabled (see `read_at`).
+    uring_readahead_t * readahead_;
+
+    // Used by `readlines` to stitch together a line that crosses the end of
+    // `mem_`.
+    uint8_t * carry_;
+    size_t    carry_len_;
+    size_t    carry_cap_;
 
     constexpr reader_base_t() = default;
 
@@ -59,6 +91,10 @@ struct reader_base_t {
     // Close the file.
     void
     fshutdown() {
+        if (readahead_ != nullptr) {
+            uring_readahead_t::destroy(readahead_);
+            readahead_ = nullptr;
+        }
         if (fd_ > 0) {
             close(fd_);
         }
@@ -88,6 +124,24 @@ struct reader_base_t {
         return true;
     }
 
+    // Start reading the file ahead of us (if io_uring is enabled). Only for
+    // readers that go through `read_at`.
+    void
+    readahead_init() {
+        assert(readahead_ == nullptr);
+        readahead_ = uring_readahead_t::create(fd_, nbytes_read());
+    }
+
+    // Read (up to) `sz` bytes at `fd_off_`. Same returns as
+    // `file_ops::ensure_read`. Doesn't update `fd_off_`.
+    size_t
+    read_at(uint8_t * mem, size_t sz) {
+        if (readahead_ != nullptr) {
+            return readahead_->read(mem, sz);
+        }
+        return file_ops::ensure_read(fd_, mem, sz, fd_off_);
+    }
+
     // Copy `oremaining` bytes for `mem_` to `omem`.
     copy_ret_t
     copy_buf(uint8_t * omem, size_t oremaining) {
@@ -171,6 +225,24 @@ struct reader_base_t {
         return { mem, sz };
     }
 
+    void
+    append_carry(const uint8_t * mem, size_t len) {
+        std::tie(carry_, carry_cap_) =
+            maybe_realloc_mem(carry_, carry_len_, carry_cap_, len);
+        memcpy(carry_ + carry_len_, mem, len);
+        carry_len_ += len;
+    }
+
+    void
+    release_carry() {
+        if (carry_ != nullptr) {
+            buf_free(carry_, carry_cap_);
+        }
+        carry_     = nullptr;
+        carry_len_ = 0;
+        carry_cap_ = 0;
+    }
+
     static void
     free_alloced_line(uint8_t * mem, size_t sz) {
         buf_free(mem, sz);
@@ -256,6 +328,72 @@ struct reader_base_t {
         *sz_ptr  = sz;
         return res == k_err ? k_err : off;
     }
+
+    // readlines, returns every whole line left in the reader's buffer without
+    // copying them (see `line_batch_t`). Only a line that crosses the end of
+    // the buffer is copied. Returns `k_err` on error or the number of lines
+    // read (zero once the input is exhausted).
+    template<typename T_reader_impl_t>
+        requires(std::is_base_of_v<reader_base_t, T_reader_impl_t>)
+    static size_t readlines_impl(T_reader_impl_t * reader,
+                                 line_batch_t *    batch) {
+        batch->clear();
+        reader->carry_len_ = 0;
+        size_t res         = k_cont;
+        for (;;) {
+            if (reader->remaining_ == 0) {
+                // The lines in the batch point into the buffer so don't refill
+                // until the next call.
+                if (!batch->empty()) {
+                    break;
+                }
+                res = reader->refill();
+                if (res) {
+                    break;
+                }
+                continue;
+            }
+            uint8_t *    cur       = reader->cur_;
+            const size_t remaining = reader->remaining_;
+            uint8_t *    newline_pos = reinterpret_cast<uint8_t *>(
+                memchr(reinterpret_cast<void *>(cur), '\n', remaining));
+            size_t       to_read = remaining;
+            if (newline_pos == nullptr) {
+                // Leave the partial line for the next call unless its the
+                // only thing left to return.
+                if (!batch->empty()) {
+                    break;
+                }
+                reader->append_carry(cur, to_read);
+            }
+            else {
+                to_read = static_cast<size_t>(newline_pos - cur) + 1;
+                if (reader->carry_len_ != 0) {
+                    reader->append_carry(cur, to_read);
+                    batch->lines_.emplace_back(
+                        reinterpret_cast<char *>(reader->carry_),
+                        reader->carry_len_);
+                    // Nothing else is added to `carry_` until the next call.
+                    reader->carry_len_ = 0;
+                }
+                else {
+                    batch->lines_.emplace_back(reinterpret_cast<char *>(cur),
+                                               to_read);
+                }
+            }
+            reader->cur_ += to_read;
+            reader->remaining_ = remaining - to_read;
+        }
+        if (res == k_err) {
+            return k_err;
+        }
+        // Last line had no newline.
+        if (batch->empty() && reader->carry_len_ != 0) {
+            batch->lines_.emplace_back(reinterpret_cast<char *>(reader->carry_),
+                                       reader->carry_len_);
+        }
+        return batch->lines_.size();
+    }
 };
 
 }  // namespace tlo
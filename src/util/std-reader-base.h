@@ -14,7 +14,9 @@ namespace tlo {
 
 
 struct std_reader_base_t : reader_base_t {
-    static constexpr size_t k_default_mem_size = 4096;
+    // Large enough that `readlines` returns a good number of (LBR) lines per
+    // batch.
+    static constexpr size_t k_default_mem_size = 128 * 1024;
 
 
     void
@@ -23,6 +25,7 @@ struct std_reader_base_t : reader_base_t {
             sys::freemem(mem_, cap_);
             mem_ = nullptr;
         }
+        release_carry();
     }
 
     bool
@@ -55,7 +58,7 @@ struct std_reader_base_t : reader_base_t {
 
         size_t res;
         if constexpr (k_pread) {
-            res = file_ops::ensure_read(fd_, mem_, cap_, fd_off_);
+            res = read_at(mem_, cap_);
         }
         else {
             res = file_ops::ensure_read(fd_, mem_, cap_);
@@ -0,0 +1,442 @@
+#ifndef SRC_D_UTIL_D_STR_SCAN_H_
+#define SRC_D_UTIL_D_STR_SCAN_H_
+
+#include "src/util/compiler.h"
+
+#include <bit>
+#include <limits>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined __SSE2__) || (defined __AVX2__) || (defined __AVX512BW__)
+# include <immintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernels for scanning text (used by the perf script parser).
+//
+// Delimiter searches are done 64/32/16 bytes at a time with AVX512BW/AVX2/SSE2
+// and 8 bytes at a time with SWAR (SIMD within a register) otherwise. We build
+// with `-march=native` so the widest available is picked at compile time. Hex
+// and decimal numbers are converted 8 digits at a time with SWAR.
+//
+// Every variant gives the exact same result as the scalar loop it replaces
+// (they are all kept around so that can be tested).
+
+namespace tlo {
+namespace scan {
+namespace detail {
+
+static constexpr uint64_t k_ones  = 0x0101010101010101UL;
+static constexpr uint64_t k_highs = k_ones * 0x80U;
+static constexpr uint64_t k_low7s = k_ones * 0x7fU;
+
+static uint64_t
+load8(const char * p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Missing bytes are zero (never a digit).
+static uint64_t
+load_upto8(const char * p, size_t n) {
+    uint64_t v = 0;
+    if (n >= sizeof(v)) {
+        return load8(p);
+    }
+    memcpy(&v, p, n);
+    return v;
+}
+
+// High bit of each byte is set iff the byte is `c`.
+static constexpr uint64_t
+bytes_eq(uint64_t v, char c) {
+    const uint64_t t = v ^ (k_ones * static_cast<uint8_t>(c));
+    return ~(((t & k_low7s) + k_low7s) | t) & k_highs;
+}
+
+// High bit of each byte is set iff the byte is in `[lo, hi]`.
+static constexpr uint64_t
+bytes_in(uint64_t v, uint64_t low7s, uint8_t lo, uint8_t hi) {
+    const uint64_t ge_lo = low7s + k_ones * (0x80U - lo);
+    const uint64_t gt_hi = low7s + k_ones * (0x7fU - hi);
+    return ge_lo & ~gt_hi & ~v & k_highs;
+}
+
+static constexpr uint64_t
+dec_digits(uint64_t v) {
+    return bytes_in(v, v & k_low7s, '0', '9');
+}
+
+static constexpr uint64_t
+hex_digits(uint64_t v) {
+    const uint64_t low7s = v & k_low7s;
+    return bytes_in(v, low7s, '0', '9') |
+           bytes_in(v, low7s | (k_ones * 0x20U), 'a', 'f');
+}
+
+// Number of leading bytes set in `mask` (high bit of each byte).
+static constexpr size_t
+leading_bytes(uint64_t mask) {
+    const uint64_t missing = ~mask & k_highs;
+    return missing == 0 ? 8 : static_cast<size_t>(std::countr_zero(missing)) / 8;
+}
+
+// Value of the first `n` (1-8) digits in `v` (each byte is the digit value,
+// first digit in the low byte).
+template<uint64_t k_base>
+static constexpr uint64_t
+combine_digits(uint64_t v, size_t n) {
+    // Move the digits to the top so the (ignored) low bytes are leading zeros.
+    v <<= 8 * (8 - n);
+    if constexpr (k_base == 16) {
+        v = ((v << 4U) + (v >> 8U)) & 0x00ff00ff00ff00ffUL;
+        v = ((v << 8U) + (v >> 16U)) & 0x0000ffff0000ffffUL;
+        return ((v << 16U) + (v >> 32U)) & 0x00000000ffffffffUL;
+    }
+    else {
+        static_assert(k_base == 10);
+        v = (v * 10 + (v >> 8U)) & 0x00ff00ff00ff00ffUL;
+        v = (v * 100 + (v >> 16U)) & 0x0000ffff0000ffffUL;
+        return (v * 10000 + (v >> 32U)) & 0x00000000ffffffffUL;
+    }
+}
+
+static constexpr uint64_t
+hex_digit_values(uint64_t v) {
+    // '0'-'9' are 0x30-0x39, 'a'-'f'/'A'-'F' are 0x61-0x66/0x41-0x46 (bit 6
+    // set and 9 less than their value in the low nibble).
+    return (v & (k_ones * 0xfU)) + ((v >> 6U) & k_ones) * 9;
+}
+
+static constexpr uint64_t
+dec_digit_values(uint64_t v) {
+    return v & (k_ones * 0xfU);
+}
+
+template<uint64_t k_base>
+static constexpr uint64_t
+digits(uint64_t v) {
+    return k_base == 16 ? hex_digits(v) : dec_digits(v);
+}
+
+template<uint64_t k_base>
+static constexpr uint64_t
+digit_values(uint64_t v) {
+    return k_base == 16 ? hex_digit_values(v) : dec_digit_values(v);
+}
+
+// Parse up to 16 digits, 8 at a time. Returns false if there are more than 16
+// digits (caller has to do overflow checking).
+template<uint64_t k_base>
+static bool
+parse_digits(const char * p, size_t n, uint64_t * val_out, size_t * len_out) {
+    const uint64_t v0   = load_upto8(p, n);
+    const size_t   len0 = leading_bytes(digits<k_base>(v0));
+    if (len0 != 8 || n == 8) {
+        *val_out =
+            len0 == 0 ? 0 : combine_digits<k_base>(digit_values<k_base>(v0), len0);
+        *len_out = len0;
+        return true;
+    }
+
+    const uint64_t v1   = load_upto8(p + 8, n - 8);
+    const size_t   len1 = leading_bytes(digits<k_base>(v1));
+    if (len1 == 8 && n > 16 && (digits<k_base>(static_cast<uint8_t>(p[16])) != 0)) {
+        return false;
+    }
+    const uint64_t hi = combine_digits<k_base>(digit_values<k_base>(v0), 8);
+    if (len1 == 0) {
+        *val_out = hi;
+        *len_out = 8;
+        return true;
+    }
+    const uint64_t lo = combine_digits<k_base>(digit_values<k_base>(v1), len1);
+    if constexpr (k_base == 16) {
+        *val_out = (hi << (4 * len1)) | lo;
+    }
+    else {
+        static constexpr uint64_t k_pow10[9] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+        };
+        *val_out = hi * k_pow10[len1] + lo;
+    }
+    *len_out = 8 + len1;
+    return true;
+}
+
+static size_t
+find_first_of_scalar(const char * p, size_t n, char c0, char c1) {
+    size_t i;
+    for (i = 0; i < n && p[i] != c0 && p[i] != c1; ++i) {
+    }
+    return i;
+}
+
+static size_t
+find_first_not_of_scalar(const char * p, size_t n, char c) {
+    size_t i;
+    for (i = 0; i < n && p[i] == c; ++i) {
+    }
+    return i;
+}
+
+static size_t
+find_first_of_swar(const char * p, size_t n, char c0, char c1) {
+    size_t i = 0;
+    for (; (i + 8) <= n; i += 8) {
+        const uint64_t v    = load8(p + i);
+        const uint64_t hits = bytes_eq(v, c0) | bytes_eq(v, c1);
+        if (hits != 0) {
+            return i + static_cast<size_t>(std::countr_zero(hits)) / 8;
+        }
+    }
+    return i + find_first_of_scalar(p + i, n - i, c0, c1);
+}
+
+static size_t
+find_first_not_of_swar(const char * p, size_t n, char c) {
+    size_t i = 0;
+    for (; (i + 8) <= n; i += 8) {
+        const uint64_t misses = ~bytes_eq(load8(p + i), c) & k_highs;
+        if (misses != 0) {
+            return i + static_cast<size_t>(std::countr_zero(misses)) / 8;
+        }
+    }
+    return i + find_first_not_of_scalar(p + i, n - i, c);
+}
+
+#ifdef __SSE2__
+static size_t
+find_first_of_sse2(const char * p, size_t n, char c0, char c1) {
+    const __m128i v0 = _mm_set1_epi8(c0);
+    const __m128i v1 = _mm_set1_epi8(c1);
+    size_t        i  = 0;
+    for (; (i + 16) <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i_u *>(p + i));
+        const uint32_t hits = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, v0), _mm_cmpeq_epi8(v, v1))));
+        if (hits != 0) {
+            return i + static_cast<size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_first_of_swar(p + i, n - i, c0, c1);
+}
+
+static size_t
+find_first_not_of_sse2(const char * p, size_t n, char c) {
+    const __m128i vc = _mm_set1_epi8(c);
+    size_t        i  = 0;
+    for (; (i + 16) <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i_u *>(p + i));
+        const uint32_t misses =
+            ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc))) &
+            0xffffU;
+        if (misses != 0) {
+            return i + static_cast<size_t>(std::countr_zero(misses));
+        }
+    }
+    return i + find_first_not_of_swar(p + i, n - i, c);
+}
+#endif
+
+#ifdef __AVX2__
+static size_t
+find_first_of_avx2(const char * p, size_t n, char c0, char c1) {
+    const __m256i v0 = _mm256_set1_epi8(c0);
+    const __m256i v1 = _mm256_set1_epi8(c1);
+    size_t        i  = 0;
+    for (; (i + 32) <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i_u *>(p + i));
+        const uint32_t hits = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, v0),
+                                                 _mm256_cmpeq_epi8(v, v1))));
+        if (hits != 0) {
+            return i + static_cast<size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_first_of_sse2(p + i, n - i, c0, c1);
+}
+
+static size_t
+find_first_not_of_avx2(const char * p, size_t n, char c) {
+    const __m256i vc = _mm256_set1_epi8(c);
+    size_t        i  = 0;
+    for (; (i + 32) <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i_u *>(p + i));
+        const uint32_t misses = ~static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc)));
+        if (misses != 0) {
+            return i + static_cast<size_t>(std::countr_zero(misses));
+        }
+    }
+    return i + find_first_not_of_sse2(p + i, n - i, c);
+}
+#endif
+
+#ifdef __AVX512BW__
+static size_t
+find_first_of_avx512(const char * p, size_t n, char c0, char c1) {
+    const __m512i v0 = _mm512_set1_epi8(c0);
+    const __m512i v1 = _mm512_set1_epi8(c1);
+    size_t        i  = 0;
+    for (; (i + 64) <= n; i += 64) {
+        const __m512i  v    = _mm512_loadu_si512(p + i);
+        const uint64_t hits = _mm512_cmpeq_epi8_mask(v, v0) |
+                              _mm512_cmpeq_epi8_mask(v, v1);
+        if (hits != 0) {
+            return i + static_cast<size_t>(std::countr_zero(hits));
+        }
+    }
+    return i + find_first_of_avx2(p + i, n - i, c0, c1);
+}
+
+static size_t
+find_first_not_of_avx512(const char * p, size_t n, char c) {
+    const __m512i vc = _mm512_set1_epi8(c);
+    size_t        i  = 0;
+    for (; (i + 64) <= n; i += 64) {
+        const uint64_t misses =
+            _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(p + i), vc);
+        if (misses != 0) {
+            return i + static_cast<size_t>(std::countr_zero(misses));
+        }
+    }
+    return i + find_first_not_of_avx2(p + i, n - i, c);
+}
+#endif
+
+// The widest available.
+static size_t
+find_first_of_wide(const char * p, size_t n, char c0, char c1) {
+#if (defined __AVX512BW__)
+    return find_first_of_avx512(p, n, c0, c1);
+#elif (defined __AVX2__)
+    return find_first_of_avx2(p, n, c0, c1);
+#elif (defined __SSE2__)
+    return find_first_of_sse2(p, n, c0, c1);
+#else
+    return find_first_of_swar(p, n, c0, c1);
+#endif
+}
+
+static size_t
+find_first_not_of_wide(const char * p, size_t n, char c) {
+#if (defined __AVX512BW__)
+    return find_first_not_of_avx512(p, n, c);
+#elif (defined __AVX2__)
+    return find_first_not_of_avx2(p, n, c);
+#elif (defined __SSE2__)
+    return find_first_not_of_sse2(p, n, c);
+#else
+    return find_first_not_of_swar(p, n, c);
+#endif
+}
+
+// Parsing is one long dependency chain and most searches end within a char or
+// two, so check those before paying the latency of a vector compare.
+static constexpr size_t k_nprobe = 2;
+
+}  // namespace detail
+
+// Index of the first char in `[p, p + n)` that is `c0` or `c1` (`n` if
+// there is none).
+static size_t
+find_first_of(const char * p, size_t n, char c0, char c1) {
+    for (size_t i = 0; i < detail::k_nprobe; ++i) {
+        if (i == n || p[i] == c0 || p[i] == c1) {
+            return i;
+        }
+    }
+    return detail::k_nprobe +
+           detail::find_first_of_wide(p + detail::k_nprobe,
+                                      n - detail::k_nprobe, c0, c1);
+}
+
+// Index of the first char in `[p, p + n)` that is not `c` (`n` if there is
+// none).
+static size_t
+find_first_not_of(const char * p, size_t n, char c) {
+    for (size_t i = 0; i < detail::k_nprobe; ++i) {
+        if (i == n || p[i] != c) {
+            return i;
+        }
+    }
+    return detail::k_nprobe +
+           detail::find_first_not_of_wide(p + detail::k_nprobe,
+                                          n - detail::k_nprobe, c);
+}
+
+// Parse the base `k_base` digits (no prefix/sign) at the start of `[p, p + n)`
+// as a `T_t`. Same result as `std::from_chars(p, p + n, val, k_base)`. Returns
+// the number of chars consumed or 0 on error (no digits or overflow).
+// `*val_out` is only set on success.
+template<typename T_t, uint64_t k_base>
+static size_t
+parse_uint(const char * p, size_t n, T_t * val_out) {
+    static_assert(std::numeric_limits<T_t>::is_integer &&
+                  !std::numeric_limits<T_t>::is_signed);
+    static_assert(k_base == 10 || k_base == 16);
+    // Most digits we can have and know the value fits in `T_t`.
+    static constexpr size_t k_max_digits =
+        k_base == 16 ? sizeof(T_t) * 2 : std::numeric_limits<T_t>::digits10;
+
+    uint64_t val;
+    size_t   len;
+    if (TLO_LIKELY(detail::parse_digits<k_base>(p, n, &val, &len) &&
+                   len <= k_max_digits)) {
+        if (len != 0) {
+            *val_out = static_cast<T_t>(val);
+        }
+        return len;
+    }
+
+    // Slow path, needs overflow checking.
+    T_t          out = 0;
+    const char * end = p + n;
+    const char * cur = p;
+    for (; cur != end; ++cur) {
+        uint64_t digit;
+        if (*cur >= '0' && *cur <= '9') {
+            digit = static_cast<uint64_t>(*cur - '0');
+        }
+        else if (k_base == 16 && (*cur | 0x20) >= 'a' && (*cur | 0x20) <= 'f') {
+            digit = static_cast<uint64_t>((*cur | 0x20) - 'a' + 10);
+        }
+        else {
+            break;
+        }
+        if (out > (std::numeric_limits<T_t>::max() - digit) / k_base) {
+            return 0;
+        }
+        out = static_cast<T_t>(out * k_base + digit);
+    }
+    if (cur != p) {
+        *val_out = out;
+    }
+    return static_cast<size_t>(cur - p);
+}
+
+template<typename T_t>
+static size_t
+parse_hex(const char * p, size_t n, T_t * val_out) {
+    return parse_uint<T_t, 16>(p, n, val_out);
+}
+
+template<typename T_t>
+static size_t
+parse_dec(const char * p, size_t n, T_t * val_out) {
+    return parse_uint<T_t, 10>(p, n, val_out);
+}
+
+}  // namespace scan
+}  // namespace tlo
+
+#endif
@@ -0,0 +1,385 @@
+#ifndef SRC_D_UTIL_D_STREAM_READER_H_
+#define SRC_D_UTIL_D_STREAM_READER_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Readers for streaming lz4 (frame format), xz, and gzip compressed files.
+// Partially implemented in reader_base_t. Each format is just a codec hooked
+// into `sreader_t` which handles the buffering (the same way creader_t does
+// for zstd). Formats we weren't built with are empty readers (and we fail if
+// we try to read one).
+//
+// A codec has:
+//      bool   init();
+//      void   cleanup();
+//      // Decompress from `in[*in_pos, in_sz)` into `out`. `last` if there is
+//      // no input after `in`. Returns bytes written or `reader_base_t::k_err`.
+//      size_t decompress(const uint8_t * in, size_t in_sz, size_t * in_pos,
+//                        uint8_t * out, size_t out_cap, bool last);
+//      // Not in the middle of a frame/stream (so the input may end here).
+//      bool   at_end() const;
+
+#include "src/util/compiler.h"
+#include "src/util/file-ops.h"
+#include "src/util/memory.h"
+#include "src/util/reader.h"
+#include "src/util/verbosity.h"
+
+#include <limits>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef TLO_LZ4
+# include "lz4frame.h"
+#endif
+#ifdef TLO_XZ
+# include "lzma.h"
+#endif
+#ifdef TLO_GZIP
+# include "zlib.h"
+#endif
+
+#include "src/util/empty-reader.h"
+
+namespace tlo {
+
+template<typename T_codec_t>
+struct sreader_t : reader_base_t {
+    static constexpr size_t k_in_size  = 128 * 1024;
+    static constexpr size_t k_out_size = 256 * 1024;
+
+    // Compressed data (after `mem_` in the same allocation).
+    uint8_t * mem_in_;
+    size_t    pos_in_;
+    size_t    sz_in_;
+    // Read the whole file into `mem_in_`.
+    bool      eof_in_;
+    T_codec_t codec_;
+
+    constexpr sreader_t() = default;
+
+    void
+    release() {
+        if (mem_ != nullptr) {
+            sys::freemem(mem_, k_out_size + k_in_size);
+            mem_ = nullptr;
+        }
+        release_carry();
+    }
+
+    void
+    shutdown() {
+        fshutdown();
+        codec_.cleanup();
+    }
+
+    void
+    cleanup() {
+        shutdown();
+        release();
+    }
+
+    bool
+    init(const char * path) {
+        codec_.cleanup();
+        if (!finit(path)) {
+            return false;
+        }
+        if (!codec_.init()) {
+            TLO_perr("Unable to init %s decoder for: %s\n", T_codec_t::k_name,
+                     path);
+            shutdown();
+            return false;
+        }
+        if (mem_ == nullptr) {
+            mem_ = reinterpret_cast<uint8_t *>(
+                sys::getmem(k_out_size + k_in_size));
+        }
+        cap_       = k_out_size;
+        cur_       = mem_ + cap_;
+        remaining_ = 0;
+
+        mem_in_ = mem_ + k_out_size;
+        pos_in_ = 0;
+        sz_in_  = 0;
+        eof_in_ = false;
+
+        readahead_init();
+        return true;
+    }
+
+    size_t
+    refill() {
+        assert(pos_in_ <= sz_in_);
+        // A call can produce no output (i.e while reading a frame header) so
+        // keep going until it does.
+        for (;;) {
+            if (pos_in_ == sz_in_ && !eof_in_) {
+                const size_t nread = read_at(mem_in_, k_in_size);
+                if (nread == file_ops::k_err) {
+                    return k_err;
+                }
+                fd_off_ += static_cast<ssize_t>(nread);
+                pos_in_ = 0;
+                sz_in_  = nread;
+                eof_in_ = nread != k_in_size;
+            }
+
+            const size_t prev_pos = pos_in_;
+            const size_t nout = codec_.decompress(mem_in_, sz_in_, &pos_in_,
+                                                  mem_, cap_, eof_in_);
+            if (nout == k_err) {
+                return k_err;
+            }
+            cur_       = mem_;
+            remaining_ = nout;
+            if (nout != 0) {
+                return k_cont;
+            }
+            if (pos_in_ == sz_in_ && eof_in_) {
+                // Otherwise the file is truncated.
+                return codec_.at_end() ? k_done : k_err;
+            }
+            // Neither output nor progress on the input.
+            if (pos_in_ == prev_pos && pos_in_ != sz_in_) {
+                return k_err;
+            }
+        }
+    }
+
+    size_t
+    init_output() {
+        if (remaining_ == 0) {
+            return refill();
+        }
+        return k_cont;
+    }
+
+    size_t
+    readn(uint8_t * umem, size_t usz) {
+        return readn_impl(this, umem, usz);
+    }
+
+    size_t
+    readline(uint8_t ** mem_ptr, size_t * sz_ptr) {
+        return readline_impl(this, mem_ptr, sz_ptr);
+    }
+
+    // Lines are parsed in place from the decompression output buffer.
+    size_t
+    readlines(line_batch_t * batch) {
+        return readlines_impl(this, batch);
+    }
+};
+
+#ifdef TLO_LZ4
+struct lz4_codec_t {
+    static constexpr const char * k_name = "lz4";
+
+    LZ4F_dctx * dctx_;
+    bool        at_end_;
+
+    bool
+    init() {
+        if (LZ4F_isError(
+                LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION))) {
+            dctx_ = nullptr;
+            return false;
+        }
+        at_end_ = true;
+        return true;
+    }
+
+    void
+    cleanup() {
+        if (dctx_ != nullptr) {
+            (void)LZ4F_freeDecompressionContext(dctx_);
+            dctx_ = nullptr;
+        }
+    }
+
+    size_t
+    decompress(const uint8_t * in,
+               size_t          in_sz,
+               size_t *        in_pos,
+               uint8_t *       out,
+               size_t          out_cap,
+               bool            last) {
+        (void)last;
+        size_t src_sz = in_sz - *in_pos;
+        size_t dst_sz = out_cap;
+        if (src_sz == 0 && at_end_) {
+            return 0;
+        }
+        // Frames following each other are decoded one after the other.
+        const size_t res =
+            LZ4F_decompress(dctx_, out, &dst_sz, in + *in_pos, &src_sz, nullptr);
+        if (LZ4F_isError(res)) {
+            return reader_base_t::k_err;
+        }
+        *in_pos += src_sz;
+        // Zero means the frame is done.
+        at_end_ = res == 0;
+        return dst_sz;
+    }
+
+    bool
+    at_end() const {
+        return at_end_;
+    }
+};
+using lz4reader_t = sreader_t<lz4_codec_t>;
+#else
+using lz4reader_t = detail::empty_reader_impl_t<3>;
+#endif
+
+#ifdef TLO_XZ
+struct xz_codec_t {
+    static constexpr const char * k_name = "xz";
+
+    lzma_stream strm_;
+    bool        active_;
+    bool        started_;
+    bool        done_;
+
+    bool
+    init() {
+        strm_ = LZMA_STREAM_INIT;
+        // Handles files made of multiple streams.
+        if (lzma_stream_decoder(&strm_, std::numeric_limits<uint64_t>::max(),
+                                LZMA_CONCATENATED) != LZMA_OK) {
+            return false;
+        }
+        active_  = true;
+        started_ = false;
+        done_    = false;
+        return true;
+    }
+
+    void
+    cleanup() {
+        if (active_) {
+            lzma_end(&strm_);
+            active_ = false;
+        }
+    }
+
+    size_t
+    decompress(const uint8_t * in,
+               size_t          in_sz,
+               size_t *        in_pos,
+               uint8_t *       out,
+               size_t          out_cap,
+               bool            last) {
+        if (done_) {
+            return 0;
+        }
+        strm_.next_in   = in + *in_pos;
+        strm_.avail_in  = in_sz - *in_pos;
+        strm_.next_out  = out;
+        strm_.avail_out = out_cap;
+        // With `LZMA_CONCATENATED` the decoder only knows the last stream is
+        // done once we tell it there is no more input.
+        const lzma_ret res = lzma_code(&strm_, last ? LZMA_FINISH : LZMA_RUN);
+        started_ |= strm_.avail_in != (in_sz - *in_pos);
+        *in_pos = in_sz - strm_.avail_in;
+        if (res == LZMA_STREAM_END) {
+            done_ = true;
+        }
+        // Buffer error is just no progress (i.e truncated input, which the
+        // reader catches).
+        else if (res != LZMA_OK && res != LZMA_BUF_ERROR) {
+            return reader_base_t::k_err;
+        }
+        return out_cap - strm_.avail_out;
+    }
+
+    bool
+    at_end() const {
+        return done_ || !started_;
+    }
+};
+using xzreader_t = sreader_t<xz_codec_t>;
+#else
+using xzreader_t = detail::empty_reader_impl_t<4>;
+#endif
+
+#ifdef TLO_GZIP
+struct gz_codec_t {
+    static constexpr const char * k_name = "gzip";
+    // Max window and detect gzip/zlib headers.
+    static constexpr int k_window_bits = 15 + 32;
+
+    z_stream strm_;
+    bool     active_;
+    bool     at_end_;
+
+    bool
+    init() {
+        strm_ = z_stream{};
+        // `inflateInit2` is a macro with a C-style cast.
+        TLO_DISABLE_WARNING("-Wold-style-cast")
+        const int res = inflateInit2(&strm_, k_window_bits);
+        TLO_REENABLE_WARNING
+        if (res != Z_OK) {
+            return false;
+        }
+        active_ = true;
+        at_end_ = true;
+        return true;
+    }
+
+    void
+    cleanup() {
+        if (active_) {
+            (void)inflateEnd(&strm_);
+            active_ = false;
+        }
+    }
+
+    size_t
+    decompress(const uint8_t * in,
+               size_t          in_sz,
+               size_t *        in_pos,
+               uint8_t *       out,
+               size_t          out_cap,
+               bool            last) {
+        (void)last;
+        if (at_end_) {
+            if (*in_pos == in_sz) {
+                return 0;
+            }
+            // gzip files can be multiple members concatenated.
+            if (inflateReset(&strm_) != Z_OK) {
+                return reader_base_t::k_err;
+            }
+            at_end_ = false;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        strm_.next_in   = const_cast<uint8_t *>(in + *in_pos);
+        strm_.avail_in  = static_cast<uInt>(in_sz - *in_pos);
+        strm_.next_out  = out;
+        strm_.avail_out = static_cast<uInt>(out_cap);
+        const int res   = inflate(&strm_, Z_NO_FLUSH);
+        *in_pos         = in_sz - strm_.avail_in;
+        if (res == Z_STREAM_END) {
+            at_end_ = true;
+        }
+        else if (res != Z_OK && res != Z_BUF_ERROR) {
+            return reader_base_t::k_err;
+        }
+        return out_cap - strm_.avail_out;
+    }
+
+    bool
+    at_end() const {
+        return at_end_;
+    }
+};
+using gzreader_t = sreader_t<gz_codec_t>;
+#else
+using gzreader_t = detail::empty_reader_impl_t<5>;
+#endif
+
+}  // namespace tlo
+#endif
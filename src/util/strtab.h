@@ -258,6 +258,16 @@ struct strtab_t {
         return sz;
     }
 
+    // Drop all the strings (anything returned so far is no longer valid).
+    void
+    clear() {
+        set_.set_.clear();
+        if constexpr (k_maybe_empty) {
+            set_.hit_empty_ = false;
+        }
+        allocator_.reset();
+    }
+
     struct strtab_hasher_t {
         using is_avalanching = void;
         using is_transparent = void;
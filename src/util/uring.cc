@@ -0,0 +1,461 @@
+#include "src/util/uring.h"
+#include "src/util/file-ops.h"
+#include "src/util/memory.h"
+
+#include <algorithm>
+#include <new>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>) && (defined __NR_io_uring_setup)
+# include <linux/io_uring.h>
+# define TLO_HAS_URING
+#endif
+
+namespace tlo {
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+bool uring_t::G_enabled = false;
+
+#ifdef TLO_HAS_URING
+
+bool
+uring_t::available() {
+    static const bool k_available = []() {
+        uring_t ring{};
+        const bool ok = ring.init(1);
+        ring.cleanup();
+        return ok;
+    }();
+    return k_available;
+}
+
+// Offsets the kernel gives us into the ring mappings.
+static uint32_t *
+ring_field(void * ring, uint32_t off) {
+    return static_cast<uint32_t *>(
+        static_cast<void *>(static_cast<uint8_t *>(ring) + off));
+}
+
+bool
+uring_t::init(uint32_t entries) {
+    *this = uring_t{};
+
+    io_uring_params params{};
+    const long fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return false;
+    }
+    fd_ = static_cast<int>(fd);
+    // We need `IORING_OP_READ` (5.6, same as `IORING_FEAT_RW_CUR_POS`) and
+    // the rings to be mapped together.
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0 ||
+        (params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+        cleanup();
+        return false;
+    }
+
+    sq_map_sz_ = std::max(
+        params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    sq_map_ = mmap(nullptr, sq_map_sz_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED) {
+        sq_map_ = nullptr;
+        cleanup();
+        return false;
+    }
+    // Single mapping for both rings.
+    cq_map_    = sq_map_;
+    cq_map_sz_ = 0;
+
+    sqes_sz_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_    = mmap(nullptr, sqes_sz_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        cleanup();
+        return false;
+    }
+
+    sq_head_  = ring_field(sq_map_, params.sq_off.head);
+    sq_tail_  = ring_field(sq_map_, params.sq_off.tail);
+    sq_mask_  = ring_field(sq_map_, params.sq_off.ring_mask);
+    sq_array_ = ring_field(sq_map_, params.sq_off.array);
+
+    cq_head_ = ring_field(cq_map_, params.cq_off.head);
+    cq_tail_ = ring_field(cq_map_, params.cq_off.tail);
+    cq_mask_ = ring_field(cq_map_, params.cq_off.ring_mask);
+    cqes_    = ring_field(cq_map_, params.cq_off.cqes);
+
+    entries_ = params.sq_entries;
+    nqueued_ = 0;
+    return true;
+}
+
+void
+uring_t::cleanup() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_sz_);
+    }
+    if (cq_map_ != nullptr && cq_map_ != sq_map_) {
+        munmap(cq_map_, cq_map_sz_);
+    }
+    if (sq_map_ != nullptr) {
+        munmap(sq_map_, sq_map_sz_);
+    }
+    if (fd_ > 0) {
+        close(fd_);
+    }
+    *this = uring_t{};
+}
+
+bool
+uring_t::queue_read(int      fd,
+                    void *   buf,
+                    uint32_t len,
+                    uint64_t off,
+                    uint64_t user_data) {
+    // We are the only producer so only the head (updated by the kernel)
+    // needs to be synchronized.
+    const uint32_t tail = *sq_tail_;
+    const uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if ((tail - head) >= entries_) {
+        return false;
+    }
+    const uint32_t idx = tail & *sq_mask_;
+    io_uring_sqe * sqe = reinterpret_cast<io_uring_sqe *>(sqes_) + idx;
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = fd;
+    sqe->addr      = reinterpret_cast<uint64_t>(buf);
+    sqe->len       = len;
+    sqe->off       = off;
+    sqe->user_data = user_data;
+    sq_array_[idx] = idx;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++nqueued_;
+    return true;
+}
+
+bool
+uring_t::submit(uint32_t wait_nr) {
+    for (;;) {
+        const long res =
+            syscall(__NR_io_uring_enter, fd_, nqueued_, wait_nr,
+                    wait_nr != 0 ? IORING_ENTER_GETEVENTS : 0U, nullptr, 0);
+        if (res >= 0) {
+            assert(static_cast<uint32_t>(res) <= nqueued_);
+            nqueued_ -= static_cast<uint32_t>(res);
+            return true;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return false;
+        }
+    }
+}
+
+bool
+uring_t::next_cqe(uint64_t * user_data_out, int32_t * res_out) {
+    // Likewise we are the only consumer.
+    const uint32_t head = *cq_head_;
+    const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    const io_uring_cqe * cqe =
+        reinterpret_cast<const io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+    *user_data_out = cqe->user_data;
+    *res_out       = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else
+
+bool
+uring_t::available() {
+    return false;
+}
+
+bool
+uring_t::init(uint32_t entries) {
+    (void)entries;
+    *this = uring_t{};
+    return false;
+}
+
+void
+uring_t::cleanup() {
+    *this = uring_t{};
+}
+
+bool
+uring_t::queue_read(int      fd,
+                    void *   buf,
+                    uint32_t len,
+                    uint64_t off,
+                    uint64_t user_data) {
+    (void)fd;
+    (void)buf;
+    (void)len;
+    (void)off;
+    (void)user_data;
+    return false;
+}
+
+bool
+uring_t::submit(uint32_t wait_nr) {
+    (void)wait_nr;
+    return false;
+}
+
+bool
+uring_t::next_cqe(uint64_t * user_data_out, int32_t * res_out) {
+    (void)user_data_out;
+    (void)res_out;
+    return false;
+}
+
+#endif
+
+bool
+uring_t::wait_cqe(uint64_t * user_data_out, int32_t * res_out) {
+    while (!next_cqe(user_data_out, res_out)) {
+        if (!submit(1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uring_readahead_t *
+uring_readahead_t::create(int fd, uint64_t off) {
+    if (!uring_t::enabled()) {
+        return nullptr;
+    }
+    const size_t size = file_ops::filesize(fd);
+    if (size == file_ops::k_err || size < off + k_min_file_size) {
+        return nullptr;
+    }
+    uring_readahead_t * readahead = new (buf_alloc(sizeof(uring_readahead_t)))
+        uring_readahead_t{};
+    if (!readahead->ring_.init(k_depth)) {
+        buf_free(readahead, sizeof(uring_readahead_t));
+        return nullptr;
+    }
+    readahead->bufs_ =
+        reinterpret_cast<uint8_t *>(sys::getmem(k_depth * k_chunk_size));
+    readahead->fd_       = fd;
+    readahead->next_off_ = off;
+    for (size_t slot = 0; slot < k_depth; ++slot) {
+        if (!readahead->queue_slot(slot)) {
+            destroy(readahead);
+            return nullptr;
+        }
+    }
+    if (!readahead->ring_.submit(0)) {
+        destroy(readahead);
+        return nullptr;
+    }
+    return readahead;
+}
+
+void
+uring_readahead_t::destroy(uring_readahead_t * readahead) {
+    // If something went wrong we can't know what is still in flight, so leak
+    // the buffers rather than risk the kernel writing to freed memory.
+    if (readahead->drain()) {
+        sys::freemem(readahead->bufs_, k_depth * k_chunk_size);
+    }
+    readahead->ring_.cleanup();
+    buf_free(readahead, sizeof(uring_readahead_t));
+}
+
+bool
+uring_readahead_t::queue_slot(size_t slot) {
+    offs_[slot] = next_off_;
+    lens_[slot] = 0;
+    done_[slot] = false;
+    if (!ring_.queue_read(fd_, slot_buf(slot), k_chunk_size, next_off_,
+                          slot)) {
+        return false;
+    }
+    next_off_ += k_chunk_size;
+    ++ninflight_;
+    return true;
+}
+
+bool
+uring_readahead_t::wait_slot(size_t slot) {
+    while (!done_[slot]) {
+        uint64_t done_slot;
+        int32_t  res;
+        if (!ring_.wait_cqe(&done_slot, &res)) {
+            return false;
+        }
+        assert(done_slot < k_depth);
+        assert(ninflight_ != 0);
+        --ninflight_;
+        size_t nread = 0;
+        if (res >= 0) {
+            nread = static_cast<size_t>(res);
+        }
+        else if (res != -EAGAIN && res != -EINTR) {
+            return false;
+        }
+        // A short read doesn't necessarily mean we hit the end of the file
+        // so finish it ourselves (if we are at the end this reads nothing).
+        if (nread < k_chunk_size) {
+            const size_t rest = file_ops::ensure_read(
+                fd_, slot_buf(done_slot) + nread, k_chunk_size - nread,
+                static_cast<ssize_t>(offs_[done_slot] + nread));
+            if (rest == file_ops::k_err) {
+                return false;
+            }
+            nread += rest;
+        }
+        lens_[done_slot] = nread;
+        done_[done_slot] = true;
+    }
+    return true;
+}
+
+size_t
+uring_readahead_t::read(uint8_t * mem, size_t sz) {
+    size_t total = 0;
+    while (total < sz && !eof_) {
+        if (!wait_slot(head_)) {
+            return file_ops::k_err;
+        }
+        const size_t n = std::min(lens_[head_] - head_pos_, sz - total);
+        memcpy(mem + total, slot_buf(head_) + head_pos_, n);
+        total += n;
+        head_pos_ += n;
+        if (head_pos_ != lens_[head_]) {
+            continue;
+        }
+        // Only the last chunk of the file is short.
+        if (lens_[head_] != k_chunk_size) {
+            eof_ = true;
+            break;
+        }
+        // Reuse the slot for the next chunk.
+        if (!queue_slot(head_) || !ring_.submit(0)) {
+            return file_ops::k_err;
+        }
+        head_     = (head_ + 1) % k_depth;
+        head_pos_ = 0;
+    }
+    return total;
+}
+
+bool
+uring_readahead_t::drain() {
+    uint64_t done_slot;
+    int32_t  res;
+    while (ninflight_ != 0) {
+        if (!ring_.wait_cqe(&done_slot, &res)) {
+            return false;
+        }
+        --ninflight_;
+    }
+    return true;
+}
+
+void
+file_prefetcher_t::start(vec_t<vec_t<char>> paths) {
+    join();
+    if (!uring_t::enabled() || paths.empty()) {
+        return;
+    }
+    stop_.store(false, std::memory_order_relaxed);
+    paths_  = std::move(paths);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void
+file_prefetcher_t::run() {
+    uring_t ring{};
+    if (!ring.init(k_depth)) {
+        return;
+    }
+    // The data is thrown away so every read can go to the same buffer.
+    uint8_t * buf = reinterpret_cast<uint8_t *>(sys::getmem(k_chunk_size));
+    // Reads in flight for each file (closed once they are all done).
+    vec_t<int>    fds{};
+    vec_t<size_t> pending{};
+    size_t        ninflight = 0;
+
+    auto reap = [&]() {
+        uint64_t idx;
+        int32_t  res;
+        if (!ring.wait_cqe(&idx, &res)) {
+            return false;
+        }
+        (void)res;
+        --ninflight;
+        if (--pending[idx] == 0) {
+            close(fds[idx]);
+        }
+        return true;
+    };
+
+    bool okay = true;
+    for (const vec_t<char> & path : paths_) {
+        if (!okay || stop_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        const int fd = open(path.data(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        const size_t size = file_ops::filesize(fd);
+        if (size == 0 || size == file_ops::k_err) {
+            close(fd);
+            continue;
+        }
+        const size_t idx = fds.size();
+        fds.emplace_back(fd);
+        // One extra so the file isn't closed while we are still queuing.
+        pending.emplace_back(1);
+        for (size_t off = 0; okay && off < size; off += k_chunk_size) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            while (okay && ninflight == k_depth) {
+                okay = reap();
+            }
+            if (okay && ring.queue_read(fd, buf, k_chunk_size, off, idx)) {
+                ++pending[idx];
+                ++ninflight;
+                okay = ring.submit(0);
+            }
+        }
+        if (--pending[idx] == 0) {
+            close(fd);
+        }
+    }
+    while (okay && ninflight != 0) {
+        okay = reap();
+    }
+    // Same as `uring_readahead_t::destroy`.
+    if (okay) {
+        sys::freemem(buf, k_chunk_size);
+    }
+    for (size_t idx = 0; idx < fds.size(); ++idx) {
+        if (pending[idx] != 0) {
+            close(fds[idx]);
+        }
+    }
+    ring.cleanup();
+}
+
+}  // namespace tlo
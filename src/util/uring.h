@@ -0,0 +1,188 @@
+#ifndef SRC_D_UTIL_D_URING_H_
+#define SRC_D_UTIL_D_URING_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Optional io_uring backed I/O (implemented in uring.cc).
+//
+// On network-backed or cold-cache storage the synchronous reads of the
+// file readers (and the page faults on mapped ELF files) leave us blocked on
+// I/O for long stretches. With io_uring we can instead keep a deep queue of
+// large reads in flight:
+//      - `uring_readahead_t` reads a file sequentially ahead of a reader
+//        (see `reader_base_t::read_at`).
+//      - `file_prefetcher_t` reads whole files in the background so they are
+//        in the page cache by the time they are mapped (i.e the ELF/debug
+//        files of the DSOs found during the info pass).
+//
+// This talks to the kernel directly (no liburing). Its opt-in (see
+// `uring_t::set_enabled`) and if io_uring is unavailable everything falls
+// back to the regular readers.
+
+#include "src/util/vec.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tlo {
+
+struct uring_t {
+    int fd_;
+    // Submission queue (shared with the kernel).
+    uint32_t * sq_head_;
+    uint32_t * sq_tail_;
+    uint32_t * sq_mask_;
+    uint32_t * sq_array_;
+    void *     sqes_;
+    // Completion queue (shared with the kernel).
+    uint32_t * cq_head_;
+    uint32_t * cq_tail_;
+    uint32_t * cq_mask_;
+    void *     cqes_;
+
+    void *   sq_map_;
+    size_t   sq_map_sz_;
+    void *   cq_map_;
+    size_t   cq_map_sz_;
+    size_t   sqes_sz_;
+    uint32_t entries_;
+    // Queued but not yet submitted.
+    uint32_t nqueued_;
+
+    // Set by `set_enabled`.
+    static bool G_enabled;
+
+    constexpr uring_t() = default;
+
+    // Check that io_uring (with the features we need) is usable. Only
+    // actually checked once.
+    static bool available();
+
+    // Use io_uring for reading. Returns false (and stays disabled) if its
+    // not available.
+    static bool
+    set_enabled(bool on) {
+        G_enabled = on && available();
+        return G_enabled == on;
+    }
+
+    static bool
+    enabled() {
+        return G_enabled;
+    }
+
+    bool init(uint32_t entries);
+    void cleanup();
+
+    bool
+    active() const {
+        return fd_ > 0;
+    }
+
+    // Queue a read of `len` bytes at `off` into `buf`. The result of the
+    // read is returned by `next_cqe` with `user_data`. False if the
+    // submission queue is full.
+    bool queue_read(int      fd,
+                    void *   buf,
+                    uint32_t len,
+                    uint64_t off,
+                    uint64_t user_data);
+
+    // Submit everything queued and wait for at least `wait_nr` completions.
+    bool submit(uint32_t wait_nr);
+
+    // Pop a completion. False if there are none.
+    bool next_cqe(uint64_t * user_data_out, int32_t * res_out);
+
+    // Same as `next_cqe` but waits for one.
+    bool wait_cqe(uint64_t * user_data_out, int32_t * res_out);
+};
+
+// Reads a file sequentially with up to `k_depth` reads of `k_chunk_size`
+// in flight. Not thread safe.
+struct uring_readahead_t {
+    static constexpr size_t k_chunk_size = 1024 * 1024;
+    static constexpr size_t k_depth      = 16;
+    // Smaller files aren't worth the setup.
+    static constexpr size_t k_min_file_size = 2 * k_chunk_size;
+
+    uring_t   ring_;
+    uint8_t * bufs_;
+    int       fd_;
+    // Next chunk (slot) to return and how much of it has been returned.
+    size_t   head_;
+    size_t   head_pos_;
+    uint64_t next_off_;
+    size_t   ninflight_;
+    bool     eof_;
+
+    std::array<uint64_t, k_depth> offs_;
+    std::array<size_t, k_depth>   lens_;
+    std::array<bool, k_depth>     done_;
+
+    // Null if io_uring isn't enabled, the file is too small, or we couldn't
+    // set it up. `fd` is still owned by the caller (and must outlive the
+    // readahead).
+    static uring_readahead_t * create(int fd, uint64_t off);
+    static void                destroy(uring_readahead_t * readahead);
+
+    // Same as `file_ops::ensure_read` at the current offset (which advances
+    // by the amount read).
+    size_t read(uint8_t * mem, size_t sz);
+
+    bool queue_slot(size_t slot);
+    bool wait_slot(size_t slot);
+    // Wait for all reads in flight (so the buffers can be freed).
+    bool drain();
+
+    uint8_t *
+    slot_buf(size_t slot) const {
+        return bufs_ + slot * k_chunk_size;
+    }
+};
+
+// Reads whole files on a background thread just to get them into the page
+// cache. Files that can't be opened are skipped.
+struct file_prefetcher_t {
+    static constexpr size_t k_chunk_size = uring_readahead_t::k_chunk_size;
+    static constexpr size_t k_depth      = 32;
+
+    std::thread       thread_;
+    std::atomic<bool> stop_;
+    // Null-terminated paths.
+    vec_t<vec_t<char>> paths_;
+
+    file_prefetcher_t() : stop_(false) {}
+    file_prefetcher_t(const file_prefetcher_t &) = delete;
+    file_prefetcher_t(file_prefetcher_t &&)      = delete;
+    ~file_prefetcher_t() {
+        stop();
+    }
+
+    // Start prefetching `paths` (waits for any previous prefetch first). Does
+    // nothing if io_uring isn't enabled.
+    void start(vec_t<vec_t<char>> paths);
+
+    // Stop early (whatever is in flight is still waited for).
+    void
+    stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        join();
+    }
+
+    void
+    join() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void run();
+};
+
+}  // namespace tlo
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef SRC_D_UTIL_D_WORK_QUEUE_H_
+#define SRC_D_UTIL_D_WORK_QUEUE_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// Bounded blocking FIFO for handing work between threads.
+// Producers block while the queue is full, consumers block while it is empty.
+// Once `close` is called consumers drain what is left and then `pop` returns
+// false.
+// Also has `ordered_slots_t` for when results must be consumed in order.
+
+#include "src/util/vec.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tlo {
+
+template<typename T_t>
+struct work_queue_t {
+    vec_t<T_t>              items_;
+    size_t                  head_;
+    size_t                  size_;
+    bool                    closed_;
+    std::mutex              mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+
+    explicit work_queue_t(size_t capacity)
+        : items_(capacity), head_(0), size_(0), closed_(false) {
+        assert(capacity != 0);
+    }
+
+    size_t
+    capacity() const {
+        return items_.size();
+    }
+
+    // Returns false if the queue was closed before the item could be added.
+    bool
+    push(T_t item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock,
+                       [this]() { return closed_ || size_ != capacity(); });
+        if (closed_) {
+            return false;
+        }
+        items_[(head_ + size_) % capacity()] = std::move(item);
+        ++size_;
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and empty.
+    bool
+    pop(T_t * item_out) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait(lock, [this]() { return closed_ || size_ != 0; });
+        if (size_ == 0) {
+            return false;
+        }
+        *item_out = std::move(items_[head_]);
+        head_     = (head_ + 1) % capacity();
+        --size_;
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void
+    close() {
+        {
+            const std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+};
+
+// Ring of result slots for items [0, nitems). Workers claim items in order but
+// may finish them in any order, a single consumer takes the results in order.
+// A worker blocks while the slot for its item is still held by the consumer,
+// so at most `capacity` results are outstanding at once.
+template<typename T_t>
+struct ordered_slots_t {
+    vec_t<T_t>              slots_;
+    vec_t<uint8_t>          ready_;
+    size_t                  nitems_;
+    size_t                  next_claim_;
+    size_t                  next_consume_;
+    bool                    closed_;
+    std::mutex              mtx_;
+    std::condition_variable ready_cv_;
+    std::condition_variable free_cv_;
+
+    ordered_slots_t(size_t capacity, size_t nitems)
+        : slots_(capacity),
+          ready_(capacity, 0),
+          nitems_(nitems),
+          next_claim_(0),
+          next_consume_(0),
+          closed_(false) {
+        assert(capacity != 0);
+    }
+
+    size_t
+    capacity() const {
+        return slots_.size();
+    }
+
+    size_t
+    nitems() const {
+        return nitems_;
+    }
+
+    // Claim the next item. Returns false once all items are claimed or the
+    // ring was closed.
+    bool
+    claim(size_t * idx_out, T_t ** slot_out) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (closed_ || next_claim_ == nitems_) {
+            return false;
+        }
+        const size_t idx = next_claim_++;
+        free_cv_.wait(lock, [this, idx]() {
+            return closed_ || idx < next_consume_ + capacity();
+        });
+        if (closed_) {
+            return false;
+        }
+        *idx_out  = idx;
+        *slot_out = &slots_[idx % capacity()];
+        return true;
+    }
+
+    // Mark the result of item `idx` as ready for the consumer.
+    void
+    publish(size_t idx) {
+        {
+            const std::lock_guard<std::mutex> lock(mtx_);
+            ready_[idx % capacity()] = 1;
+        }
+        ready_cv_.notify_one();
+    }
+
+    // Wait for the result of item `idx` (must be the next item to consume).
+    // Returns null if the ring was closed first.
+    T_t *
+    wait(size_t idx) {
+        assert(idx == next_consume_);
+        assert(idx < nitems_);
+        std::unique_lock<std::mutex> lock(mtx_);
+        ready_cv_.wait(lock, [this, idx]() {
+            return closed_ || ready_[idx % capacity()] != 0;
+        });
+        return ready_[idx % capacity()] != 0 ? &slots_[idx % capacity()]
+                                              : nullptr;
+    }
+
+    // Give the slot of item `idx` back to the workers.
+    void
+    release(size_t idx) {
+        assert(idx == next_consume_);
+        {
+            const std::lock_guard<std::mutex> lock(mtx_);
+            ready_[idx % capacity()] = 0;
+            next_consume_            = idx + 1;
+        }
+        free_cv_.notify_all();
+    }
+
+    void
+    close() {
+        {
+            const std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        ready_cv_.notify_all();
+        free_cv_.notify_all();
+    }
+};
+
+// Number of workers to use if the user asks for "all of them" (0).
+static size_t
+resolve_num_jobs(size_t njobs) {
+    if (njobs == 0) {
+        njobs = std::thread::hardware_concurrency();
+    }
+    return njobs == 0 ? 1 : njobs;
+}
+
+}  // namespace tlo
+
+#endif
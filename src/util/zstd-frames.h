@@ -0,0 +1,159 @@
+#ifndef SRC_D_UTIL_D_ZSTD_FRAMES_H_
+#define SRC_D_UTIL_D_ZSTD_FRAMES_H_
+
+#ifndef TLO_ZSTD
+# error "Zstd frames require ZSTD"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Locating the independent frames of a zstd file so they can be decompressed
+// in parallel.
+// Files in the zstd seekable format (i.e written by `compress_file_seekable`)
+// end with a seek table (stored in a skippable frame) that lists the size of
+// every frame. For any other multi-frame file (i.e from pzstd or just
+// concatenated .zst files) we walk the frame headers instead.
+
+#include "src/util/vec.h"
+
+#include <span>
+
+#include "zstd.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace tlo {
+
+struct zst_frame_t {
+    // Offset / size of the frame in the compressed file.
+    uint64_t coff_;
+    uint64_t csize_;
+    // Size of the frame once decompressed.
+    uint64_t dsize_;
+};
+
+namespace zst_frames {
+static constexpr uint32_t k_seekable_magic = 0x8F92EAB1U;
+static constexpr uint32_t k_seek_table_magic =
+    ZSTD_MAGIC_SKIPPABLE_START | 0xEU;
+static constexpr size_t   k_skippable_hdr_size   = 8;
+static constexpr size_t   k_seek_footer_size     = 9;
+static constexpr size_t   k_seek_entry_size      = 8;
+static constexpr size_t   k_seek_entry_csum_size = 12;
+static constexpr uint8_t  k_seek_checksum_flag   = 0x80U;
+static constexpr uint8_t  k_seek_reserved_bits   = 0x7cU;
+
+static uint32_t
+read_le32(const uint8_t * p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void
+append_le32(vec_t<uint8_t> * out, uint32_t v) {
+    const uint8_t * p = reinterpret_cast<const uint8_t *>(&v);
+    out->insert(out->end(), p, p + sizeof(v));
+}
+
+// Frames listed in the seek table at the end of `data`. Returns false if there
+// is no valid seek table.
+static bool
+from_seek_table(std::span<const uint8_t> data, vec_t<zst_frame_t> * frames) {
+    if (data.size() < k_skippable_hdr_size + k_seek_footer_size) {
+        return false;
+    }
+    const uint8_t * footer = data.data() + data.size() - k_seek_footer_size;
+    if (read_le32(footer + 5) != k_seekable_magic) {
+        return false;
+    }
+    const uint8_t desc = footer[4];
+    if ((desc & k_seek_reserved_bits) != 0) {
+        return false;
+    }
+    const uint64_t nframes    = read_le32(footer);
+    const uint64_t entry_size = (desc & k_seek_checksum_flag) != 0
+                                    ? k_seek_entry_csum_size
+                                    : k_seek_entry_size;
+    const uint64_t table_size = nframes * entry_size + k_seek_footer_size;
+    if (table_size + k_skippable_hdr_size > data.size()) {
+        return false;
+    }
+    const uint8_t * table =
+        data.data() + data.size() - table_size - k_skippable_hdr_size;
+    if (read_le32(table) != k_seek_table_magic ||
+        read_le32(table + 4) != table_size) {
+        return false;
+    }
+
+    frames->clear();
+    frames->reserve(nframes);
+    uint64_t        coff  = 0;
+    const uint8_t * entry = table + k_skippable_hdr_size;
+    for (uint64_t i = 0; i < nframes; ++i, entry += entry_size) {
+        const uint64_t csize = read_le32(entry);
+        const uint64_t dsize = read_le32(entry + 4);
+        if (csize == 0) {
+            return false;
+        }
+        frames->emplace_back(zst_frame_t{ coff, csize, dsize });
+        coff += csize;
+    }
+    // The frames must cover everything before the seek table.
+    return coff == static_cast<uint64_t>(table - data.data());
+}
+
+// Frames found by walking the frame headers (skippable frames are dropped).
+// Returns false if a frame is malformed or doesn't record its decompressed
+// size.
+static bool
+from_headers(std::span<const uint8_t> data, vec_t<zst_frame_t> * frames) {
+    frames->clear();
+    size_t off = 0;
+    while (off < data.size()) {
+        const uint8_t * p     = data.data() + off;
+        const size_t    left  = data.size() - off;
+        const size_t    csize = ZSTD_findFrameCompressedSize(p, left);
+        if (ZSTD_isError(csize) || csize == 0 || left < sizeof(uint32_t)) {
+            return false;
+        }
+        if ((read_le32(p) & ZSTD_MAGIC_SKIPPABLE_MASK) !=
+            ZSTD_MAGIC_SKIPPABLE_START) {
+            const uint64_t dsize = ZSTD_getFrameContentSize(p, left);
+            if (dsize == ZSTD_CONTENTSIZE_UNKNOWN ||
+                dsize == ZSTD_CONTENTSIZE_ERROR) {
+                return false;
+            }
+            frames->emplace_back(zst_frame_t{ off, csize, dsize });
+        }
+        off += csize;
+    }
+    return true;
+}
+
+static bool
+find(std::span<const uint8_t> data, vec_t<zst_frame_t> * frames) {
+    return from_seek_table(data, frames) || from_headers(data, frames);
+}
+
+// Append a seek table (without checksums) for `frames` to `out`. Every frame
+// must be less than 4GB both compressed and decompressed.
+static void
+append_seek_table(std::span<const zst_frame_t> frames, vec_t<uint8_t> * out) {
+    const size_t table_size =
+        frames.size() * k_seek_entry_size + k_seek_footer_size;
+    append_le32(out, k_seek_table_magic);
+    append_le32(out, static_cast<uint32_t>(table_size));
+    for (const zst_frame_t & frame : frames) {
+        append_le32(out, static_cast<uint32_t>(frame.csize_));
+        append_le32(out, static_cast<uint32_t>(frame.dsize_));
+    }
+    append_le32(out, static_cast<uint32_t>(frames.size()));
+    out->emplace_back(0);
+    append_le32(out, k_seekable_magic);
+}
+
+}  // namespace zst_frames
+}  // namespace tlo
+#endif
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include "src/cfg/ext-tsp.h"
+#include "src/util/vec.h"
+
+#include <algorithm>
+#include <random>
+
+#include <stdint.h>
+
+static tlo::vec_t<size_t>
+flatten(const tlo::vec_t<tlo::vec_t<size_t>> & chains) {
+    tlo::vec_t<size_t> order{};
+    for (const tlo::vec_t<size_t> & chain : chains) {
+        order.insert(order.end(), chain.begin(), chain.end());
+    }
+    return order;
+}
+
+static bool
+is_permutation(tlo::vec_t<size_t> order, size_t n) {
+    if (order.size() != n) {
+        return false;
+    }
+    std::sort(order.begin(), order.end());
+    for (size_t i = 0; i < n; ++i) {
+        if (order[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(cfg, ext_tsp_jump_score) {
+    // Fall-through.
+    ASSERT_EQ(tlo::ext_tsp_t::jump_score(0, 100, 100, 2.0), 2.0);
+    // Short forward / backward jumps get partial credit.
+    const double fwd = tlo::ext_tsp_t::jump_score(0, 100, 200, 2.0);
+    ASSERT_GT(fwd, 0.0);
+    ASSERT_LT(fwd, 2.0 * tlo::ext_tsp_t::k_forward_weight);
+    ASSERT_GT(fwd, tlo::ext_tsp_t::jump_score(0, 100, 1000, 2.0));
+    const double bwd = tlo::ext_tsp_t::jump_score(1000, 100, 0, 2.0);
+    ASSERT_GT(bwd, 0.0);
+    ASSERT_LT(bwd, 2.0 * tlo::ext_tsp_t::k_backward_weight);
+    // Too far.
+    ASSERT_EQ(tlo::ext_tsp_t::jump_score(
+                  0, 100, 100 + tlo::ext_tsp_t::k_forward_distance * 2, 2.0),
+              0.0);
+    ASSERT_EQ(tlo::ext_tsp_t::jump_score(
+                  tlo::ext_tsp_t::k_backward_distance * 2, 100, 0, 2.0),
+              0.0);
+}
+
+TEST(cfg, ext_tsp_call_chain) {
+    // 3 -> 1 -> 4 -> 0 are hot calls, 2 is unconnected.
+    tlo::ext_tsp_t et{};
+    for (size_t i = 0; i < 5; ++i) {
+        et.add_node(256);
+    }
+    et.add_jump(3, 1, 100);
+    et.add_jump(1, 4, 90);
+    et.add_jump(4, 0, 80);
+    et.add_jump(0, 3, 1);
+
+    tlo::vec_t<tlo::vec_t<size_t>> chains{};
+    et.run(0, &chains);
+    ASSERT_EQ(chains.size(), 2U);
+    ASSERT_TRUE(is_permutation(flatten(chains), 5));
+
+    const tlo::vec_t<size_t> expec = { 3, 1, 4, 0 };
+    bool                     found = false;
+    for (const tlo::vec_t<size_t> & chain : chains) {
+        if (chain.size() == 1) {
+            ASSERT_EQ(chain[0], 2U);
+        }
+        else {
+            ASSERT_EQ(chain, expec);
+            found = true;
+        }
+    }
+    ASSERT_TRUE(found);
+}
+
+TEST(cfg, ext_tsp_max_chain_size) {
+    tlo::ext_tsp_t et{};
+    for (size_t i = 0; i < 8; ++i) {
+        et.add_node(1000);
+    }
+    for (size_t i = 0; i + 1 < 8; ++i) {
+        et.add_jump(i, i + 1, 10);
+    }
+    tlo::vec_t<tlo::vec_t<size_t>> chains{};
+    et.run(2500, &chains);
+    ASSERT_TRUE(is_permutation(flatten(chains), 8));
+    for (const tlo::vec_t<size_t> & chain : chains) {
+        ASSERT_LE(chain.size(), 2U);
+    }
+}
+
+TEST(cfg, ext_tsp_random) {
+    static constexpr size_t k_num_nodes = 5000;
+    static constexpr size_t k_num_jumps = 15000;
+
+    std::mt19937_64                         rng(1234);
+    std::uniform_int_distribution<uint64_t> size_dist(16, 8192);
+    std::uniform_int_distribution<size_t>   node_dist(0, k_num_nodes - 1);
+    std::uniform_int_distribution<uint64_t> weight_dist(1, 1000);
+
+    tlo::ext_tsp_t et{};
+    for (size_t i = 0; i < k_num_nodes; ++i) {
+        et.add_node(size_dist(rng));
+    }
+    for (size_t i = 0; i < k_num_jumps; ++i) {
+        // Skew towards a hot set so that there are some large chains.
+        const size_t src = node_dist(rng) % (i % 4 == 0 ? k_num_nodes : 256);
+        const size_t dst = node_dist(rng);
+        et.add_jump(src, dst, static_cast<double>(weight_dist(rng)));
+    }
+
+    tlo::vec_t<size_t> identity(k_num_nodes);
+    for (size_t i = 0; i < k_num_nodes; ++i) {
+        identity[i] = i;
+    }
+    const double base_score = et.score(identity);
+
+    tlo::vec_t<tlo::vec_t<size_t>> chains{};
+    et.run(2 * 1024 * 1024, &chains);
+    const tlo::vec_t<size_t> order = flatten(chains);
+    ASSERT_TRUE(is_permutation(order, k_num_nodes));
+    ASSERT_LT(chains.size(), k_num_nodes);
+
+    // The tracked score of each chain must match its real score.
+    double total_score = 0.0;
+    for (const tlo::vec_t<size_t> & chain : chains) {
+        uint64_t chain_size = 0;
+        for (const size_t id : chain) {
+            chain_size += et.nodes_[id].size_;
+        }
+        ASSERT_LE(chain_size, 2U * 1024U * 1024U);
+        const tlo::ext_tsp_t::chain_t & tracked =
+            et.chains_[et.nodes_[chain[0]].chain_];
+        ASSERT_NEAR(tracked.score_, et.score(chain),
+                    1e-6 * std::max(1.0, tracked.score_));
+        total_score += tracked.score_;
+    }
+    // Jumps between chains can only add to the score.
+    ASSERT_GE(et.score(order) + 1e-6 * total_score, total_score);
+    ASSERT_GT(total_score, base_score);
+}
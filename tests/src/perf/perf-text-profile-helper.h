@@ -0,0 +1,313 @@
+#ifndef SRC_D_PERF_D_PERF_TEXT_PROFILE_HELPER_H_
+#define SRC_D_PERF_D_PERF_TEXT_PROFILE_HELPER_H_
+
+////////////////////////////////////////////////////////////////////////////////
+// `perf script` style profiles of the test binary itself (so samples resolve to
+// real functions and branch instructions) and helpers to collect / compare
+// them.
+
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-file.h"
+#include "src/perf/perf-stats.h"
+#include "src/sym/syms.h"
+#include "src/system/br-insn.h"
+
+#include "src/util/file-ops.h"
+#include "src/util/file-reader.h"
+#include "src/util/vec.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Writes `perf script` style text to a temporary file.
+struct tmp_text_file_t {
+    std::array<char, 256> path_;  // NOLINT(*magic*)
+
+    explicit tmp_text_file_t(const std::string & text) {
+        const int fd = tlo::file_ops::new_tmpfile(&path_, "/tmp/.perf-text-");
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(tlo::file_ops::ensure_write(
+                      fd, reinterpret_cast<const uint8_t *>(text.data()),
+                      text.size()),
+                  text.size());
+        close(fd);
+    }
+    ~tmp_text_file_t() {
+        (void)remove(path_.data());
+    }
+};
+
+static void
+collect_text_profile(const char *                   info_path,
+                     const char *                   events_path,
+                     size_t                         njobs,
+                     tlo::perf::perf_stats_t *      stats,
+                     tlo::perf::perf_checkpoint_t * checkpoint = nullptr) {
+    tlo::file_reader_t fr_events, fr_info;
+    fr_info.init(info_path);
+    fr_events.init(events_path);
+    ASSERT_TRUE(fr_info.active());
+    ASSERT_TRUE(fr_events.active());
+    ASSERT_TRUE(tlo::perf::collect_perf_file_info(&fr_info, stats));
+    ASSERT_TRUE(tlo::perf::collect_perf_file_events(&fr_events, stats, njobs,
+                                                    checkpoint));
+    fr_info.cleanup();
+    fr_events.cleanup();
+}
+
+// Profile of `nevents` branch samples from 4 processes running this test
+// binary. Every branch source is a real branch instruction in its text so the
+// edges get decoded branch types and resolve to real symbols.
+//  - `typed_events` (if not null) has the same samples with the brtype from
+//    perf (>= 6.3 format) for the branches whose type maps to the same
+//    instruction we would decode.
+//  - `offset_events` (if not null) has the same samples as offsets into the
+//    binary (`--dso-offsets` format).
+//  - If `remap_shift` is non-zero pid 100 maps the text again half way through
+//    the samples (at 1.010000), `remap_shift` bytes further into the file.
+static void
+make_elf_profile(std::string * info,
+                 std::string * events,
+                 std::string * typed_events,
+                 uint32_t      nevents,
+                 std::string * offset_events = nullptr,
+                 uint64_t      remap_shift   = 0) {
+    // NOLINTBEGIN(*magic*)
+    std::array<char, PATH_MAX> path{};
+    ASSERT_NE(realpath("/proc/self/exe", path.data()), nullptr);
+    tlo::sym::sym_state_t   ss{};
+    const tlo::sym::dso_t * dso = ss.get_dso(tlo::strbuf_t<>{ path.data() });
+    ASSERT_NE(dso, nullptr);
+    ASSERT_NE(dso->text_map_, nullptr);
+    ASSERT_GT(dso->text_len_, tlo::system::k_max_insn_sz);
+
+    // What perf calls the branches we decode as `je rel32`, `jmp rel32`,
+    // `call rel32` and `ret`.
+    static constexpr std::array<std::pair<uint32_t, const char *>, 4>
+        k_brtypes = { { { 0x0f84, "COND" },
+                        { 0xe9, "UNCOND" },
+                        { 0xe8, "CALL" },
+                        { 0xc3, "RET" } } };
+    tlo::vec_t<uint64_t>     sites{};
+    tlo::vec_t<const char *> site_types{};
+    const uint64_t           text_end =
+        dso->text_off_ + dso->text_len_ - tlo::system::k_max_insn_sz;
+    for (uint64_t off = dso->text_off_; off < text_end; ++off) {
+        std::array<uint8_t, tlo::system::k_max_insn_sz> insn_bytes{};
+        ASSERT_TRUE(
+            dso->read_insn(off, { insn_bytes.data(), insn_bytes.size() }));
+        if (tlo::system::br_insn_t::is_prefix_byte(insn_bytes[0])) {
+            continue;
+        }
+        const tlo::system::br_insn_t br_insn =
+            tlo::system::br_insn_t::find(insn_bytes);
+        if (!br_insn.good()) {
+            continue;
+        }
+        const char * type = "";
+        for (const auto & [enc, name] : k_brtypes) {
+            if (tlo::system::br_insn_t::find_enc(enc).eq(br_insn)) {
+                type = name;
+            }
+        }
+        sites.push_back(off);
+        site_types.push_back(type);
+    }
+    ASSERT_GT(sites.size(), 64U);
+
+    const uint64_t base     = 0x560000000000UL;
+    auto           add_mmap = [&](uint32_t pid, const char * ts,
+                        uint64_t pgoff) {
+        std::array<char, PATH_MAX + 256> line{};
+        const int             len = snprintf(
+            line.data(), line.size(),
+            "app %u/%u %s: PERF_RECORD_MMAP2 %u/%u: [0x%lx(0x%lx) @ 0x%lx fd:01 1 0]: r-xp %s\n",
+            pid, pid, ts, pid, pid, base, dso->text_len_, pgoff, path.data());
+        ASSERT_GT(len, 0);
+        info->append(line.data(), static_cast<size_t>(len));
+    };
+    for (uint32_t pid = 100; pid < 104; ++pid) {
+        add_mmap(pid, "0.000001", dso->text_off_);
+    }
+    if (remap_shift != 0) {
+        add_mmap(100, "1.010000", dso->text_off_ + remap_shift);
+    }
+    for (uint32_t i = 0; i < nevents; ++i) {
+        const uint32_t pid     = 100 + (i % 4);
+        // Spread over the text, but with repeats.
+        const size_t   from_i  = (i * 7919U) % sites.size();
+        const size_t   to_i    = (i * 104729U) % sites.size();
+        const size_t   from2_i = (from_i + 1) % sites.size();
+        const uint64_t from    = base + sites[from_i] - dso->text_off_;
+        const uint64_t to      = base + sites[to_i] - dso->text_off_;
+        const uint64_t from2   = base + sites[from2_i] - dso->text_off_;
+        for (std::string * out : { events, typed_events }) {
+            if (out == nullptr) {
+                continue;
+            }
+            const bool typed = out == typed_events;
+            std::array<char, 1024> line{};
+            const int              len = snprintf(
+                line.data(), line.size(),
+                "app %u/%u 1.%06u: %lx (%s) 0x%lx(%s)/0x%lx(%s)/P/-/-/%u/%s%s  0x%lx(%s)/0x%lx(%s)/P/-/-/3/%s%s\n",
+                pid, pid, i % 1000000, to, path.data(), from, path.data(), to,
+                path.data(), i % 17, typed ? site_types[from_i] : "",
+                typed ? "/-" : "", from2, path.data(), from, path.data(),
+                typed ? site_types[from2_i] : "", typed ? "/-" : "");
+            ASSERT_GT(len, 0);
+            out->append(line.data(), static_cast<size_t>(len));
+        }
+        if (offset_events != nullptr) {
+            std::array<char, 1024> line{};
+            const int              len = snprintf(
+                line.data(), line.size(),
+                "app %u/%u 1.%06u: 0x%lx(%s)/0x%lx(%s)/P/-/-/%u/  0x%lx(%s)/0x%lx(%s)/P/-/-/3/\n",
+                pid, pid, i % 1000000, sites[from_i], path.data(), sites[to_i],
+                path.data(), i % 17, sites[from2_i], path.data(),
+                sites[from_i], path.data());
+            ASSERT_GT(len, 0);
+            offset_events->append(line.data(), static_cast<size_t>(len));
+        }
+    }
+    // NOLINTEND(*magic*)
+}
+
+// Identify a function (clump) by its dso / first function so it can be
+// matched up across sym states.
+static std::string
+clump_key(const tlo::sym::func_clump_t * fc) {
+    const tlo::sym::func_t * func = fc->first();
+    return std::string(func->dso()->name_.sview()) + ":" +
+           std::string(func->name_.sview()) + ":" +
+           std::string(func->ident_.sview());
+}
+
+// Save states can't hold an edge within a function (only the clumper drops
+// those).
+static void
+drop_self_edges(tlo::vec_t<tlo::perf::perf_edge_t> * edges) {
+    edges->erase(std::remove_if(edges->begin(), edges->end(),
+                                [](const tlo::perf::perf_edge_t & pe) {
+                                    return pe.from_ == pe.to_;
+                                }),
+                 edges->end());
+}
+
+// Sum up the stats of each function / edge by `clump_key`. Reloaded edges
+// don't keep their branch type so unless `with_brtype` edges that only differ
+// by it become one. Reloading also merges same named functions (i.e two copies
+// of a static function) so an edge between them is dropped.
+static void
+stats_by_clump(const tlo::vec_t<tlo::perf::perf_func_t> &            funcs,
+               const tlo::vec_t<tlo::perf::perf_edge_t> &            edges,
+               std::map<std::string, tlo::perf::perf_func_stats_t> * funcs_out,
+               std::map<std::string, tlo::perf::perf_edge_stats_t> * edges_out,
+               bool with_brtype = false) {
+    for (const tlo::perf::perf_func_t & pf : funcs) {
+        (*funcs_out)[clump_key(pf.func_clump_)].add(pf.stats());
+    }
+    for (const tlo::perf::perf_edge_t & pe : edges) {
+        const std::string from = clump_key(pe.from_);
+        const std::string to   = clump_key(pe.to_);
+        if (with_brtype) {
+            (*edges_out)[from + " -" + pe.br_insn_.name() + "-> " + to].add(
+                pe.stats());
+        }
+        else if (from != to) {
+            (*edges_out)[from + " -> " + to].add(pe.stats());
+        }
+    }
+}
+
+// Every function / edge must have the same weight.
+static void
+expect_same_funcs_and_edges(const tlo::vec_t<tlo::perf::perf_func_t> & expec_funcs,
+                            const tlo::vec_t<tlo::perf::perf_edge_t> & expec_edges,
+                            const tlo::vec_t<tlo::perf::perf_func_t> & funcs,
+                            const tlo::vec_t<tlo::perf::perf_edge_t> & edges,
+                            bool with_brtype = true) {
+    std::map<std::string, tlo::perf::perf_func_stats_t> expec_func_stats,
+        func_stats;
+    std::map<std::string, tlo::perf::perf_edge_stats_t> expec_edge_stats,
+        edge_stats;
+    stats_by_clump(expec_funcs, expec_edges, &expec_func_stats,
+                   &expec_edge_stats, with_brtype);
+    stats_by_clump(funcs, edges, &func_stats, &edge_stats, with_brtype);
+    ASSERT_EQ(expec_func_stats.size(), func_stats.size());
+    ASSERT_EQ(expec_edge_stats.size(), edge_stats.size());
+    for (auto & [key, pf_stats] : expec_func_stats) {
+        auto res = func_stats.find(key);
+        ASSERT_NE(res, func_stats.end()) << key;
+        ASSERT_TRUE(pf_stats.eq(res->second)) << key;
+    }
+    for (auto & [key, pe_stats] : expec_edge_stats) {
+        auto res = edge_stats.find(key);
+        ASSERT_NE(res, edge_stats.end()) << key;
+        ASSERT_TRUE(pe_stats.eq(res->second)) << key;
+    }
+}
+
+static void
+expect_same_funcs_and_edges(const tlo::perf::perf_stats_t & expec,
+                            const tlo::perf::perf_stats_t & stats) {
+    tlo::vec_t<tlo::perf::perf_func_t> expec_funcs, funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t> expec_edges, edges;
+    expec.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &expec_funcs);
+    expec.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &expec_edges);
+    stats.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &funcs);
+    stats.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &edges);
+    ASSERT_FALSE(expec_funcs.empty());
+    ASSERT_FALSE(expec_edges.empty());
+    expect_same_funcs_and_edges(expec_funcs, expec_edges, funcs, edges);
+}
+
+// Same samples must give the same functions / edges in every process and the
+// same dsos / clumps.
+static void
+expect_same_stats(const tlo::perf::perf_stats_t & expec,
+                  const tlo::perf::perf_stats_t & stats) {
+    tlo::perf::perf_func_stats_t func_stats = expec.agr_func_stats_;
+    tlo::perf::perf_edge_stats_t edge_stats = expec.agr_edge_stats_;
+    ASSERT_TRUE(func_stats.eq(stats.agr_func_stats_));
+    ASSERT_TRUE(edge_stats.eq(stats.agr_edge_stats_));
+    ASSERT_EQ(expec.tpids_.size(), stats.tpids_.size());
+    for (const auto & tpid_and_stats : expec.tpids_) {
+        auto res = stats.tpids_.find(tpid_and_stats.first);
+        ASSERT_NE(res, stats.tpids_.end());
+        ASSERT_EQ(tpid_and_stats.second.funcs_.size(),
+                  res->second.funcs_.size());
+        ASSERT_EQ(tpid_and_stats.second.edges_.size(),
+                  res->second.edges_.size());
+        func_stats = tpid_and_stats.second.func_stats();
+        edge_stats = tpid_and_stats.second.edge_stats();
+        ASSERT_TRUE(func_stats.eq(res->second.func_stats()));
+        ASSERT_TRUE(edge_stats.eq(res->second.edge_stats()));
+    }
+    for (const tlo::sym::dso_t * dso : expec.state_->dsos()) {
+        const tlo::sym::dso_t * other =
+            stats.state_->find_dso(dso->name_.without_extra());
+        ASSERT_NE(other, nullptr);
+        ASSERT_EQ(dso->num_comm_uses(), other->num_comm_uses());
+    }
+    // Deferred sample address updates must have made it back.
+    uint64_t expec_size = 0, size = 0;
+    for (const tlo::sym::func_clump_t * fc : expec.state_->func_clumps()) {
+        expec_size += fc->size();
+    }
+    for (const tlo::sym::func_clump_t * fc : stats.state_->func_clumps()) {
+        size += fc->size();
+    }
+    ASSERT_EQ(expec_size, size);
+    expect_same_funcs_and_edges(expec, stats);
+}
+
+#endif
@@ -0,0 +1,298 @@
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-data-reader.h"
+#include "src/util/file-ops.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+namespace pabi = tlo::perf::perf_abi;
+
+constexpr uint64_t k_ns_per_sec = 1000UL * 1000UL * 1000UL;
+constexpr size_t   k_attr_size  = 128;
+
+// Build a minimal perf.data file in memory.
+struct perf_data_builder_t {
+    std::vector<uint8_t> data_;
+    uint64_t             sample_type_ = pabi::k_sample_ip | pabi::k_sample_tid |
+                            pabi::k_sample_time | pabi::k_sample_branch_stack;
+
+    template<typename T_t>
+    static void
+    put(std::vector<uint8_t> * out, T_t v) {
+        const uint8_t * p = reinterpret_cast<const uint8_t *>(&v);
+        out->insert(out->end(), p, p + sizeof(T_t));
+    }
+
+    static void
+    put_str(std::vector<uint8_t> * out, std::string_view s) {
+        out->insert(out->end(), s.begin(), s.end());
+        do {
+            out->push_back(0);
+        } while (out->size() % sizeof(uint64_t));
+    }
+
+    void
+    add_record(uint32_t type, uint16_t misc, const std::vector<uint8_t> & body) {
+        put(&data_, type);
+        put(&data_, misc);
+        put(&data_, static_cast<uint16_t>(body.size() + 8));
+        data_.insert(data_.end(), body.begin(), body.end());
+    }
+
+    static void
+    put_sample_id(std::vector<uint8_t> * out,
+                  uint32_t               pid,
+                  uint32_t               tid,
+                  uint64_t               time) {
+        put(out, pid);
+        put(out, tid);
+        put(out, time);
+    }
+
+    void
+    add_comm(uint32_t pid, uint32_t tid, std::string_view comm, uint64_t time) {
+        std::vector<uint8_t> body;
+        put(&body, pid);
+        put(&body, tid);
+        put_str(&body, comm);
+        put_sample_id(&body, pid, tid, time);
+        add_record(pabi::k_record_comm, 0, body);
+    }
+
+    void
+    add_mmap2(uint32_t         pid,
+              uint64_t         base,
+              uint64_t         len,
+              uint64_t         pgoff,
+              uint32_t         prot,
+              std::string_view path,
+              uint64_t         time) {
+        std::vector<uint8_t> body;
+        put(&body, pid);
+        put(&body, pid);
+        put(&body, base);
+        put(&body, len);
+        put(&body, pgoff);
+        body.insert(body.end(), 24, 0);
+        put(&body, prot);
+        put(&body, uint32_t(2));
+        put_str(&body, path);
+        put_sample_id(&body, pid, pid, time);
+        add_record(pabi::k_record_mmap2, 0, body);
+    }
+
+    void
+    add_kernel_mmap(uint64_t base, uint64_t len, uint64_t time) {
+        std::vector<uint8_t> body;
+        put(&body, uint32_t(-1));
+        put(&body, uint32_t(0));
+        put(&body, base);
+        put(&body, len);
+        put(&body, uint64_t(0));
+        put_str(&body, "[kernel.kallsyms]_text");
+        put_sample_id(&body, uint32_t(-1), 0, time);
+        add_record(pabi::k_record_mmap, 0, body);
+    }
+
+    void
+    add_fork(uint32_t cpid, uint32_t ppid, uint64_t time) {
+        std::vector<uint8_t> body;
+        put(&body, cpid);
+        put(&body, ppid);
+        put(&body, cpid);
+        put(&body, ppid);
+        put(&body, time);
+        put_sample_id(&body, cpid, cpid, time);
+        add_record(pabi::k_record_fork, 0, body);
+    }
+
+    void
+    add_sample(uint32_t                                   pid,
+               uint64_t                                   ip,
+               uint64_t                                   time,
+               const std::vector<pabi::branch_entry_t> & brs) {
+        std::vector<uint8_t> body;
+        put(&body, ip);
+        put(&body, pid);
+        put(&body, pid);
+        put(&body, time);
+        put(&body, static_cast<uint64_t>(brs.size()));
+        for (const auto & br : brs) {
+            put(&body, br);
+        }
+        add_record(pabi::k_record_sample, 0, body);
+    }
+
+    std::vector<uint8_t>
+    build() const {
+        std::vector<uint8_t> out;
+        pabi::file_header_t   hdr{};
+        hdr.magic_         = pabi::k_magic;
+        hdr.size_          = sizeof(hdr);
+        hdr.attr_size_     = k_attr_size + sizeof(pabi::file_section_t);
+        hdr.attrs_.offset_ = sizeof(hdr);
+        hdr.attrs_.size_   = hdr.attr_size_;
+        hdr.data_.offset_  = hdr.attrs_.offset_ + hdr.attrs_.size_;
+        hdr.data_.size_    = data_.size();
+        put(&out, hdr);
+
+        std::array<uint8_t, k_attr_size> attr{};
+        const uint64_t                   flags = pabi::k_attr_sample_id_all;
+        memcpy(attr.data() + pabi::k_attr_sample_type_off, &sample_type_,
+               sizeof(uint64_t));
+        memcpy(attr.data() + pabi::k_attr_flags_off, &flags, sizeof(uint64_t));
+        out.insert(out.end(), attr.begin(), attr.end());
+        put(&out, pabi::file_section_t{ 0, 0 });
+        out.insert(out.end(), data_.begin(), data_.end());
+        return out;
+    }
+};
+
+struct tmp_perf_data_t {
+    std::array<char, 256> path_;  // NOLINT(*magic*)
+
+    explicit tmp_perf_data_t(const std::vector<uint8_t> & bytes) {
+        const int fd = tlo::file_ops::new_tmpfile(&path_, "/tmp/.perf-data-");
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(tlo::file_ops::ensure_write(fd, bytes.data(), bytes.size()),
+                  bytes.size());
+        close(fd);
+    }
+    ~tmp_perf_data_t() {
+        (void)remove(path_.data());
+    }
+};
+
+}  // namespace
+
+
+TEST(perf, perf_data_time_to_ts) {
+    ASSERT_EQ(tlo::perf::perf_data_reader_t::time_to_ts(
+                  1114875UL * k_ns_per_sec + 29688123UL),
+              (uint64_t(1114875) << 32U) + uint64_t(29688));
+    ASSERT_EQ(tlo::perf::perf_data_reader_t::time_to_ts(0), 0U);
+}
+
+TEST(perf, perf_data_bad_file) {
+    std::vector<uint8_t> bytes(512, 0);
+    tmp_perf_data_t      tmp{ bytes };
+    ASSERT_FALSE(tlo::perf::perf_data_reader_t::is_perf_data(tmp.path_.data()));
+    tlo::perf::perf_data_reader_t pdr;
+    ASSERT_FALSE(pdr.init(tmp.path_.data()));
+    ASSERT_FALSE(pdr.active());
+}
+
+TEST(perf, perf_data_decode) {
+    perf_data_builder_t builder;
+    builder.add_comm(100, 100, "app", 0);
+    builder.add_kernel_mmap(0xffffffff81000000UL, 0x1000000, 0);
+    // Fork is written before the mmap it should inherit (but happens after
+    // it). Records are only ordered per-cpu so we must sort.
+    builder.add_fork(200, 100, 2 * k_ns_per_sec);
+    builder.add_mmap2(100, 0x400000, 0x1000, 0x2000, pabi::k_prot_read |
+                      pabi::k_prot_exec, "/usr/bin/app", 1 * k_ns_per_sec);
+    builder.add_mmap2(100, 0x600000, 0x1000, 0, pabi::k_prot_read,
+                      "/usr/lib/data", 1 * k_ns_per_sec);
+    builder.add_sample(
+        200, 0x400010, 3 * k_ns_per_sec + 5000,
+        { { 0x400020, 0x400100,
+            pabi::k_branch_predicted | (7UL << pabi::k_branch_cycles_off) |
+                (4UL << pabi::k_branch_type_off) },
+          { 0xffffffff81000010UL, 0x400030, pabi::k_branch_mispred } });
+    builder.add_sample(100, 0x500000, 3 * k_ns_per_sec, {});
+
+    tmp_perf_data_t tmp{ builder.build() };
+    ASSERT_TRUE(tlo::perf::perf_data_reader_t::is_perf_data(tmp.path_.data()));
+
+    tlo::perf::perf_data_reader_t pdr;
+    ASSERT_TRUE(pdr.init(tmp.path_.data()));
+    ASSERT_TRUE(pdr.active());
+
+    std::vector<std::string> order;
+    ASSERT_TRUE(pdr.collect_info([&order](const tlo::perf::info_sample_t & s,
+                                          size_t) {
+        if (s.is_mmap()) {
+            const tlo::perf::sample_mmap_t * mmap = s.get_mmap();
+            if (mmap == nullptr) {
+                ADD_FAILURE() << "mmap sample without mmap info";
+                return;
+            }
+            order.emplace_back(mmap->dso_.sview());
+            if (mmap->dso_.sview() == "/usr/bin/app") {
+                EXPECT_TRUE(mmap->is_executable());
+                EXPECT_EQ(mmap->map_base_, 0x400000U);
+                EXPECT_EQ(mmap->map_size_, 0x1000U);
+                EXPECT_EQ(mmap->map_off_, 0x2000U);
+                EXPECT_EQ(s.hdr_.timestamp_, uint64_t(1) << 32U);
+            }
+            else {
+                EXPECT_FALSE(mmap->is_executable());
+            }
+        }
+        else if (s.is_fork()) {
+            const tlo::perf::sample_fork_t * fork = s.get_fork();
+            if (fork == nullptr) {
+                ADD_FAILURE() << "fork sample without fork info";
+                return;
+            }
+            order.emplace_back("fork");
+            EXPECT_EQ(fork->ppid_, 100U);
+            EXPECT_EQ(fork->cpid_, 200U);
+        }
+        else if (s.is_comm()) {
+            const tlo::perf::sample_comm_t * comm = s.get_comm();
+            if (comm == nullptr) {
+                ADD_FAILURE() << "comm sample without comm info";
+                return;
+            }
+            order.emplace_back("comm");
+            EXPECT_EQ(comm->comm_.sview(), "app");
+        }
+    }));
+    ASSERT_EQ(order, (std::vector<std::string>{ "comm", "/usr/bin/app",
+                                                "/usr/lib/data", "fork" }));
+
+    size_t nsamples = 0;
+    ASSERT_TRUE(pdr.collect_samples([&nsamples](tlo::perf::lbr_sample_t * s,
+                                                bool is_lbr, size_t) {
+        if (nsamples++ == 0) {
+            ASSERT_TRUE(is_lbr);
+            ASSERT_TRUE(s->valid());
+            ASSERT_EQ(s->hdr_.pid_, 200U);
+            ASSERT_EQ(s->hdr_.comm_.sview(), "app");
+            ASSERT_EQ(s->hdr_.timestamp_, (uint64_t(3) << 32U) + 5U);
+            ASSERT_EQ(s->loc_.mapped_addr_, 0x400010U);
+            ASSERT_EQ(s->loc_.dso_.sview(), "/usr/bin/app");
+            ASSERT_EQ(s->num_lbr_samples(), 2U);
+            // Oldest branch first.
+            ASSERT_EQ(s->samples_[0].from_.mapped_addr_, 0xffffffff81000010UL);
+            ASSERT_EQ(s->samples_[0].from_.dso_.sview(), "[kernel.kallsyms]");
+            ASSERT_EQ(s->samples_[0].to_.dso_.sview(), "/usr/bin/app");
+            ASSERT_EQ(s->samples_[0].predicted_,
+                      tlo::perf::lbr_br_sample_t::k_mispred);
+            ASSERT_EQ(s->samples_[0].brtype_, 0U);
+            ASSERT_EQ(s->samples_[1].from_.mapped_addr_, 0x400020U);
+            ASSERT_EQ(s->samples_[1].to_.mapped_addr_, 0x400100U);
+            ASSERT_EQ(s->samples_[1].predicted_,
+                      tlo::perf::lbr_br_sample_t::k_pred);
+            ASSERT_EQ(s->samples_[1].cycles_, 7U);
+            // PERF_BR_CALL
+            ASSERT_EQ(s->samples_[1].brtype_, 4U);
+        }
+        else {
+            ASSERT_FALSE(is_lbr);
+            ASSERT_EQ(s->hdr_.pid_, 100U);
+            ASSERT_EQ(s->loc_.dso_.sview(), "[unknown]");
+        }
+    }));
+    ASSERT_EQ(nsamples, 2U);
+}
@@ -3,16 +3,27 @@
 #include "gtest/gtest.h"
 
 #include "src/perf/perf-file.h"
+#include "src/perf/perf-sample-cache.h"
 #include "src/perf/perf-saver.h"
 #include "src/perf/perf-stats.h"
 
 #include "src/util/file-ops.h"
 #include "src/util/file-reader.h"
+#include "src/util/global-stats.h"
 #include "src/util/verbosity.h"
 
+#include <algorithm>
+#include <array>
+#include <map>
 #include <string>
 
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "perf-file-and-save-state-helper.h"
+#include "perf-text-profile-helper.h"
 
 
 #define INPUT_PATH                                                             \
@@ -547,3 +558,514 @@ TEST(perf, collect_perf_file_known) {
         ASSERT_TRUE(G_okay);
     }
 }
+
+
+TEST(perf, collect_perf_file_events_parallel) {
+    std::string info;
+    std::string events;
+    // Enough lines to fill multiple chunks. One process maps its text again
+    // part way through so where a sample lands depends on its timestamp, not
+    // on which worker gets it.
+    make_elf_profile(&info, &events, nullptr, 40000,  // NOLINT(*magic*)
+                     nullptr, 0x1000);                // NOLINT(*magic*)
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+
+    tlo::sym::sym_state_t   ss_serial{};
+    tlo::perf::perf_stats_t serial{ &ss_serial };
+    double nsamples = tlo::G_total_stats.total_samples_.second;
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &serial);
+    ASSERT_TRUE(serial.valid());
+    const double serial_nsamples = tlo::G_total_stats.total_samples_.second -
+                                   nsamples;
+
+    // 2 jobs runs read/parse/collect as a pipeline, more splits the
+    // parsing/collecting between workers.
+    for (const size_t njobs : { size_t{ 2 }, size_t{ 4 }, size_t{ 8 } }) {
+        tlo::sym::sym_state_t   ss_parallel{};
+        tlo::perf::perf_stats_t parallel{ &ss_parallel };
+        nsamples = tlo::G_total_stats.total_samples_.second;
+        collect_text_profile(info_file.path_.data(), events_file.path_.data(),
+                             njobs, &parallel);
+        ASSERT_TRUE(parallel.valid());
+        ASSERT_EQ(tlo::G_total_stats.total_samples_.second - nsamples,
+                  serial_nsamples);
+
+        ASSERT_NE(serial.agr_edge_stats_.num_edges_, 0U);
+        ASSERT_EQ(ss_serial.dso_tab_.size(), ss_parallel.dso_tab_.size());
+        ASSERT_EQ(ss_serial.func_tab_.size(), ss_parallel.func_tab_.size());
+        expect_same_stats(serial, parallel);
+    }
+}
+
+TEST(perf, dso_offsets) {
+    std::string info;
+    std::string events;
+    std::string offset_events;
+    // The same branches as offsets into the binary. The IP of each sample is
+    // the newest branch's target (which is what the offsets format uses).
+    make_elf_profile(&info, &events, nullptr, 4000,  // NOLINT(*magic*)
+                     &offset_events);
+    // Sample without branches is skipped.
+    offset_events += "app 100/100 1.000002: \n";
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+    const tmp_text_file_t offset_events_file{ offset_events };
+
+    tlo::sym::sym_state_t   ss_expec{};
+    tlo::perf::perf_stats_t expec{ &ss_expec };
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &expec);
+    ASSERT_TRUE(expec.valid());
+    ASSERT_NE(expec.agr_edge_stats_.num_edges_, 0U);
+
+    for (const size_t njobs : { size_t{ 1 }, size_t{ 2 }, size_t{ 4 } }) {
+        tlo::sym::sym_state_t   ss{};
+        tlo::perf::perf_stats_t stats{ &ss };
+        stats.use_dso_offsets();
+        tlo::file_reader_t fr_events;
+        fr_events.init(offset_events_file.path_.data());
+        ASSERT_TRUE(fr_events.active());
+        // No info events.
+        ASSERT_TRUE(
+            tlo::perf::collect_perf_file_events(&fr_events, &stats, njobs));
+        fr_events.cleanup();
+        ASSERT_TRUE(stats.valid());
+        ASSERT_TRUE(stats.mappings_.mappings_.empty());
+
+        expect_same_stats(expec, stats);
+    }
+}
+
+TEST(perf, collect_profiles) {
+    std::string info[2];    // NOLINT(*avoid-c-arrays)
+    std::string events[2];  // NOLINT(*avoid-c-arrays)
+    make_elf_profile(&info[0], &events[0], nullptr, 4000);  // NOLINT(*magic*)
+    make_elf_profile(&info[1], &events[1], nullptr, 1000);  // NOLINT(*magic*)
+    const tmp_text_file_t info_files[2]   = {  // NOLINT(*avoid-c-arrays)
+        tmp_text_file_t{ info[0] }, tmp_text_file_t{ info[1] }
+    };
+    const tmp_text_file_t events_files[2] = {  // NOLINT(*avoid-c-arrays)
+        tmp_text_file_t{ events[0] }, tmp_text_file_t{ events[1] }
+    };
+
+    tlo::sym::sym_state_t   ss_expec{};
+    tlo::perf::perf_stats_t expec{ &ss_expec };
+    for (size_t i = 0; i < 2; ++i) {
+        collect_text_profile(info_files[i].path_.data(),
+                             events_files[i].path_.data(), 1, &expec);
+        ASSERT_TRUE(expec.valid());
+    }
+    tlo::vec_t<tlo::perf::perf_func_t> expec_funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t> expec_edges;
+    expec.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &expec_funcs);
+    expec.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &expec_edges);
+    std::map<std::string, tlo::perf::perf_func_stats_t> expec_func_stats;
+    std::map<std::string, tlo::perf::perf_edge_stats_t> expec_edge_stats;
+    stats_by_clump(expec_funcs, expec_edges, &expec_func_stats,
+                   &expec_edge_stats, true);
+
+    // Each profile on its own, normalizing scales all of its functions / edges
+    // by the same amount.
+    std::array<std::map<std::string, tlo::perf::perf_func_stats_t>, 2>
+        single_func_stats;
+    std::array<std::map<std::string, tlo::perf::perf_edge_stats_t>, 2>
+                          single_edge_stats;
+    std::array<double, 2> func_scales{};
+    std::array<double, 2> edge_scales{};
+    for (size_t i = 0; i < 2; ++i) {
+        tlo::sym::sym_state_t   ss{};
+        tlo::perf::perf_stats_t single{ &ss };
+        collect_text_profile(info_files[i].path_.data(),
+                             events_files[i].path_.data(), 1, &single);
+        tlo::vec_t<tlo::perf::perf_func_t> funcs;
+        tlo::vec_t<tlo::perf::perf_edge_t> edges;
+        single.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &funcs);
+        single.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &edges);
+        // Self edges aren't saved so they don't count (as with reloading).
+        double nedges = 0.0;
+        for (const tlo::perf::perf_edge_t & pe : edges) {
+            nedges += pe.from_ != pe.to_ ? pe.stats().num_edges_ : 0.0;
+        }
+        ASSERT_NE(nedges, 0.0);
+        func_scales[i] = static_cast<double>(tlo::perf::k_func_scale_point) /
+                         single.agr_func_stats_.num_samples_;
+        edge_scales[i] =
+            static_cast<double>(tlo::perf::k_edge_scale_point) / nedges;
+        stats_by_clump(funcs, edges, &single_func_stats[i],
+                       &single_edge_stats[i], true);
+    }
+
+    tlo::vec_t<tlo::perf::perf_profile_t> profiles{};
+    for (size_t i = 0; i < 2; ++i) {
+        profiles.emplace_back(tlo::perf::perf_profile_t{
+            events_files[i].path_.data(), info_files[i].path_.data() });
+    }
+    // Unreadable profiles are skipped.
+    profiles.emplace_back(
+        tlo::perf::perf_profile_t{ "/no/such/events", "/no/such/info" });
+
+    for (const size_t njobs : { size_t{ 1 }, size_t{ 2 }, size_t{ 4 } }) {
+        // Without normalizing it is the same as collecting them one after the
+        // other.
+        tlo::sym::sym_state_t           ss{};
+        tlo::perf::perf_stats_t         stats{ &ss };
+        tlo::perf::perf_state_scaling_t scaling{};
+        scaling.set_no_scale();
+        ASSERT_TRUE(tlo::perf::collect_perf_profiles(profiles, &stats,
+                                                     &scaling, njobs));
+        ASSERT_FALSE(scaling.did_scale_any());
+        ASSERT_TRUE(stats.valid());
+        expect_same_stats(expec, stats);
+
+        // Normalized, each profile has the same weight.
+        tlo::sym::sym_state_t           ss_norm{};
+        tlo::perf::perf_stats_t         norm{ &ss_norm };
+        tlo::perf::perf_state_scaling_t norm_scaling{};
+        ASSERT_TRUE(tlo::perf::collect_perf_profiles(profiles, &norm,
+                                                     &norm_scaling, njobs));
+        ASSERT_TRUE(norm_scaling.did_scale());
+        ASSERT_NEAR(norm.agr_func_stats_.num_samples_,
+                    2.0 * tlo::perf::k_func_scale_point, 1.0);
+
+        tlo::vec_t<tlo::perf::perf_func_t> funcs;
+        tlo::vec_t<tlo::perf::perf_edge_t> edges;
+        norm.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &funcs);
+        norm.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &edges);
+        std::map<std::string, tlo::perf::perf_func_stats_t> func_stats;
+        std::map<std::string, tlo::perf::perf_edge_stats_t> edge_stats;
+        stats_by_clump(funcs, edges, &func_stats, &edge_stats, true);
+        ASSERT_EQ(func_stats.size(), expec_func_stats.size());
+        ASSERT_EQ(edge_stats.size(), expec_edge_stats.size());
+        for (const auto & [key, pf_stats] : func_stats) {
+            tlo::perf::perf_func_stats_t expec_pf_stats{};
+            for (size_t i = 0; i < 2; ++i) {
+                auto res = single_func_stats[i].find(key);
+                if (res != single_func_stats[i].end()) {
+                    tlo::perf::perf_func_stats_t scaled = res->second;
+                    scaled.num_samples_ *= func_scales[i];
+                    scaled.num_br_samples_in_ *= edge_scales[i];
+                    scaled.num_br_samples_out_ *= edge_scales[i];
+                    expec_pf_stats.add(scaled);
+                }
+            }
+            ASSERT_NEAR(pf_stats.num_samples_, expec_pf_stats.num_samples_,
+                        1e-9 * expec_pf_stats.num_samples_)  // NOLINT(*magic*)
+                << key;
+            // The branch totals are scaled with the edges they add up to.
+            ASSERT_NEAR(pf_stats.num_br_samples_in_,
+                        expec_pf_stats.num_br_samples_in_,
+                        1e-9 * expec_pf_stats.num_br_samples_in_)  // NOLINT
+                << key;
+            ASSERT_NEAR(pf_stats.num_br_samples_out_,
+                        expec_pf_stats.num_br_samples_out_,
+                        1e-9 * expec_pf_stats.num_br_samples_out_)  // NOLINT
+                << key;
+        }
+        for (const auto & [key, pe_stats] : edge_stats) {
+            double expec_nedges = 0.0;
+            for (size_t i = 0; i < 2; ++i) {
+                auto res = single_edge_stats[i].find(key);
+                if (res != single_edge_stats[i].end()) {
+                    expec_nedges += res->second.num_edges_ * edge_scales[i];
+                }
+            }
+            ASSERT_NEAR(pe_stats.num_edges_, expec_nedges,
+                        1e-9 * expec_nedges)  // NOLINT(*magic*)
+                << key;
+        }
+
+        funcs.clear();
+        edges.clear();
+        norm.filter_and_clump(
+            tlo::perf::perf_stats_func_filter_t{},
+            tlo::perf::perf_stats_edge_filter_t{},
+            tlo::perf::perf_stats_function_order_clumper_t{}, &funcs, &edges);
+        ASSERT_FALSE(funcs.empty());
+        for (const tlo::perf::perf_func_t & pf : funcs) {
+            ASSERT_TRUE(pf.valid());
+        }
+    }
+
+    // Nothing to collect.
+    tlo::sym::sym_state_t           ss_none{};
+    tlo::perf::perf_stats_t         none{ &ss_none };
+    tlo::perf::perf_state_scaling_t scaling{};
+    profiles.erase(profiles.begin(), profiles.begin() + 2);
+    ASSERT_FALSE(
+        tlo::perf::collect_perf_profiles(profiles, &none, &scaling, 2));
+}
+
+TEST(perf, collect_profiles_same_as_reload) {
+    std::string info[2];          // NOLINT(*avoid-c-arrays)
+    std::string events[2];        // NOLINT(*avoid-c-arrays)
+    std::string typed_events[2];  // NOLINT(*avoid-c-arrays)
+    make_elf_profile(&info[0], &events[0], &typed_events[0], 4000);  // NOLINT
+    make_elf_profile(&info[1], &events[1], &typed_events[1], 1000);  // NOLINT
+    const tmp_text_file_t info_files[2]   = {  // NOLINT(*avoid-c-arrays)
+        tmp_text_file_t{ info[0] }, tmp_text_file_t{ info[1] }
+    };
+    const tmp_text_file_t events_files[2] = {  // NOLINT(*avoid-c-arrays)
+        tmp_text_file_t{ events[0] }, tmp_text_file_t{ events[1] }
+    };
+    const tmp_text_file_t save_files[2] = {  // NOLINT(*avoid-c-arrays)
+        tmp_text_file_t{ "" }, tmp_text_file_t{ "" }
+    };
+
+    // `--profiles A,B`
+    tlo::vec_t<tlo::perf::perf_profile_t> profiles{};
+    for (size_t i = 0; i < 2; ++i) {
+        profiles.emplace_back(tlo::perf::perf_profile_t{
+            events_files[i].path_.data(), info_files[i].path_.data() });
+    }
+    tlo::sym::sym_state_t           ss_profiles{};
+    tlo::perf::perf_stats_t         stats{ &ss_profiles };
+    tlo::perf::perf_state_scaling_t scaling{};
+    ASSERT_TRUE(
+        tlo::perf::collect_perf_profiles(profiles, &stats, &scaling, 2));
+    ASSERT_TRUE(scaling.did_scale());
+    tlo::vec_t<tlo::perf::perf_func_t> funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t> edges;
+    stats.filter_and_clump(tlo::perf::perf_stats_func_filter_t{},
+                           tlo::perf::perf_stats_edge_filter_t{},
+                           tlo::perf::perf_stats_clumper_t{}, &funcs, &edges);
+    drop_self_edges(&edges);
+
+    // `--save` A and B then `--reload A,B`
+    tlo::vec_t<std::string_view> save_paths{};
+    for (size_t i = 0; i < 2; ++i) {
+        tlo::sym::sym_state_t   ss{};
+        tlo::perf::perf_stats_t single{ &ss };
+        collect_text_profile(info_files[i].path_.data(),
+                             events_files[i].path_.data(), 1, &single);
+        ASSERT_TRUE(single.valid());
+        tlo::vec_t<tlo::perf::perf_func_t> single_funcs;
+        tlo::vec_t<tlo::perf::perf_edge_t> single_edges;
+        single.filter_and_clump(tlo::perf::perf_stats_func_filter_t{},
+                                tlo::perf::perf_stats_edge_filter_t{},
+                                tlo::perf::perf_stats_clumper_t{},
+                                &single_funcs, &single_edges);
+        drop_self_edges(&single_edges);
+        tlo::perf::perf_state_scaling_t save_scaling{};
+        save_scaling.set_no_scale();
+        const tlo::perf::perf_state_saver_t saver{ &ss };
+        ASSERT_TRUE(saver.save_state(save_files[i].path_.data(), &single_funcs,
+                                     &single_edges, &save_scaling,
+                                     tlo::perf::k_perf_state_binary));
+        save_paths.emplace_back(save_files[i].path_.data());
+    }
+    tlo::sym::sym_state_t                  ss_reload{};
+    tlo::vec_t<tlo::perf::perf_func_t>     reload_funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t>     reload_edges;
+    tlo::perf::perf_state_scaling_t        reload_scaling{};
+    const tlo::perf::perf_state_reloader_t reloader{ &ss_reload };
+    ASSERT_TRUE(reloader.reload_state(&save_paths, &reload_funcs,
+                                      &reload_edges, &reload_scaling));
+    ASSERT_TRUE(reload_scaling.did_scale());
+
+    std::map<std::string, tlo::perf::perf_func_stats_t> func_stats,
+        reload_func_stats;
+    std::map<std::string, tlo::perf::perf_edge_stats_t> edge_stats,
+        reload_edge_stats;
+    stats_by_clump(funcs, edges, &func_stats, &edge_stats);
+    stats_by_clump(reload_funcs, reload_edges, &reload_func_stats,
+                   &reload_edge_stats);
+    ASSERT_GT(func_stats.size(), 16U);
+    ASSERT_EQ(func_stats.size(), reload_func_stats.size());
+    ASSERT_EQ(edge_stats.size(), reload_edge_stats.size());
+    // Same weight for every function and edge (up to the order they were
+    // added in). The branch totals differ, a save state has them (and the
+    // tracked branches) from before its edges were scaled.
+    for (const auto & [key, pf_stats] : func_stats) {
+        auto res = reload_func_stats.find(key);
+        ASSERT_NE(res, reload_func_stats.end()) << key;
+        ASSERT_NEAR(pf_stats.num_samples_, res->second.num_samples_,
+                    1e-9 * pf_stats.num_samples_)  // NOLINT(*magic*)
+            << key;
+    }
+    for (const auto & [key, pe_stats] : edge_stats) {
+        auto res = reload_edge_stats.find(key);
+        ASSERT_NE(res, reload_edge_stats.end()) << key;
+        ASSERT_NEAR(pe_stats.num_edges_, res->second.num_edges_,
+                    1e-9 * pe_stats.num_edges_)  // NOLINT(*magic*)
+            << key;
+    }
+}
+
+TEST(perf, checkpoint) {
+    std::string info;
+    std::string events;
+    make_elf_profile(&info, &events, nullptr, 40000);  // NOLINT(*magic*)
+    // The first run is killed part way through the events.
+    const size_t     cut = events.find('\n', events.size() / 2) + 1;
+    const std::string partial = events.substr(0, cut);
+
+    const tmp_text_file_t  info_file{ info };
+    const tmp_text_file_t  events_file{ events };
+    const tmp_text_file_t  partial_file{ partial };
+    const tmp_text_file_t  checkpoint_file{ "" };
+    const std::string_view key = "profile";
+
+    tlo::sym::sym_state_t   ss_serial{};
+    tlo::perf::perf_stats_t serial{ &ss_serial };
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &serial);
+    ASSERT_TRUE(serial.valid());
+
+    for (const size_t njobs : { size_t{ 1 }, size_t{ 2 }, size_t{ 4 } }) {
+        // No interval so it is written after every batch.
+        tlo::perf::perf_checkpoint_t checkpoint{ checkpoint_file.path_.data(),
+                                                 key, 0, 0 };
+        {
+            tlo::sym::sym_state_t   ss_killed{};
+            tlo::perf::perf_stats_t killed{ &ss_killed };
+            tlo::file_reader_t      fr_events, fr_info;
+            fr_info.init(info_file.path_.data());
+            fr_events.init(partial_file.path_.data());
+            ASSERT_TRUE(tlo::perf::collect_perf_file_info(&fr_info, &killed));
+            ASSERT_TRUE(tlo::perf::collect_perf_file_events(
+                &fr_events, &killed, njobs, &checkpoint));
+        }
+
+        // A checkpoint is not a complete sample cache.
+        tlo::sym::sym_state_t   ss_cached{};
+        tlo::perf::perf_stats_t cached{ &ss_cached };
+        ASSERT_FALSE(tlo::perf::perf_sample_cache_t::load(
+            checkpoint_file.path_.data(), key, &cached, 1));
+
+        tlo::sym::sym_state_t   ss_resumed{};
+        tlo::perf::perf_stats_t resumed{ &ss_resumed };
+        tlo::file_reader_t      fr_events, fr_info;
+        fr_info.init(info_file.path_.data());
+        fr_events.init(events_file.path_.data());
+        ASSERT_TRUE(tlo::perf::collect_perf_file_info(&fr_info, &resumed));
+        ASSERT_FALSE(tlo::perf::perf_sample_cache_t::load_checkpoint(
+            checkpoint_file.path_.data(), "not-the-key", &resumed, 1,
+            &checkpoint.nbytes_done_));
+        ASSERT_TRUE(tlo::perf::perf_sample_cache_t::load_checkpoint(
+            checkpoint_file.path_.data(), key, &resumed, 1,
+            &checkpoint.nbytes_done_));
+        ASSERT_EQ(checkpoint.nbytes_done_, cut);
+        ASSERT_TRUE(tlo::perf::collect_perf_file_events(&fr_events, &resumed,
+                                                        njobs, &checkpoint));
+
+        ASSERT_TRUE(resumed.valid());
+        expect_same_stats(serial, resumed);
+    }
+}
+
+TEST(perf, elf_profile) {
+    std::string info;
+    std::string events;
+    std::string typed_events;
+    make_elf_profile(&info, &events, &typed_events, 20000);  // NOLINT(*magic*)
+    ASSERT_NE(typed_events.find("/CALL/-"), std::string::npos);
+    ASSERT_NE(typed_events.find("//-"), std::string::npos);
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+    const tmp_text_file_t typed_events_file{ typed_events };
+
+    tlo::sym::sym_state_t   ss_serial{};
+    tlo::perf::perf_stats_t serial{ &ss_serial };
+    double nsearched = tlo::G_total_stats.total_insn_searched_.second;
+    double ndecoded  = tlo::G_total_stats.total_insn_decoded_.second;
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &serial);
+    ASSERT_TRUE(serial.valid());
+    const double serial_nsearched =
+        tlo::G_total_stats.total_insn_searched_.second - nsearched;
+    ASSERT_NE(serial_nsearched, 0.0);
+    ASSERT_EQ(tlo::G_total_stats.total_insn_decoded_.second - ndecoded,
+              serial_nsearched);
+
+    // Real functions / branch types, not one [unknown] function per dso.
+    tlo::vec_t<tlo::perf::perf_func_t> funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t> edges;
+    serial.filter_funcs(tlo::perf::perf_stats_func_filter_t{}, &funcs);
+    serial.filter_edges(tlo::perf::perf_stats_edge_filter_t{}, &edges);
+    ASSERT_GT(funcs.size(), 16U);
+    size_t ncalls = 0;
+    for (const tlo::perf::perf_edge_t & pedge : edges) {
+        ASSERT_TRUE(pedge.br_insn_.good());
+        ncalls += pedge.br_insn_.is_trackable_call() ? 1U : 0U;
+    }
+    ASSERT_NE(ncalls, 0U);
+    ASSERT_NE(ncalls, edges.size());
+
+    for (const size_t njobs : { size_t{ 2 }, size_t{ 4 } }) {
+        tlo::sym::sym_state_t   ss{};
+        tlo::perf::perf_stats_t stats{ &ss };
+        collect_text_profile(info_file.path_.data(), events_file.path_.data(),
+                             njobs, &stats);
+        ASSERT_TRUE(stats.valid());
+        expect_same_stats(serial, stats);
+    }
+
+    for (const bool preagr : { false, true }) {
+        for (const size_t njobs : { size_t{ 1 }, size_t{ 2 }, size_t{ 4 } }) {
+            tlo::sym::sym_state_t   ss{};
+            tlo::perf::perf_stats_t stats{ &ss, tlo::perf::k_agr_tpid, preagr };
+            collect_text_profile(info_file.path_.data(),
+                                 events_file.path_.data(), njobs, &stats);
+            ASSERT_TRUE(stats.valid());
+            expect_same_stats(serial, stats);
+
+            // Branches perf classified for us don't need to be decoded, and
+            // classify the same.
+            tlo::sym::sym_state_t   ss_typed{};
+            tlo::perf::perf_stats_t typed{ &ss_typed, tlo::perf::k_agr_tpid,
+                                           preagr };
+            nsearched = tlo::G_total_stats.total_insn_searched_.second;
+            collect_text_profile(info_file.path_.data(),
+                                 typed_events_file.path_.data(), njobs,
+                                 &typed);
+            ASSERT_TRUE(typed.valid());
+            ASSERT_LT(tlo::G_total_stats.total_insn_searched_.second -
+                          nsearched,
+                      serial_nsearched);
+            expect_same_stats(serial, typed);
+        }
+    }
+}
+
+TEST(perf, perf_events_slice_cmdline) {
+    static constexpr std::string_view k_cmd =
+        "perf script -F comm,pid,tid,time,ip,dso,brstack ";
+    tlo::perf::perf_time_range_t range;
+    tlo::preader_t::cmdline_t    cmdline;
+
+    // No range, just one unsliced `perf script`.
+    ASSERT_TRUE(tlo::perf::create_perf_events_slice_cmdline(
+        "perf.data", range, 0, 4, &cmdline));
+    ASSERT_EQ(std::string_view(cmdline.data()),
+              std::string(k_cmd) + "-i perf.data");
+
+    // 2.000010 -> 5.000010 (same encoding as the parsed timestamps).
+    range.add((2UL << 32U) + 10U);
+    range.add(0);
+    range.add((5UL << 32U) + 10U);
+    range.add((3UL << 32U) + 10U);
+    ASSERT_TRUE(range.valid());
+    ASSERT_EQ(range.lo_, (2UL << 32U) + 10U);
+    ASSERT_EQ(range.hi_, (5UL << 32U) + 10U);
+
+    std::array<std::string_view, 3> expec = { {
+        "--time ,3.000009999 -i perf.data",
+        "--time 3.000010000,4.000009999 -i perf.data",
+        "--time 4.000010000, -i perf.data",
+    } };
+    for (size_t i = 0; i < expec.size(); ++i) {
+        ASSERT_TRUE(tlo::perf::create_perf_events_slice_cmdline(
+            "perf.data", range, i, expec.size(), &cmdline));
+        ASSERT_EQ(std::string_view(cmdline.data()),
+                  std::string(k_cmd) + std::string(expec[i]));
+    }
+
+    std::string long_path(cmdline.size(), 'x');
+    ASSERT_FALSE(tlo::perf::create_perf_events_slice_cmdline(long_path, range,
+                                                             1, 3, &cmdline));
+}
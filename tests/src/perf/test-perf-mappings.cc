@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-mappings.h"
+#include "src/perf/perf-sample.h"
+#include "src/sym/syms.h"
+
+#include <string_view>
+
+#include <stdint.h>
+
+namespace {
+using tlo::perf::info_sample_t;
+using tlo::perf::perf_map_hint_t;
+using tlo::perf::perf_mappings_t;
+using tlo::perf::sample_hdr_t;
+using tlo::perf::sample_loc_t;
+
+constexpr std::string_view k_lib_a = "/nonexistent/liba.so";
+constexpr std::string_view k_lib_b = "/nonexistent/libb.so";
+constexpr uint32_t         k_pid   = 42;
+
+tlo::small_str_t<char const *>
+to_sstr(std::string_view sv) {
+    return { sv.data(), static_cast<uint16_t>(sv.length()) };
+}
+
+void
+add_mmap(tlo::sym::sym_state_t * ss,
+         perf_mappings_t *       mappings,
+         uint64_t                ts,
+         uint64_t                base,
+         uint64_t                size,
+         uint64_t                off,
+         std::string_view        dso) {
+    info_sample_t sample{};
+    sample.hdr_.pid_       = k_pid;
+    sample.hdr_.tid_       = k_pid;
+    sample.hdr_.timestamp_ = ts;
+    sample.use_mmap();
+    tlo::perf::sample_mmap_t * mmap = sample.get_mmap();
+    mmap->map_base_                 = base;
+    mmap->map_size_                 = size;
+    mmap->map_off_                  = off;
+    mmap->pid_                      = k_pid;
+    mmap->tid_                      = k_pid;
+    mmap->read_                     = 1;
+    mmap->exec_                     = 1;
+    mmap->dso_                      = to_sstr(dso);
+    ASSERT_TRUE(mappings->add_sample(ss->get_strtab(), sample));
+}
+
+// Returns the unmapped address or -1 if no mapping was found.
+uint64_t
+unmap(const perf_mappings_t * mappings,
+      const tlo::sym::dso_t * dso,
+      uint64_t                ts,
+      uint64_t                addr,
+      perf_map_hint_t *       hint = nullptr) {
+    sample_hdr_t hdr{};
+    hdr.pid_       = k_pid;
+    hdr.tid_       = k_pid;
+    hdr.timestamp_ = ts;
+    sample_loc_t loc{};
+    loc.mapped_addr_ = addr;
+    if (!mappings->fillin_sample_loc(dso, hdr, &loc, nullptr, hint)) {
+        return static_cast<uint64_t>(-1);
+    }
+    return loc.unmapped_addr_;
+}
+}  // namespace
+
+TEST(perf, mappings_lookup) {
+    tlo::sym::sym_state_t ss{};
+    perf_mappings_t       mappings{};
+    // A at [0x1000, 0x3000) then B remapped over the top half of it, then A
+    // again (different offset) over B.
+    add_mmap(&ss, &mappings, 10, 0x1000, 0x2000, 0x0, k_lib_a);
+    add_mmap(&ss, &mappings, 20, 0x2000, 0x2000, 0x10000, k_lib_b);
+    add_mmap(&ss, &mappings, 30, 0x2800, 0x800, 0x50000, k_lib_a);
+    // Far away and unrelated.
+    add_mmap(&ss, &mappings, 5, 0x100000, 0x1000, 0x0, k_lib_b);
+    ASSERT_TRUE(mappings.finalize());
+
+    tlo::sym::dso_t * dso_a = ss.get_dso(tlo::strbuf_t<>{ k_lib_a });
+    tlo::sym::dso_t * dso_b = ss.get_dso(tlo::strbuf_t<>{ k_lib_b });
+
+    ASSERT_EQ(unmap(&mappings, dso_a, 10, 0x1010), 0x10U);
+    ASSERT_EQ(unmap(&mappings, dso_a, 10, 0x2900), 0x1900U);
+    // Mapping is in the future.
+    ASSERT_EQ(unmap(&mappings, dso_a, 9, 0x1010), static_cast<uint64_t>(-1));
+    ASSERT_EQ(unmap(&mappings, dso_b, 15, 0x2010), static_cast<uint64_t>(-1));
+    ASSERT_EQ(unmap(&mappings, dso_b, 25, 0x2010), 0x10010U);
+    ASSERT_EQ(unmap(&mappings, dso_b, 25, 0x3ff0), 0x11ff0U);
+    // Newest mapping of A wins.
+    ASSERT_EQ(unmap(&mappings, dso_a, 25, 0x2900), 0x1900U);
+    ASSERT_EQ(unmap(&mappings, dso_a, 30, 0x2900), 0x50100U);
+    ASSERT_EQ(unmap(&mappings, dso_a, 30, 0x1900), 0x900U);
+    ASSERT_EQ(unmap(&mappings, dso_b, 1000, 0x100010), 0x10U);
+    ASSERT_EQ(unmap(&mappings, dso_b, 1000, 0x101000),
+              static_cast<uint64_t>(-1));
+    ASSERT_EQ(unmap(&mappings, dso_a, 1000, 0x500),
+              static_cast<uint64_t>(-1));
+}
+
+TEST(perf, mappings_lookup_hint) {
+    tlo::sym::sym_state_t ss{};
+    perf_mappings_t       mappings{};
+    add_mmap(&ss, &mappings, 10, 0x1000, 0x2000, 0x0, k_lib_a);
+    add_mmap(&ss, &mappings, 30, 0x2800, 0x800, 0x50000, k_lib_a);
+    add_mmap(&ss, &mappings, 10, 0x8000, 0x1000, 0x0, k_lib_b);
+    ASSERT_TRUE(mappings.finalize());
+
+    tlo::sym::dso_t * dso_a = ss.get_dso(tlo::strbuf_t<>{ k_lib_a });
+    tlo::sym::dso_t * dso_b = ss.get_dso(tlo::strbuf_t<>{ k_lib_b });
+
+    perf_map_hint_t hint{};
+    ASSERT_EQ(unmap(&mappings, dso_a, 20, 0x2900, &hint), 0x1900U);
+    ASSERT_NE(hint.map_, nullptr);
+    ASSERT_EQ(hint.dso_, dso_a);
+    // Same mapping, hint is reused.
+    ASSERT_EQ(unmap(&mappings, dso_a, 25, 0x1100, &hint), 0x100U);
+    // Hint must not be used once the newer mapping is live.
+    ASSERT_EQ(unmap(&mappings, dso_a, 30, 0x2900, &hint), 0x50100U);
+    ASSERT_EQ(unmap(&mappings, dso_a, 30, 0x1100, &hint), 0x100U);
+    // Different DSO at the same address must not match.
+    ASSERT_EQ(unmap(&mappings, dso_b, 30, 0x1100, &hint),
+              static_cast<uint64_t>(-1));
+    ASSERT_EQ(unmap(&mappings, dso_b, 30, 0x8100, &hint), 0x100U);
+    ASSERT_EQ(hint.dso_, dso_b);
+    // Different pid.
+    sample_hdr_t hdr{};
+    hdr.pid_       = k_pid + 1;
+    hdr.timestamp_ = 30;
+    sample_loc_t loc{};
+    loc.mapped_addr_ = 0x8100;
+    ASSERT_FALSE(mappings.fillin_sample_loc(dso_b, hdr, &loc, nullptr, &hint));
+}
+
+TEST(perf, mappings_lookup_many_remaps) {
+    struct map_t {
+        uint64_t ts_;
+        uint64_t base_;
+        uint64_t size_;
+        uint64_t off_;
+    };
+    // NOLINTBEGIN(*magic*)
+    // A huge early mapping of B under everything (so every later mapping
+    // overlaps something far before it), then A remapped over and over at
+    // overlapping addresses.
+    const map_t       big{ 1, 0x1000, 0x10000000, 0 };
+    tlo::vec_t<map_t> maps{};
+    for (uint64_t i = 0; i < 2000; ++i) {
+        maps.emplace_back(map_t{ 10 + ((i * 7919) % 2000),
+                                 0x100000 + ((i * 0x3000) % 0x40000),
+                                 0x8000 + ((i % 7) * 0x1000), i * 0x100000 });
+    }
+
+    tlo::sym::sym_state_t ss{};
+    perf_mappings_t       mappings{};
+    add_mmap(&ss, &mappings, big.ts_, big.base_, big.size_, big.off_, k_lib_b);
+    for (const map_t & map : maps) {
+        add_mmap(&ss, &mappings, map.ts_, map.base_, map.size_, map.off_,
+                 k_lib_a);
+    }
+    ASSERT_TRUE(mappings.finalize());
+
+    tlo::sym::dso_t * dso_a = ss.get_dso(tlo::strbuf_t<>{ k_lib_a });
+    tlo::sym::dso_t * dso_b = ss.get_dso(tlo::strbuf_t<>{ k_lib_b });
+
+    for (uint64_t addr = 0xff000; addr < 0x150000; addr += 0x801) {
+        for (const uint64_t ts : { 5UL, 100UL, 1000UL, 5000UL }) {
+            // Newest mapping of A containing `addr`.
+            const map_t * best = nullptr;
+            for (const map_t & map : maps) {
+                if (map.ts_ <= ts && addr >= map.base_ &&
+                    addr < map.base_ + map.size_ &&
+                    (best == nullptr || map.ts_ > best->ts_)) {
+                    best = &map;
+                }
+            }
+            ASSERT_EQ(unmap(&mappings, dso_a, ts, addr),
+                      best == nullptr ? static_cast<uint64_t>(-1)
+                                      : addr - best->base_ + best->off_);
+            ASSERT_EQ(unmap(&mappings, dso_b, ts, addr), addr - big.base_);
+        }
+    }
+    // NOLINTEND(*magic*)
+}
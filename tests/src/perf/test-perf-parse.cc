@@ -1,7 +1,9 @@
 #include "gtest/gtest.h"
 
+#include "src/perf/perf-brtype.h"
 #include "src/perf/perf-parse.h"
 
+#include <array>
 #include <string>
 
 
@@ -473,3 +475,188 @@ TEST(perf, parse_lbr_line_new) {
     ASSERT_EQ(sample.num_lbr_samples(), 31U);
     ASSERT_TRUE(sample.valid());
 }
+
+TEST(perf, parse_lbr_brtype) {
+    tlo::perf::lbr_sample_t sample;
+    size_t                  res;
+    // perf < 5.15 (no brtype), perf < 6.3 (brtype), and perf >= 6.3 (brtype +
+    // brdesc). The last entry on the line is followed by the newline.
+    std::string test_s =
+        "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/-/1 0x401010(/a)/0x402010(/a)/P/-/-/2/ 0x401020(/a)/0x402020(/a)/P/-/-/3/CALL 0x401030(/a)/0x402030(/a)/M/-/-/4/RET/- 0x401040(/a)/0x402040(/a)/P/-/-/5//- 0x401050(/a)/0x402050(/a)/P/-/-/6/IND_CALL/- 0x401060(/a)/0x402060(/a)/P/-/-/7/COND/- 0x401070(/a)/0x402070(/a)/P/-/-/8/BOGUS 0x401080(/a)/0x402080(/a)/P/-/-/9/UNCOND\n";
+
+    // NOLINTBEGIN(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+    static const uint8_t k_expec_brtypes[] = {
+        tlo::perf::k_perf_br_uncond,  tlo::perf::k_perf_br_unknown,
+        tlo::perf::k_perf_br_cond,    tlo::perf::k_perf_br_ind_call,
+        tlo::perf::k_perf_br_unknown, tlo::perf::k_perf_br_ret,
+        tlo::perf::k_perf_br_call,    tlo::perf::k_perf_br_unknown,
+        tlo::perf::k_perf_br_unknown,
+    };
+    // NOLINTEND(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+
+    res =
+        tlo::perf::parse_sample_line(test_s.c_str(), test_s.length(), &sample);
+    ASSERT_NE(res, tlo::perf::k_parse_done);
+    ASSERT_NE(res, tlo::perf::k_parse_error);
+    ASSERT_NE(res, tlo::perf::k_parse_incomplete);
+    ASSERT_EQ(tlo::perf::parse_lbr_line(test_s.c_str(), test_s.length(), res,
+                                        &sample),
+              tlo::perf::k_parse_done);
+    ASSERT_EQ(sample.num_lbr_samples(), 9U);
+    ASSERT_TRUE(sample.valid());
+    for (uint32_t i = 0; i < sample.num_lbr_samples(); ++i) {
+        ASSERT_EQ(sample.samples_[i].brtype_, k_expec_brtypes[i]);
+        ASSERT_EQ(sample.samples_[i].cycles_, 9 - i);
+        ASSERT_TRUE(sample.samples_[i].br_insn_.bad());
+    }
+
+    // Types we can classify without decoding.
+    ASSERT_STREQ(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_call).name(),
+        "call_rel32");
+    ASSERT_STREQ(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_ind_call).name(),
+        "call_ind");
+    ASSERT_STREQ(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_cond).name(),
+        "jz_rel32");
+    ASSERT_TRUE(tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_call)
+                    .is_trackable_call());
+    ASSERT_TRUE(tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_ret)
+                    .is_ret());
+    ASSERT_FALSE(tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_ret)
+                     .is_trackable_call());
+    ASSERT_TRUE(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_unknown).bad());
+    ASSERT_TRUE(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_no_tx).bad());
+    ASSERT_TRUE(
+        tlo::perf::perf_brtype_to_br_insn(tlo::perf::k_perf_br_irq).bad());
+}
+
+TEST(perf, parse_lbr_fmt) {
+    using tlo::perf::lbr_fmt_t;
+    struct fmt_test_t {
+        lbr_fmt_t   fmt_;
+        std::string line_;
+        uint8_t     brtype_;
+    };
+    // NOLINTBEGIN(*magic*)
+    const std::array<fmt_test_t, 3> k_tests = { {
+        { tlo::perf::k_lbr_fmt_cycles,
+          "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/-/1  0x401010(/a)/0x402010(/a)/M/X/A/2\n",
+          tlo::perf::k_perf_br_unknown },
+        { tlo::perf::k_lbr_fmt_brtype,
+          "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/-/1/  0x401010(/a)/0x402010(/a)/M/X/A/2/CALL\n",
+          tlo::perf::k_perf_br_call },
+        { tlo::perf::k_lbr_fmt_brdesc,
+          "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/-/1//-  0x401010(/a)/0x402010(/a)/M/X/A/2/CALL/-\n",
+          tlo::perf::k_perf_br_call },
+    } };
+    // NOLINTEND(*magic*)
+
+    tlo::perf::lbr_sample_t sample;
+    for (const fmt_test_t & test : k_tests) {
+        const size_t off = tlo::perf::parse_sample_line(test.line_, &sample);
+        ASSERT_NE(off, tlo::perf::k_parse_error);
+        ASSERT_NE(off, tlo::perf::k_parse_done);
+        ASSERT_EQ(tlo::perf::detect_lbr_fmt(test.line_, off), test.fmt_);
+
+        for (const fmt_test_t & other : k_tests) {
+            const size_t res = tlo::perf::parse_lbr_line(test.line_, off,
+                                                         &sample, other.fmt_);
+            if (other.fmt_ != test.fmt_) {
+                // Entries in the wrong format don't parse.
+                ASSERT_EQ(res, tlo::perf::k_parse_error);
+                continue;
+            }
+            ASSERT_EQ(res, tlo::perf::k_parse_done);
+            ASSERT_EQ(sample.num_lbr_samples(), 2U);
+            ASSERT_TRUE(sample.valid());
+            ASSERT_EQ(sample.samples_[0].from_.mapped_addr_, 0x401010U);
+            ASSERT_EQ(sample.samples_[0].to_.mapped_addr_, 0x402010U);
+            ASSERT_EQ(sample.samples_[0].cycles_, 2U);
+            ASSERT_EQ(sample.samples_[0].predicted_,
+                      tlo::perf::lbr_br_sample_t::k_mispred);
+            ASSERT_TRUE(sample.samples_[0].in_tx_);
+            ASSERT_TRUE(sample.samples_[0].aborted_);
+            ASSERT_EQ(sample.samples_[0].brtype_, test.brtype_);
+            ASSERT_EQ(sample.samples_[1].cycles_, 1U);
+            ASSERT_EQ(sample.samples_[1].brtype_,
+                      tlo::perf::k_perf_br_unknown);
+        }
+
+        // Detected from the first line, and used for the rest.
+        tlo::perf::lbr_line_parser_t parser{};
+        ASSERT_EQ(parser.parse_lbr_line(test.line_, off, &sample),
+                  tlo::perf::k_parse_done);
+        ASSERT_EQ(parser.fmt_, test.fmt_);
+        ASSERT_EQ(sample.num_lbr_samples(), 2U);
+        ASSERT_EQ(sample.samples_[0].brtype_, test.brtype_);
+    }
+
+    tlo::perf::lbr_line_parser_t parser{};
+    // No entries, so nothing to detect from.
+    std::string line = "app  12/13  4.000005: \n";
+    ASSERT_EQ(parser.parse_lbr_offsets_line(line, &sample),
+              tlo::perf::k_parse_incomplete);
+    ASSERT_EQ(parser.fmt_, tlo::perf::k_lbr_fmt_unknown);
+    ASSERT_FALSE(parser.reported_);
+
+    // Too many fields is an error (not silently dropping the extra ones).
+    line =
+        "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/-/1/CALL/-/7\n";
+    size_t off = tlo::perf::parse_sample_line(line, &sample);
+    ASSERT_EQ(tlo::perf::detect_lbr_fmt(line, off),
+              tlo::perf::k_lbr_fmt_unknown);
+    ASSERT_EQ(parser.parse_lbr_line(line, off, &sample),
+              tlo::perf::k_parse_error);
+    ASSERT_TRUE(parser.reported_);
+    ASSERT_EQ(parser.fmt_, tlo::perf::k_lbr_fmt_unknown);
+
+    // As is a bad field.
+    line =
+        "app  1/1  1.000001:      401000 (/a) 0x401000(/a)/0x402000(/a)/P/-/?/1/CALL\n";
+    off = tlo::perf::parse_sample_line(line, &sample);
+    ASSERT_EQ(tlo::perf::detect_lbr_fmt(line, off),
+              tlo::perf::k_lbr_fmt_unknown);
+
+    // The brstackoff lines use the same entries.
+    line =
+        "app  12/13  4.000005: 0x1f0(/usr/bin/app)/0x2000(/usr/lib/libc.so.6)/P/-/-/7/CALL\n";
+    parser = tlo::perf::lbr_line_parser_t{};
+    ASSERT_EQ(parser.parse_lbr_offsets_line(line, &sample),
+              tlo::perf::k_parse_done);
+    ASSERT_EQ(parser.fmt_, tlo::perf::k_lbr_fmt_brtype);
+    ASSERT_EQ(sample.samples_[0].brtype_, tlo::perf::k_perf_br_call);
+    ASSERT_EQ(tlo::perf::parse_lbr_offsets_line(
+                  line, &sample, tlo::perf::k_lbr_fmt_brdesc),
+              tlo::perf::k_parse_error);
+}
+
+TEST(perf, parse_lbr_offsets_line) {
+    tlo::perf::lbr_sample_t sample;
+    std::string             test_s =
+        "app  12/13  4.000005: 0x1f0(/usr/bin/app)/0x2000(/usr/lib/libc.so.6)/P/-/-/7/CALL/-  0x10(/usr/lib/libc.so.6)/0x1e0(/usr/bin/app)/M/-/-/2//-\n";
+    ASSERT_EQ(tlo::perf::parse_lbr_offsets_line(test_s, &sample),
+              tlo::perf::k_parse_done);
+    ASSERT_EQ(sample.hdr_.comm_.sview(), "app");
+    ASSERT_EQ(sample.hdr_.pid_, 12U);
+    ASSERT_EQ(sample.hdr_.tid_, 13U);
+    ASSERT_EQ(sample.num_lbr_samples(), 2U);
+    ASSERT_TRUE(sample.valid());
+    // Oldest first.
+    ASSERT_EQ(sample.samples_[0].from_.mapped_addr_, 0x10U);
+    ASSERT_EQ(sample.samples_[0].to_.mapped_addr_, 0x1e0U);
+    ASSERT_EQ(sample.samples_[1].from_.mapped_addr_, 0x1f0U);
+    ASSERT_EQ(sample.samples_[1].to_.dso_.sview(), "/usr/lib/libc.so.6");
+    ASSERT_EQ(sample.samples_[1].cycles_, 7U);
+    // No IP, the newest branch's target stands in for it.
+    ASSERT_EQ(sample.loc_.mapped_addr_, 0x2000U);
+    ASSERT_EQ(sample.loc_.dso_.sview(), "/usr/lib/libc.so.6");
+
+    // Sample without any branches.
+    test_s = "app  12/13  4.000005: \n";
+    ASSERT_EQ(tlo::perf::parse_lbr_offsets_line(test_s, &sample),
+              tlo::perf::k_parse_incomplete);
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-sample-cache.h"
+#include "src/perf/perf-stats.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "perf-text-profile-helper.h"
+
+TEST(perf, sample_cache) {
+    std::string info;
+    std::string events;
+    make_elf_profile(&info, &events, nullptr, 4000);  // NOLINT(*magic*)
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+    const tmp_text_file_t cache_file{ "" };
+
+    tlo::sym::sym_state_t   ss_collected{};
+    tlo::perf::perf_stats_t collected{ &ss_collected };
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &collected);
+    ASSERT_TRUE(collected.valid());
+
+    const std::array<std::string_view, 2> inputs = {
+        { events_file.path_.data(), info_file.path_.data() }
+    };
+    tlo::vec_t<char> key{};
+    ASSERT_TRUE(tlo::perf::perf_sample_cache_t::make_key(inputs, &key));
+    const std::string_view key_sv{ key.data(), key.size() };
+    ASSERT_TRUE(tlo::perf::perf_sample_cache_t::save(cache_file.path_.data(),
+                                                     key_sv, collected));
+
+    tlo::sym::sym_state_t   ss_stale{};
+    tlo::perf::perf_stats_t stale{ &ss_stale };
+    ASSERT_FALSE(tlo::perf::perf_sample_cache_t::load(
+        cache_file.path_.data(), "not-the-key", &stale, 1));
+    ASSERT_TRUE(stale.tpids_.empty());
+
+    tlo::sym::sym_state_t   ss_cached{};
+    tlo::perf::perf_stats_t cached{ &ss_cached };
+    ASSERT_TRUE(tlo::perf::perf_sample_cache_t::load(cache_file.path_.data(),
+                                                     key_sv, &cached, 1));
+    ASSERT_TRUE(cached.valid());
+    ASSERT_EQ(ss_collected.dso_tab_.size(), ss_cached.dso_tab_.size());
+    ASSERT_EQ(ss_collected.func_tab_.size(), ss_cached.func_tab_.size());
+    expect_same_stats(collected, cached);
+
+    // Filtering / clumping must not be able to tell the difference.
+    tlo::vec_t<tlo::perf::perf_func_t> funcs, cached_funcs;
+    tlo::vec_t<tlo::perf::perf_edge_t> edges, cached_edges;
+    collected.filter_and_clump(
+        tlo::perf::perf_stats_func_filter_t{},
+        tlo::perf::perf_stats_edge_filter_t{},
+        tlo::perf::perf_stats_function_order_clumper_t{}, &funcs, &edges);
+    cached.filter_and_clump(tlo::perf::perf_stats_func_filter_t{},
+                            tlo::perf::perf_stats_edge_filter_t{},
+                            tlo::perf::perf_stats_function_order_clumper_t{},
+                            &cached_funcs, &cached_edges);
+    ASSERT_EQ(funcs.size(), cached_funcs.size());
+    ASSERT_EQ(edges.size(), cached_edges.size());
+    expect_same_funcs_and_edges(funcs, edges, cached_funcs, cached_edges);
+    uint64_t size = 0, cached_size = 0;
+    for (size_t i = 0; i < funcs.size(); ++i) {
+        size += funcs[i].func_clump_->size();
+        cached_size += cached_funcs[i].func_clump_->size();
+    }
+    ASSERT_NE(size, 0U);
+    ASSERT_EQ(size, cached_size);
+}
@@ -7,10 +7,22 @@
 #include "src/perf/perf-saver.h"
 #include "src/perf/perf-stats.h"
 
+#include "src/util/file-ops.h"
+#include "src/util/json.h"
+
+#include <array>
+#include <map>
 #include <random>
 #include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "perf-file-and-save-state-helper.h"
+#include "perf-text-profile-helper.h"
 
 #define INPUT_PATH     TLO_PROJECT_DIR "/tests/src/perf/test-inputs/partial-saves/"
 #define ORDER_PATH_FMT INPUT_PATH "expec-order-c3"
@@ -3059,3 +3071,144 @@ TEST(perf, save_partial_states_cross_build) {
     }
 }
 
+static tlo::file_ops::filebuf_t
+read_tmp_file(const std::array<char, 256> & path) {
+    tlo::file_ops::filebuf_t content = tlo::file_ops::readfile(path.data());
+    EXPECT_TRUE(content.active());
+    return content;
+}
+
+static void
+reload_and_check(const char *                               path,
+                 const tlo::vec_t<tlo::perf::perf_func_t> & expec_funcs,
+                 const tlo::vec_t<tlo::perf::perf_edge_t> & expec_edges) {
+    tlo::sym::sym_state_t              ss{};
+    tlo::vec_t<tlo::perf::perf_func_t> funcs{};
+    tlo::vec_t<tlo::perf::perf_edge_t> edges{};
+    tlo::perf::perf_state_scaling_t    scaling_todo{};
+    scaling_todo.set_force_no_scale();
+    const tlo::perf::perf_state_reloader_t reloader{ &ss };
+    ASSERT_TRUE(reloader.reload_state(path, &funcs, &edges, &scaling_todo));
+    // Reloaded edges have no branch type.
+    expect_same_funcs_and_edges(expec_funcs, expec_edges, funcs, edges, false);
+
+    // Same sized functions, except where reloading merged same named ones.
+    std::map<std::string, std::pair<size_t, uint64_t>> expec_sizes;
+    for (const tlo::perf::perf_func_t & pf : expec_funcs) {
+        auto & [cnt, size] = expec_sizes[clump_key(pf.func_clump_)];
+        ++cnt;
+        size = pf.func_clump_->size();
+    }
+    size_t nchecked = 0;
+    for (const tlo::perf::perf_func_t & pf : funcs) {
+        const auto & [cnt, size] = expec_sizes[clump_key(pf.func_clump_)];
+        if (cnt == 1) {
+            ASSERT_EQ(pf.func_clump_->size(), size);
+            ++nchecked;
+        }
+    }
+    ASSERT_NE(nchecked, 0U);
+}
+
+TEST(perf, save_state_formats) {
+    std::string info;
+    std::string events;
+    make_elf_profile(&info, &events, nullptr, 4000);  // NOLINT(*magic*)
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+
+    tlo::sym::sym_state_t   ss{};
+    tlo::perf::perf_stats_t stats{ &ss };
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &stats);
+    ASSERT_TRUE(stats.valid());
+    tlo::vec_t<tlo::perf::perf_func_t> funcs{};
+    tlo::vec_t<tlo::perf::perf_edge_t> edges{};
+    stats.filter_and_clump(tlo::perf::perf_stats_func_filter_t{},
+                           tlo::perf::perf_stats_edge_filter_t{},
+                           tlo::perf::perf_stats_clumper_t{}, &funcs, &edges);
+    drop_self_edges(&edges);
+    ASSERT_GT(funcs.size(), 16U);
+    ASSERT_FALSE(edges.empty());
+
+    // NOLINTNEXTLINE(*magic*)
+    std::array<std::array<char, 256>, 6> paths{};
+    for (auto & path : paths) {
+        const int fd = tlo::file_ops::new_tmpfile(&path);
+        ASSERT_GT(fd, 0);
+        close(fd);
+    }
+    const auto & [bin_path, json_path, bin_to_json_path,
+                  bin_to_json_to_bin_path, json_to_bin_path,
+                  json_to_bin_to_json_path] = paths;
+
+    tlo::perf::perf_state_scaling_t scaling_todo{};
+    ASSERT_TRUE(scaling_todo.set_add_scale(2.0));  // NOLINT(*magic*)
+    const tlo::perf::perf_state_saver_t saver{ &ss };
+    ASSERT_TRUE(saver.save_state(bin_path.data(), &funcs, &edges,
+                                 &scaling_todo,
+                                 tlo::perf::k_perf_state_binary));
+    ASSERT_TRUE(saver.save_state(json_path.data(), &funcs, &edges,
+                                 &scaling_todo, tlo::perf::k_perf_state_json));
+
+    reload_and_check(bin_path.data(), funcs, edges);
+    reload_and_check(json_path.data(), funcs, edges);
+
+    // binary -> json -> binary
+    ASSERT_TRUE(tlo::perf::convert_perf_state(bin_path.data(),
+                                              bin_to_json_path.data(),
+                                              tlo::perf::k_perf_state_json));
+    ASSERT_TRUE(tlo::perf::convert_perf_state(
+        bin_to_json_path.data(), bin_to_json_to_bin_path.data(),
+        tlo::perf::k_perf_state_binary));
+    {
+        tlo::file_ops::filebuf_t orig = read_tmp_file(bin_path);
+        tlo::file_ops::filebuf_t conv = read_tmp_file(bin_to_json_to_bin_path);
+        ASSERT_EQ(orig.size(), conv.size());
+        ASSERT_EQ(memcmp(orig.data(), conv.data(), orig.size()), 0);
+        orig.cleanup();
+        conv.cleanup();
+    }
+
+    // json -> binary -> json
+    ASSERT_TRUE(tlo::perf::convert_perf_state(json_path.data(),
+                                              json_to_bin_path.data(),
+                                              tlo::perf::k_perf_state_binary));
+    ASSERT_TRUE(tlo::perf::convert_perf_state(
+        json_to_bin_path.data(), json_to_bin_to_json_path.data(),
+        tlo::perf::k_perf_state_json));
+    {
+        tlo::file_ops::filebuf_t orig = read_tmp_file(json_path);
+        tlo::file_ops::filebuf_t conv = read_tmp_file(json_to_bin_to_json_path);
+        ASSERT_EQ(orig.size(), conv.size());
+        ASSERT_EQ(memcmp(orig.data(), conv.data(), orig.size()), 0);
+        const tlo::json_t js = tlo::json_t::parse(std::string_view{
+            reinterpret_cast<const char *>(orig.data()), orig.size() });
+        ASSERT_TRUE(js.contains("perf_funcs"));
+        ASSERT_EQ(js["perf_funcs"].size(), funcs.size());
+        ASSERT_EQ(js["scaling"]["func_scale"].get<double>(), 2.0);
+        orig.cleanup();
+        conv.cleanup();
+    }
+
+    // A truncated binary save state is rejected rather than trusted.
+    {
+        tlo::file_ops::filebuf_t orig = read_tmp_file(bin_path);
+        ASSERT_TRUE(tlo::file_ops::writefile(
+            bin_to_json_to_bin_path.data(),
+            tlo::file_ops::filebuf_t{ orig.data(), orig.size() - 1 }, O_TRUNC));
+        orig.cleanup();
+        tlo::sym::sym_state_t                  ss_bad{};
+        tlo::vec_t<tlo::perf::perf_func_t>     funcs_bad{};
+        tlo::vec_t<tlo::perf::perf_edge_t>     edges_bad{};
+        const tlo::perf::perf_state_reloader_t reloader{ &ss_bad };
+        ASSERT_FALSE(reloader.reload_state(bin_to_json_to_bin_path.data(),
+                                           &funcs_bad, &edges_bad, nullptr));
+        ASSERT_TRUE(funcs_bad.empty());
+    }
+
+    for (const auto & path : paths) {
+        (void)remove(path.data());
+    }
+}
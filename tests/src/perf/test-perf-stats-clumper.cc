@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-stats-clumper.h"
+#include "src/sym/syms.h"
+#include "src/system/br-insn.h"
+
+#include <array>
+#include <string_view>
+
+#include <stdint.h>
+
+namespace {
+using tlo::perf::perf_edge_stats_t;
+using tlo::perf::perf_edge_t;
+using tlo::perf::perf_func_stats_t;
+using tlo::perf::perf_func_t;
+using tlo::sym::addr_range_t;
+using tlo::sym::func_clump_t;
+using tlo::sym::func_t;
+
+func_t
+make_func(const tlo::sym::dso_t * dso,
+          std::string_view        name,
+          uint64_t                lo,
+          uint64_t                hi) {
+    return func_t{ dso, true, name, std::string_view{ "" },
+                   addr_range_t{ lo, hi } };
+}
+}  // namespace
+
+TEST(perf, clump_by_name_chain) {
+    tlo::sym::sym_state_t   ss{};
+    const tlo::sym::dso_t * dso =
+        ss.get_dso(tlo::strbuf_t<>{ "/proc/self/exe" });
+    ASSERT_NE(dso, nullptr);
+
+    // NOLINTBEGIN(*magic*)
+    // Clump 2 shares "a" with clump 1 and "b" with clump 0. It merges into
+    // clump 1 (its first name), and then clump 0 follows "b" into clump 1 as
+    // well, not the other way around.
+    std::array<func_t, 6> funcs = { {
+        make_func(dso, "b", 0x1000, 0x1010),
+        make_func(dso, "a", 0x2000, 0x2010),
+        make_func(dso, "a", 0x3000, 0x3010),
+        make_func(dso, "b", 0x3010, 0x3030),
+        make_func(dso, "c", 0x4000, 0x4010),
+        make_func(dso, "d", 0x5000, 0x5010),
+    } };
+    std::array<func_clump_t, 5> clumps = { {
+        func_clump_t{ { &funcs[0], 1 }, funcs[0].get_addr_range() },
+        func_clump_t{ { &funcs[1], 1 }, funcs[1].get_addr_range() },
+        func_clump_t{ { &funcs[2], 2 }, addr_range_t{ 0x3000, 0x3030 } },
+        func_clump_t{ { &funcs[4], 1 }, funcs[4].get_addr_range() },
+        func_clump_t{ { &funcs[5], 1 }, funcs[5].get_addr_range() },
+    } };
+    const tlo::system::br_insn_t call = tlo::system::br_insn_t::find_enc(0xe8);
+    // NOLINTEND(*magic*)
+
+    tlo::vec_t<perf_func_t> pfuncs{};
+    for (func_clump_t & fc : clumps) {
+        pfuncs.emplace_back(perf_func_t{ &fc, perf_func_stats_t{} });
+    }
+    tlo::vec_t<perf_edge_t> pedges{};
+    pedges.emplace_back(
+        perf_edge_t{ &clumps[0], &clumps[3], call, perf_edge_stats_t{} });
+    pedges.emplace_back(
+        perf_edge_t{ &clumps[2], &clumps[1], call, perf_edge_stats_t{} });
+    pedges.emplace_back(
+        perf_edge_t{ &clumps[3], &clumps[4], call, perf_edge_stats_t{} });
+
+    tlo::perf::perf_stats_function_order_clumper_t{}.clump(&pfuncs, &pedges);
+
+    // The merged away clumps are filled from the back.
+    ASSERT_EQ(pfuncs.size(), 3U);
+    ASSERT_EQ(pfuncs[0].func_clump_, &clumps[4]);
+    ASSERT_EQ(pfuncs[1].func_clump_, &clumps[1]);
+    ASSERT_EQ(pfuncs[2].func_clump_, &clumps[3]);
+    ASSERT_EQ(clumps[1].num_funcs(), 4U);
+    ASSERT_EQ(pedges.size(), 2U);
+    ASSERT_EQ(pedges[0].from_, &clumps[1]);
+    ASSERT_EQ(pedges[0].to_, &clumps[3]);
+    ASSERT_EQ(pedges[1].from_, &clumps[3]);
+    ASSERT_EQ(pedges[1].to_, &clumps[4]);
+
+    for (const func_clump_t & fc : clumps) {
+        fc.cleanup();
+    }
+}
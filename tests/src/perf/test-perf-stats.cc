@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include "src/perf/perf-stats.h"
+#include "src/util/global-stats.h"
+
+#include <array>
+#include <string>
+
+#include "perf-text-profile-helper.h"
+
+TEST(perf, aggregation_keys) {
+    std::string info;
+    std::string events;
+    make_elf_profile(&info, &events, nullptr, 4000);  // NOLINT(*magic*)
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+
+    tlo::sym::sym_state_t   ss_tpid{};
+    tlo::perf::perf_stats_t per_tpid{ &ss_tpid };
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &per_tpid);
+    ASSERT_TRUE(per_tpid.valid());
+    ASSERT_EQ(per_tpid.tpids_.size(), 4U);
+
+    // 4 processes (with one thread each) all named "app".
+    const std::array<std::pair<const char *, size_t>, 3> k_keys = {
+        { { "pid", 4 }, { "comm", 1 }, { "global", 1 } }
+    };
+    for (const auto & [name, nkeys] : k_keys) {
+        tlo::perf::perf_agr_key_t agr_key;
+        ASSERT_TRUE(tlo::perf::perf_agr_key_from_str(name, &agr_key));
+        for (const size_t njobs : { size_t{ 1 }, size_t{ 4 } }) {
+            tlo::sym::sym_state_t   ss{};
+            tlo::perf::perf_stats_t stats{ &ss, agr_key };
+            collect_text_profile(info_file.path_.data(),
+                                 events_file.path_.data(), njobs, &stats);
+            ASSERT_TRUE(stats.valid());
+            ASSERT_EQ(stats.tpids_.size(), nkeys);
+            ASSERT_TRUE(per_tpid.agr_func_stats_.eq(stats.agr_func_stats_));
+            ASSERT_TRUE(per_tpid.agr_edge_stats_.eq(stats.agr_edge_stats_));
+            // Coarser tables, but the same weight for every function / edge
+            // once they are filtered.
+            expect_same_funcs_and_edges(per_tpid, stats);
+        }
+    }
+    tlo::perf::perf_agr_key_t agr_key;
+    ASSERT_FALSE(tlo::perf::perf_agr_key_from_str("tid", &agr_key));
+}
+
+TEST(perf, preaggregate) {
+    std::string info;
+    std::string events;
+    // Remap the text of one process part way through the samples so the same
+    // addresses resolve differently depending on the timestamp.
+    make_elf_profile(&info, &events, nullptr, 20000,  // NOLINT(*magic*)
+                     nullptr, 0x3000);                // NOLINT(*magic*)
+
+    const tmp_text_file_t info_file{ info };
+    const tmp_text_file_t events_file{ events };
+
+    tlo::sym::sym_state_t   ss_expec{};
+    tlo::perf::perf_stats_t expec{ &ss_expec };
+    double nbranches = tlo::G_total_stats.total_tracked_branches_.second;
+    collect_text_profile(info_file.path_.data(), events_file.path_.data(), 1,
+                         &expec);
+    ASSERT_TRUE(expec.valid());
+    const double expec_nbranches =
+        tlo::G_total_stats.total_tracked_branches_.second - nbranches;
+    ASSERT_NE(expec_nbranches, 0.0);
+
+    for (const size_t njobs : { size_t{ 1 }, size_t{ 2 }, size_t{ 4 } }) {
+        tlo::sym::sym_state_t   ss{};
+        tlo::perf::perf_stats_t stats{ &ss, tlo::perf::k_agr_tpid, true };
+        nbranches = tlo::G_total_stats.total_tracked_branches_.second;
+        collect_text_profile(info_file.path_.data(), events_file.path_.data(),
+                             njobs, &stats);
+        ASSERT_TRUE(stats.valid());
+        ASSERT_TRUE(stats.preagr_.empty());
+        ASSERT_EQ(tlo::G_total_stats.total_tracked_branches_.second -
+                      nbranches,
+                  expec_nbranches);
+
+        // Samples after the remap must have used the later mapping.
+        expect_same_stats(expec, stats);
+    }
+}
@@ -0,0 +1,212 @@
+#include "gtest/gtest.h"
+
+#include "src/sym/sym-cache.h"
+#include "src/sym/syms.h"
+#include "src/system/insn.h"
+#include "src/util/file-ops.h"
+#include "src/util/global-stats.h"
+
+#include <array>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+TEST(sym, dso_read_insn_mapped) {
+    tlo::sym::sym_state_t ss{};
+    // Any ELF will do, use ourselves.
+    tlo::sym::dso_t * dso = ss.get_dso(tlo::strbuf_t<>{ "/proc/self/exe" });
+    ASSERT_NE(dso, nullptr);
+    ASSERT_TRUE(dso->is_findable());
+    ASSERT_NE(dso->text_map_, nullptr);
+    ASSERT_GT(dso->text_len_, 0U);
+    ASSERT_EQ(dso->text_off_ % tlo::k_page_size, 0U);
+
+    const int fd = open("/proc/self/exe", O_RDONLY);
+    ASSERT_GE(fd, 0);
+    // Offsets in the mapping, at its very end, and outside of it must all
+    // match what is in the file.
+    const std::array<uint64_t, 4> offs = { {
+        dso->text_off_, dso->text_off_ + dso->text_len_ / 2,
+        dso->text_off_ + dso->text_len_ - 3, 0 } };
+    for (uint64_t off : offs) {
+        std::array<uint8_t, tlo::system::k_max_insn_sz> expec{};
+        std::array<uint8_t, tlo::system::k_max_insn_sz> insn_bytes{};
+        const size_t nread = static_cast<size_t>(
+            pread(fd, expec.data(), expec.size(), static_cast<off_t>(off)));
+        ASSERT_GE(nread, 3U);
+        ASSERT_TRUE(
+            dso->read_insn(off, { insn_bytes.data(), insn_bytes.size() }));
+        ASSERT_EQ(memcmp(expec.data(), insn_bytes.data(), nread), 0);
+    }
+    close(fd);
+}
+
+TEST(sym, dso_br_insn_cache) {
+    tlo::sym::sym_state_t ss{};
+    tlo::sym::dso_t * dso = ss.get_dso(tlo::strbuf_t<>{ "/proc/self/exe" });
+    ASSERT_NE(dso, nullptr);
+
+    // Locking (`shared`) or not, it is the same cache.
+    tlo::system::br_insn_t br_insn{};
+    for (uint64_t off = 0; off < 4096; off += 7) {
+        const bool shared = (off % 2) == 0;
+        ASSERT_FALSE(dso->find_cached_br_insn(off, &br_insn, shared));
+        dso->cache_br_insn(off, tlo::system::br_insn_t{ off % 5 }, shared);
+    }
+    for (uint64_t off = 0; off < 4096; off += 7) {
+        const bool shared = (off % 2) != 0;
+        ASSERT_TRUE(dso->find_cached_br_insn(off, &br_insn, shared));
+        ASSERT_EQ(br_insn.desc_idx_, off % 5);
+        ASSERT_FALSE(dso->find_cached_br_insn(off + 1, &br_insn, shared));
+    }
+}
+
+TEST(sym, dso_preload) {
+    const std::array<tlo::strbuf_t<>, 3> dso_strs = { {
+        tlo::strbuf_t<>{ "/proc/self/exe" },
+        tlo::strbuf_t<>{ "/nonexistent/libfoo.so" },
+        tlo::strbuf_t<>{ "[kernel.kallsyms]" },
+    } };
+
+    tlo::sym::sym_state_t ss_serial{};
+    tlo::sym::sym_state_t ss{};
+    ss.preload_dsos(dso_strs, 2);
+    // Nothing is tracked until requested.
+    size_t ndsos = 0;
+    for (const tlo::sym::dso_t * dso : ss.dsos()) {
+        (void)dso;
+        ++ndsos;
+    }
+    ASSERT_EQ(ndsos, 0U);
+
+    for (const tlo::strbuf_t<> & dso_str : dso_strs) {
+        const tlo::sym::dso_t * expec = ss_serial.get_dso(dso_str);
+        const tlo::sym::dso_t * dso   = ss.get_dso(dso_str);
+        ASSERT_NE(dso, nullptr);
+        ASSERT_EQ(dso, ss.get_dso(dso_str));
+        ASSERT_TRUE(dso->finalized_);
+        ASSERT_EQ(dso->is_findable(), expec->is_findable());
+        ASSERT_EQ(dso->num_func_refs(), expec->num_func_refs());
+        ASSERT_EQ(dso->num_func_clumps(), expec->num_func_clumps());
+        ASSERT_EQ(dso->num_deps(), expec->num_deps());
+        if (dso_str.eq(dso_strs[0])) {
+            ASSERT_GT(dso->num_func_refs(), 0U);
+        }
+        for (size_t i = 0; i < dso->num_func_refs(); ++i) {
+            const tlo::sym::func_t & func       = dso->all_funcs_[i];
+            const tlo::sym::func_t & expec_func = expec->all_funcs_[i];
+            ASSERT_TRUE(func.name_.eq(expec_func.name_));
+            ASSERT_TRUE(func.ident_.eq(expec_func.ident_));
+            ASSERT_TRUE(func.get_addr_range().eq(expec_func.get_addr_range()));
+            ASSERT_EQ(func.dso(), dso);
+            // Must have been moved to the shared table.
+            ASSERT_EQ(ss.get_strtab()->get_sbuf(func.name_).str(),
+                      func.name_.str());
+        }
+        for (size_t i = 0; i < dso->num_deps(); ++i) {
+            ASSERT_EQ(ss.get_strtab()->get_sbuf(dso->deps_[i]).str(),
+                      dso->deps_[i].str());
+        }
+    }
+}
+
+static void
+expect_same_syms(const tlo::sym::dso_t * dso, const tlo::sym::dso_t * expec) {
+    ASSERT_TRUE(dso->finalized_);
+    ASSERT_EQ(dso->num_func_refs(), expec->num_func_refs());
+    ASSERT_EQ(dso->num_func_clumps(), expec->num_func_clumps());
+    ASSERT_EQ(dso->num_deps(), expec->num_deps());
+    ASSERT_EQ(dso->has_dbg_, expec->has_dbg_);
+    ASSERT_EQ(dso->num_buildids(), expec->num_buildids());
+    for (size_t i = 0; i < dso->num_func_refs(); ++i) {
+        const tlo::sym::func_t & func       = dso->all_funcs_[i];
+        const tlo::sym::func_t & expec_func = expec->all_funcs_[i];
+        ASSERT_TRUE(func.name_.eq(expec_func.name_));
+        ASSERT_TRUE(func.ident_.eq(expec_func.ident_));
+        ASSERT_EQ(func.ident_.extra(), expec_func.ident_.extra());
+        ASSERT_EQ(func.has_elfinfo(), expec_func.has_elfinfo());
+        ASSERT_TRUE(func.get_addr_range().eq(expec_func.get_addr_range()));
+        ASSERT_EQ(func.dso(), dso);
+    }
+    for (size_t i = 0; i < dso->num_func_clumps(); ++i) {
+        const tlo::sym::func_clump_t & fc       = dso->func_clumps_[i];
+        const tlo::sym::func_clump_t & expec_fc = expec->func_clumps_[i];
+        ASSERT_EQ(fc.num_funcs(), expec_fc.num_funcs());
+        ASSERT_TRUE(fc.get_addr_range().eq(expec_fc.get_addr_range()));
+    }
+    for (size_t i = 0; i < dso->num_deps(); ++i) {
+        ASSERT_TRUE(dso->deps_[i].eq(expec->deps_[i]));
+    }
+    for (const tlo::strbuf_t<> & buildid : expec->buildids()) {
+        ASSERT_TRUE(dso->buildids().contains(buildid));
+    }
+}
+
+static double
+sym_cache_hits() {
+    return tlo::G_total_stats.total_sym_cache_hits_.second;
+}
+
+TEST(sym, dso_sym_cache) {
+    std::array<char, 64> dir = { { "/tmp/.tlo-sym-cache-XXXXXX" } };
+    ASSERT_NE(mkdtemp(dir.data()), nullptr);
+    tlo::sym::sym_cache_t::set_cache_dir(dir.data());
+
+    const tlo::strbuf_t<>   dso_str{ "/proc/self/exe" };
+    tlo::sym::sym_state_t   ss_elf{};
+    const tlo::sym::dso_t * expec = ss_elf.get_dso(dso_str);
+    ASSERT_GT(expec->num_func_refs(), 0U);
+
+    // Loading it populated the cache.
+    std::array<char, 512> entry{};
+    DIR *                 dirp = opendir(dir.data());
+    ASSERT_NE(dirp, nullptr);
+    for (const dirent * ent = readdir(dirp); ent != nullptr;
+         ent                = readdir(dirp)) {
+        if (ent->d_name[0] != '.') {
+            ASSERT_EQ(entry[0], '\0');
+            (void)snprintf(entry.data(), entry.size(), "%s/%s", dir.data(),
+                           ent->d_name);
+        }
+    }
+    closedir(dirp);
+    ASSERT_NE(entry[0], '\0');
+
+    {
+        const double          hits = sym_cache_hits();
+        tlo::sym::sym_state_t ss{};
+        expect_same_syms(ss.get_dso(dso_str), expec);
+        ASSERT_EQ(sym_cache_hits(), hits + 1);
+    }
+
+    // A corrupted entry must be ignored (and replaced).
+    const int fd = open(entry.data(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    const size_t fsize = tlo::file_ops::filesize(fd);
+    uint8_t      byte  = 0;
+    ASSERT_EQ(pread(fd, &byte, 1, static_cast<off_t>(fsize - 2)), 1);
+    byte ^= 0xff;
+    ASSERT_EQ(pwrite(fd, &byte, 1, static_cast<off_t>(fsize - 2)), 1);
+    close(fd);
+    {
+        const double          hits = sym_cache_hits();
+        tlo::sym::sym_state_t ss{};
+        expect_same_syms(ss.get_dso(dso_str), expec);
+        ASSERT_EQ(sym_cache_hits(), hits);
+    }
+    {
+        const double          hits = sym_cache_hits();
+        tlo::sym::sym_state_t ss{};
+        expect_same_syms(ss.get_dso(dso_str), expec);
+        ASSERT_EQ(sym_cache_hits(), hits + 1);
+    }
+
+    tlo::sym::sym_cache_t::set_cache_dir({});
+    ASSERT_EQ(unlink(entry.data()), 0);
+    ASSERT_EQ(rmdir(dir.data()), 0);
+}
@@ -29,8 +29,11 @@ struct test_pair_t {
     }
 };
 
+// Collect the generated inputs and their copies compressed with `ext` (one of
+// zst, lz4, xz, or gz).
 static void
-collect_file_pairs(std::vector<test_pair_t> * tests) {
+collect_file_pairs(std::vector<test_pair_t> * tests,
+                   const char *               ext = "zst") {
     char const * input_path = CINPUT_PATH;
     uint32_t     cnt, inp;
     for (cnt = 0; cnt < k_max_ctypes; ++cnt) {
@@ -45,8 +48,8 @@ collect_file_pairs(std::vector<test_pair_t> * tests) {
         }
         tests->emplace_back(file_path.data());
         for (inp = 1; inp < k_max_clevels; ++inp) {
-            res = snprintf(file_path.data(), k_file_path_sz, "%s%u.zst.%u",
-                           input_path, cnt, inp);
+            res = snprintf(file_path.data(), k_file_path_sz, "%s%u.%s.%u",
+                           input_path, cnt, ext, inp);
             ASSERT_LT(res, k_file_path_sz - 1);
             ASSERT_GT(res, 0);
             if (!tlo::file_ops::exists(file_path.data())) {
@@ -87,6 +87,13 @@ args = [(100, 100000, 1), (1000, 10000, 5), (10000, 1000, 10),
 
 ZSTD_CMD = "zstd -{} --long={} {} {} -o " + DST_PATH + "/{}"
 
+# Streaming formats (see src/util/stream-reader.h). For each the last level
+# is written as two independently compressed halves concatenated together
+# (multiple frames/streams/members).
+STREAM_FMTS = [("lz4", "lz4 -q -c -{} {}", [1, 9]),
+               ("xz", "xz -q -c -{} {}", [1, 6]),
+               ("gz", "gzip -q -c -{} {}", [1, 9])]
+
 for existing_f in os.listdir(DST_PATH):
     if existing_f.startswith("generated-test-compressed-reader-input-c"):
         os_do("rm {}".format(os.path.join(DST_PATH, existing_f)))
@@ -112,6 +119,20 @@ for arg in args:
         out_file = in_file + ".zst." + str(clevel)
 
         os_do(ZSTD_CMD.format(clevel, mwidth, ultra, in_path, out_file))
+    for ext, cmd, clevels in STREAM_FMTS:
+        for clevel in clevels:
+            out_path = os.path.join(DST_PATH,
+                                    in_file + ".{}.{}".format(ext, clevel))
+            if clevel != clevels[-1]:
+                os_do(cmd.format(clevel, in_path) + " > " + out_path)
+                continue
+            os_do("split -n 2 {} {}".format(in_path, in_path + ".part-"))
+            os_do(
+                cmd.format(clevel, in_path + ".part-aa") + " > " + out_path)
+            os_do(
+                cmd.format(clevel, in_path + ".part-ab") + " >> " + out_path)
+            os_do("rm {}.part-*".format(in_path))
+
     os_do("cp {} {}".format(in_path, DST_PATH))
 os_do("echo 1 > {}".format(
     os.path.join(os.getcwd(), sys.argv[0]) + ".done"))
@@ -2,17 +2,26 @@
 
 #include "tests/test-helpers/test-help.h"
 
+#include "src/util/compressed-writer.h"
 #include "src/util/file-ops.h"
 #include "src/util/file-reader.h"
+#include "src/util/uring.h"
+#ifdef TLO_ZSTD
+# include "src/util/zstd-frames.h"
+#endif
 
 #include "compressed-files-test-helper.h"
 
 #include <array>
+#include <random>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include <fcntl.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
 
 TEST(util, NO_ZSTD_DISABLED(file_reader_init)) {
     tlo::file_reader_t fr;
@@ -70,3 +79,362 @@ TEST(util, NO_ZSTD_DISABLED(file_reader_readlines)) {
     fr[0].cleanup();
     fr[1].cleanup();
 }
+
+// Read all lines with `nextlines` (the last line may not have a newline).
+static std::vector<std::string>
+collect_batched_lines(tlo::file_reader_t * fr) {
+    std::vector<std::string> lines;
+    tlo::line_batch_t        batch{};
+    while (fr->nextlines(&batch)) {
+        EXPECT_FALSE(batch.empty());
+        for (const std::string_view line : batch.lines_) {
+            lines.emplace_back(line);
+        }
+    }
+    EXPECT_TRUE(batch.empty());
+    EXPECT_FALSE(fr->nextlines(&batch));
+    return lines;
+}
+
+TEST(util, NO_ZSTD_DISABLED(file_reader_readlines_batched)) {
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests);
+    ASSERT_GT(tests.size(), 0U);
+
+    tlo::file_reader_t fr;
+    for (const test_pair_t & tp : tests) {
+        // `nextline` includes the null-terminator, batched lines don't.
+        std::vector<std::string> expec;
+        fr.init(tp.ascii_path_);
+        ASSERT_TRUE(fr.is_ascii());
+        for (;;) {
+            const std::string_view line = fr.nextline();
+            if (line.empty()) {
+                break;
+            }
+            ASSERT_EQ(line.back(), '\0');
+            expec.emplace_back(line.substr(0, line.length() - 1));
+        }
+
+        fr.init(tp.ascii_path_);
+        ASSERT_TRUE(fr.active());
+        ASSERT_EQ(collect_batched_lines(&fr), expec);
+        ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+
+        for (const std::string & zst_path : tp.zst_paths_) {
+            fr.init(zst_path);
+            ASSERT_TRUE(fr.is_zst());
+            ASSERT_TRUE(fr.active());
+            ASSERT_EQ(collect_batched_lines(&fr), expec);
+        }
+    }
+    fr.cleanup();
+}
+
+#ifdef TLO_ZSTD
+// Path for a temporary .zst file (the reader picks the reader type based on
+// the extension).
+static std::string
+tmp_zst_path() {
+    std::array<char, 256> tmpfile;
+    const int             fd = tlo::file_ops::new_tmpfile(&tmpfile);
+    EXPECT_GE(fd, 0);
+    close(fd);
+    (void)remove(tmpfile.data());
+    return std::string{ tmpfile.data() } + ".zst";
+}
+
+TEST(util, file_reader_zst_multi_frame) {
+    static constexpr size_t k_frame_size = 512 * 1024;
+    static constexpr size_t k_njobs      = 3;
+
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests);
+    ASSERT_GT(tests.size(), 0U);
+
+    const std::string  seekable_path = tmp_zst_path();
+    const std::string  frames_path   = tmp_zst_path();
+    tlo::file_reader_t fr;
+    for (const test_pair_t & tp : tests) {
+        std::vector<std::string> expec;
+        fr.init(tp.ascii_path_);
+        ASSERT_TRUE(fr.is_ascii());
+        expec = collect_batched_lines(&fr);
+
+        // Seekable format (with a seek table).
+        ASSERT_TRUE(tlo::compress_file_seekable(tp.ascii_path_.c_str(),
+                                                seekable_path.c_str(), 1,
+                                                k_njobs, k_frame_size));
+        // Same frames without the seek table.
+        tlo::file_ops::filebuf_t seekable =
+            tlo::file_ops::readfile(seekable_path.c_str());
+        ASSERT_TRUE(seekable.active());
+        tlo::vec_t<tlo::zst_frame_t> frames;
+        ASSERT_TRUE(tlo::zst_frames::from_seek_table(seekable.buf_, &frames));
+        ASSERT_GT(frames.size(), 1U);
+        const size_t frames_size = frames.back().coff_ + frames.back().csize_;
+        ASSERT_TRUE(tlo::file_ops::writefile(
+            frames_path.c_str(),
+            tlo::file_ops::filebuf_t{ seekable.data(), frames_size },
+            O_TRUNC));
+        seekable.cleanup();
+
+        for (const std::string & path : { seekable_path, frames_path }) {
+            for (const size_t njobs : { size_t{ 1 }, k_njobs }) {
+                fr.init(path, njobs);
+                ASSERT_TRUE(fr.is_zst());
+                ASSERT_TRUE(fr.active());
+                ASSERT_EQ(collect_batched_lines(&fr), expec);
+                ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+
+                fr.init(path, njobs);
+                for (const std::string & line : expec) {
+                    const std::string_view res = fr.nextline();
+                    ASSERT_EQ(res.substr(0, res.length() - 1), line);
+                }
+                ASSERT_TRUE(fr.nextline().empty());
+            }
+        }
+
+        // Single frame files are still streamed.
+        for (const std::string & zst_path : tp.zst_paths_) {
+            fr.init(zst_path, k_njobs);
+            ASSERT_TRUE(fr.is_zst());
+            ASSERT_EQ(collect_batched_lines(&fr), expec);
+        }
+    }
+    fr.cleanup();
+    (void)remove(seekable_path.c_str());
+    (void)remove(frames_path.c_str());
+}
+#endif
+
+// Check the reader for `ext` files is picked (by their magic bytes, not just
+// their extension) and that they read the same as the uncompressed files.
+template<typename T_reader_t>
+void
+check_stream_fmt(const char * ext,
+                 bool (tlo::file_reader_t::*is_fmt)() const) {
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests, ext);
+    ASSERT_GT(tests.size(), 0U);
+
+    std::array<char, 256> tmpfile;
+    const int             fd = tlo::file_ops::new_tmpfile(&tmpfile);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    const std::string noext_path = tmpfile.data();
+
+    tlo::file_reader_t fr;
+    for (const test_pair_t & tp : tests) {
+        fr.init(tp.ascii_path_);
+        ASSERT_TRUE(fr.is_ascii());
+        const std::vector<std::string> expec = collect_batched_lines(&fr);
+
+        for (const std::string & path : tp.zst_paths_) {
+            fr.init(path);
+            ASSERT_TRUE((fr.*is_fmt)());
+            ASSERT_TRUE(fr.active());
+            ASSERT_EQ(collect_batched_lines(&fr), expec);
+            ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+
+            fr.init(path);
+            for (const std::string & line : expec) {
+                const std::string_view res = fr.nextline();
+                ASSERT_EQ(res.substr(0, res.length() - 1), line);
+            }
+            ASSERT_TRUE(fr.nextline().empty());
+
+            tlo::file_ops::filebuf_t buf =
+                tlo::file_ops::readfile(path.c_str());
+            ASSERT_TRUE(buf.active());
+            ASSERT_TRUE(tlo::file_ops::writefile(noext_path.c_str(), buf,
+                                                 O_TRUNC));
+            fr.init(noext_path);
+            ASSERT_TRUE((fr.*is_fmt)());
+            ASSERT_EQ(collect_batched_lines(&fr), expec);
+
+            // Truncated input is an error, not a short read.
+            ASSERT_TRUE(tlo::file_ops::writefile(
+                noext_path.c_str(),
+                tlo::file_ops::filebuf_t{ buf.data(), buf.size() - 1 },
+                O_TRUNC));
+            buf.cleanup();
+            T_reader_t reader{};
+            ASSERT_TRUE(reader.init(noext_path.c_str()));
+            std::array<uint8_t, 4096> rbuf;
+            size_t                    res;
+            do {
+                res = reader.readn(rbuf.data(), rbuf.size());
+            } while (res == rbuf.size());
+            ASSERT_EQ(res, tlo::reader_base_t::k_err);
+            reader.cleanup();
+        }
+    }
+    fr.cleanup();
+    (void)remove(noext_path.c_str());
+}
+
+TEST(util, NO_LZ4_DISABLED(file_reader_lz4)) {
+    check_stream_fmt<tlo::lz4reader_t>("lz4", &tlo::file_reader_t::is_lz4);
+}
+
+TEST(util, NO_XZ_DISABLED(file_reader_xz)) {
+    check_stream_fmt<tlo::xzreader_t>("xz", &tlo::file_reader_t::is_xz);
+}
+
+TEST(util, NO_GZIP_DISABLED(file_reader_gz)) {
+    check_stream_fmt<tlo::gzreader_t>("gz", &tlo::file_reader_t::is_gz);
+}
+
+TEST(util, file_reader_io_uring) {
+    if (!tlo::uring_t::available()) {
+        GTEST_SKIP() << "io_uring is unavailable";
+    }
+    // Random (so it doesn't compress well) lines of random length and an odd
+    // total size so the last chunk read ahead is short.
+    static constexpr size_t k_size =
+        4 * tlo::uring_readahead_t::k_chunk_size + 4321;
+    std::mt19937                          rng(0);
+    std::uniform_int_distribution<size_t> len_dist(0, 300);
+    std::string                           content;
+    while (content.size() < k_size) {
+        const size_t len = len_dist(rng);
+        for (size_t i = 0; i < len; ++i) {
+            content.push_back(static_cast<char>('!' + rng() % 90));
+        }
+        content.push_back('\n');
+    }
+    content.resize(k_size);
+
+    std::array<char, 256> ascii_path;
+    const int             fd = tlo::file_ops::new_tmpfile(&ascii_path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_TRUE(tlo::file_ops::writefile(
+        ascii_path.data(),
+        tlo::file_ops::filebuf_t{
+            reinterpret_cast<const uint8_t *>(content.data()),
+            content.size() },
+        O_TRUNC));
+
+    // Odd sized reads straight from the readahead.
+    const int rfd = open(ascii_path.data(), O_RDONLY);
+    ASSERT_GE(rfd, 0);
+    ASSERT_TRUE(tlo::uring_t::set_enabled(true));
+    for (const size_t off : { size_t{ 0 }, size_t{ 12345 } }) {
+        tlo::uring_readahead_t * readahead =
+            tlo::uring_readahead_t::create(rfd, off);
+        ASSERT_NE(readahead, nullptr);
+        std::string res;
+        std::array<uint8_t, 77777> buf;
+        for (;;) {
+            const size_t n = readahead->read(buf.data(), buf.size());
+            ASSERT_NE(n, tlo::file_ops::k_err);
+            res.append(reinterpret_cast<const char *>(buf.data()), n);
+            if (n != buf.size()) {
+                break;
+            }
+        }
+        ASSERT_EQ(readahead->read(buf.data(), buf.size()), 0U);
+        ASSERT_EQ(res, content.substr(off));
+        tlo::uring_readahead_t::destroy(readahead);
+    }
+    close(rfd);
+
+    std::vector<std::string> paths{ ascii_path.data() };
+#ifdef TLO_ZSTD
+    const std::string zst_path = tmp_zst_path();
+    ASSERT_TRUE(tlo::compress_file_seekable(ascii_path.data(),
+                                            zst_path.c_str(), 1, 1));
+    ASSERT_GE(tlo::file_ops::filesize(zst_path.c_str()),
+              tlo::uring_readahead_t::k_min_file_size);
+    paths.emplace_back(zst_path);
+#endif
+
+    tlo::file_reader_t fr;
+    for (const std::string & path : paths) {
+        ASSERT_TRUE(tlo::uring_t::set_enabled(false));
+        fr.init(path);
+        const std::vector<std::string> expec = collect_batched_lines(&fr);
+        ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+
+        ASSERT_TRUE(tlo::uring_t::set_enabled(true));
+        fr.init(path);
+        ASSERT_TRUE(fr.active());
+        if (fr.is_ascii()) {
+            const auto * areader = fr.areader();
+            ASSERT_NE(areader, nullptr);
+            ASSERT_NE(areader->readahead_, nullptr);
+        }
+#ifdef TLO_ZSTD
+        else {
+            const auto * creader = fr.creader();
+            ASSERT_NE(creader, nullptr);
+            ASSERT_NE(creader->readahead_, nullptr);
+        }
+#endif
+        ASSERT_EQ(collect_batched_lines(&fr), expec);
+        ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+
+        fr.init(path);
+        for (const std::string & line : expec) {
+            const std::string_view res = fr.nextline();
+            ASSERT_EQ(res.substr(0, res.length() - 1), line);
+        }
+        ASSERT_TRUE(fr.nextline().empty());
+        (void)remove(path.c_str());
+    }
+    fr.cleanup();
+    ASSERT_TRUE(tlo::uring_t::set_enabled(false));
+}
+
+TEST(util, file_reader_seek) {
+    std::string content;
+    for (size_t i = 0; i < 10000; ++i) {  // NOLINT(*magic*)
+        content += "line " + std::to_string(i) + "\n";
+    }
+    std::array<char, 256> ascii_path;
+    const int             fd = tlo::file_ops::new_tmpfile(&ascii_path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_TRUE(tlo::file_ops::writefile(
+        ascii_path.data(),
+        tlo::file_ops::filebuf_t{
+            reinterpret_cast<const uint8_t *>(content.data()),
+            content.size() },
+        O_TRUNC));
+    const size_t off = content.find("line 5000\n");
+    ASSERT_NE(off, std::string::npos);
+
+    tlo::file_reader_t fr;
+    for (const bool uring : { false, true }) {
+        if (uring && !tlo::uring_t::set_enabled(true)) {
+            continue;
+        }
+        fr.init(ascii_path.data());
+        ASSERT_FALSE(fr.seek(content.size() + 1));
+        ASSERT_TRUE(fr.seek(off));
+        ASSERT_EQ(fr.nbytes_read(), off);
+        std::string res;
+        for (const std::string & line : collect_batched_lines(&fr)) {
+            res += line;
+        }
+        ASSERT_EQ(res, content.substr(off));
+        ASSERT_EQ(fr.nbytes_read(), fr.nbytes_total());
+        // Only before anything was read.
+        ASSERT_FALSE(fr.seek(off));
+    }
+    ASSERT_TRUE(tlo::uring_t::set_enabled(false));
+
+#ifdef TLO_ZSTD
+    const std::string zst_path = tmp_zst_path();
+    ASSERT_TRUE(tlo::compress_file_seekable(ascii_path.data(),
+                                            zst_path.c_str(), 1, 1));
+    fr.init(zst_path);
+    ASSERT_FALSE(fr.seek(off));
+    (void)remove(zst_path.c_str());
+#endif
+    fr.cleanup();
+    (void)remove(ascii_path.data());
+}
@@ -8,6 +8,7 @@
 #include "src/util/file-ops.h"
 #include "src/util/memory.h"
 #include "src/util/reader.h"
+#include "src/util/stream-reader.h"
 
 #include "compressed-files-test-helper.h"
 
@@ -194,6 +195,30 @@ TEST(util, NO_ZSTD_DISABLED(creader_read)) {
 }
 
 
+TEST(util, NO_LZ4_DISABLED(lz4reader_read)) {
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests, "lz4");
+    ASSERT_GT(tests.size(), 0U);
+    run_reader_tests<tlo::lz4reader_t>(tests);
+}
+
+
+TEST(util, NO_XZ_DISABLED(xzreader_read)) {
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests, "xz");
+    ASSERT_GT(tests.size(), 0U);
+    run_reader_tests<tlo::xzreader_t>(tests);
+}
+
+
+TEST(util, NO_GZIP_DISABLED(gzreader_read)) {
+    std::vector<test_pair_t> tests;
+    collect_file_pairs(&tests, "gz");
+    ASSERT_GT(tests.size(), 0U);
+    run_reader_tests<tlo::gzreader_t>(tests);
+}
+
+
 TEST(util, areader_read) {
     std::vector<test_pair_t> tests;
     char const *             input_path = CINPUT_PATH;
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "src/util/str-scan.h"
+
+#include <charconv>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+// Mostly chars from the alphabet, the rest random bytes.
+static std::string
+make_str(std::mt19937_64 * rng, std::string_view alphabet, size_t len) {
+    std::string str;
+    for (size_t i = 0; i < len; ++i) {
+        const uint64_t r = (*rng)();
+        str += (r % 8) == 0 ? static_cast<char>(r >> 8U)
+                            : alphabet[(r >> 8U) % alphabet.size()];
+    }
+    return str;
+}
+
+TEST(util, str_scan_find) {
+    static constexpr std::string_view k_alphabet = "abc/() :x";
+    std::mt19937_64                   rng(1);
+    for (uint32_t iter = 0; iter < 20000; ++iter) {
+        // Long runs without the delimiters so the wide loops are used.
+        const std::string str =
+            make_str(&rng, iter % 2 ? k_alphabet : "abc", rng() % 300);
+        const char c0 = k_alphabet[rng() % k_alphabet.size()];
+        const char c1 = rng() % 4 ? k_alphabet[rng() % k_alphabet.size()]
+                                  : static_cast<char>(rng());
+        for (size_t off = 0; off < std::min<size_t>(str.size(), 3); ++off) {
+            const char * p = str.data() + off;
+            const size_t n = str.size() - off;
+
+            const size_t expec_of =
+                tlo::scan::detail::find_first_of_scalar(p, n, c0, c1);
+            const size_t expec_not_of =
+                tlo::scan::detail::find_first_not_of_scalar(p, n, c0);
+            ASSERT_EQ(tlo::scan::find_first_of(p, n, c0, c1), expec_of);
+            ASSERT_EQ(tlo::scan::find_first_not_of(p, n, c0), expec_not_of);
+            ASSERT_EQ(tlo::scan::detail::find_first_of_swar(p, n, c0, c1),
+                      expec_of);
+            ASSERT_EQ(tlo::scan::detail::find_first_not_of_swar(p, n, c0),
+                      expec_not_of);
+#ifdef __SSE2__
+            ASSERT_EQ(tlo::scan::detail::find_first_of_sse2(p, n, c0, c1),
+                      expec_of);
+            ASSERT_EQ(tlo::scan::detail::find_first_not_of_sse2(p, n, c0),
+                      expec_not_of);
+#endif
+#ifdef __AVX2__
+            ASSERT_EQ(tlo::scan::detail::find_first_of_avx2(p, n, c0, c1),
+                      expec_of);
+            ASSERT_EQ(tlo::scan::detail::find_first_not_of_avx2(p, n, c0),
+                      expec_not_of);
+#endif
+#ifdef __AVX512BW__
+            ASSERT_EQ(tlo::scan::detail::find_first_of_avx512(p, n, c0, c1),
+                      expec_of);
+            ASSERT_EQ(tlo::scan::detail::find_first_not_of_avx512(p, n, c0),
+                      expec_not_of);
+#endif
+        }
+    }
+}
+
+template<typename T_t, int k_base>
+static void
+check_parse_uint(const std::string & str) {
+    for (size_t n = 0; n <= str.size(); ++n) {
+        T_t        expec_val = 0;
+        const auto res =
+            std::from_chars(str.data(), str.data() + n, expec_val, k_base);
+        const size_t expec_len =
+            res.ec == std::errc() ? static_cast<size_t>(res.ptr - str.data())
+                                  : 0;
+
+        T_t          val = 0;
+        const size_t len =
+            k_base == 16 ? tlo::scan::parse_hex(str.data(), n, &val)
+                         : tlo::scan::parse_dec(str.data(), n, &val);
+        ASSERT_EQ(len, expec_len) << str.substr(0, n);
+        ASSERT_EQ(val, expec_val) << str.substr(0, n);
+    }
+}
+
+TEST(util, str_scan_parse_uint) {
+    std::mt19937_64                rng(2);
+    const std::vector<std::string> fixed = {
+        "",
+        "0",
+        "/",
+        "ffffffff",
+        "100000000",
+        "ffffffffffffffff",
+        "10000000000000000",
+        "0000000000000000000000000001",
+        "4294967295",
+        "4294967296",
+        "18446744073709551615",
+        "18446744073709551616",
+        "99999999999999999999",
+        "7fffffffABCDEF/0x1",
+        "123456.654321: ",
+    };
+    for (const std::string & str : fixed) {
+        check_parse_uint<uint32_t, 10>(str);
+        check_parse_uint<uint64_t, 10>(str);
+        check_parse_uint<uint32_t, 16>(str);
+        check_parse_uint<uint64_t, 16>(str);
+    }
+    for (uint32_t iter = 0; iter < 4000; ++iter) {
+        const std::string digits =
+            make_str(&rng, iter % 2 ? "0123456789" : "0123456789abcdefABCDEF",
+                     rng() % 24);
+        const std::string str = digits + make_str(&rng, " /:.)x", rng() % 4);
+        check_parse_uint<uint32_t, 10>(str);
+        check_parse_uint<uint64_t, 10>(str);
+        check_parse_uint<uint32_t, 16>(str);
+        check_parse_uint<uint64_t, 16>(str);
+    }
+}
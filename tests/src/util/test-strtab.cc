@@ -158,3 +158,23 @@ TEST(util, strbuf_many) {
     ASSERT_EQ(corr_set.size(), stab0.size());
     ASSERT_EQ(corr_set.size(), stab1.size());
 }
+
+TEST(util, strtab_clear) {
+    tlo::strtab_t<false> stab0{};
+    tlo::strtab_t<true>  stab1{};
+
+    ASSERT_TRUE(stab0.get("foo").added());
+    ASSERT_TRUE(stab1.get("").added());
+    ASSERT_TRUE(stab1.get("foo").added());
+    stab0.clear();
+    stab1.clear();
+    ASSERT_EQ(stab0.size(), 0U);
+    ASSERT_EQ(stab1.size(), 0U);
+
+    ASSERT_TRUE(stab0.get("foo").added());
+    ASSERT_TRUE(stab1.get("").added());
+    ASSERT_TRUE(stab1.get("foo").added());
+    ASSERT_FALSE(stab0.get("foo").added());
+    ASSERT_FALSE(stab1.get("").added());
+    ASSERT_EQ(stab0.get("foo").sview(), "foo");
+}
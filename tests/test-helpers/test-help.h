@@ -9,5 +9,23 @@
 # define NO_ZSTD_DISABLED(...) __VA_ARGS__
 #endif
 
+#ifndef TLO_LZ4
+# define NO_LZ4_DISABLED(...) TLO_CAT(DISABLED_, __VA_ARGS__)
+#else
+# define NO_LZ4_DISABLED(...) __VA_ARGS__
+#endif
+
+#ifndef TLO_XZ
+# define NO_XZ_DISABLED(...) TLO_CAT(DISABLED_, __VA_ARGS__)
+#else
+# define NO_XZ_DISABLED(...) __VA_ARGS__
+#endif
+
+#ifndef TLO_GZIP
+# define NO_GZIP_DISABLED(...) TLO_CAT(DISABLED_, __VA_ARGS__)
+#else
+# define NO_GZIP_DISABLED(...) __VA_ARGS__
+#endif
+
 
 #endif